@@ -33,7 +33,7 @@ enum class DrawingMode {
     MIDPOINT_CIRCLE,
     BRESENHAM_CIRCLE,
     MULTI_BEZIER,  // Bezier
-    SCANLINE_FILL, // դ
+    SCANLINE_FILL, // ɨ䣨߱
     SEED_FILL,     // 
     POLYGON,       // 
     CLIP_LINES,    // Liang-Barskyü
@@ -65,4 +65,14 @@ enum class LineStyle {
     DOT = 2,            // 
     DASH_DOT = 3,       // 㻮
     DASH_DOT_DOT = 4    // ˫㻮
-};
\ No newline at end of file
+};
+// ߶ʽߣ
+enum class LineCap {
+    ROUND = 0,          // Բͷ˵㴦߿Բ
+    FLAT = 1            // ƽͷֹڶ˵
+};
+// Χģʽ
+enum class BoundsMode {
+    CONTROL_HULL = 0,   // BezierȡƵΧУߣ죩
+    TIGHT = 1           // Bezierȡ߱ļֵ߽⵼㣬ϸֱƽ
+};
@@ -0,0 +1,85 @@
+#pragma once
+#include "CommonType.h"
+
+// 线型的虚线模式：从实段开始交替的实段、空段长度；实线的段数为0
+struct DashPattern {
+    const float *lengths;
+    int count;
+    float period;
+};
+
+// 各线型的虚线模式表，编译期常量，按 LineStyle 的值索引
+namespace DashPatterns {
+    // 像素级算法（中点/Bresenham画线、画圆）的线型，单位为像素：8像素线段、2像素点、4像素间隔
+    constexpr float PIXEL_DASH[] = {8.0f, 4.0f};
+    constexpr float PIXEL_DOT[] = {2.0f, 4.0f};
+    constexpr float PIXEL_DASH_DOT[] = {8.0f, 4.0f, 2.0f, 4.0f};
+    constexpr float PIXEL_DASH_DOT_DOT[] = {8.0f, 4.0f, 2.0f, 4.0f, 2.0f, 4.0f};
+
+    // 笔划（D2D笔划样式、软件光栅化）的线型，以线宽为单位
+    constexpr float STROKE_DASH[] = {5.0f, 5.0f};
+    constexpr float STROKE_DOT[] = {1.0f, 3.0f};
+    constexpr float STROKE_DASH_DOT[] = {8.0f, 3.0f, 1.0f, 3.0f};
+    constexpr float STROKE_DASH_DOT_DOT[] = {8.0f, 3.0f, 1.0f, 3.0f, 1.0f, 3.0f};
+
+    constexpr DashPattern PIXEL_PATTERNS[] = {
+        {nullptr, 0, 0.0f},
+        {PIXEL_DASH, 2, 12.0f},
+        {PIXEL_DOT, 2, 6.0f},
+        {PIXEL_DASH_DOT, 4, 18.0f},
+        {PIXEL_DASH_DOT_DOT, 6, 24.0f}
+    };
+    constexpr DashPattern STROKE_PATTERNS[] = {
+        {nullptr, 0, 0.0f},
+        {STROKE_DASH, 2, 10.0f},
+        {STROKE_DOT, 2, 4.0f},
+        {STROKE_DASH_DOT, 4, 15.0f},
+        {STROKE_DASH_DOT_DOT, 6, 19.0f}
+    };
+
+    inline const DashPattern &Pixel(LineStyle style) {
+        return PIXEL_PATTERNS[static_cast<int>(style)];
+    }
+    inline const DashPattern &Stroke(LineStyle style) {
+        return STROKE_PATTERNS[static_cast<int>(style)];
+    }
+}
+
+// 沿路径推进的虚线游标：记录当前所在的段和段内剩余长度，每前进一步只做减法和比较，
+// 不需要开方和取模。线段、圆弧、折线都按弧长推进同一个游标，跨段保持相位
+class DashCursor {
+public:
+    // scale 为模式长度的缩放（笔划线型传入线宽）
+    explicit DashCursor(const DashPattern &pattern, float scale = 1.0f) :
+        m_lengths(pattern.lengths), m_count(scale > 0.0f ? pattern.count : 0), m_scale(scale), m_index(0),
+        m_remain(m_count ? pattern.lengths[0] * scale : 0.0f) {
+    }
+
+    bool IsSolid() const {
+        return m_count == 0;
+    }
+    // 当前位置是否在实段上（位置恰好在段的末端时属于下一段）
+    bool IsOn() const {
+        return (m_index & 1) == 0;
+    }
+    // 当前段剩余的长度
+    float Remaining() const {
+        return m_remain;
+    }
+
+    void Advance(float distance) {
+        if (!m_count) return;
+        m_remain -= distance;
+        while (m_remain <= 0.0f) {
+            m_index = (m_index + 1 == m_count) ? 0 : m_index + 1;
+            m_remain += m_lengths[m_index] * m_scale;
+        }
+    }
+
+private:
+    const float *m_lengths;
+    int m_count;
+    float m_scale;
+    int m_index;
+    float m_remain;
+};
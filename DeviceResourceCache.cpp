@@ -0,0 +1,188 @@
+#include "DeviceResourceCache.h"
+#include <cwchar>
+
+namespace {
+    thread_local DeviceResourceCache *g_currentCache = nullptr;
+
+    // 颜色分量量化到8位后打包，作为画刷的键
+    uint64_t PackColor(const D2D1_COLOR_F &color) {
+        auto channel = [](float v) -> uint64_t {
+            v = v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v);
+            return static_cast<uint64_t>(v * 255.0f + 0.5f);
+        };
+        return channel(color.r) << 24 | channel(color.g) << 16 | channel(color.b) << 8 | channel(color.a);
+    }
+
+    template <typename Map>
+    void SweepIdle(Map &entries, uint64_t frame, uint32_t maxIdle) {
+        for (auto it = entries.begin(); it != entries.end();) {
+            if (frame - it->second.lastFrame > maxIdle) {
+                it = entries.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+DeviceResourceCache::DeviceResourceCache() :
+    m_pRenderTarget(nullptr), m_pCompatibleTarget(nullptr), m_pFactory(nullptr), m_pDWriteFactory(nullptr), m_frame(0), m_viewScale(1.0f), m_strokeScale(1.0f) {
+}
+
+DeviceResourceCache::~DeviceResourceCache() {
+    Clear();
+    if (g_currentCache == this) g_currentCache = nullptr;
+}
+
+void DeviceResourceCache::Attach(ID2D1RenderTarget *pRenderTarget, IDWriteFactory *pDWriteFactory) {
+    if (pRenderTarget != m_pRenderTarget) {
+        ReleaseBrushes();
+        ReleaseBitmaps();
+        m_pRenderTarget = pRenderTarget;
+        m_pCompatibleTarget = nullptr;
+        if (pRenderTarget) {
+            ID2D1Factory *pFactory = nullptr;
+            pRenderTarget->GetFactory(&pFactory);
+            if (pFactory != m_pFactory) {
+                // 换了工厂，旧工厂创建的几何不能再和新目标一起使用
+                for (auto &entry : m_geometries) {
+                    if (entry.second.pGeometry) entry.second.pGeometry->Release();
+                }
+                m_geometries.clear();
+                if (m_pFactory) m_pFactory->Release();
+                m_pFactory = pFactory;
+            } else if (pFactory) {
+                pFactory->Release();
+            }
+        }
+    }
+    m_pDWriteFactory = pDWriteFactory;
+}
+
+void DeviceResourceCache::DiscardDeviceResources() {
+    ReleaseBrushes();
+    ReleaseBitmaps();
+    m_pRenderTarget = nullptr;
+    m_pCompatibleTarget = nullptr;
+}
+
+void DeviceResourceCache::Clear() {
+    ReleaseBrushes();
+    ReleaseBitmaps();
+    m_pRenderTarget = nullptr;
+    m_pCompatibleTarget = nullptr;
+    for (auto &entry : m_geometries) {
+        if (entry.second.pGeometry) entry.second.pGeometry->Release();
+    }
+    m_geometries.clear();
+    for (auto &entry : m_textLayouts) {
+        if (entry.second.pLayout) entry.second.pLayout->Release();
+    }
+    m_textLayouts.clear();
+    for (auto &entry : m_textFormats) {
+        if (entry.second) entry.second->Release();
+    }
+    m_textFormats.clear();
+    if (m_pFactory) {
+        m_pFactory->Release();
+        m_pFactory = nullptr;
+    }
+    m_pDWriteFactory = nullptr;
+}
+
+void DeviceResourceCache::ReleaseBrushes() {
+    for (auto &entry : m_brushes) {
+        if (entry.second) entry.second->Release();
+    }
+    m_brushes.clear();
+}
+
+void DeviceResourceCache::ReleaseBitmaps() {
+    for (auto &entry : m_bitmaps) {
+        if (entry.second.pBitmap) entry.second.pBitmap->Release();
+    }
+    m_bitmaps.clear();
+}
+
+void DeviceResourceCache::EndFrame() {
+    for (auto &entry : m_geometries) {
+        if (m_frame - entry.second.lastFrame > MAX_IDLE_FRAMES && entry.second.pGeometry) {
+            entry.second.pGeometry->Release();
+            entry.second.pGeometry = nullptr;
+        }
+    }
+    SweepIdle(m_geometries, m_frame, MAX_IDLE_FRAMES);
+    for (auto &entry : m_bitmaps) {
+        if (m_frame - entry.second.lastFrame > MAX_IDLE_FRAMES && entry.second.pBitmap) {
+            entry.second.pBitmap->Release();
+            entry.second.pBitmap = nullptr;
+        }
+    }
+    SweepIdle(m_bitmaps, m_frame, MAX_IDLE_FRAMES);
+    for (auto &entry : m_textLayouts) {
+        if (m_frame - entry.second.lastFrame > MAX_IDLE_FRAMES && entry.second.pLayout) {
+            entry.second.pLayout->Release();
+            entry.second.pLayout = nullptr;
+        }
+    }
+    SweepIdle(m_textLayouts, m_frame, MAX_IDLE_FRAMES);
+}
+
+ID2D1SolidColorBrush *DeviceResourceCache::GetBrush(const D2D1_COLOR_F &color) {
+    if (!m_pRenderTarget) return nullptr;
+    ID2D1SolidColorBrush *&pBrush = m_brushes[PackColor(color)];
+    if (!pBrush) {
+        m_pRenderTarget->CreateSolidColorBrush(color, &pBrush);
+    }
+    return pBrush;
+}
+
+ID2D1Bitmap *DeviceResourceCache::CreateMaskBitmap(ID2D1RenderTarget *pRenderTarget, UINT32 width, UINT32 height,
+                                                   const void *pixels, UINT32 pitch) {
+    if (!pRenderTarget || width == 0 || height == 0) return nullptr;
+    D2D1_BITMAP_PROPERTIES properties = D2D1::BitmapProperties(
+        D2D1::PixelFormat(DXGI_FORMAT_A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED));
+    ID2D1Bitmap *pBitmap = nullptr;
+    if (FAILED(pRenderTarget->CreateBitmap(D2D1::SizeU(width, height), pixels, pitch, properties, &pBitmap))) {
+        return nullptr;
+    }
+    return pBitmap;
+}
+
+IDWriteTextFormat *DeviceResourceCache::GetTextFormat(const wchar_t *family, float size) {
+    if (!m_pDWriteFactory) return nullptr;
+    wchar_t prefix[32];
+    swprintf(prefix, 32, L"%g|", size);
+    IDWriteTextFormat *&pFormat = m_textFormats[std::wstring(prefix) + family];
+    if (!pFormat) {
+        m_pDWriteFactory->CreateTextFormat(
+            family, nullptr,
+            DWRITE_FONT_WEIGHT_NORMAL,
+            DWRITE_FONT_STYLE_NORMAL,
+            DWRITE_FONT_STRETCH_NORMAL,
+            size, L"en-us", &pFormat);
+    }
+    return pFormat;
+}
+
+IDWriteTextLayout *DeviceResourceCache::GetTextLayout(IDWriteTextFormat *pFormat, const wchar_t *text,
+                                                      float maxWidth, float maxHeight) {
+    if (!m_pDWriteFactory || !pFormat) return nullptr;
+    wchar_t prefix[64];
+    swprintf(prefix, 64, L"%p|%gx%g|", static_cast<void *>(pFormat), maxWidth, maxHeight);
+    LayoutEntry &entry = m_textLayouts[std::wstring(prefix) + text];
+    entry.lastFrame = m_frame;
+    if (!entry.pLayout) {
+        m_pDWriteFactory->CreateTextLayout(text, static_cast<UINT32>(wcslen(text)), pFormat,
+                                           maxWidth, maxHeight, &entry.pLayout);
+    }
+    return entry.pLayout;
+}
+
+DeviceResourceCache *DeviceResourceCache::Current() {
+    return g_currentCache;
+}
+
+void DeviceResourceCache::SetCurrent(DeviceResourceCache *cache) {
+    g_currentCache = cache;
+}
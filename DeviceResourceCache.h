@@ -0,0 +1,169 @@
+#pragma once
+#include <d2d1.h>
+#include <dwrite.h>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 绘制循环用的资源缓存：纯色画刷按颜色、路径几何按图形的几何版本、文本格式按字体、文本布局按文本内容缓存，
+// 跨帧复用，只在内容变化或设备丢失时重建，绘制一帧不再反复创建和释放这些对象。
+// 画刷依赖渲染目标，设备丢失或更换渲染目标时释放；路径几何和文本与设备无关，设备丢失后继续使用。
+// 几何和文本布局记录最后一次使用的帧，连续 MAX_IDLE_FRAMES 帧没有用到的（图形已删除、几何已修改、文本已变化）在 EndFrame 时释放。
+// 每个线程有自己的当前缓存（界面线程由 GraphicsEngine 设置），图形绘制时通过它取得资源；返回的对象都是借用的，不需要 Release
+class DeviceResourceCache {
+public:
+    static const uint32_t MAX_IDLE_FRAMES = 60;
+
+    DeviceResourceCache();
+    ~DeviceResourceCache();
+
+    DeviceResourceCache(const DeviceResourceCache &) = delete;
+    DeviceResourceCache &operator=(const DeviceResourceCache &) = delete;
+
+    // 绑定渲染目标和DirectWrite工厂（不持有引用）；渲染目标变化时释放旧目标上创建的画刷
+    void Attach(ID2D1RenderTarget *pRenderTarget, IDWriteFactory *pDWriteFactory);
+    // 设备丢失：释放依赖渲染目标的资源，解除绑定
+    void DiscardDeviceResources();
+    // 释放全部资源
+    void Clear();
+
+    ID2D1RenderTarget *GetRenderTarget() const {
+        return m_pRenderTarget;
+    }
+    // 与绑定的渲染目标共享设备的兼容目标（如静态层的位图渲染目标），在它上面绘制时同样使用缓存中的画刷和位图（不持有引用）
+    void SetCompatibleTarget(ID2D1RenderTarget *pTarget) {
+        m_pCompatibleTarget = pTarget;
+    }
+    // 在 pTarget 上绘制时能否使用这个缓存的资源
+    bool IsBoundTo(const ID2D1RenderTarget *pTarget) const {
+        return pTarget && (pTarget == m_pRenderTarget || pTarget == m_pCompatibleTarget);
+    }
+
+    // 绘制时的视图缩放（窗口像素/文档单位），由 GraphicsEngine 每帧设置；图形据此选择细节层次
+    void SetViewScale(float scale) {
+        m_viewScale = scale;
+    }
+    float GetViewScale() const {
+        return m_viewScale;
+    }
+    // 绘制带保留变换的图形时设为该变换的缩放（其余时候为1）：渲染目标的变换含有这部分缩放，
+    // 描边线宽先除以它，拖动缩放过程中的线宽与变换写回几何后一致
+    void SetStrokeScale(float scale) {
+        m_strokeScale = scale;
+    }
+    float GetStrokeScale() const {
+        return m_strokeScale;
+    }
+
+    // 帧边界：EndFrame 释放长时间未用的几何、位图和文本布局
+    void BeginFrame() {
+        ++m_frame;
+    }
+    void EndFrame();
+
+    // 纯色画刷，按颜色（含不透明度）缓存
+    ID2D1SolidColorBrush *GetBrush(const D2D1_COLOR_F &color);
+    // 文本格式，按字体名和字号缓存
+    IDWriteTextFormat *GetTextFormat(const wchar_t *family, float size);
+    // 文本布局，按格式、文本和布局框大小缓存
+    IDWriteTextLayout *GetTextLayout(IDWriteTextFormat *pFormat, const wchar_t *text, float maxWidth, float maxHeight);
+
+    // 路径几何：(version, variant) 相同时复用，否则调用 build(sink) 生成图形后缓存。
+    // version 为图形的几何版本，variant 区分同一几何生成的不同路径（如不同线宽的描边）；失败时返回空
+    template <typename Build>
+    ID2D1PathGeometry *GetPathGeometry(uint64_t version, uint32_t variant, Build build) {
+        GeometryEntry &entry = m_geometries[GeometryKey{version, variant}];
+        entry.lastFrame = m_frame;
+        if (!entry.pGeometry) {
+            entry.pGeometry = CreatePathGeometry(m_pFactory, build);
+        }
+        return entry.pGeometry;
+    }
+
+    // 不透明度遮罩位图（A8）：(version, variant) 相同时复用，否则把 width×height 的遮罩清零后调用 build(pixels, pitch)
+    // 写入，再创建位图缓存。没有绑定渲染目标或创建失败时返回空
+    template <typename Build>
+    ID2D1Bitmap *GetMaskBitmap(uint64_t version, uint32_t variant, UINT32 width, UINT32 height, Build build) {
+        if (!m_pRenderTarget) return nullptr;
+        BitmapEntry &entry = m_bitmaps[GeometryKey{version, variant}];
+        entry.lastFrame = m_frame;
+        if (!entry.pBitmap) {
+            m_maskPixels.assign(static_cast<size_t>(width) * height, 0);
+            build(m_maskPixels.data(), width);
+            entry.pBitmap = CreateMaskBitmap(m_pRenderTarget, width, height, m_maskPixels.data(), width);
+        }
+        return entry.pBitmap;
+    }
+
+    // 不经过缓存创建A8遮罩位图，pixels 为空时内容未初始化（调用方 Release）
+    static ID2D1Bitmap *CreateMaskBitmap(ID2D1RenderTarget *pRenderTarget, UINT32 width, UINT32 height,
+                                         const void *pixels, UINT32 pitch);
+
+    // 不经过缓存创建路径几何（调用方 Release）
+    template <typename Build>
+    static ID2D1PathGeometry *CreatePathGeometry(ID2D1Factory *pFactory, Build build) {
+        ID2D1PathGeometry *pGeometry = nullptr;
+        if (!pFactory || FAILED(pFactory->CreatePathGeometry(&pGeometry))) return nullptr;
+        ID2D1GeometrySink *pSink = nullptr;
+        HRESULT hr = pGeometry->Open(&pSink);
+        if (SUCCEEDED(hr)) {
+            build(pSink);
+            hr = pSink->Close();
+            pSink->Release();
+        }
+        if (FAILED(hr)) {
+            pGeometry->Release();
+            return nullptr;
+        }
+        return pGeometry;
+    }
+
+    // 当前线程的缓存，未设置时为空
+    static DeviceResourceCache *Current();
+    static void SetCurrent(DeviceResourceCache *cache);
+
+private:
+    struct GeometryKey {
+        uint64_t version;
+        uint32_t variant;
+        bool operator==(const GeometryKey &other) const {
+            return version == other.version && variant == other.variant;
+        }
+    };
+    struct GeometryKeyHash {
+        size_t operator()(const GeometryKey &key) const {
+            return std::hash<uint64_t>()(key.version * 0x9E3779B97F4A7C15ull + key.variant);
+        }
+    };
+    struct GeometryEntry {
+        ID2D1PathGeometry *pGeometry = nullptr;
+        uint64_t lastFrame = 0;
+    };
+    struct BitmapEntry {
+        ID2D1Bitmap *pBitmap = nullptr;
+        uint64_t lastFrame = 0;
+    };
+    struct LayoutEntry {
+        IDWriteTextLayout *pLayout = nullptr;
+        uint64_t lastFrame = 0;
+    };
+
+    ID2D1RenderTarget *m_pRenderTarget;
+    ID2D1RenderTarget *m_pCompatibleTarget;
+    ID2D1Factory *m_pFactory; // 渲染目标所属的工厂（持有引用，几何在设备丢失后仍由它创建）
+    IDWriteFactory *m_pDWriteFactory;
+    uint64_t m_frame;
+    float m_viewScale;
+    float m_strokeScale;
+
+    std::unordered_map<uint64_t, ID2D1SolidColorBrush *> m_brushes; // 按打包后的RGBA8颜色
+    std::unordered_map<GeometryKey, GeometryEntry, GeometryKeyHash> m_geometries;
+    std::unordered_map<GeometryKey, BitmapEntry, GeometryKeyHash> m_bitmaps;
+    std::vector<uint8_t> m_maskPixels; // 生成遮罩位图的暂存区
+    std::unordered_map<std::wstring, IDWriteTextFormat *> m_textFormats; // 按 "字号|字体名"
+    std::unordered_map<std::wstring, LayoutEntry> m_textLayouts;        // 按 "格式|宽x高|文本"
+
+    void ReleaseBrushes();
+    void ReleaseBitmaps();
+};
@@ -0,0 +1,112 @@
+#include "DocumentArena.h"
+#include <new>
+
+namespace {
+    const size_t MIN_CLASS_SIZE = 16;                          // 最小分级，同时保证16字节对齐
+    const size_t SMALL_LIMIT = 1024;                           // 按16字节分级的上限
+    const int SMALL_CLASS_COUNT = static_cast<int>(SMALL_LIMIT / MIN_CLASS_SIZE);
+
+    thread_local std::shared_ptr<DocumentArena> g_currentArena;
+}
+
+DocumentArena::DocumentArena() : m_retired(false), m_cursor(nullptr), m_end(nullptr) {
+    for (int i = 0; i < CLASS_COUNT; ++i) {
+        m_freeLists[i] = nullptr;
+    }
+}
+
+DocumentArena::~DocumentArena() {
+    for (char *block : m_blocks) {
+        ::operator delete(block);
+    }
+}
+
+int DocumentArena::SizeClass(size_t bytes) {
+    // 1KB 以内按16字节分级，更大的按2的幂再四等分，取整浪费不超过四分之一
+    if (bytes <= SMALL_LIMIT) {
+        return static_cast<int>((bytes + MIN_CLASS_SIZE - 1) / MIN_CLASS_SIZE) - 1;
+    }
+    int index = SMALL_CLASS_COUNT;
+    size_t base = SMALL_LIMIT;
+    while (bytes > base * 2) {
+        base <<= 1;
+        index += 4;
+    }
+    size_t step = base / 4;
+    return index + static_cast<int>((bytes - base + step - 1) / step) - 1;
+}
+
+size_t DocumentArena::ClassSize(int index) {
+    if (index < SMALL_CLASS_COUNT) {
+        return (index + 1) * MIN_CLASS_SIZE;
+    }
+    index -= SMALL_CLASS_COUNT;
+    size_t base = SMALL_LIMIT << (index / 4);
+    return base + (index % 4 + 1) * (base / 4);
+}
+
+void *DocumentArena::Allocate(size_t bytes) {
+    if (bytes > MAX_POOLED_SIZE) {
+        return ::operator new(bytes);
+    }
+    if (bytes == 0) bytes = 1;
+
+    int index = SizeClass(bytes);
+    size_t size = ClassSize(index);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // 优先复用本级释放的小块
+    if (FreeNode *node = m_freeLists[index]) {
+        m_freeLists[index] = node->next;
+        return node;
+    }
+    // 当前块剩余空间不足时申请新块，剩余部分丢弃（最多浪费一个分级大小）
+    if (static_cast<size_t>(m_end - m_cursor) < size) {
+        char *block = static_cast<char *>(::operator new(BLOCK_SIZE));
+        m_blocks.push_back(block);
+        m_cursor = block;
+        m_end = block + BLOCK_SIZE;
+    }
+    void *p = m_cursor;
+    m_cursor += size;
+    return p;
+}
+
+void DocumentArena::Deallocate(void *p, size_t bytes) {
+    if (!p) return;
+    if (bytes > MAX_POOLED_SIZE) {
+        ::operator delete(p);
+        return;
+    }
+    // 已丢弃的文档逐个析构对象时不回收小块，整块在区销毁时归还
+    if (m_retired.load(std::memory_order_relaxed)) return;
+    if (bytes == 0) bytes = 1;
+
+    int index = SizeClass(bytes);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    FreeNode *node = static_cast<FreeNode *>(p);
+    node->next = m_freeLists[index];
+    m_freeLists[index] = node;
+}
+
+void DocumentArena::Retire() {
+    m_retired.store(true, std::memory_order_relaxed);
+}
+
+size_t DocumentArena::ReservedBytes() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_blocks.size() * BLOCK_SIZE;
+}
+
+std::shared_ptr<DocumentArena> DocumentArena::Current() {
+    return g_currentArena;
+}
+
+std::shared_ptr<DocumentArena> DocumentArena::BeginDocument() {
+    g_currentArena = std::make_shared<DocumentArena>();
+    return g_currentArena;
+}
+
+void DocumentArena::SetCurrent(std::shared_ptr<DocumentArena> arena) {
+    g_currentArena = std::move(arena);
+}
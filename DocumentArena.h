@@ -0,0 +1,111 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+// 文档区：一个文档的图形对象和它们的点序列从大块内存中分配
+// 小块按大小分级，释放的小块挂回本级空闲链表，编辑过程中反复增删不会无限增长；超过上限的大块直接走全局堆。
+// 区由共享指针持有，分配器和控制块各持一份，最后一个引用消失时整块归还。
+// 整个文档被丢弃时先调用 Retire：此后析构的对象释放小块时直接返回，不加锁也不写空闲链表，内存只按块归还。
+// 每个线程有自己的当前文档区（界面线程由 GraphicsEngine 设置），其他线程未设置时分配器退回全局堆
+class DocumentArena : public std::enable_shared_from_this<DocumentArena> {
+public:
+    static const size_t BLOCK_SIZE = 1 << 20;      // 每次向系统申请的块大小
+    static const size_t MAX_POOLED_SIZE = 1 << 16; // 超过此大小的分配直接走全局堆
+
+    DocumentArena();
+    ~DocumentArena();
+
+    void *Allocate(size_t bytes);
+    void Deallocate(void *p, size_t bytes);
+
+    // 文档整体丢弃：之后的小块释放不再回收，内存在区销毁时随块一起归还。
+    // 区中剩下的对象仍可正常使用和分配（如撤销历史恢复的图形），只是释放的小块不再复用
+    void Retire();
+
+    // 已向系统申请的块内存总量（字节）
+    size_t ReservedBytes() const;
+
+    // 当前线程的文档区，未设置时为空
+    static std::shared_ptr<DocumentArena> Current();
+    // 为当前线程开始一个新文档：创建新的文档区并设为当前。旧区在其中的对象全部释放后整体归还
+    static std::shared_ptr<DocumentArena> BeginDocument();
+    static void SetCurrent(std::shared_ptr<DocumentArena> arena);
+
+private:
+    static const int CLASS_COUNT = 64 + 6 * 4; // 16B ~ 1KB 每16字节一级，1KB ~ 64KB 每倍四级
+
+    struct FreeNode {
+        FreeNode *next;
+    };
+
+    mutable std::mutex m_mutex;
+    std::atomic<bool> m_retired;
+    std::vector<char *> m_blocks;
+    char *m_cursor;
+    char *m_end;
+    FreeNode *m_freeLists[CLASS_COUNT];
+
+    static int SizeClass(size_t bytes);
+    static size_t ClassSize(int index);
+};
+
+// 从文档区分配的标准分配器；不绑定文档区时等同于 std::allocator
+// 默认构造时绑定当前线程的文档区，移动赋值和交换时分配器随内容一起转移
+template <typename T>
+class ArenaAllocator {
+public:
+    typedef T value_type;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    ArenaAllocator() : m_arena(DocumentArena::Current()) {
+    }
+    explicit ArenaAllocator(std::shared_ptr<DocumentArena> arena) : m_arena(std::move(arena)) {
+    }
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) : m_arena(other.Arena()) {
+    }
+
+    T *allocate(size_t n) {
+        size_t bytes = n * sizeof(T);
+        return static_cast<T *>(m_arena ? m_arena->Allocate(bytes) : ::operator new(bytes));
+    }
+    void deallocate(T *p, size_t n) {
+        if (m_arena) {
+            m_arena->Deallocate(p, n * sizeof(T));
+        } else {
+            ::operator delete(p);
+        }
+    }
+
+    // 容器复制出的副本放在复制时所在线程的当前文档区
+    ArenaAllocator select_on_container_copy_construction() const {
+        return ArenaAllocator();
+    }
+
+    const std::shared_ptr<DocumentArena> &Arena() const {
+        return m_arena;
+    }
+
+private:
+    std::shared_ptr<DocumentArena> m_arena;
+};
+
+template <typename T, typename U>
+inline bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) {
+    return a.Arena() == b.Arena();
+}
+template <typename T, typename U>
+inline bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) {
+    return a.Arena() != b.Arena();
+}
+
+// 在当前文档区上创建对象，控制块和对象一起分配
+template <typename T, typename... Args>
+std::shared_ptr<T> MakeDocumentShared(Args &&...args) {
+    return std::allocate_shared<T>(ArenaAllocator<T>(), std::forward<Args>(args)...);
+}
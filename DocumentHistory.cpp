@@ -0,0 +1,176 @@
+#include "DocumentHistory.h"
+#include "Shape.h"
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+    // 块按控制块+对象一起分配时大致的固定开销
+    const size_t CHUNK_OVERHEAD = sizeof(std::vector<std::shared_ptr<Shape>>) + 16;
+
+    bool ChunkMatches(const std::vector<std::shared_ptr<Shape>> &chunk,
+                      const std::vector<std::shared_ptr<Shape>> &shapes, size_t pos) {
+        if (shapes.size() - pos < chunk.size()) return false;
+        for (size_t i = 0; i < chunk.size(); ++i) {
+            if (chunk[i] != shapes[pos + i]) return false;
+        }
+        return true;
+    }
+}
+
+std::shared_ptr<const DocumentSnapshot> DocumentSnapshot::Build(const std::vector<std::shared_ptr<Shape>> &shapes,
+                                                                const DocumentSnapshot *previous, size_t firstChanged,
+                                                                size_t &addedBytes) {
+    auto snapshot = std::make_shared<DocumentSnapshot>();
+    snapshot->m_size = shapes.size();
+
+    // 旧快照各块的首个图形 -> 块下标：图形列表在某处插入或删除后，后面的块仍能按块首重新对齐并共享
+    size_t previousChunks = previous ? previous->m_chunks.size() : 0;
+    std::unordered_map<const Shape *, size_t> chunkStart;
+    chunkStart.reserve(previousChunks);
+    for (size_t c = 0; c < previousChunks; ++c) {
+        chunkStart.emplace(previous->m_chunks[c]->front().get(), c);
+    }
+    std::vector<uint8_t> shared(previousChunks, 0);
+    std::vector<uint8_t> isNew; // 与 snapshot->m_chunks 对应，是否为新建的块
+    size_t lastShared = SIZE_MAX; // 最后放入的块若是共享的旧块，记下它在旧快照中的下标
+
+    // 完全位于 firstChanged 之前的块原样共享
+    size_t pos = 0;
+    size_t skipped = 0;
+    size_t unchanged = (std::min)(firstChanged, shapes.size());
+    while (skipped < previousChunks && pos + previous->m_chunks[skipped]->size() <= unchanged) {
+        snapshot->m_chunks.push_back(previous->m_chunks[skipped]);
+        isNew.push_back(0);
+        shared[skipped] = 1;
+        lastShared = skipped;
+        pos += previous->m_chunks[skipped]->size();
+        ++skipped;
+    }
+
+    Chunk pending;
+    auto flush = [&]() {
+        if (pending.empty()) return;
+        // 新块与前面的块合起来不超过一块时合并，避免逐个追加图形时产生大量小块
+        if (!snapshot->m_chunks.empty() && snapshot->m_chunks.back()->size() + pending.size() <= CHUNK_SIZE) {
+            const Chunk &last = *snapshot->m_chunks.back();
+            pending.insert(pending.begin(), last.begin(), last.end());
+            if (lastShared != SIZE_MAX) shared[lastShared] = 0;
+            snapshot->m_chunks.pop_back();
+            isNew.pop_back();
+        }
+        snapshot->m_chunks.push_back(std::make_shared<const Chunk>(std::move(pending)));
+        isNew.push_back(1);
+        lastShared = SIZE_MAX;
+        pending.clear();
+    };
+
+    while (pos < shapes.size()) {
+        auto it = chunkStart.find(shapes[pos].get());
+        if (it != chunkStart.end() && ChunkMatches(*previous->m_chunks[it->second], shapes, pos)) {
+            flush();
+            const auto &chunk = previous->m_chunks[it->second];
+            snapshot->m_chunks.push_back(chunk);
+            isNew.push_back(0);
+            shared[it->second] = 1;
+            lastShared = it->second;
+            pos += chunk->size();
+            continue;
+        }
+        pending.push_back(shapes[pos++]);
+        if (pending.size() == CHUNK_SIZE) flush();
+    }
+    flush();
+
+    // 新占用的内存：快照本身、新块，以及新块中不在旧快照里的图形（新建或复制出的）。
+    // 共享块里的图形不会出现在新块中，所以只需和旧快照中未被共享的块比较
+    std::unordered_set<const Shape *> previousShapes;
+    for (size_t c = 0; c < previousChunks; ++c) {
+        if (shared[c]) continue;
+        for (const auto &shape : *previous->m_chunks[c]) {
+            previousShapes.insert(shape.get());
+        }
+    }
+    addedBytes = sizeof(DocumentSnapshot) + snapshot->m_chunks.capacity() * sizeof(snapshot->m_chunks[0]);
+    for (size_t c = 0; c < snapshot->m_chunks.size(); ++c) {
+        if (!isNew[c]) continue;
+        const Chunk &chunk = *snapshot->m_chunks[c];
+        addedBytes += CHUNK_OVERHEAD + chunk.capacity() * sizeof(chunk[0]);
+        for (const auto &shape : chunk) {
+            if (!previousShapes.count(shape.get())) {
+                addedBytes += shape->GetMemoryBytes();
+            }
+        }
+    }
+    return snapshot;
+}
+
+bool DocumentSnapshot::Equals(const std::vector<std::shared_ptr<Shape>> &shapes, size_t firstChanged) const {
+    if (shapes.size() != m_size) return false;
+    size_t pos = 0;
+    for (const auto &chunk : m_chunks) {
+        if (pos + chunk->size() > firstChanged && !ChunkMatches(*chunk, shapes, pos)) return false;
+        pos += chunk->size();
+    }
+    return true;
+}
+
+void DocumentSnapshot::CopyTo(std::vector<std::shared_ptr<Shape>> &out) const {
+    out.clear();
+    out.reserve(m_size);
+    for (const auto &chunk : m_chunks) {
+        out.insert(out.end(), chunk->begin(), chunk->end());
+    }
+}
+
+DocumentHistory::DocumentHistory() : m_current(0), m_bytes(0), m_byteLimit(DEFAULT_BYTE_LIMIT) {
+}
+
+bool DocumentHistory::Commit(const std::vector<std::shared_ptr<Shape>> &shapes, size_t firstChanged) {
+    const DocumentSnapshot *current = m_steps.empty() ? nullptr : m_steps[m_current].snapshot.get();
+    if (!current) firstChanged = 0;
+    if (current && current->Equals(shapes, firstChanged)) return false;
+
+    // 新的编辑使可重做的步骤失效
+    while (m_steps.size() > m_current + 1) {
+        m_bytes -= m_steps.back().bytes;
+        m_steps.pop_back();
+    }
+
+    Step step;
+    step.snapshot = DocumentSnapshot::Build(shapes, current, firstChanged, step.bytes);
+    if (!m_steps.empty()) m_bytes += step.bytes;
+    m_steps.push_back(std::move(step));
+    m_current = m_steps.size() - 1;
+
+    Trim();
+    return true;
+}
+
+const DocumentSnapshot *DocumentHistory::Undo() {
+    if (!CanUndo()) return nullptr;
+    --m_current;
+    return m_steps[m_current].snapshot.get();
+}
+
+const DocumentSnapshot *DocumentHistory::Redo() {
+    if (!CanRedo()) return nullptr;
+    ++m_current;
+    return m_steps[m_current].snapshot.get();
+}
+
+void DocumentHistory::SetByteLimit(size_t bytes) {
+    m_byteLimit = bytes;
+    Trim();
+}
+
+void DocumentHistory::Trim() {
+    // 丢弃最早的步骤，直到不超过上限；当前状态必须保留。
+    // 丢弃后下一步成为新的基准，它的增量不再计入
+    while (m_bytes > m_byteLimit && m_current > 0) {
+        m_bytes -= m_steps[1].bytes;
+        m_steps.pop_front();
+        --m_current;
+    }
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+class Shape;
+
+// 文档快照：某一时刻的图形列表，创建后不再修改
+// 图形指针分块存放，生成新快照时与上一快照内容相同的块直接共享，未改动的图形也按指针共享，
+// 所以一步编辑只为改动所在的块和被改动（复制）的图形占用新内存，与文档大小无关
+class DocumentSnapshot {
+public:
+    static const size_t CHUNK_SIZE = 256; // 每块最多存放的图形数
+
+    // 由图形列表生成快照，尽量共享 previous 中的块（插入、删除后按块首图形重新对齐）
+    // firstChanged 之前的图形与 previous 相同，完全落在这一范围内的块不再逐个比较
+    // addedBytes 返回这一快照新占用的内存：新块，以及新块中不属于 previous 的图形
+    static std::shared_ptr<const DocumentSnapshot> Build(const std::vector<std::shared_ptr<Shape>> &shapes,
+                                                         const DocumentSnapshot *previous, size_t firstChanged,
+                                                         size_t &addedBytes);
+
+    size_t Size() const {
+        return m_size;
+    }
+    // 内容（图形指针序列）是否与图形列表相同，firstChanged 含义同 Build
+    bool Equals(const std::vector<std::shared_ptr<Shape>> &shapes, size_t firstChanged = 0) const;
+    // 按顺序展开为图形列表
+    void CopyTo(std::vector<std::shared_ptr<Shape>> &out) const;
+    // 按顺序逐个访问图形 visit(下标, 图形)，不复制指针
+    template <typename F>
+    void ForEach(F visit) const {
+        size_t index = 0;
+        for (const auto &chunk : m_chunks) {
+            for (const auto &shape : *chunk) {
+                visit(index++, shape);
+            }
+        }
+    }
+    // 只访问升序下标列表 indices 中的图形 visit(下标, 图形)，不含所列下标的块整块跳过
+    template <typename F>
+    void ForEachIndex(const std::vector<uint32_t> &indices, F visit) const {
+        size_t base = 0;
+        size_t k = 0;
+        for (const auto &chunk : m_chunks) {
+            if (k == indices.size()) break;
+            size_t end = base + chunk->size();
+            for (; k < indices.size() && indices[k] < end; ++k) {
+                visit(static_cast<size_t>(indices[k]), (*chunk)[indices[k] - base]);
+            }
+            base = end;
+        }
+    }
+
+private:
+    typedef std::vector<std::shared_ptr<Shape>> Chunk;
+
+    std::vector<std::shared_ptr<const Chunk>> m_chunks;
+    size_t m_size = 0;
+};
+
+// 撤销/重做历史：按顺序保存文档快照，当前状态之前的可撤销，之后的可重做
+// 每一步记录它新占用的内存，历史按字节数而不是步数限制：超过上限时丢弃最早的步骤
+class DocumentHistory {
+public:
+    static const size_t DEFAULT_BYTE_LIMIT = 128u << 20;
+
+    DocumentHistory();
+
+    // 记录图形列表的当前状态为新的一步，丢弃所有可重做的步骤；与当前状态相同时不记录，返回 false
+    // 调用方知道自上一步以来只改动了下标 firstChanged 及之后的图形时传入，前面的块直接共享而不比较
+    bool Commit(const std::vector<std::shared_ptr<Shape>> &shapes, size_t firstChanged = 0);
+
+    bool CanUndo() const {
+        return m_current > 0;
+    }
+    bool CanRedo() const {
+        return m_current + 1 < m_steps.size();
+    }
+    // 当前状态的快照。图形库每次记录历史或恢复快照后与它内容相同，可以直接交给其他线程只读使用
+    std::shared_ptr<const DocumentSnapshot> Current() const {
+        return m_steps.empty() ? nullptr : m_steps[m_current].snapshot;
+    }
+    // 移到上一步/下一步，返回要恢复的快照；不能移动时返回 nullptr
+    const DocumentSnapshot *Undo();
+    const DocumentSnapshot *Redo();
+
+    // 历史占用的内存：最早一步之后各步的增量之和（最早一步即当前文档本身的基准，不计入）
+    size_t GetBytes() const {
+        return m_bytes;
+    }
+    size_t GetByteLimit() const {
+        return m_byteLimit;
+    }
+    void SetByteLimit(size_t bytes);
+
+    size_t GetStepCount() const {
+        return m_steps.size();
+    }
+    // 第 index 步（0 为最早）新占用的内存
+    size_t GetStepBytes(size_t index) const {
+        return m_steps[index].bytes;
+    }
+
+private:
+    struct Step {
+        std::shared_ptr<const DocumentSnapshot> snapshot;
+        size_t bytes;
+    };
+
+    std::deque<Step> m_steps;
+    size_t m_current; // 当前状态在 m_steps 中的下标
+    size_t m_bytes;
+    size_t m_byteLimit;
+
+    void Trim();
+};
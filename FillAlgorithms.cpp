@@ -1,8 +1,10 @@
 #include "FillAlgorithms.h"
+#include "Profiler.h"
+#include "WorkStealing.h"
 #include <algorithm>
+#include <atomic>
 #include <stack>
 #include <set>
-#include <map>
 #include <cmath>
 
 namespace FillAlgorithms {
@@ -64,7 +66,7 @@ static bool IsPointInsideShape(Shape* shape, D2D1_POINT_2F point) {
         // 使用射线法判断点是否在多边形内
         auto poly = dynamic_cast<Poly*>(shape);
         if (poly) {
-            const std::vector<D2D1_POINT_2F>& points = poly->GetPoints();
+            const PointVector& points = poly->GetPoints();
             if (points.size() < 3) return false; // 至少需要3个点形成多边形
             
             int intersections = 0;
@@ -91,24 +93,9 @@ static bool IsPointInsideShape(Shape* shape, D2D1_POINT_2F point) {
     }
     case ShapeType::DIAMOND:
     case ShapeType::PARALLELOGRAM: {
-        // 使用射线法判断点是否在四边形内
-        // 通过GetIntersectionSegments获取4条边，从中提取4个顶点
-        auto segments = shape->GetIntersectionSegments();
-        if (segments.size() != 4) return false;
-        
-        // 提取4个顶点（按边的起点）
-        std::vector<D2D1_POINT_2F> vertices;
-        vertices.push_back(segments[0].first);  // 第一条边的起点
-        vertices.push_back(segments[1].first);  // 第二条边的起点
-        vertices.push_back(segments[2].first);  // 第三条边的起点
-        vertices.push_back(segments[3].first);  // 第四条边的起点
-        
-        // 使用射线法判断点是否在四边形内
+        // 使用射线法判断点是否在四边形内：逐条访问4条边，不复制顶点
         int intersections = 0;
-        for (size_t i = 0; i < 4; ++i) {
-            D2D1_POINT_2F p1 = vertices[i];
-            D2D1_POINT_2F p2 = vertices[(i + 1) % 4];
-            
+        shape->ForEachIntersectionSegment([&](D2D1_POINT_2F p1, D2D1_POINT_2F p2) {
             // 检查射线是否与边相交
             if ((p1.y <= point.y && p2.y > point.y) || (p2.y <= point.y && p1.y > point.y)) {
                 float xIntersection = p1.x + (point.y - p1.y) * (p2.x - p1.x) / (p2.y - p1.y);
@@ -116,7 +103,7 @@ static bool IsPointInsideShape(Shape* shape, D2D1_POINT_2F point) {
                     intersections++;
                 }
             }
-        }
+        });
         
         // 奇数个交点表示在四边形内
         return (intersections % 2) == 1;
@@ -128,10 +115,75 @@ static bool IsPointInsideShape(Shape* shape, D2D1_POINT_2F point) {
     return false;
 }
 
-// 栅栏填充法（Fence Fill）
-// 过一个顶点做垂直线作为栅栏，对栅栏与各边区域内的像素进行取补标记
-// 全部边都被取过后，仍有标记的像素记为要填充的像素
-std::vector<D2D1_POINT_2F> ScanlineFill(Shape* shape, D2D1_POINT_2F seedPoint) {
+bool ContainsPoint(Shape* shape, D2D1_POINT_2F point) {
+    return IsPointInsideShape(shape, point);
+}
+
+// 取消时返回 true
+static bool IsCancelled(const FillControl* control) {
+    return control && control->cancelled.load(std::memory_order_relaxed);
+}
+
+static void ReportProgress(FillControl* control, float progress) {
+    if (control) {
+        control->progress.store(progress, std::memory_order_relaxed);
+    }
+}
+
+// 有序边表中的一条边：只保存与扫描线相交的非水平边，y 取半开区间 [yMin, yMax)
+struct FillEdge {
+    float yMin, yMax;
+    float xAtYMin;     // yMin 处的 x
+    float inverseSlope; // dx/dy
+};
+
+// 一行中的一个填充区间 [x0, x1]
+struct FillSpan {
+    int y, x0, x1;
+};
+
+// 每条带至少的行数，避免行数很少时线程的启动开销超过计算本身
+static const int MIN_BAND_ROWS = 32;
+
+// 可填充图形的边，按 yMin 排序（有序边表）；POLYLINE 与内部判断一致，首尾相接闭合
+static std::vector<FillEdge> BuildEdgeTable(Shape* shape) {
+    std::vector<FillEdge> edges;
+    auto addEdge = [&](D2D1_POINT_2F a, D2D1_POINT_2F b) {
+        if (a.y == b.y) return; // 水平边不与扫描线相交
+        if (a.y > b.y) std::swap(a, b);
+        FillEdge edge;
+        edge.yMin = a.y;
+        edge.yMax = b.y;
+        edge.xAtYMin = a.x;
+        edge.inverseSlope = (b.x - a.x) / (b.y - a.y);
+        edges.push_back(edge);
+    };
+    if (shape->GetType() == ShapeType::POLYLINE) {
+        auto poly = dynamic_cast<Poly*>(shape);
+        if (!poly) return edges;
+        const PointVector& points = poly->GetPoints();
+        if (points.size() < 3) return edges;
+        for (size_t i = 0; i < points.size(); ++i) {
+            addEdge(points[i], points[(i + 1) % points.size()]);
+        }
+    } else {
+        shape->ForEachIntersectionSegment(addEdge);
+    }
+    std::sort(edges.begin(), edges.end(), [](const FillEdge& a, const FillEdge& b) {
+        return a.yMin < b.yMin;
+    });
+    return edges;
+}
+
+// 扫描线填充（有序边表）
+// 每条整数扫描线 y 与活性边求交，交点排序后两两配对，按奇偶规则填充 [ceil(x2k), ceil(x2k+1) - 1]；
+// 边的 y 取半开区间，顶点和水平边不重复计数。圆按圆方程直接求每行的区间，与内部判断一致。
+// 行之间互不依赖：y 范围按带分给 threadCount 个线程，每条带从共享的有序边表中自己建立活性边表，
+// 交点由边的起点直接算出（不沿用上一行的增量），所以结果与分带方式无关，任意线程数逐位一致。
+// 第一遍各带求出自己的区间和像素数，按前缀和确定各带在结果中的位置后，第二遍各带写入自己的那一段，合并不需要加锁。
+// 进度：求区间占一半，写像素占一半
+std::vector<D2D1_POINT_2F> ScanlineFill(Shape* shape, D2D1_POINT_2F seedPoint, FillControl* control, int threadCount) {
+    PROFILE_SCOPE("FillAlgorithms::ScanlineFill");
     std::vector<D2D1_POINT_2F> fillPixels;
     
     if (!shape) return fillPixels;
@@ -141,91 +193,127 @@ std::vector<D2D1_POINT_2F> ScanlineFill(Shape* shape, D2D1_POINT_2F seedPoint) {
         return fillPixels;
     }
     
-    D2D1_RECT_F bounds = shape->GetBounds();
-    int minY = static_cast<int>(bounds.top);
-    int maxY = static_cast<int>(bounds.bottom);
-    
-    // 1. 选择一个顶点，过该顶点做垂直线作为栅栏
-    auto segments = shape->GetIntersectionSegments();
-    if (segments.empty()) return fillPixels;
-    
-    // 选择第一个顶点作为栅栏位置
-    int fenceX = static_cast<int>(segments[0].first.x);
-    
-    // 2. 将栅栏上的点直接加入填充结果
-    // 因为栅栏点会在异或过程中被处理偶数次，导致没有标记
-    for (int y = minY; y <= maxY; ++y) {
-        D2D1_POINT_2F fencePoint = D2D1::Point2F(static_cast<float>(fenceX), static_cast<float>(y));
-        if (IsPointInsideShape(shape, fencePoint)) {
-            fillPixels.push_back(fencePoint);
+    D2D1_POINT_2F center;
+    float radius;
+    bool circle = shape->GetCircleGeometry(center, radius);
+    std::vector<FillEdge> edges;
+    int minY, maxY;
+    if (circle) {
+        minY = static_cast<int>(std::floor(center.y - radius));
+        maxY = static_cast<int>(std::ceil(center.y + radius));
+    } else {
+        edges = BuildEdgeTable(shape);
+        if (edges.empty()) return fillPixels;
+        float top = edges.front().yMin;
+        float bottom = top;
+        for (const FillEdge& edge : edges) {
+            bottom = (std::max)(bottom, edge.yMax);
         }
+        minY = static_cast<int>(std::ceil(top));
+        maxY = static_cast<int>(std::ceil(bottom)) - 1;
     }
+    if (maxY < minY) return fillPixels;
     
-    // 3. 使用标记数组，对每个像素进行取补标记
-    // 使用map存储标记状态（true表示被标记，false表示未标记）
-    std::map<std::pair<int, int>, bool> marks;
+    int rows = maxY - minY + 1;
+    int bandCount = (std::max)(1, (std::min)((std::max)(threadCount, 1) * 4, rows / MIN_BAND_ROWS));
+    std::vector<std::vector<FillSpan>> bandSpans(bandCount);
+    std::vector<size_t> bandPixels(bandCount, 0);
+    std::atomic<int> rowsDone(0);
     
-    // 4. 对每条与多边形相交的扫描线，将位于栅栏与边之间的像素取补
-    for (int y = minY; y <= maxY; ++y) {
-        // 对当前扫描线，找到所有与之相交的边
-        for (const auto& segment : segments) {
-            int xa = static_cast<int>(segment.first.x);
-            int ya = static_cast<int>(segment.first.y);
-            int xb = static_cast<int>(segment.second.x);
-            int yb = static_cast<int>(segment.second.y);
-            
-            // 跳过水平边（与扫描线平行，不相交）
-            if (ya == yb) {
-                continue;
-            }
-            
-            // 判断该边是否与当前扫描线相交（包含边的所有端点）
-            int yMin = (std::min)(ya, yb);
-            int yMax = (std::max)(ya, yb);
-            if (y <= yMin || y > yMax) {
-                continue; // 不相交
-            }
-            
-            // 计算该边在当前扫描线上的交点X坐标
-            int edgeX;
-            if (xa == xb) {
-                // 竖直边
-                edgeX = xa;
+    // 第一遍：各带求区间
+    WorkStealing::ParallelFor(bandCount, threadCount, [&](int band, int) {
+        int y0 = minY + static_cast<int>(static_cast<int64_t>(rows) * band / bandCount);
+        int y1 = minY + static_cast<int>(static_cast<int64_t>(rows) * (band + 1) / bandCount);
+        std::vector<FillSpan>& spans = bandSpans[band];
+        size_t pixels = 0;
+        auto addSpan = [&](int y, int x0, int x1) {
+            if (x0 > x1) return;
+            FillSpan span = {y, x0, x1};
+            spans.push_back(span);
+            pixels += static_cast<size_t>(x1 - x0 + 1);
+        };
+        
+        // 活性边表：带的第一行之前开始、仍未结束的边，之后逐行加入新开始的边
+        std::vector<const FillEdge*> active;
+        std::vector<float> crossings;
+        size_t next = 0;
+        for (int y = y0; y < y1; ++y) {
+            if (IsCancelled(control)) return;
+            float fy = static_cast<float>(y);
+            if (circle) {
+                // 与内部判断相同的严格不等式 dx^2 + dy^2 < r^2，开方的舍入误差在两端各修正一格
+                float dy = fy - center.y;
+                float rest = radius * radius - dy * dy;
+                if (rest > 0) {
+                    float half = std::sqrt(rest);
+                    int x0 = static_cast<int>(std::ceil(center.x - half));
+                    int x1 = static_cast<int>(std::floor(center.x + half));
+                    auto inside = [&](int x) {
+                        float dx = static_cast<float>(x) - center.x;
+                        return dx * dx + dy * dy < radius * radius;
+                    };
+                    if (inside(x0 - 1)) --x0;
+                    if (!inside(x0)) ++x0;
+                    if (inside(x1 + 1)) ++x1;
+                    if (!inside(x1)) --x1;
+                    addSpan(y, x0, x1);
+                }
             } else {
-                // 斜边：使用线性插值计算交点
-                edgeX = static_cast<int>(std::round(xa + double(y - ya) * (xb - xa) / (yb - ya)));
+                while (next < edges.size() && edges[next].yMin <= fy) {
+                    active.push_back(&edges[next++]);
+                }
+                active.erase(std::remove_if(active.begin(), active.end(), [fy](const FillEdge* edge) {
+                    return edge->yMax <= fy;
+                }), active.end());
+                
+                crossings.clear();
+                for (const FillEdge* edge : active) {
+                    crossings.push_back(edge->xAtYMin + (fy - edge->yMin) * edge->inverseSlope);
+                }
+                std::sort(crossings.begin(), crossings.end());
+                for (size_t k = 0; k + 1 < crossings.size(); k += 2) {
+                    addSpan(y, static_cast<int>(std::ceil(crossings[k])), static_cast<int>(std::ceil(crossings[k + 1])) - 1);
+                }
             }
-            
-            // 将栅栏与该边交点之间的扫描线段取补（异或操作），包含栅栏点和边界点
-            int x1 = (std::min)(fenceX, edgeX);
-            int x2 = (std::max)(fenceX, edgeX);
-            
-            for (int x = x1; x <= x2; ++x) {
-                marks[{x, y}] = !marks[{x, y}];
+            if (control) {
+                ReportProgress(control, 0.5f * (rowsDone.fetch_add(1, std::memory_order_relaxed) + 1) / rows);
             }
-            
         }
+        bandPixels[band] = pixels;
+    });
+    if (IsCancelled(control)) return fillPixels;
+    
+    // 各带在结果中的起点
+    std::vector<size_t> bandOffsets(bandCount + 1, 0);
+    for (int band = 0; band < bandCount; ++band) {
+        bandOffsets[band + 1] = bandOffsets[band] + bandPixels[band];
     }
+    fillPixels.resize(bandOffsets[bandCount]);
     
-    // 5. 收集仍有标记的像素作为填充像素
-    for (const auto& mark : marks) {
-        if (mark.second) { // 仍有标记
-            int x = mark.first.first;
-            int y = mark.first.second;
-            D2D1_POINT_2F fillPoint = D2D1::Point2F(static_cast<float>(x), static_cast<float>(y));
-            
-            // 验证该点在图形内部
-            if (IsPointInsideShape(shape, fillPoint)) {
-                fillPixels.push_back(fillPoint);
+    // 第二遍：各带写入自己的一段
+    std::atomic<int> bandsDone(0);
+    WorkStealing::ParallelFor(bandCount, threadCount, [&](int band, int) {
+        D2D1_POINT_2F* out = fillPixels.data() + bandOffsets[band];
+        for (const FillSpan& span : bandSpans[band]) {
+            if (IsCancelled(control)) return;
+            float fy = static_cast<float>(span.y);
+            for (int x = span.x0; x <= span.x1; ++x) {
+                *out++ = D2D1::Point2F(static_cast<float>(x), fy);
             }
         }
-    }
+        if (control) {
+            ReportProgress(control, 0.5f + 0.5f * (bandsDone.fetch_add(1, std::memory_order_relaxed) + 1) / bandCount);
+        }
+    });
+    if (IsCancelled(control)) return std::vector<D2D1_POINT_2F>();
     
     return fillPixels;
 }
 
 // 种子填充法（使用栈实现非递归）
-std::vector<D2D1_POINT_2F> SeedFill(Shape* shape, D2D1_POINT_2F seedPoint) {
+// 进度按已填充像素数估计：包围盒面积（不超过填充上限）为总量
+std::vector<D2D1_POINT_2F> SeedFill(Shape* shape, D2D1_POINT_2F seedPoint, FillControl* control) {
+    PROFILE_SCOPE("FillAlgorithms::SeedFill");
     std::vector<D2D1_POINT_2F> fillPixels;
     
     if (!shape) return fillPixels;
@@ -254,7 +342,15 @@ std::vector<D2D1_POINT_2F> SeedFill(Shape* shape, D2D1_POINT_2F seedPoint) {
     int dx[] = {0, 0, 1, -1};
     int dy[] = {1, -1, 0, 0};
     
-    while (!stack.empty() && fillPixels.size() < 100000) { // 限制填充数量防止无限循环
+    const size_t maxPixels = 100000;
+    double area = (static_cast<double>(maxX) - minX + 1) * (static_cast<double>(maxY) - minY + 1);
+    float expected = static_cast<float>((std::min)(area, static_cast<double>(maxPixels)));
+    size_t popped = 0;
+    while (!stack.empty() && fillPixels.size() < maxPixels) { // 限制填充数量防止无限循环
+        if ((++popped & 1023) == 0) {
+            if (IsCancelled(control)) return std::vector<D2D1_POINT_2F>();
+            ReportProgress(control, (std::min)(0.99f, fillPixels.size() / expected));
+        }
         std::pair<int, int> current = stack.top();
         stack.pop();
         int x = current.first;
@@ -281,6 +377,7 @@ std::vector<D2D1_POINT_2F> SeedFill(Shape* shape, D2D1_POINT_2F seedPoint) {
         }
     }
     
+    ReportProgress(control, 1.0f);
     return fillPixels;
 }
 
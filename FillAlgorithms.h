@@ -1,14 +1,27 @@
 #pragma once
 #include <d2d1.h>
+#include <atomic>
 #include <vector>
 #include <memory>
 #include "Shape.h"
 
 // 填充算法命名空间
 namespace FillAlgorithms {
-    // 栅栏填充法（扫描线填充）
-    std::vector<D2D1_POINT_2F> ScanlineFill(Shape* shape, D2D1_POINT_2F seedPoint);
+    // 后台填充的控制：调用方置 cancelled 后，算法在下一行（种子填充为下一批像素）处返回空结果；
+    // progress 为已完成的比例（0~1），由算法写入，可在任意线程读取
+    struct FillControl {
+        std::atomic<bool> cancelled{false};
+        std::atomic<float> progress{0.0f};
+    };
+
+    // 点是否在可填充的封闭图形内部（两种填充算法对种子点的检查）
+    bool ContainsPoint(Shape* shape, D2D1_POINT_2F point);
+
+    // 扫描线填充（有序边表）：按奇偶规则填充整个封闭图形，y 范围分带后由 threadCount 个线程并行扫描，
+    // 结果按行排列，与线程数无关
+    std::vector<D2D1_POINT_2F> ScanlineFill(Shape* shape, D2D1_POINT_2F seedPoint, FillControl* control = nullptr,
+                                            int threadCount = 1);
     
     // 种子填充法
-    std::vector<D2D1_POINT_2F> SeedFill(Shape* shape, D2D1_POINT_2F seedPoint);
+    std::vector<D2D1_POINT_2F> SeedFill(Shape* shape, D2D1_POINT_2F seedPoint, FillControl* control = nullptr);
 }
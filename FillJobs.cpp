@@ -0,0 +1,163 @@
+#include "FillJobs.h"
+#include "Shape.h"
+#include <algorithm>
+
+FillJobQueue::FillJobQueue(int threadCount) : m_threadCount(threadCount), m_nextId(1), m_stop(false) {
+    if (m_threadCount <= 0) {
+        // 留一个核给界面线程和绘制线程
+        m_threadCount = (std::max)(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+    }
+}
+
+FillJobQueue::~FillJobQueue() {
+    Shutdown();
+}
+
+void FillJobQueue::SetNotify(NotifyFunction notify) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_notify = std::move(notify);
+}
+
+uint64_t FillJobQueue::Submit(std::shared_ptr<Shape> shape, ShapeHandle handle, D2D1_POINT_2F seed, Algorithm algorithm) {
+    std::shared_ptr<Job> job = std::make_shared<Job>();
+    job->shape = std::move(shape);
+    job->handle = handle;
+    job->geometryVersion = job->shape ? job->shape->GetGeometryVersion() : 0;
+    job->seed = seed;
+    job->algorithm = algorithm;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_threads.empty()) {
+        m_stop = false;
+        for (int i = 0; i < m_threadCount; ++i) {
+            m_threads.emplace_back(&FillJobQueue::Run, this);
+        }
+    }
+    job->id = m_nextId++;
+    m_queue.push_back(job);
+    m_active.push_back(job);
+    m_wake.notify_one();
+    return job->id;
+}
+
+size_t FillJobQueue::Cancel(ShapeHandle handle) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t count = 0;
+    for (const auto &job : m_active) {
+        if (SameShape(job->handle, handle) && !job->control.cancelled.exchange(true)) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+size_t FillJobQueue::CancelAll() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t count = 0;
+    for (const auto &job : m_active) {
+        if (!job->control.cancelled.exchange(true)) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+std::vector<FillJobQueue::Result> FillJobQueue::TakeResults() {
+    std::vector<Result> results;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    results.swap(m_results);
+    return results;
+}
+
+std::vector<FillJobQueue::Progress> FillJobQueue::GetProgress() const {
+    std::vector<Progress> progress;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto &job : m_active) {
+        if (job->control.cancelled.load(std::memory_order_relaxed)) continue;
+        Progress p;
+        p.id = job->id;
+        p.handle = job->handle;
+        p.progress = job->control.progress.load(std::memory_order_relaxed);
+        progress.push_back(p);
+    }
+    return progress;
+}
+
+size_t FillJobQueue::Pending() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_active.size();
+}
+
+void FillJobQueue::WaitIdle() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this]() {
+        return m_active.empty();
+    });
+}
+
+void FillJobQueue::Shutdown() {
+    std::vector<std::thread> threads;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto &job : m_active) {
+            job->control.cancelled = true;
+        }
+        m_stop = true;
+        threads.swap(m_threads);
+    }
+    m_wake.notify_all();
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    // 尚未开始的任务直接丢弃
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_queue.clear();
+    m_active.clear();
+    m_results.clear();
+    m_idle.notify_all();
+}
+
+void FillJobQueue::Run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_wake.wait(lock, [this]() {
+            return m_stop || !m_queue.empty();
+        });
+        if (m_stop) break;
+        std::shared_ptr<Job> job = m_queue.front();
+        m_queue.pop_front();
+        // 扫描线填充按行分带并行：未完成的任务平分线程数，只有一个大图形在填充时用满全部线程
+        int bandThreads = (std::max)(1, m_threadCount / static_cast<int>(m_active.size()));
+        lock.unlock();
+
+        // 在开始前就被取消的任务不计算
+        std::vector<D2D1_POINT_2F> pixels;
+        if (!job->control.cancelled && job->shape) {
+            if (job->algorithm == Algorithm::SCANLINE) {
+                pixels = FillAlgorithms::ScanlineFill(job->shape.get(), job->seed, &job->control, bandThreads);
+            } else {
+                pixels = FillAlgorithms::SeedFill(job->shape.get(), job->seed, &job->control);
+            }
+        }
+        // 图形副本在工作线程上释放，不在持锁时析构
+        job->shape = nullptr;
+
+        lock.lock();
+        if (!job->control.cancelled) {
+            Result result;
+            result.id = job->id;
+            result.handle = job->handle;
+            result.geometryVersion = job->geometryVersion;
+            result.pixels = std::move(pixels);
+            m_results.push_back(std::move(result));
+        }
+        m_active.erase(std::find(m_active.begin(), m_active.end(), job));
+        if (m_active.empty()) m_idle.notify_all();
+        NotifyFunction notify = m_notify;
+        lock.unlock();
+
+        if (notify) notify();
+        lock.lock();
+    }
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include <d2d1.h>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "FillAlgorithms.h"
+#include "ShapeStore.h"
+
+class Shape;
+
+// 后台填充任务队列：界面线程提交图形副本和种子点，线程池中的工作线程并发计算填充像素，
+// 互不相关的图形可以同时填充。每个任务带取消标志和进度，结束后结果放入完成列表，
+// 由界面线程取出后再写回图形（见 GraphicsEngine::ApplyCompletedFills）。
+// 任务只访问自己的图形副本，与图形库和绘制线程没有共享数据；不依赖窗口，可以单独测试
+class FillJobQueue {
+public:
+    enum class Algorithm {
+        SCANLINE, // 扫描线填充（有序边表，按行分带并行）
+        SEED      // 种子填充
+    };
+
+    // 已完成的任务
+    struct Result {
+        uint64_t id;
+        ShapeHandle handle;       // 提交时图形在图形库中的句柄
+        uint64_t geometryVersion; // 提交时图形的几何版本，写回前比较，不同则结果已过时
+        std::vector<D2D1_POINT_2F> pixels;
+    };
+
+    // 等待或正在运行的任务
+    struct Progress {
+        uint64_t id;
+        ShapeHandle handle;
+        float progress; // 0~1，尚未开始为0
+    };
+
+    // 任务结束（完成或被取消）时在工作线程上调用，用于唤醒界面线程，不能在其中访问图形库
+    typedef std::function<void()> NotifyFunction;
+
+    // threadCount 为 0 时取硬件线程数减一（至少一个）；线程在第一次提交时才创建。
+    // 扫描线填充另外按行分带，由未完成的任务平分这些线程数
+    explicit FillJobQueue(int threadCount = 0);
+    ~FillJobQueue();
+
+    FillJobQueue(const FillJobQueue &) = delete;
+    FillJobQueue &operator=(const FillJobQueue &) = delete;
+
+    void SetNotify(NotifyFunction notify);
+
+    // 提交一个填充任务，shape 必须是调用方不再修改的副本；返回任务编号
+    uint64_t Submit(std::shared_ptr<Shape> shape, ShapeHandle handle, D2D1_POINT_2F seed, Algorithm algorithm);
+    // 取消图形上全部未完成的任务，返回取消的个数。被取消的任务不产生结果
+    size_t Cancel(ShapeHandle handle);
+    size_t CancelAll();
+
+    // 取出已完成的结果（按完成顺序）
+    std::vector<Result> TakeResults();
+    // 未完成任务的进度（按提交顺序）
+    std::vector<Progress> GetProgress() const;
+    // 未完成的任务数
+    size_t Pending() const;
+    // 等待全部任务结束（完成或被取消）
+    void WaitIdle();
+    // 取消全部任务并结束工作线程；之后再提交会重新创建线程
+    void Shutdown();
+
+private:
+    struct Job {
+        uint64_t id;
+        std::shared_ptr<Shape> shape;
+        ShapeHandle handle;
+        uint64_t geometryVersion;
+        D2D1_POINT_2F seed;
+        Algorithm algorithm;
+        FillAlgorithms::FillControl control;
+    };
+
+    int m_threadCount;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake; // 有新任务或要求停止
+    std::condition_variable m_idle; // 没有未完成的任务
+    std::deque<std::shared_ptr<Job>> m_queue;  // 尚未开始的任务
+    std::vector<std::shared_ptr<Job>> m_active; // 未完成的任务（等待和运行中），按提交顺序
+    std::vector<Result> m_results;
+    uint64_t m_nextId;
+    bool m_stop;
+    NotifyFunction m_notify;
+    std::vector<std::thread> m_threads;
+
+    void Run();
+    static bool SameShape(ShapeHandle a, ShapeHandle b) {
+        return a.slot == b.slot && a.generation == b.generation;
+    }
+};
@@ -1,11 +1,149 @@
 #include "GraphicsEngine.h"
 #include "Shape.h"
 #include "IntersectionManager.h"
+#include "LineClipping.h"
+#include "SoftwareRasterizer.h"
+#include "WorkStealing.h"
+#include "DashPattern.h"
+#include "Profiler.h"
 #include <cmath>
+#include <memory>
+
+// ͼλƵļʱ ShapeType ˳
+static const char *const DRAW_SCOPE_NAMES[] = {
+    "Draw Line", "Draw Circle", "Draw Rect", "Draw Triangle", "Draw Diamond",
+    "Draw Parallelogram", "Draw Curve", "Draw Polyline", "Draw MultiBezier", "Draw Polygon"
+};
+
+// ӿ޳ʱΧиľ룺ݱԵصİ뾶
+static const float CULL_MARGIN = 2.0f;
+
+// ͼŷΧ
+static const float MIN_ZOOM = 1.0f / 1024.0f;
+static const float MAX_ZOOM = 64.0f;
+// ŵȫͼʱĴ
+static const float FIT_MARGIN = 20.0f;
+
+// ϸڲΣϣΧг߼߿С LOD_DOT_PIXELS ͼλһ㣬С LOD_BOX_PIXELS ĻɰΧоο
+// ͼζѡеͼճ
+static const float LOD_DOT_PIXELS = 2.0f;
+static const float LOD_BOX_PIXELS = 6.0f;
+
+// ѡɸݲСڸͼ HitTest ݲֱΪ10أ
+static const float HIT_TEST_MARGIN = 10.0f;
+
+namespace {
+    // ͼ任ĵ zoom ƽ offset
+    inline D2D1_MATRIX_3X2_F ViewMatrix(D2D1_POINT_2F offset, float zoom) {
+        return D2D1::Matrix3x2F(zoom, 0.0f, 0.0f, zoom, offset.x, offset.y);
+    }
+
+    inline D2D1_POINT_2F TransformPoint(const D2D1_MATRIX_3X2_F &m, D2D1_POINT_2F p) {
+        return D2D1::Point2F(p.x * m._11 + p.y * m._21 + m._31, p.x * m._12 + p.y * m._22 + m._32);
+    }
+
+    //  a  b ı任
+    inline D2D1_MATRIX_3X2_F Multiply(const D2D1_MATRIX_3X2_F &a, const D2D1_MATRIX_3X2_F &b) {
+        return D2D1::Matrix3x2F(a._11 * b._11 + a._12 * b._21, a._11 * b._12 + a._12 * b._22,
+                                a._21 * b._11 + a._22 * b._21, a._21 * b._12 + a._22 * b._22,
+                                a._31 * b._11 + a._32 * b._21 + b._31, a._31 * b._12 + a._32 * b._22 + b._32);
+    }
+
+    // ͼԪƱ任תһˣڻƴ任ͼΡ
+    // ߿任ţдؼΣBakeTransformʱ߿䣬϶ɿߴϸһ
+    class TransformedBackend : public RenderBackend {
+    public:
+        TransformedBackend(RenderBackend &target, const D2D1_MATRIX_3X2_F &m) :
+            m_target(target), m_m(m), m_scale(sqrtf(m._11 * m._11 + m._12 * m._12)) {
+        }
+
+        void Clear(const D2D1_COLOR_F &color) override {
+            m_target.Clear(color);
+        }
+        void DrawLine(D2D1_POINT_2F p0, D2D1_POINT_2F p1,
+                      const D2D1_COLOR_F &color, float width, LineStyle style) override {
+            m_target.DrawLine(TransformPoint(m_m, p0), TransformPoint(m_m, p1), color, width, style);
+        }
+        void DrawPolyline(const D2D1_POINT_2F *points, size_t count, bool closed,
+                          const D2D1_COLOR_F &color, float width, LineStyle style) override {
+            m_target.DrawPolyline(Map(points, count), count, closed, color, width, style);
+        }
+        void DrawEllipse(D2D1_POINT_2F center, float radiusX, float radiusY,
+                         const D2D1_COLOR_F &color, float width, LineStyle style) override {
+            if (radiusX == radiusY || m_m._12 == 0.0f) {
+                // ԲƱ任ԲתʱԲҲ
+                m_target.DrawEllipse(TransformPoint(m_m, center), radiusX * m_scale, radiusY * m_scale,
+                                     color, width, style);
+                return;
+            }
+            // תԲԲʾչƽɱպ
+            const int SEGMENTS = 64;
+            m_ellipse.resize(SEGMENTS);
+            for (int i = 0; i < SEGMENTS; ++i) {
+                float t = 6.2831853f * i / SEGMENTS;
+                m_ellipse[i] = D2D1::Point2F(center.x + radiusX * cosf(t), center.y + radiusY * sinf(t));
+            }
+            DrawPolyline(m_ellipse.data(), SEGMENTS, true, color, width, style);
+        }
+        void DrawBezier(D2D1_POINT_2F p0, D2D1_POINT_2F p1, D2D1_POINT_2F p2, D2D1_POINT_2F p3,
+                        const D2D1_COLOR_F &color, float width, LineStyle style) override {
+            // Bezierڷ任ֻ任Ƶ
+            m_target.DrawBezier(TransformPoint(m_m, p0), TransformPoint(m_m, p1), TransformPoint(m_m, p2),
+                                TransformPoint(m_m, p3), color, width, style);
+        }
+        void FillPolygon(const D2D1_POINT_2F *points, size_t count, const D2D1_COLOR_F &color) override {
+            m_target.FillPolygon(Map(points, count), count, color);
+        }
+        void FillPixels(const D2D1_POINT_2F *pixels, size_t count, const D2D1_COLOR_F &color) override {
+            // ı任Ըռһ
+            m_points.resize(count);
+            for (size_t i = 0; i < count; ++i) {
+                D2D1_POINT_2F c = TransformPoint(m_m, D2D1::Point2F(pixels[i].x + 0.5f, pixels[i].y + 0.5f));
+                m_points[i] = D2D1::Point2F(floorf(c.x), floorf(c.y));
+            }
+            m_target.FillPixels(m_points.data(), count, color);
+        }
+
+    private:
+        RenderBackend &m_target;
+        D2D1_MATRIX_3X2_F m_m;
+        float m_scale;
+        std::vector<D2D1_POINT_2F> m_points;
+        std::vector<D2D1_POINT_2F> m_ellipse;
+
+        const D2D1_POINT_2F *Map(const D2D1_POINT_2F *points, size_t count) {
+            m_points.resize(count);
+            for (size_t i = 0; i < count; ++i) {
+                m_points[i] = TransformPoint(m_m, points[i]);
+            }
+            return m_points.data();
+        }
+    };
+
+    // Ƶˣ任ͼξ TransformedBackend ת
+    void DrawShapeTo(const Shape &shape, RenderBackend &backend, const D2D1_COLOR_F &color) {
+        if (shape.HasTransform()) {
+            TransformedBackend transformed(backend, shape.GetTransform());
+            shape.DrawTo(transformed, color);
+        } else {
+            shape.DrawTo(backend, color);
+        }
+    }
+}
 
 GraphicsEngine::GraphicsEngine() :
     m_hwnd(nullptr), m_pD2DFactory(nullptr), m_pRenderTarget(nullptr), m_pNormalBrush(nullptr), m_pSelectedBrush(nullptr), m_pDWriteFactory(nullptr), m_currentMode(DrawingMode::SELECT),
-    m_pStrokeStyle(nullptr), m_pSolidStrokeStyle(nullptr), m_pDashStrokeStyle(nullptr), m_pDotStrokeStyle(nullptr), m_pDashDotStrokeStyle(nullptr), m_pDashDotDotStrokeStyle(nullptr) {
+    m_pStrokeStyle(nullptr), m_pSolidStrokeStyle(nullptr), m_pDashStrokeStyle(nullptr), m_pDotStrokeStyle(nullptr), m_pDashDotStrokeStyle(nullptr), m_pDashDotDotStrokeStyle(nullptr),
+    m_pHighlightStrokeStyle(nullptr), m_targetSize(D2D1::SizeU(0, 0)),
+    m_viewOffset(D2D1::Point2F(0, 0)), m_zoom(1.0f), m_clientWidth(0), m_clientHeight(0),
+    m_lodWidth(0), m_lodHeight(0), m_lodDirty(D2D1::RectU(0, 0, 0, 0)), m_pLodBitmap(nullptr),
+    m_pLayerTarget(nullptr), m_layerVersion(0), m_sceneVersion(1) {
+    // ߳ϴͼκ͵жڵǰĵ
+    m_arena = DocumentArena::BeginDocument();
+    m_transformBaseCenter = D2D1::Point2F(0, 0);
+    // ĵΪʷĵһ
+    m_firstChanged = SIZE_MAX;
+    m_history.Commit(m_store.Shapes());
 }
 
 GraphicsEngine::~GraphicsEngine() {
@@ -14,12 +152,27 @@ GraphicsEngine::~GraphicsEngine() {
 
 HRESULT GraphicsEngine::Initialize(HWND hwnd) {
     m_hwnd = hwnd;
+    RECT rc;
+    GetClientRect(m_hwnd, &rc);
+    m_clientWidth = rc.right - rc.left;
+    m_clientHeight = rc.bottom - rc.top;
 
-    // D2D
-    HRESULT hr = D2D1CreateFactory(D2D1_FACTORY_TYPE_SINGLE_THREADED, &m_pD2DFactory);
+    // ̹߳ȾĿﴴ֮󽻸߳ʹãл̵߳ĵ
+    HRESULT hr = D2D1CreateFactory(D2D1_FACTORY_TYPE_MULTI_THREADED, &m_pD2DFactory);
+    if (SUCCEEDED(hr)) {
+        // ıʽͲԴͨ
+        hr = DWriteCreateFactory(DWRITE_FACTORY_TYPE_SHARED, __uuidof(IDWriteFactory),
+                                 reinterpret_cast<IUnknown **>(&m_pDWriteFactory));
+    }
     if (SUCCEEDED(hr)) {
         hr = CreateDeviceResources();
     }
+    if (SUCCEEDED(hr)) {
+        m_resources.Attach(m_pRenderTarget, m_pDWriteFactory);
+        m_renderThread.Start([this](const std::shared_ptr<const RenderFrame> &frame) {
+            DrawFrame(*frame);
+        });
+    }
 
     return hr;
 }
@@ -32,6 +185,7 @@ HRESULT GraphicsEngine::CreateDeviceResources() {
         GetClientRect(m_hwnd, &rc);
 
         D2D1_SIZE_U size = D2D1::SizeU(rc.right - rc.left, rc.bottom - rc.top);
+        m_targetSize = size;
 
         hr = m_pD2DFactory->CreateHwndRenderTarget(
             D2D1::RenderTargetProperties(),
@@ -45,7 +199,10 @@ HRESULT GraphicsEngine::CreateDeviceResources() {
         if (SUCCEEDED(hr)) {
             hr = m_pRenderTarget->CreateSolidColorBrush(D2D1::ColorF(D2D1::ColorF::Gray), &m_pSelectedBrush);
         }
+    }
 
+    // ʻʽڹȾĿؽ
+    if (m_pStrokeStyle == nullptr) {
         if (SUCCEEDED(hr)) {
             // ʵʽ
             hr = m_pD2DFactory->CreateStrokeStyle(
@@ -64,7 +221,7 @@ HRESULT GraphicsEngine::CreateDeviceResources() {
 
         if (SUCCEEDED(hr)) {
             // ʽ
-            FLOAT dashes[] = {5.0f, 5.0f};
+            const DashPattern &dashes = DashPatterns::Stroke(LineStyle::DASH);
             hr = m_pD2DFactory->CreateStrokeStyle(
                 D2D1::StrokeStyleProperties(
                     D2D1_CAP_STYLE_FLAT,
@@ -74,14 +231,14 @@ HRESULT GraphicsEngine::CreateDeviceResources() {
                     10.0f,
                     D2D1_DASH_STYLE_CUSTOM,
                     0.0f),
-                dashes,
-                ARRAYSIZE(dashes),
+                dashes.lengths,
+                dashes.count,
                 &m_pDashStrokeStyle);
         }
 
         if (SUCCEEDED(hr)) {
             // ʽ
-            FLOAT dots[] = {1.0f, 3.0f};
+            const DashPattern &dots = DashPatterns::Stroke(LineStyle::DOT);
             hr = m_pD2DFactory->CreateStrokeStyle(
                 D2D1::StrokeStyleProperties(
                     D2D1_CAP_STYLE_ROUND,
@@ -91,14 +248,14 @@ HRESULT GraphicsEngine::CreateDeviceResources() {
                     10.0f,
                     D2D1_DASH_STYLE_CUSTOM,
                     0.0f),
-                dots,
-                ARRAYSIZE(dots),
+                dots.lengths,
+                dots.count,
                 &m_pDotStrokeStyle);
         }
 
         if (SUCCEEDED(hr)) {
             // 㻮ʽ--ߣ
-            FLOAT dashDot[] = {8.0f, 3.0f, 1.0f, 3.0f};
+            const DashPattern &dashDot = DashPatterns::Stroke(LineStyle::DASH_DOT);
             hr = m_pD2DFactory->CreateStrokeStyle(
                 D2D1::StrokeStyleProperties(
                     D2D1_CAP_STYLE_FLAT,
@@ -108,14 +265,14 @@ HRESULT GraphicsEngine::CreateDeviceResources() {
                     10.0f,
                     D2D1_DASH_STYLE_CUSTOM,
                     0.0f),
-                dashDot,
-                ARRAYSIZE(dashDot),
+                dashDot.lengths,
+                dashDot.count,
                 &m_pDashDotStrokeStyle);
         }
 
         if (SUCCEEDED(hr)) {
             // ˫㻮ʽ---ߣ
-            FLOAT dashDotDot[] = {8.0f, 3.0f, 1.0f, 3.0f, 1.0f, 3.0f};
+            const DashPattern &dashDotDot = DashPatterns::Stroke(LineStyle::DASH_DOT_DOT);
             hr = m_pD2DFactory->CreateStrokeStyle(
                 D2D1::StrokeStyleProperties(
                     D2D1_CAP_STYLE_FLAT,
@@ -125,8 +282,8 @@ HRESULT GraphicsEngine::CreateDeviceResources() {
                     10.0f,
                     D2D1_DASH_STYLE_CUSTOM,
                     0.0f),
-                dashDotDot,
-                ARRAYSIZE(dashDotDot),
+                dashDotDot.lengths,
+                dashDotDot.count,
                 &m_pDashDotDotStrokeStyle);
         }
 
@@ -146,34 +303,520 @@ HRESULT GraphicsEngine::CreateDeviceResources() {
                 ARRAYSIZE(dashes),
                 &m_pStrokeStyle);
         }
+
+        if (SUCCEEDED(hr)) {
+            // ͼε
+            FLOAT dashes[] = {5.0f, 5.0f};
+            hr = m_pD2DFactory->CreateStrokeStyle(
+                D2D1::StrokeStyleProperties(
+                    D2D1_CAP_STYLE_FLAT,
+                    D2D1_CAP_STYLE_FLAT,
+                    D2D1_CAP_STYLE_ROUND,
+                    D2D1_LINE_JOIN_MITER,
+                    10.0f,
+                    D2D1_DASH_STYLE_CUSTOM,
+                    0.0f),
+                dashes,
+                ARRAYSIZE(dashes),
+                &m_pHighlightStrokeStyle);
+        }
     }
 
     return hr;
 }
 
-void GraphicsEngine::Resize(UINT width, UINT height) {
+void GraphicsEngine::DiscardDeviceResources() {
+    ReleaseLayer();
+    if (m_pLodBitmap) {
+        m_pLodBitmap->Release();
+        m_pLodBitmap = nullptr;
+    }
+    if (m_pNormalBrush) {
+        m_pNormalBrush->Release();
+        m_pNormalBrush = nullptr;
+    }
+    if (m_pSelectedBrush) {
+        m_pSelectedBrush->Release();
+        m_pSelectedBrush = nullptr;
+    }
     if (m_pRenderTarget) {
-        m_pRenderTarget->Resize(D2D1::SizeU(width, height));
+        m_pRenderTarget->Release();
+        m_pRenderTarget = nullptr;
+    }
+    m_resources.DiscardDeviceResources();
+}
+
+void GraphicsEngine::BeginDraw() {
+    Profiler::BeginFrame();
+    if (m_pD2DFactory == nullptr || FAILED(CreateDeviceResources())) return;
+    m_resources.Attach(m_pRenderTarget, m_pDWriteFactory);
+    m_resources.BeginFrame();
+    m_pRenderTarget->BeginDraw();
+}
+
+HRESULT GraphicsEngine::EndDraw() {
+    if (m_pRenderTarget == nullptr) return S_OK;
+    HRESULT hr = m_pRenderTarget->EndDraw();
+    m_resources.EndFrame();
+    Profiler::EndFrame();
+    if (hr == D2DERR_RECREATE_TARGET) {
+        // 豸ʧȾĿͻˢһ֡ؽ豸޹صļκı
+        DiscardDeviceResources();
+        InvalidateRect(m_hwnd, nullptr, FALSE);
+        hr = S_OK;
+    }
+    return hr;
+}
+
+void GraphicsEngine::Resize(UINT width, UINT height) {
+    m_clientWidth = width;
+    m_clientHeight = height;
+}
+
+void GraphicsEngine::SubmitFrame(OverlayList overlay) {
+    if (!m_renderThread.IsRunning()) return;
+    PROFILE_SCOPE("GraphicsEngine::SubmitFrame");
+
+    // ͼοÿ޸ĺѼ¼ʷǰֻͬѡͼοܴδύı任
+    std::shared_ptr<RenderFrame> frame = std::make_shared<RenderFrame>();
+    frame->document = m_history.Current();
+    frame->bounds = m_store.BoundsSnapshot();
+    frame->sceneVersion = m_sceneVersion;
+    frame->selectedIndex = m_selectedShape ? m_store.IndexOf(m_selectedHandle) : ShapeStore::npos;
+    frame->selectedTransform = D2D1::IdentityMatrix();
+    if (frame->selectedIndex != ShapeStore::npos) {
+        frame->selected = SelectedFrameShape();
+        if (m_selectedShape->HasTransform()) {
+            frame->selectedTransform = m_selectedShape->GetTransform();
+        }
     }
+    frame->viewOffset = m_viewOffset;
+    frame->zoom = m_zoom;
+    frame->width = m_clientWidth;
+    frame->height = m_clientHeight;
+    frame->overlay = std::move(overlay);
+    m_renderThread.Submit(std::move(frame));
 }
 
-void GraphicsEngine::Render() {
+std::shared_ptr<Shape> GraphicsEngine::SelectedFrameShape() {
+    // ΰ汾漸޸ĸƵͼԭ汾϶ʱֻб任ڱ䣬һֱ
+    const Shape &shape = *m_selectedShape;
+    if (!m_frameSelected || m_frameSelected->GetGeometryVersion() != shape.GetGeometryVersion() ||
+        m_frameSelected->GetLineWidth() != shape.GetLineWidth() || m_frameSelected->GetLineStyle() != shape.GetLineStyle()) {
+        m_frameSelected = shape.Clone();
+        m_frameSelected->SetSelected(true);
+    }
+    return m_frameSelected;
+}
+
+void GraphicsEngine::DrawFrame(const RenderFrame &frame) {
+    // ͼλʱӵǰȡˢ·κλͼ
+    if (DeviceResourceCache::Current() != &m_resources) {
+        DeviceResourceCache::SetCurrent(&m_resources);
+    }
+    if (m_pRenderTarget && (frame.width != m_targetSize.width || frame.height != m_targetSize.height)) {
+        m_targetSize = D2D1::SizeU(frame.width, frame.height);
+        m_pRenderTarget->Resize(m_targetSize);
+    }
+
+    BeginDraw();
+    if (m_pRenderTarget == nullptr) return; // ȾĿؽʧܣһػ
+    Render(frame);
+    frame.overlay.Replay(m_pRenderTarget, m_resources, ViewMatrix(frame.viewOffset, frame.zoom), m_pHighlightStrokeStyle);
+    EndDraw();
+}
+
+void GraphicsEngine::Render(const RenderFrame &frame, const D2D1_RECT_F *clip) {
     if (m_pRenderTarget == nullptr) {
         return;
     }
+    PROFILE_SCOPE("GraphicsEngine::Render");
+
+    D2D1_SIZE_F size = m_pRenderTarget->GetSize();
+    D2D1_RECT_F visible = D2D1::RectF(0, 0, size.width, size.height);
+    if (clip) {
+        visible.left = (std::max)(visible.left, clip->left);
+        visible.top = (std::max)(visible.top, clip->top);
+        visible.right = (std::min)(visible.right, clip->right);
+        visible.bottom = (std::min)(visible.bottom, clip->bottom);
+        if (visible.left >= visible.right || visible.top >= visible.bottom) return;
+        m_pRenderTarget->PushAxisAlignedClip(visible, D2D1_ANTIALIAS_MODE_ALIASED);
+    }
+
+    // ϸڲȾĿͬ󣬳ߴ仯ʱ·
+    UINT32 maskWidth = static_cast<UINT32>(ceilf(size.width));
+    UINT32 maskHeight = static_cast<UINT32>(ceilf(size.height));
+    if (maskWidth != m_lodWidth || maskHeight != m_lodHeight) {
+        m_lodWidth = maskWidth;
+        m_lodHeight = maskHeight;
+        m_lodMask.assign(static_cast<size_t>(maskWidth) * maskHeight, 0);
+        m_lodDirty = D2D1::RectU(0, 0, 0, 0);
+        if (m_pLodBitmap) {
+            m_pLodBitmap->Release();
+            m_pLodBitmap = nullptr;
+        }
+    }
+    m_resources.SetViewScale(frame.zoom);
+
+    if (UpdateLayer(frame)) {
+        ID2D1Bitmap *pLayer = nullptr;
+        if (SUCCEEDED(m_pLayerTarget->GetBitmap(&pLayer))) {
+            PROFILE_SCOPE("Draw Layer");
+            Profiler::CountDrawCalls();
+            // ̬ȾĿͬDPIͬһһӦ
+            m_pRenderTarget->DrawBitmap(pLayer, D2D1::RectF(0, 0, size.width, size.height), 1.0f,
+                                        D2D1_BITMAP_INTERPOLATION_MODE_NEAREST_NEIGHBOR);
+            pLayer->Release();
+        }
+    } else {
+        m_pRenderTarget->Clear(D2D1::ColorF(D2D1::ColorF::White));
+        DrawShapes(m_pRenderTarget, frame, visible);
+    }
+
+    // ѡеͼƿƵȱǣܳΧУ޳Ҳ򻯣϶ÿ֡仯̬
+    if (frame.selected) {
+        const D2D1_MATRIX_3X2_F view = ViewMatrix(frame.viewOffset, frame.zoom);
+        m_pRenderTarget->SetTransform(Multiply(frame.selectedTransform, view));
+        // 任Ų߿дغһ£ʱͼαɼ߿ٵ
+        const D2D1_MATRIX_3X2_F &m = frame.selectedTransform;
+        float strokeScale = sqrtf(m._11 * m._11 + m._12 * m._12);
+        m_resources.SetStrokeScale(strokeScale > 0.0f ? strokeScale : 1.0f);
+        DrawShape(m_pRenderTarget, *frame.selected, true);
+        m_resources.SetStrokeScale(1.0f);
+        m_pRenderTarget->SetTransform(D2D1::IdentityMatrix());
+    }
+
+    if (clip) {
+        m_pRenderTarget->PopAxisAlignedClip();
+    }
+}
+
+bool GraphicsEngine::UpdateLayer(const RenderFrame &frame) {
+    D2D1_SIZE_F size = m_pRenderTarget->GetSize();
+    if (m_pLayerTarget) {
+        D2D1_SIZE_F layerSize = m_pLayerTarget->GetSize();
+        if (layerSize.width != size.width || layerSize.height != size.height) {
+            ReleaseLayer();
+        }
+    }
+    if (!m_pLayerTarget) {
+        if (FAILED(m_pRenderTarget->CreateCompatibleRenderTarget(size, &m_pLayerTarget))) {
+            m_pLayerTarget = nullptr;
+            return false;
+        }
+        // ĿȾĿ깲豸ʱֱʹԴеĻˢλͼ
+        m_resources.SetCompatibleTarget(m_pLayerTarget);
+        m_layerVersion = 0;
+    }
+    if (m_layerVersion == frame.sceneVersion) return true;
+
+    PROFILE_SCOPE("Render Layer");
+    m_pLayerTarget->BeginDraw();
+    m_pLayerTarget->Clear(D2D1::ColorF(D2D1::ColorF::White));
+    DrawShapes(m_pLayerTarget, frame, D2D1::RectF(0, 0, size.width, size.height));
+    if (FAILED(m_pLayerTarget->EndDraw())) {
+        // 豸ʧȴ󣺶̬㣬ֱ֡ӻƣ豸ʧȾĿ EndDraw ͳһ
+        ReleaseLayer();
+        return false;
+    }
+    m_layerVersion = frame.sceneVersion;
+    return true;
+}
+
+void GraphicsEngine::ReleaseLayer() {
+    if (m_pLayerTarget) {
+        m_resources.SetCompatibleTarget(nullptr);
+        m_pLayerTarget->Release();
+        m_pLayerTarget = nullptr;
+    }
+    m_layerVersion = 0;
+}
+
+void GraphicsEngine::DrawShapes(ID2D1RenderTarget *pTarget, const RenderFrame &frame, const D2D1_RECT_F &visible) {
+    const float zoom = frame.zoom;
+    const D2D1_POINT_2F offset = frame.viewOffset;
+    const D2D1_MATRIX_3X2_F view = ViewMatrix(offset, zoom);
+    pTarget->SetTransform(view);
+
+    // ɼ㵽ĵꣻ޳밴ؼ
+    D2D1_POINT_2F visibleMin = D2D1::Point2F((visible.left - offset.x) / zoom, (visible.top - offset.y) / zoom);
+    D2D1_POINT_2F visibleMax = D2D1::Point2F((visible.right - offset.x) / zoom, (visible.bottom - offset.y) / zoom);
+    float cullMargin = CULL_MARGIN / zoom;
+
+    // ֡İΧиϰΧк߿жϿɼԺϸڲΣɨ飬
+    // ޳򻯵ͼβͼζҪƵ±갴˳ռٴӿȡͼλ
+    const ShapeBoundsSnapshot &boundsSnapshot = *frame.bounds;
+    size_t count = (std::min)(boundsSnapshot.Size(), frame.document->Size());
+    uint32_t culled = 0;
+    m_drawIndices.clear();
+    for (size_t c = 0; c < boundsSnapshot.ChunkCount(); ++c) {
+        const ShapeBoundsSnapshot::Chunk &chunk = boundsSnapshot.ChunkAt(c);
+        size_t base = c * ShapeBoundsSnapshot::CHUNK_SIZE;
+        size_t n = (std::min)(chunk.Size(), count - (std::min)(count, base));
+        for (size_t j = 0; j < n; ++j) {
+            if (base + j == frame.selectedIndex) continue;
+            float halfWidth = chunk.lineWidth[j] * 0.5f;
+            float margin = halfWidth + cullMargin;
+            float left = chunk.minX[j], top = chunk.minY[j], right = chunk.maxX[j], bottom = chunk.maxY[j];
+            if (right + margin < visibleMin.x || left - margin > visibleMax.x ||
+                bottom + margin < visibleMin.y || top - margin > visibleMax.y) {
+                ++culled;
+                continue;
+            }
+            float extent = ((std::max)(right - left, bottom - top) + 2.0f * halfWidth) * zoom;
+            if (extent < LOD_BOX_PIXELS) {
+                SplatLod(D2D1::RectF((left - halfWidth) * zoom + offset.x, (top - halfWidth) * zoom + offset.y,
+                                     (right + halfWidth) * zoom + offset.x, (bottom + halfWidth) * zoom + offset.y),
+                         extent < LOD_DOT_PIXELS);
+                continue;
+            }
+            m_drawIndices.push_back(static_cast<uint32_t>(base + j));
+        }
+    }
+    frame.document->ForEachIndex(m_drawIndices, [&](size_t, const std::shared_ptr<Shape> &shape) {
+        if (shape->HasTransform()) {
+            pTarget->SetTransform(Multiply(shape->GetTransform(), view));
+            DrawShape(pTarget, *shape, false);
+            pTarget->SetTransform(view);
+        } else {
+            DrawShape(pTarget, *shape, false);
+        }
+    });
+    Profiler::CountCulled(culled);
+
+    pTarget->SetTransform(D2D1::IdentityMatrix());
+    FlushLod(pTarget);
+}
+
+void GraphicsEngine::DrawShape(ID2D1RenderTarget *pTarget, Shape &shape, bool selected) {
+    PROFILE_SCOPE(DRAW_SCOPE_NAMES[static_cast<int>(shape.GetType())]);
+    Profiler::CountDrawCalls();
+    // ȡ״ʽ
+    ID2D1StrokeStyle* shapeStrokeStyle = GetStrokeStyle(shape.GetLineStyle());
+    // ״ѡУʹѡʽʹ״Լʽ
+    ID2D1StrokeStyle* strokeStyleToUse = selected ? m_pStrokeStyle : shapeStrokeStyle;
+    shape.Draw(pTarget, m_pNormalBrush, m_pSelectedBrush, strokeStyleToUse);
+}
+
+void GraphicsEngine::SplatLod(const D2D1_RECT_F &screenBounds, bool dot) {
+    if (m_lodMask.empty()) return;
+    int maxX = static_cast<int>(m_lodWidth) - 1;
+    int maxY = static_cast<int>(m_lodHeight) - 1;
+    auto clampX = [maxX](float x) {
+        return (std::max)(0, (std::min)(maxX, static_cast<int>(floorf(x))));
+    };
+    auto clampY = [maxY](float y) {
+        return (std::max)(0, (std::min)(maxY, static_cast<int>(floorf(y))));
+    };
+    int left, top, right, bottom;
+    if (dot) {
+        left = right = clampX((screenBounds.left + screenBounds.right) * 0.5f);
+        top = bottom = clampY((screenBounds.top + screenBounds.bottom) * 0.5f);
+        m_lodMask[static_cast<size_t>(top) * m_lodWidth + left] = 255;
+    } else {
+        left = clampX(screenBounds.left);
+        top = clampY(screenBounds.top);
+        right = clampX(screenBounds.right);
+        bottom = clampY(screenBounds.bottom);
+        uint8_t *topRow = &m_lodMask[static_cast<size_t>(top) * m_lodWidth];
+        uint8_t *bottomRow = &m_lodMask[static_cast<size_t>(bottom) * m_lodWidth];
+        for (int x = left; x <= right; ++x) {
+            topRow[x] = 255;
+            bottomRow[x] = 255;
+        }
+        for (int y = top + 1; y < bottom; ++y) {
+            uint8_t *row = &m_lodMask[static_cast<size_t>(y) * m_lodWidth];
+            row[left] = 255;
+            row[right] = 255;
+        }
+    }
+
+    if (m_lodDirty.left >= m_lodDirty.right) {
+        m_lodDirty = D2D1::RectU(left, top, right + 1, bottom + 1);
+    } else {
+        m_lodDirty.left = (std::min)(m_lodDirty.left, static_cast<UINT32>(left));
+        m_lodDirty.top = (std::min)(m_lodDirty.top, static_cast<UINT32>(top));
+        m_lodDirty.right = (std::max)(m_lodDirty.right, static_cast<UINT32>(right + 1));
+        m_lodDirty.bottom = (std::max)(m_lodDirty.bottom, static_cast<UINT32>(bottom + 1));
+    }
+}
+
+void GraphicsEngine::FlushLod(ID2D1RenderTarget *pTarget) {
+    if (m_lodDirty.left >= m_lodDirty.right) return;
+    D2D1_RECT_U dirty = m_lodDirty;
+    m_lodDirty = D2D1::RectU(0, 0, 0, 0);
+
+    if (!m_pLodBitmap) {
+        m_pLodBitmap = DeviceResourceCache::CreateMaskBitmap(m_pRenderTarget, m_lodWidth, m_lodHeight, nullptr, 0);
+    }
+    const uint8_t *first = &m_lodMask[static_cast<size_t>(dirty.top) * m_lodWidth + dirty.left];
+    if (m_pLodBitmap && SUCCEEDED(m_pLodBitmap->CopyFromMemory(&dirty, first, m_lodWidth))) {
+        PROFILE_SCOPE("Draw LOD");
+        Profiler::CountDrawCalls();
+        D2D1_RECT_F rect = D2D1::RectF(static_cast<float>(dirty.left), static_cast<float>(dirty.top),
+                                       static_cast<float>(dirty.right), static_cast<float>(dirty.bottom));
+        // FillOpacityMask ҪȾĿΪģʽ
+        D2D1_ANTIALIAS_MODE mode = pTarget->GetAntialiasMode();
+        pTarget->SetAntialiasMode(D2D1_ANTIALIAS_MODE_ALIASED);
+        pTarget->FillOpacityMask(m_pLodBitmap, m_pNormalBrush, D2D1_OPACITY_MASK_CONTENT_GRAPHICS, &rect, &rect);
+        pTarget->SetAntialiasMode(mode);
+    }
+
+    for (UINT32 y = dirty.top; y < dirty.bottom; ++y) {
+        uint8_t *row = &m_lodMask[static_cast<size_t>(y) * m_lodWidth];
+        std::fill(row + dirty.left, row + dirty.right, static_cast<uint8_t>(0));
+    }
+}
+
+D2D1_MATRIX_3X2_F GraphicsEngine::GetViewTransform() const {
+    return ViewMatrix(m_viewOffset, m_zoom);
+}
+
+D2D1_POINT_2F GraphicsEngine::ScreenToWorld(D2D1_POINT_2F point) const {
+    return D2D1::Point2F((point.x - m_viewOffset.x) / m_zoom, (point.y - m_viewOffset.y) / m_zoom);
+}
+
+D2D1_POINT_2F GraphicsEngine::WorldToScreen(D2D1_POINT_2F point) const {
+    return D2D1::Point2F(point.x * m_zoom + m_viewOffset.x, point.y * m_zoom + m_viewOffset.y);
+}
+
+void GraphicsEngine::PanView(float dx, float dy) {
+    InvalidateLayer();
+    m_viewOffset.x += dx;
+    m_viewOffset.y += dy;
+}
+
+void GraphicsEngine::ZoomView(float factor, D2D1_POINT_2F anchor) {
+    float zoom = (std::max)(MIN_ZOOM, (std::min)(MAX_ZOOM, m_zoom * factor));
+    InvalidateLayer();
+    // anchor ĵǰ󲻱
+    D2D1_POINT_2F world = ScreenToWorld(anchor);
+    m_zoom = zoom;
+    m_viewOffset = D2D1::Point2F(anchor.x - world.x * zoom, anchor.y - world.y * zoom);
+}
+
+void GraphicsEngine::ZoomToFit() {
+    if (m_store.Size() == 0 || m_clientWidth == 0 || m_clientHeight == 0) {
+        ResetView();
+        return;
+    }
+    InvalidateLayer();
+    D2D1_RECT_F bounds = m_store.TotalBounds();
+    D2D1_SIZE_F size = D2D1::SizeF(static_cast<float>(m_clientWidth), static_cast<float>(m_clientHeight));
+    float width = (std::max)(bounds.right - bounds.left, 1.0f);
+    float height = (std::max)(bounds.bottom - bounds.top, 1.0f);
+    float availableWidth = (std::max)(size.width - 2.0f * FIT_MARGIN, 1.0f);
+    float availableHeight = (std::max)(size.height - 2.0f * FIT_MARGIN, 1.0f);
+    m_zoom = (std::max)(MIN_ZOOM, (std::min)(MAX_ZOOM, (std::min)(availableWidth / width, availableHeight / height)));
+    // ͼεĶ׼
+    m_viewOffset = D2D1::Point2F(size.width * 0.5f - (bounds.left + bounds.right) * 0.5f * m_zoom,
+                                 size.height * 0.5f - (bounds.top + bounds.bottom) * 0.5f * m_zoom);
+}
 
-    m_pRenderTarget->Clear(D2D1::ColorF(D2D1::ColorF::White));
+void GraphicsEngine::ResetView() {
+    InvalidateLayer();
+    m_viewOffset = D2D1::Point2F(0, 0);
+    m_zoom = 1.0f;
+}
+
+void GraphicsEngine::RenderTo(RenderBackend &backend) const {
+    const D2D1_COLOR_F normalColor = D2D1::ColorF(D2D1::ColorF::Black);
+    const D2D1_COLOR_F selectedColor = D2D1::ColorF(D2D1::ColorF::Gray);
 
-    for (auto &shape : m_shapes) {
-        // ȡ״ʽ
-        ID2D1StrokeStyle* shapeStrokeStyle = GetStrokeStyle(shape->GetLineStyle());
-        // ״ѡУʹѡʽʹ״Լʽ
-        ID2D1StrokeStyle* strokeStyleToUse = shape->IsSelected() ? m_pStrokeStyle : shapeStrokeStyle;
-        shape->Draw(m_pRenderTarget, m_pNormalBrush, m_pSelectedBrush, strokeStyleToUse);
+    backend.Clear(D2D1::ColorF(D2D1::ColorF::White));
+    for (const auto &shape : m_store.Shapes()) {
+        DrawShapeTo(*shape, backend, shape == m_selectedShape ? selectedColor : normalColor);
+    }
+}
+
+void GraphicsEngine::RenderToSurface(RasterSurface &surface, int threadCount) const {
+    // ˮƽֿȾһֿпڻУֿͼβᱻ
+    // ֿȡпȣÿеĸֿ黮޹أԶ߳̽뵥߳λһ
+    const int BAND_HEIGHT = 64; // ÿֿ
+    int bandCount = (surface.height + BAND_HEIGHT - 1) / BAND_HEIGHT;
+    if (bandCount == 0 || surface.width == 0) return;
+
+    const D2D1_COLOR_F normalColor = D2D1::ColorF(D2D1::ColorF::Black);
+    const D2D1_COLOR_F selectedColor = D2D1::ColorF(D2D1::ColorF::Gray);
+
+    // Χаͼη䵽ֿ飨CSRʽbinStart[band] ~ binStart[band + 1] Ϊ÷ֿͼ±꣩
+    // ͼΰԭ˳μ룬ֿڵĻ˳ͼбһ£Ͻȷ
+    // Χк߿ֱȡͼο飬ʱͼζ
+    const auto &shapes = m_store.Shapes();
+    std::vector<std::pair<int, int>> shapeBands(shapes.size(), std::make_pair(1, 0));
+    std::vector<int> binStart(bandCount + 1, 0);
+    for (size_t i = 0; i < shapes.size(); ++i) {
+        D2D1_RECT_F bounds = m_store.BoundsAt(i);
+        float margin = m_store.LineWidthAt(i) * 0.5f + 2.0f;
+        float top = bounds.top - margin;
+        float bottom = bounds.bottom + margin;
+        if (bounds.right + margin < 0 || bounds.left - margin >= surface.width ||
+            bottom < 0 || top >= surface.height) {
+            continue;
+        }
+        int firstBand = top <= 0 ? 0 : static_cast<int>(top) / BAND_HEIGHT;
+        int lastBand = (std::min)(bandCount - 1, static_cast<int>(bottom) / BAND_HEIGHT);
+        shapeBands[i] = std::make_pair(firstBand, lastBand);
+        for (int band = firstBand; band <= lastBand; ++band) {
+            ++binStart[band + 1];
+        }
+    }
+    for (int band = 0; band < bandCount; ++band) {
+        binStart[band + 1] += binStart[band];
+    }
+    std::vector<int> binShapes(binStart[bandCount]);
+    std::vector<int> binFill(binStart.begin(), binStart.end() - 1);
+    for (size_t i = 0; i < shapes.size(); ++i) {
+        for (int band = shapeBands[i].first; band <= shapeBands[i].second; ++band) {
+            binShapes[binFill[band]++] = static_cast<int>(i);
+        }
     }
+
+    // ÿ߳һդۻʱڸ̴߳ĸֿ֮临
+    int workerCount = WorkStealing::WorkerCount(bandCount, threadCount);
+    std::vector<std::unique_ptr<SoftwareRasterizer>> rasterizers(workerCount);
+
+    // ֿ֮вصֱ߳̿дͬһ壻ȡ֤ͼηֲʱȻ
+    WorkStealing::ParallelFor(bandCount, workerCount, [&](int band, int worker) {
+        if (!rasterizers[worker]) {
+            rasterizers[worker].reset(new SoftwareRasterizer(surface));
+        }
+        SoftwareRasterizer &rasterizer = *rasterizers[worker];
+
+        int top = band * BAND_HEIGHT;
+        int bottom = (std::min)(surface.height, top + BAND_HEIGHT);
+        rasterizer.SetClipRect(0, top, surface.width, bottom);
+        rasterizer.Clear(D2D1::ColorF(D2D1::ColorF::White));
+
+        for (int k = binStart[band]; k < binStart[band + 1]; ++k) {
+            const auto &shape = shapes[binShapes[k]];
+            DrawShapeTo(*shape, rasterizer, shape == m_selectedShape ? selectedColor : normalColor);
+        }
+    });
+}
+
+size_t GraphicsEngine::ClipSegmentShapes(const ClipWindow *windows, size_t windowCount) {
+    PROFILE_SCOPE("GraphicsEngine::ClipSegmentShapes");
+    CommitSelectedTransform();
+    // üԭ޸ͼβͼΣȡбüɺŻزȡ
+    std::vector<std::shared_ptr<Shape>> shapes = m_store.Release();
+    size_t changed = LineClipping::ClipShapes(shapes, windows, windowCount);
+    ReplaceShapes(std::move(shapes));
+    return changed;
 }
 
 void GraphicsEngine::Cleanup() {
+    // δɵ䲻д
+    m_fills.Shutdown();
+    // ͣ»̣֮߳豸Դֻʣǰ̷߳
+    m_renderThread.Stop();
+    m_frameSelected = nullptr;
+    ReleaseLayer();
+    m_resources.Clear();
+    if (m_pLodBitmap) {
+        m_pLodBitmap->Release();
+        m_pLodBitmap = nullptr;
+    }
     if (m_pNormalBrush) {
         m_pNormalBrush->Release();
         m_pNormalBrush = nullptr;
@@ -206,6 +849,10 @@ void GraphicsEngine::Cleanup() {
         m_pDashDotDotStrokeStyle->Release();
         m_pDashDotDotStrokeStyle = nullptr;
     }
+    if (m_pHighlightStrokeStyle) {
+        m_pHighlightStrokeStyle->Release();
+        m_pHighlightStrokeStyle = nullptr;
+    }
     if (m_pRenderTarget) {
         m_pRenderTarget->Release();
         m_pRenderTarget = nullptr;
@@ -221,27 +868,187 @@ void GraphicsEngine::Cleanup() {
 }
 
 void GraphicsEngine::AddShape(std::shared_ptr<Shape> shape) {
-    m_shapes.push_back(shape);
+    MarkChanged(m_store.Size());
+    m_store.Add(std::move(shape));
+    RecordHistory();
+}
+
+void GraphicsEngine::ClearAllShapes() {
+    m_fills.CancelAll();
+    ClearSelection();
+    MarkChanged(0);
+    // ĵͼʱС
+    m_arena->Retire();
+    m_store.Clear();
+    m_arena = DocumentArena::BeginDocument();
+    RecordHistory();
+}
+
+void GraphicsEngine::ReplaceShapes(std::vector<std::shared_ptr<Shape>> shapes) {
+    MarkChanged(0);
+    m_store.Assign(std::move(shapes));
+    if (m_selectedShape) {
+        // ѡͼα༭滻类üʱȡѡ
+        size_t index = m_store.IndexOf(m_selectedShape.get());
+        if (index == ShapeStore::npos) {
+            m_selectedShape = nullptr;
+        }
+        m_selectedHandle = m_store.HandleAt(index);
+    }
+    RecordHistory();
 }
 
 void GraphicsEngine::DeleteSelectedShape() {
     if (m_selectedShape) {
-        auto it = std::find(m_shapes.begin(), m_shapes.end(), m_selectedShape);
-        if (it != m_shapes.end()) {
-            m_shapes.erase(it);
+        MarkChanged(m_store.IndexOf(m_selectedHandle));
+        if (m_store.Remove(m_selectedHandle)) {
             m_selectedShape = nullptr;
+            m_selectedHandle = ShapeHandle();
+            RecordHistory();
         }
     }
 }
 
+std::shared_ptr<Shape> GraphicsEngine::EditShapeAt(size_t index) {
+    if (index >= m_store.Size()) return nullptr;
+
+    MarkChanged(index);
+    std::shared_ptr<Shape> shape = m_store.Shapes()[index];
+    if (m_uncommitted.count(shape.get())) {
+        return shape;
+    }
+    // ͼαʷеĿãһ滻ͼοУԭ󱣳ֲ
+    std::shared_ptr<Shape> copy = shape->Clone();
+    m_store.Replace(index, copy);
+    m_uncommitted.insert(copy.get());
+    if (m_selectedShape == shape) {
+        m_selectedShape = copy;
+    }
+    return copy;
+}
+
+std::shared_ptr<Shape> GraphicsEngine::EditSelectedShape() {
+    size_t index = m_store.IndexOf(m_selectedHandle);
+    if (index == ShapeStore::npos) return nullptr;
+    return EditShapeAt(index);
+}
+
+void GraphicsEngine::UpdateShapeAt(size_t index) {
+    if (index >= m_store.Size()) return;
+    MarkChanged(index);
+    m_store.Sync(index);
+    RecordHistory();
+}
+
+bool GraphicsEngine::SubmitFill(size_t index, D2D1_POINT_2F seed, FillJobQueue::Algorithm algorithm) {
+    if (index >= m_store.Size()) return false;
+    // ڼм㣬ѡͼδ任ʱдؼ
+    CommitSelectedTransform();
+
+    ShapeHandle handle = m_store.HandleAt(index);
+    m_fills.Cancel(handle);
+    // ֻ߳ʸԭͼμΰ汾ͬдʱݴжϽǷʱ
+    m_fills.Submit(m_store.Shapes()[index]->Clone(), handle, seed, algorithm);
+    return true;
+}
+
+size_t GraphicsEngine::ApplyCompletedFills() {
+    size_t applied = 0;
+    for (FillJobQueue::Result &result : m_fills.TakeResults()) {
+        size_t index = m_store.IndexOf(result.handle);
+        if (index == ShapeStore::npos) continue;
+        if (m_store.Shapes()[index]->GetGeometryVersion() != result.geometryVersion) continue;
+        if (result.pixels.empty()) continue;
+        // ͬͬд޸ĵͼϣ¼һʷ
+        EditShapeAt(index)->SetFillPixels(result.pixels);
+        UpdateShapeAt(index);
+        ++applied;
+    }
+    return applied;
+}
+
+void GraphicsEngine::RecordHistory() {
+    m_history.Commit(m_store.Shapes(), m_firstChanged);
+    // ǰͼȫ¿ã֮޸ĶҪȸ
+    m_uncommitted.clear();
+    m_firstChanged = SIZE_MAX;
+}
+
+bool GraphicsEngine::Undo() {
+    ClearSelection();
+    const DocumentSnapshot *snapshot = m_history.Undo();
+    if (!snapshot) return false;
+    RestoreSnapshot(*snapshot);
+    return true;
+}
+
+bool GraphicsEngine::Redo() {
+    ClearSelection();
+    const DocumentSnapshot *snapshot = m_history.Redo();
+    if (!snapshot) return false;
+    RestoreSnapshot(*snapshot);
+    return true;
+}
+
+void GraphicsEngine::RestoreSnapshot(const DocumentSnapshot &snapshot) {
+    // 󽻵ȹܳеͼοѲڻָĵ
+    clearIntersection();
+    InvalidateLayer();
+    m_uncommitted.clear();
+    m_firstChanged = SIZE_MAX;
+
+    std::vector<std::shared_ptr<Shape>> shapes;
+    snapshot.CopyTo(shapes);
+    const auto &current = m_store.Shapes();
+
+    // ȥβͬĲֻ֣мĶͼο⣬ͼεݲȡ
+    size_t prefix = 0;
+    size_t common = (std::min)(shapes.size(), current.size());
+    while (prefix < common && shapes[prefix] == current[prefix]) ++prefix;
+    size_t suffix = 0;
+    while (suffix < common - prefix &&
+           shapes[shapes.size() - 1 - suffix] == current[current.size() - 1 - suffix]) {
+        ++suffix;
+    }
+    size_t oldCount = current.size() - prefix - suffix;
+    size_t newCount = shapes.size() - prefix - suffix;
+
+    // мĲ롢ɾÿζҪƶݣʱֱ滻
+    const size_t MAX_INCREMENTAL = 64;
+    size_t shift = oldCount > newCount ? oldCount - newCount : newCount - oldCount;
+    if (shift > MAX_INCREMENTAL) {
+        m_store.Assign(std::move(shapes));
+        return;
+    }
+    size_t replaced = (std::min)(oldCount, newCount);
+    for (size_t i = 0; i < replaced; ++i) {
+        if (current[prefix + i] != shapes[prefix + i]) {
+            m_store.Replace(prefix + i, shapes[prefix + i]);
+        }
+    }
+    for (size_t i = replaced; i < oldCount; ++i) {
+        m_store.RemoveAt(prefix + replaced);
+    }
+    for (size_t i = replaced; i < newCount; ++i) {
+        m_store.Insert(prefix + i, shapes[prefix + i]);
+    }
+}
+
 std::shared_ptr<Shape> GraphicsEngine::SelectShape(D2D1_POINT_2F point) {
-    for (auto it = m_shapes.rbegin(); it != m_shapes.rend(); ++it) {
-        if ((*it)->HitTest(point)) {
-            if (m_selectedShape) {
-                m_selectedShape->SetSelected(false);
-            }
-            m_selectedShape = *it;
-            m_selectedShape->SetSelected(true);
+    // ѡǰύѡͼεı任γʾλһ
+    CommitSelectedTransform();
+
+    // ͼοİΧкͼγشɸݲ10أСڸͼεĵݲ
+    // ϵȡѡֻԺѡȷ
+    for (size_t index = m_store.NextPointCandidate(point, HIT_TEST_MARGIN, m_store.Size());
+         index != ShapeStore::npos;
+         index = m_store.NextPointCandidate(point, HIT_TEST_MARGIN, index)) {
+        const auto &shape = m_store.Shapes()[index];
+        if (shape->HitTest(point)) {
+            // ѡ״ֻ̬Удͼϣͼοеͼͬʱã߳̿ڶȡ
+            m_selectedShape = shape;
+            m_selectedHandle = m_store.HandleAt(index);
+            InvalidateLayer(); // ѡеͼƳ̬㣬ԭѡеͼηŻ
             return m_selectedShape;
         }
     }
@@ -252,33 +1059,92 @@ std::shared_ptr<Shape> GraphicsEngine::SelectShape(D2D1_POINT_2F point) {
 }
 
 void GraphicsEngine::ClearSelection() {
+    CommitSelectedTransform();
     if (m_selectedShape) {
-        m_selectedShape->SetSelected(false);
         m_selectedShape = nullptr;
+        m_selectedHandle = ShapeHandle();
+        m_frameSelected = nullptr;
+        InvalidateLayer();
+    }
+}
+
+void GraphicsEngine::UpdateSelectedShape() {
+    size_t index = m_store.IndexOf(m_selectedHandle);
+    if (index != ShapeStore::npos) {
+        if (m_store.Shapes()[index]->HasTransform()) {
+            // 任ͼۻ任ѱ¼գ϶;ͼΣдǰȷ
+            EditShapeAt(index)->BakeTransform();
+        }
+        m_store.Sync(index);
+        MarkChanged(index);
+        RecordHistory();
+    }
+}
+
+void GraphicsEngine::CommitSelectedTransform() {
+    if (m_selectedShape && m_selectedShape->HasTransform()) {
+        UpdateSelectedShape();
+    }
+}
+
+void GraphicsEngine::SetBoundsMode(BoundsMode mode) {
+    if (mode == Shape::GetBoundsMode()) return;
+    m_renderThread.WaitIdle();
+    Shape::SetBoundsMode(mode);
+    m_store.SyncAll();
+    InvalidateLayer();
+}
+
+void GraphicsEngine::ComposeSelectedTransform(const D2D1_MATRIX_3X2_F &transform) {
+    size_t index = m_store.IndexOf(m_selectedHandle);
+    if (index == ShapeStore::npos) return;
+
+    // һۻʱδ任ģ֮ÿֻ㣻ΰΧͼλ棬任İΧΪ O(1)
+    // 任ͼϣۻǰȷѡͼûбʷ
+    if (!m_selectedShape->HasTransform()) {
+        m_transformBaseCenter = m_selectedShape->GetCenter();
+    }
+    if (!m_uncommitted.count(m_selectedShape.get())) {
+        EditShapeAt(index);
+    }
+    m_selectedShape->ComposeTransform(transform);
+    m_store.SetBounds(index, m_selectedShape->GetBounds());
+}
+
+D2D1_POINT_2F GraphicsEngine::SelectedCenter() const {
+    if (!m_selectedShape->HasTransform()) {
+        return m_selectedShape->GetCenter();
     }
+    return TransformPoint(m_selectedShape->GetTransform(), m_transformBaseCenter);
 }
 
+// ±任ֻۻѡͼεı任Уÿ O(1) CommitSelectedTransform ʱд
 void GraphicsEngine::MoveSelectedShape(float dx, float dy) {
     if (m_selectedShape) {
-        m_selectedShape->Move(dx, dy);
+        ComposeSelectedTransform(D2D1::Matrix3x2F::Translation(dx, dy));
     }
 }
 
 void GraphicsEngine::RotateSelectedShape(float angle) {
     if (m_selectedShape) {
-        m_selectedShape->Rotate(angle);
+        RotateAroundPoint(angle, SelectedCenter());
     }
 }
 
 void GraphicsEngine::ScaleSelectedShape(float scale) {
     if (m_selectedShape) {
-        m_selectedShape->Scale(scale);
+        ComposeSelectedTransform(D2D1::Matrix3x2F::Scale(scale, scale, SelectedCenter()));
     }
 }
 
 void GraphicsEngine::RotateAroundPoint(float angle, D2D1_POINT_2F center) {
     if (m_selectedShape) {
-        m_selectedShape->RotateAroundPoint(angle, center);
+        //  Shape::RotateAroundPoint ͬת򣨻ȣ
+        float s = sinf(angle);
+        float c = cosf(angle);
+        ComposeSelectedTransform(D2D1::Matrix3x2F(c, s, -s, c,
+                                                  center.x - center.x * c + center.y * s,
+                                                  center.y - center.x * s - center.y * c));
     }
 }
 
@@ -297,13 +1163,13 @@ std::shared_ptr<Line> GraphicsEngine::CreatePerpendicularLine(std::shared_ptr<Li
     if (fabs(dx) < 0.001f) { // ֱ
         // ֱ -> ˮƽֱ
         float length = 50.0f; // ̶
-        return std::make_shared<Line>(
+        return MakeDocumentShared<Line>(
             D2D1::Point2F(point.x - length, point.y),
             D2D1::Point2F(point.x + length, point.y));
     } else if (fabs(dy) < 0.001f) { // ˮƽ
         // ˮƽ -> ֱֱ
         float length = 50.0f; // ̶
-        return std::make_shared<Line>(
+        return MakeDocumentShared<Line>(
             D2D1::Point2F(point.x, point.y - length),
             D2D1::Point2F(point.x, point.y + length));
     }
@@ -322,7 +1188,7 @@ std::shared_ptr<Line> GraphicsEngine::CreatePerpendicularLine(std::shared_ptr<Li
     p2.x = point.x + length / sqrtf(1 + perpendicularSlope * perpendicularSlope);
     p2.y = point.y + perpendicularSlope * (p2.x - point.x);
 
-    return std::make_shared<Line>(p1, p2);
+    return MakeDocumentShared<Line>(p1, p2);
 }
 
 std::vector<std::shared_ptr<Line>> GraphicsEngine::CreateTangents(D2D1_POINT_2F point, std::shared_ptr<Circle> circle) {
@@ -368,8 +1234,8 @@ std::vector<std::shared_ptr<Line>> GraphicsEngine::CreateTangents(D2D1_POINT_2F
     tangent2.y = center.y + a * uy - h * vy;
 
     // 
-    tangents.push_back(std::make_shared<Line>(point, tangent1));
-    tangents.push_back(std::make_shared<Line>(point, tangent2));
+    tangents.push_back(MakeDocumentShared<Line>(point, tangent1));
+    tangents.push_back(MakeDocumentShared<Line>(point, tangent2));
 
     return tangents;
 }
@@ -5,33 +5,90 @@
 #include <dwrite.h>
 #include <wincodec.h>
 #include <vector>
+#include <algorithm>
 #include <memory>
 #include <string>
+#include <unordered_set>
 #include "CommonType.h" // Ͷ
+#include "ShapeStore.h"
+#include "DocumentArena.h"
+#include "DocumentHistory.h"
+#include "DeviceResourceCache.h"
+#include "FillJobs.h"
+#include "Overlay.h"
+#include "RenderThread.h"
 
 // ǰ
 class Shape;
 class Line;
 class Circle;
 class Rect;
+class RenderBackend;
+struct RasterSurface;
+struct ClipWindow;
+
+// ̵߳һ̴֡߳ǰĵѡͼ͸㣬ύ޸ģֻ߳
+struct RenderFrame {
+    std::shared_ptr<const DocumentSnapshot> document; // ʷĵǰգͼ±ͼοһ
+    std::shared_ptr<const ShapeBoundsSnapshot> bounds; // ͼοΧк߿ĸ± document һ£޳ʱͼ
+    uint64_t sceneVersion;                // ̬ݣĵѡͼİ汾ʱþ̬
+    size_t selectedIndex;                 // ѡͼ document е±꣬ShapeStore::npos ʾûѡ
+    std::shared_ptr<Shape> selected;      // ѡͼεĸѱΪѡУı任ʹã selectedTransform Ϊ׼
+    D2D1_MATRIX_3X2_F selectedTransform;  // ѡͼεǰı任
+    D2D1_POINT_2F viewOffset;
+    float zoom;
+    UINT32 width, height;                 // ڿͻС
+    OverlayList overlay;
+};
 
 class GraphicsEngine {
 public:
+    typedef RenderThread<std::shared_ptr<const RenderFrame>> FrameThread;
+
     GraphicsEngine();
     ~GraphicsEngine();
 
+    // ߳D2DȾĿ꣬߳
     HRESULT Initialize(HWND hwnd);
+    // ´ڿͻСȾĿһ֡ڻ߳ϵ
     void Resize(UINT width, UINT height);
-    void Render();
+    // ֹ̣ͣ߳ڻƵ֡꣩ͷȫԴ
     void Cleanup();
 
-    // ͼ
-    void BeginDraw() {
-        if (m_pRenderTarget) m_pRenderTarget->BeginDraw();
+    // ύһ֡ѳʷĵǰգͼοͬͼΣѡͼΡͼ͸̣߳ء
+    // ߳δʼһ֡һ֡滻ϢܼҲֻһ֡ڵȴ
+    // ȾĿꡢˢ̬豸Դֻڻ߳ʹã̲߳D2D
+    void SubmitFrame(OverlayList overlay);
+    // ύƺͱ滻֡
+    FrameThread::Stats GetRenderStats() const {
+        return m_renderThread.GetStats();
+    }
+    // ȴύ֡꣨滻ҪȷѸµĳϣ֡ʱ䣩
+    void WaitForFrames() {
+        m_renderThread.WaitIdle();
     }
-    HRESULT EndDraw() {
-        return m_pRenderTarget ? m_pRenderTarget->EndDraw() : S_OK;
+
+    // ͨƺ˻ȫͼΣD2D豸
+    void RenderTo(RenderBackend &backend) const;
+    // դȾRGBA壬ͼ/threadCount > 1 ʱֿùȡ߳Ⱦ뵥߳λһ
+    void RenderToSurface(RasterSurface &surface, int threadCount = 1) const;
+
+    // ͼĵ zoom ƽ offset õꡣͼʼձĵУ
+    // λ ScreenToWorld ٽ༭δлͼ任
+    D2D1_MATRIX_3X2_F GetViewTransform() const;
+    float GetZoom() const {
+        return m_zoom;
     }
+    D2D1_POINT_2F ScreenToWorld(D2D1_POINT_2F point) const;
+    D2D1_POINT_2F WorldToScreen(D2D1_POINT_2F point) const;
+    // ƽͼأ
+    void PanView(float dx, float dy);
+    // Դϵ anchor Ϊͼű [MIN_ZOOM, MAX_ZOOM]
+    void ZoomView(float factor, D2D1_POINT_2F anchor);
+    // ŲƽƵǡʾȫͼΣûͼʱָĬͼ
+    void ZoomToFit();
+    // ָĬͼԭϽǣΪ1
+    void ResetView();
 
     // ͼԪ
     void AddShape(std::shared_ptr<Shape> shape);
@@ -41,14 +98,50 @@ public:
 
     // ȡͼ
     const std::vector<std::shared_ptr<Shape>> &GetShapes() const {
-        return m_shapes;
+        return m_store.Shapes();
+    }
+    // ͼο⣨ΧСγصݣ
+    const ShapeStore &GetShapeStore() const {
+        return m_store;
+    }
+
+    // ⲿ޸ѡͼεļλʽ߿ͣãͬͼοеݣδύı任һдأ¼һʷ
+    void UpdateSelectedShape();
+
+    // дʱƣȡÿԭ޸ĵͼΡͼαʷʱȸһ滻ͼοٷظ
+    // ⲿ޸ͼǰͨȡͼΣ޸ĺ UpdateSelectedShape / UpdateShapeAt
+    std::shared_ptr<Shape> EditSelectedShape();
+    std::shared_ptr<Shape> EditShapeAt(size_t index);
+    void UpdateShapeAt(size_t index);
+
+    // /ĵָһ/һ¼״̬ȡѡ
+    bool Undo();
+    bool Redo();
+    bool CanUndo() const {
+        return m_history.CanUndo();
+    }
+    bool CanRedo() const {
+        return m_history.CanRedo();
+    }
+    // ʷڴޣֽڣʱĲ
+    void SetHistoryByteLimit(size_t bytes) {
+        m_history.SetByteLimit(bytes);
+    }
+    const DocumentHistory &GetHistory() const {
+        return m_history;
     }
 
-    // 任
+    // 任ۻѡͼεı任Уд
     void MoveSelectedShape(float dx, float dy);
     void RotateSelectedShape(float angle);
     void ScaleSelectedShape(float scale);
     void RotateAroundPoint(float angle, D2D1_POINT_2F center);
+    // ѡͼεı任дؼΣһν任ʱãѡѡͲüǰԶύ
+    void CommitSelectedTransform();
+
+    // лBezierߵİΧģʽƵΧ/ΧУˢͼοеİΧ
+    // дͼεİΧл棬ȵȻ̻߳ύ֡
+    void SetBoundsMode(BoundsMode mode);
 
     // ƴ
     std::shared_ptr<Line> CreatePerpendicularLine(std::shared_ptr<Line> line, D2D1_POINT_2F point);
@@ -56,9 +149,6 @@ public:
     // 
     std::vector<std::shared_ptr<Line>> CreateTangents(D2D1_POINT_2F point, std::shared_ptr<Circle> circle);
 
-    ID2D1RenderTarget *GetRenderTarget() {
-        return m_pRenderTarget;
-    }
     void SetDrawingMode(DrawingMode mode) {
         m_currentMode = mode;
     }
@@ -76,8 +166,8 @@ public:
     }
 
     bool IsShapeSelected(int index) const {
-        if (index >= 0 && index < m_shapes.size()) {
-            return m_shapes[index] == m_selectedShape;
+        if (index >= 0 && index < static_cast<int>(m_store.Size())) {
+            return m_store.Shapes()[index] == m_selectedShape;
         }
         return false;
     }
@@ -91,12 +181,8 @@ public:
     int GetSelectedShapeIndex() const {
         if (!m_selectedShape) return -1;
 
-        for (int i = 0; i < m_shapes.size(); ++i) {
-            if (m_shapes[i] == m_selectedShape) {
-                return i;
-            }
-        }
-        return -1;
+        size_t index = m_store.IndexOf(m_selectedHandle);
+        return index == ShapeStore::npos ? -1 : static_cast<int>(index);
     }
 
     // 󽻹
@@ -110,14 +196,37 @@ public:
     std::shared_ptr<Shape> getFirstIntersectionShape() const;
     std::shared_ptr<Shape> getSecondIntersectionShape() const;
 
-    void ClearAllShapes() {
-        m_shapes.clear();
+    // ĵͼбգʼµĵĵڴͼȫͷź黹
+    // ʷþͼʱĵӦ豻
+    void ClearAllShapes();
+
+    // ñ༭滻ͼбڵǰĵĵ
+    void ReplaceShapes(std::vector<std::shared_ptr<Shape>> shapes);
+
+    // ̨䣺±괦ͼεĸ seed ΪӼ䣬أ̣߳
+    // ͬһͼδɵȡͬͼε̳߳вύǰύѡͼεı任
+    // ʱڹ߳ϵ SetFillNotify õĻص߳յ֪ͨ ApplyCompletedFills
+    bool SubmitFill(size_t index, D2D1_POINT_2F seed, FillJobQueue::Algorithm algorithm);
+    void SetFillNotify(FillJobQueue::NotifyFunction notify) {
+        m_fills.SetNotify(std::move(notify));
+    }
+    // ȡȫδɵ䣬ȡĸ
+    size_t CancelFills() {
+        return m_fills.CancelAll();
+    }
+    // ̣߳ɵдͼΣÿһʷͼɾ򼸺Ѹı䣨ʱĽ
+    // дصĸ
+    size_t ApplyCompletedFills();
+    // δɵ估
+    std::vector<FillJobQueue::Progress> GetFillProgress() const {
+        return m_fills.GetProgress();
     }
 
-    // ȡָ͵ıʻʽ
-    ID2D1StrokeStyle* GetStrokeStyle(LineStyle lineStyle);
+    // Liang-BarskyֱߡߺBezier߲üڲڣüͼ滻Ϊɳر޸ĵͼ
+    size_t ClipSegmentShapes(const ClipWindow *windows, size_t windowCount);
 
 private:
+    // 豸Դ Initialize дֻ֮ڻ߳ʹ
     HWND m_hwnd;
     ID2D1Factory *m_pD2DFactory;
     ID2D1HwndRenderTarget *m_pRenderTarget;
@@ -132,10 +241,90 @@ private:
     ID2D1StrokeStyle *m_pDotStrokeStyle;
     ID2D1StrokeStyle *m_pDashDotStrokeStyle;
     ID2D1StrokeStyle *m_pDashDotDotStrokeStyle;
+    ID2D1StrokeStyle *m_pHighlightStrokeStyle; // ͼΣѡеͼԪ
+
+    DeviceResourceCache m_resources; // ߳ϵĵǰ
+    D2D1_SIZE_U m_targetSize;        // ȾĿ굱ǰشС
+
+    FrameThread m_renderThread;
+
+    // ͼʹڴС̣߳
+    D2D1_POINT_2F m_viewOffset;
+    float m_zoom;
+    UINT32 m_clientWidth, m_clientHeight;
+
+    // ϸڲ֣ϹСͼȾĿͬA8ϻο
+    // ֡ĩֻѸĶķΧϴλͼһΣⲿ
+    std::vector<uint8_t> m_lodMask;
+    UINT32 m_lodWidth, m_lodHeight;
+    D2D1_RECT_U m_lodDirty; // ĶΧleft >= right ʱΪ
+    ID2D1Bitmap *m_pLodBitmap;
+
+    // ֡޳ҪƵͼ±̣֮꣨߳֡临
+    std::vector<uint32_t> m_drawIndices;
+
+    void SplatLod(const D2D1_RECT_F &screenBounds, bool dot);
+    void FlushLod(ID2D1RenderTarget *pTarget);
+
+    // ̬㣺ѡͼȫͼλƵȾĿļλͼĿл档
+    // ӰݵĲͼο޸ġѡ仯ͼ仯ڽ̵߳ InvalidateLayer µĳ汾
+    // ̷߳֡İ汾뾲̬㲻ͬʱػ
+    ID2D1BitmapRenderTarget *m_pLayerTarget;
+    uint64_t m_layerVersion; // ̬ĳ汾̣߳0 ʾû
+    uint64_t m_sceneVersion; // ǰ汾̣߳1ʼ
+
+    void InvalidateLayer() {
+        ++m_sceneVersion;
+    }
+    // ̬ʱ trueҪʱػ棩Ŀ괴ʧʱ falseֱ֡ӻ
+    bool UpdateLayer(const RenderFrame &frame);
+    void ReleaseLayer();
+    // ֡ͼ任 pTarget ϻѡͼȫɼͼΣvisible Ϊ꣩޳֡ͳ
+    void DrawShapes(ID2D1RenderTarget *pTarget, const RenderFrame &frame, const D2D1_RECT_F &visible);
+    //  pTarget ǰı任һͼΣselected ʱѡ
+    void DrawShape(ID2D1RenderTarget *pTarget, Shape &shape, bool selected);
 
-    std::vector<std::shared_ptr<Shape>> m_shapes;
+    // ̣߳һ֡֡BeginDraw 豸ʧؽȾĿꣻ
+    // EndDraw  D2DERR_RECREATE_TARGET ʱͷ豸Դػ
+    void DrawFrame(const RenderFrame &frame);
+    void BeginDraw();
+    HRESULT EndDraw();
+    // ͼΣͼλھ̬Уֻڳ汾仯򴰿ڴС仯ػ棬ֻ֡һλͼѡͼÿ֡ʵʱھ̬֮ϡ
+    // ػ澲̬ʱΧ봰ڲཻͼֱκλ׼޳֡ͳơ
+    // ϸڲΣС LOD_BOX_PIXELS ͼΰΧлɵο򣬺ϳһһλƣ
+    // ͼͼСýٵĶɢߣػƵͼθĻλͼ
+    // clip ǿʱ꣩ clip ڡƽʱ任ָΪλ
+    void Render(const RenderFrame &frame, const D2D1_RECT_F *clip = nullptr);
+    // ȡָ͵ıʻʽ
+    ID2D1StrokeStyle* GetStrokeStyle(LineStyle lineStyle);
+
+    std::shared_ptr<DocumentArena> m_arena; // ǰĵͼκ͵ڵĵ
+    ShapeStore m_store;
     std::shared_ptr<Shape> m_selectedShape;
+    ShapeHandle m_selectedHandle;
+    std::shared_ptr<Shape> m_frameSelected; // ̵߳ѡͼθκʽʱ֡
+    D2D1_POINT_2F m_transformBaseCenter; // ѡͼοʼۻ任ʱ
+
+    DocumentHistory m_history;
+    std::unordered_set<const Shape *> m_uncommitted; // ϴμ¼ʷ¸ƳͼΣκοãԭ޸
+    size_t m_firstChanged;                           // ϴμ¼ʷĶС±꣬¼ʱǰĿ鲻ٱȽ
+
+    void MarkChanged(size_t index) {
+        m_firstChanged = (std::min)(m_firstChanged, index);
+        InvalidateLayer();
+    }
+    void RecordHistory();
+    void RestoreSnapshot(const DocumentSnapshot &snapshot);
+
+    // ѡͼεֻͼοеѡͼοܱԭ޸ģδύı任ֱӽ߳
+    std::shared_ptr<Shape> SelectedFrameShape();
+
+    void ComposeSelectedTransform(const D2D1_MATRIX_3X2_F &transform);
+    D2D1_POINT_2F SelectedCenter() const;
     DrawingMode m_currentMode;
 
+    FillJobQueue m_fills;
+
     HRESULT CreateDeviceResources();
+    void DiscardDeviceResources();
 };
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "IntersectionManager.h"
+#include "Profiler.h"
 #include <cmath>
 #include <algorithm>
 
@@ -208,9 +209,41 @@ void CurveCurveRecursive(const D2D1_POINT_2F A[4], const D2D1_POINT_2F B[4],
     CurveCurveRecursive(AR, BR, tol, out);
 }
 
+// ͼεıߣ INLINE_EDGES ʱڶڣΡΡΡƽı󽻲ٷڴ
+class EdgeList {
+public:
+    typedef std::pair<D2D1_POINT_2F, D2D1_POINT_2F> Edge;
+
+    void push_back(const Edge &edge) {
+        if (m_count < INLINE_EDGES) {
+            m_inline[m_count] = edge;
+        } else {
+            if (m_count == INLINE_EDGES) m_overflow.assign(m_inline, m_inline + INLINE_EDGES);
+            m_overflow.push_back(edge);
+        }
+        ++m_count;
+    }
+    size_t size() const {
+        return m_count;
+    }
+    const Edge &operator[](size_t i) const {
+        return m_count <= INLINE_EDGES ? m_inline[i] : m_overflow[i];
+    }
+
+private:
+    static const size_t INLINE_EDGES = 8;
+    Edge m_inline[INLINE_EDGES];
+    std::vector<Edge> m_overflow;
+    size_t m_count = 0;
+};
+
 template <class T>
-std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> edges(const T &poly) {
-    return poly.GetIntersectionSegments();
+EdgeList edges(const T &poly) {
+    EdgeList list;
+    poly.ForEachIntersectionSegment([&](D2D1_POINT_2F a, D2D1_POINT_2F b) {
+        list.push_back({a, b});
+    });
+    return list;
 }
 
 } // namespace
@@ -244,6 +277,7 @@ bool IntersectionManager::hasTwoShapes() const {
 }
 
 std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersection() {
+    PROFILE_SCOPE("IntersectionManager::calculateIntersection");
     intersectionPoints = calculateIntersectionImpl();
     return intersectionPoints;
 }
@@ -285,7 +319,7 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     else if (a.GetType() == ShapeType::LINE && b.GetType() == ShapeType::RECTANGLE) {
         Line &l = static_cast<Line &>(a);
         Rect &r = static_cast<Rect &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> segs = edges(r);
+        EdgeList segs = edges(r);
         for (size_t i = 0; i < segs.size(); ++i) {
             std::vector<D2D1_POINT_2F> pts = lineLine(l.GetStart(), l.GetEnd(), segs[i].first, segs[i].second);
             intersectionPoints.insert(intersectionPoints.end(), pts.begin(), pts.end());
@@ -293,7 +327,7 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     } else if (a.GetType() == ShapeType::RECTANGLE && b.GetType() == ShapeType::LINE) {
         Rect &r = static_cast<Rect &>(a);
         Line &l = static_cast<Line &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> segs = edges(r);
+        EdgeList segs = edges(r);
         for (size_t i = 0; i < segs.size(); ++i) {
             std::vector<D2D1_POINT_2F> pts = lineLine(l.GetStart(), l.GetEnd(), segs[i].first, segs[i].second);
             intersectionPoints.insert(intersectionPoints.end(), pts.begin(), pts.end());
@@ -303,7 +337,7 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     else if (a.GetType() == ShapeType::CIRCLE && b.GetType() == ShapeType::RECTANGLE) {
         Circle &c = static_cast<Circle &>(a);
         Rect &r = static_cast<Rect &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> segs = edges(r);
+        EdgeList segs = edges(r);
         for (size_t i = 0; i < segs.size(); ++i) {
             std::vector<D2D1_POINT_2F> pts = lineCircle(segs[i].first, segs[i].second, c.GetCenter(), c.GetRadius());
             intersectionPoints.insert(intersectionPoints.end(), pts.begin(), pts.end());
@@ -311,7 +345,7 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     } else if (a.GetType() == ShapeType::RECTANGLE && b.GetType() == ShapeType::CIRCLE) {
         Rect &r = static_cast<Rect &>(a);
         Circle &c = static_cast<Circle &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> segs = edges(r);
+        EdgeList segs = edges(r);
         for (size_t i = 0; i < segs.size(); ++i) {
             std::vector<D2D1_POINT_2F> pts = lineCircle(segs[i].first, segs[i].second, c.GetCenter(), c.GetRadius());
             intersectionPoints.insert(intersectionPoints.end(), pts.begin(), pts.end());
@@ -321,8 +355,8 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     else if (a.GetType() == ShapeType::RECTANGLE && b.GetType() == ShapeType::RECTANGLE) {
         Rect &r1 = static_cast<Rect &>(a);
         Rect &r2 = static_cast<Rect &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s1 = edges(r1);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s2 = edges(r2);
+        EdgeList s1 = edges(r1);
+        EdgeList s2 = edges(r2);
         for (size_t i = 0; i < s1.size(); ++i)
             for (size_t j = 0; j < s2.size(); ++j) {
                 std::vector<D2D1_POINT_2F> pts = lineLine(s1[i].first, s1[i].second, s2[j].first, s2[j].second);
@@ -333,7 +367,7 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     else if (a.GetType() == ShapeType::TRIANGLE && b.GetType() == ShapeType::LINE) {
         Triangle &t = static_cast<Triangle &>(a);
         Line &l = static_cast<Line &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s = edges(t);
+        EdgeList s = edges(t);
         for (size_t i = 0; i < s.size(); ++i) {
             std::vector<D2D1_POINT_2F> pts = lineLine(s[i].first, s[i].second, l.GetStart(), l.GetEnd());
             intersectionPoints.insert(intersectionPoints.end(), pts.begin(), pts.end());
@@ -341,7 +375,7 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     } else if (a.GetType() == ShapeType::LINE && b.GetType() == ShapeType::TRIANGLE) {
         Line &l = static_cast<Line &>(a);
         Triangle &t = static_cast<Triangle &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s = edges(t);
+        EdgeList s = edges(t);
         for (size_t i = 0; i < s.size(); ++i) {
             std::vector<D2D1_POINT_2F> pts = lineLine(l.GetStart(), l.GetEnd(), s[i].first, s[i].second);
             intersectionPoints.insert(intersectionPoints.end(), pts.begin(), pts.end());
@@ -351,7 +385,7 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     else if (a.GetType() == ShapeType::CIRCLE && b.GetType() == ShapeType::TRIANGLE) {
         Circle &c = static_cast<Circle &>(a);
         Triangle &t = static_cast<Triangle &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s = edges(t);
+        EdgeList s = edges(t);
         for (size_t i = 0; i < s.size(); ++i) {
             std::vector<D2D1_POINT_2F> pts = lineCircle(s[i].first, s[i].second, c.GetCenter(), c.GetRadius());
             intersectionPoints.insert(intersectionPoints.end(), pts.begin(), pts.end());
@@ -359,7 +393,7 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     } else if (a.GetType() == ShapeType::TRIANGLE && b.GetType() == ShapeType::CIRCLE) {
         Triangle &t = static_cast<Triangle &>(a);
         Circle &c = static_cast<Circle &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s = edges(t);
+        EdgeList s = edges(t);
         for (size_t i = 0; i < s.size(); ++i) {
             std::vector<D2D1_POINT_2F> pts = lineCircle(s[i].first, s[i].second, c.GetCenter(), c.GetRadius());
             intersectionPoints.insert(intersectionPoints.end(), pts.begin(), pts.end());
@@ -369,8 +403,8 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     else if (a.GetType() == ShapeType::TRIANGLE && b.GetType() == ShapeType::TRIANGLE) {
         Triangle &t1 = static_cast<Triangle &>(a);
         Triangle &t2 = static_cast<Triangle &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s1 = edges(t1);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s2 = edges(t2);
+        EdgeList s1 = edges(t1);
+        EdgeList s2 = edges(t2);
         for (size_t i = 0; i < s1.size(); ++i)
             for (size_t j = 0; j < s2.size(); ++j) {
                 std::vector<D2D1_POINT_2F> pts = lineLine(s1[i].first, s1[i].second, s2[j].first, s2[j].second);
@@ -381,7 +415,7 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     else if (a.GetType() == ShapeType::DIAMOND && b.GetType() == ShapeType::LINE) {
         Diamond &d = static_cast<Diamond &>(a);
         Line &l = static_cast<Line &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s = edges(d);
+        EdgeList s = edges(d);
         for (size_t i = 0; i < s.size(); ++i) {
             std::vector<D2D1_POINT_2F> pts = lineLine(s[i].first, s[i].second, l.GetStart(), l.GetEnd());
             intersectionPoints.insert(intersectionPoints.end(), pts.begin(), pts.end());
@@ -389,7 +423,7 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     } else if (a.GetType() == ShapeType::LINE && b.GetType() == ShapeType::DIAMOND) {
         Line &l = static_cast<Line &>(a);
         Diamond &d = static_cast<Diamond &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s = edges(d);
+        EdgeList s = edges(d);
         for (size_t i = 0; i < s.size(); ++i) {
             std::vector<D2D1_POINT_2F> pts = lineLine(l.GetStart(), l.GetEnd(), s[i].first, s[i].second);
             intersectionPoints.insert(intersectionPoints.end(), pts.begin(), pts.end());
@@ -399,7 +433,7 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     else if (a.GetType() == ShapeType::DIAMOND && b.GetType() == ShapeType::CIRCLE) {
         Diamond &d = static_cast<Diamond &>(a);
         Circle &c = static_cast<Circle &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s = edges(d);
+        EdgeList s = edges(d);
         for (size_t i = 0; i < s.size(); ++i) {
             std::vector<D2D1_POINT_2F> pts = lineCircle(s[i].first, s[i].second, c.GetCenter(), c.GetRadius());
             intersectionPoints.insert(intersectionPoints.end(), pts.begin(), pts.end());
@@ -407,7 +441,7 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     } else if (a.GetType() == ShapeType::CIRCLE && b.GetType() == ShapeType::DIAMOND) {
         Circle &c = static_cast<Circle &>(a);
         Diamond &d = static_cast<Diamond &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s = edges(d);
+        EdgeList s = edges(d);
         for (size_t i = 0; i < s.size(); ++i) {
             std::vector<D2D1_POINT_2F> pts = lineCircle(s[i].first, s[i].second, c.GetCenter(), c.GetRadius());
             intersectionPoints.insert(intersectionPoints.end(), pts.begin(), pts.end());
@@ -417,8 +451,8 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     else if (a.GetType() == ShapeType::DIAMOND && b.GetType() == ShapeType::RECTANGLE) {
         Diamond &d = static_cast<Diamond &>(a);
         Rect &r = static_cast<Rect &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s1 = edges(d);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s2 = edges(r);
+        EdgeList s1 = edges(d);
+        EdgeList s2 = edges(r);
         for (size_t i = 0; i < s1.size(); ++i)
             for (size_t j = 0; j < s2.size(); ++j) {
                 std::vector<D2D1_POINT_2F> pts = lineLine(s1[i].first, s1[i].second, s2[j].first, s2[j].second);
@@ -427,8 +461,8 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     } else if (a.GetType() == ShapeType::RECTANGLE && b.GetType() == ShapeType::DIAMOND) {
         Rect &r = static_cast<Rect &>(a);
         Diamond &d = static_cast<Diamond &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s1 = edges(r);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s2 = edges(d);
+        EdgeList s1 = edges(r);
+        EdgeList s2 = edges(d);
         for (size_t i = 0; i < s1.size(); ++i)
             for (size_t j = 0; j < s2.size(); ++j) {
                 std::vector<D2D1_POINT_2F> pts = lineLine(s1[i].first, s1[i].second, s2[j].first, s2[j].second);
@@ -439,8 +473,8 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     else if (a.GetType() == ShapeType::DIAMOND && b.GetType() == ShapeType::TRIANGLE) {
         Diamond &d = static_cast<Diamond &>(a);
         Triangle &t = static_cast<Triangle &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s1 = edges(d);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s2 = edges(t);
+        EdgeList s1 = edges(d);
+        EdgeList s2 = edges(t);
         for (size_t i = 0; i < s1.size(); ++i)
             for (size_t j = 0; j < s2.size(); ++j) {
                 std::vector<D2D1_POINT_2F> pts = lineLine(s1[i].first, s1[i].second, s2[j].first, s2[j].second);
@@ -449,8 +483,8 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     } else if (a.GetType() == ShapeType::TRIANGLE && b.GetType() == ShapeType::DIAMOND) {
         Triangle &t = static_cast<Triangle &>(a);
         Diamond &d = static_cast<Diamond &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s1 = edges(t);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s2 = edges(d);
+        EdgeList s1 = edges(t);
+        EdgeList s2 = edges(d);
         for (size_t i = 0; i < s1.size(); ++i)
             for (size_t j = 0; j < s2.size(); ++j) {
                 std::vector<D2D1_POINT_2F> pts = lineLine(s1[i].first, s1[i].second, s2[j].first, s2[j].second);
@@ -461,8 +495,8 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     else if (a.GetType() == ShapeType::DIAMOND && b.GetType() == ShapeType::DIAMOND) {
         Diamond &d1 = static_cast<Diamond &>(a);
         Diamond &d2 = static_cast<Diamond &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s1 = edges(d1);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s2 = edges(d2);
+        EdgeList s1 = edges(d1);
+        EdgeList s2 = edges(d2);
         for (size_t i = 0; i < s1.size(); ++i)
             for (size_t j = 0; j < s2.size(); ++j) {
                 std::vector<D2D1_POINT_2F> pts = lineLine(s1[i].first, s1[i].second, s2[j].first, s2[j].second);
@@ -473,7 +507,7 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     else if (a.GetType() == ShapeType::PARALLELOGRAM && b.GetType() == ShapeType::LINE) {
         Parallelogram &p = static_cast<Parallelogram &>(a);
         Line &l = static_cast<Line &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s = edges(p);
+        EdgeList s = edges(p);
         for (size_t i = 0; i < s.size(); ++i) {
             std::vector<D2D1_POINT_2F> pts = lineLine(s[i].first, s[i].second, l.GetStart(), l.GetEnd());
             intersectionPoints.insert(intersectionPoints.end(), pts.begin(), pts.end());
@@ -481,7 +515,7 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     } else if (a.GetType() == ShapeType::LINE && b.GetType() == ShapeType::PARALLELOGRAM) {
         Line &l = static_cast<Line &>(a);
         Parallelogram &p = static_cast<Parallelogram &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s = edges(p);
+        EdgeList s = edges(p);
         for (size_t i = 0; i < s.size(); ++i) {
             std::vector<D2D1_POINT_2F> pts = lineLine(l.GetStart(), l.GetEnd(), s[i].first, s[i].second);
             intersectionPoints.insert(intersectionPoints.end(), pts.begin(), pts.end());
@@ -491,7 +525,7 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     else if (a.GetType() == ShapeType::PARALLELOGRAM && b.GetType() == ShapeType::CIRCLE) {
         Parallelogram &p = static_cast<Parallelogram &>(a);
         Circle &c = static_cast<Circle &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s = edges(p);
+        EdgeList s = edges(p);
         for (size_t i = 0; i < s.size(); ++i) {
             std::vector<D2D1_POINT_2F> pts = lineCircle(s[i].first, s[i].second, c.GetCenter(), c.GetRadius());
             intersectionPoints.insert(intersectionPoints.end(), pts.begin(), pts.end());
@@ -499,7 +533,7 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     } else if (a.GetType() == ShapeType::CIRCLE && b.GetType() == ShapeType::PARALLELOGRAM) {
         Circle &c = static_cast<Circle &>(a);
         Parallelogram &p = static_cast<Parallelogram &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s = edges(p);
+        EdgeList s = edges(p);
         for (size_t i = 0; i < s.size(); ++i) {
             std::vector<D2D1_POINT_2F> pts = lineCircle(s[i].first, s[i].second, c.GetCenter(), c.GetRadius());
             intersectionPoints.insert(intersectionPoints.end(), pts.begin(), pts.end());
@@ -509,8 +543,8 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     else if (a.GetType() == ShapeType::PARALLELOGRAM && b.GetType() == ShapeType::RECTANGLE) {
         Parallelogram &p = static_cast<Parallelogram &>(a);
         Rect &r = static_cast<Rect &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s1 = edges(p);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s2 = edges(r);
+        EdgeList s1 = edges(p);
+        EdgeList s2 = edges(r);
         for (size_t i = 0; i < s1.size(); ++i)
             for (size_t j = 0; j < s2.size(); ++j) {
                 std::vector<D2D1_POINT_2F> pts = lineLine(s1[i].first, s1[i].second, s2[j].first, s2[j].second);
@@ -519,8 +553,8 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     } else if (a.GetType() == ShapeType::RECTANGLE && b.GetType() == ShapeType::PARALLELOGRAM) {
         Rect &r = static_cast<Rect &>(a);
         Parallelogram &p = static_cast<Parallelogram &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s1 = edges(r);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s2 = edges(p);
+        EdgeList s1 = edges(r);
+        EdgeList s2 = edges(p);
         for (size_t i = 0; i < s1.size(); ++i)
             for (size_t j = 0; j < s2.size(); ++j) {
                 std::vector<D2D1_POINT_2F> pts = lineLine(s1[i].first, s1[i].second, s2[j].first, s2[j].second);
@@ -531,8 +565,8 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     else if (a.GetType() == ShapeType::PARALLELOGRAM && b.GetType() == ShapeType::TRIANGLE) {
         Parallelogram &p = static_cast<Parallelogram &>(a);
         Triangle &t = static_cast<Triangle &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s1 = edges(p);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s2 = edges(t);
+        EdgeList s1 = edges(p);
+        EdgeList s2 = edges(t);
         for (size_t i = 0; i < s1.size(); ++i)
             for (size_t j = 0; j < s2.size(); ++j) {
                 std::vector<D2D1_POINT_2F> pts = lineLine(s1[i].first, s1[i].second, s2[j].first, s2[j].second);
@@ -541,8 +575,8 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     } else if (a.GetType() == ShapeType::TRIANGLE && b.GetType() == ShapeType::PARALLELOGRAM) {
         Triangle &t = static_cast<Triangle &>(a);
         Parallelogram &p = static_cast<Parallelogram &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s1 = edges(t);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s2 = edges(p);
+        EdgeList s1 = edges(t);
+        EdgeList s2 = edges(p);
         for (size_t i = 0; i < s1.size(); ++i)
             for (size_t j = 0; j < s2.size(); ++j) {
                 std::vector<D2D1_POINT_2F> pts = lineLine(s1[i].first, s1[i].second, s2[j].first, s2[j].second);
@@ -553,8 +587,8 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     else if (a.GetType() == ShapeType::PARALLELOGRAM && b.GetType() == ShapeType::DIAMOND) {
         Parallelogram &p = static_cast<Parallelogram &>(a);
         Diamond &d = static_cast<Diamond &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s1 = edges(p);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s2 = edges(d);
+        EdgeList s1 = edges(p);
+        EdgeList s2 = edges(d);
         for (size_t i = 0; i < s1.size(); ++i)
             for (size_t j = 0; j < s2.size(); ++j) {
                 std::vector<D2D1_POINT_2F> pts = lineLine(s1[i].first, s1[i].second, s2[j].first, s2[j].second);
@@ -563,8 +597,8 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     } else if (a.GetType() == ShapeType::DIAMOND && b.GetType() == ShapeType::PARALLELOGRAM) {
         Diamond &d = static_cast<Diamond &>(a);
         Parallelogram &p = static_cast<Parallelogram &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s1 = edges(d);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s2 = edges(p);
+        EdgeList s1 = edges(d);
+        EdgeList s2 = edges(p);
         for (size_t i = 0; i < s1.size(); ++i)
             for (size_t j = 0; j < s2.size(); ++j) {
                 std::vector<D2D1_POINT_2F> pts = lineLine(s1[i].first, s1[i].second, s2[j].first, s2[j].second);
@@ -575,8 +609,8 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     else if (a.GetType() == ShapeType::PARALLELOGRAM && b.GetType() == ShapeType::PARALLELOGRAM) {
         Parallelogram &p1 = static_cast<Parallelogram &>(a);
         Parallelogram &p2 = static_cast<Parallelogram &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s1 = edges(p1);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s2 = edges(p2);
+        EdgeList s1 = edges(p1);
+        EdgeList s2 = edges(p2);
         for (size_t i = 0; i < s1.size(); ++i)
             for (size_t j = 0; j < s2.size(); ++j) {
                 std::vector<D2D1_POINT_2F> pts = lineLine(s1[i].first, s1[i].second, s2[j].first, s2[j].second);
@@ -587,7 +621,7 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     else if (a.GetType() == ShapeType::POLYLINE && b.GetType() == ShapeType::LINE) {
         Poly &p = static_cast<Poly &>(a);
         Line &l = static_cast<Line &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s = edges(p);
+        EdgeList s = edges(p);
         for (size_t i = 0; i < s.size(); ++i) {
             std::vector<D2D1_POINT_2F> pts = lineLine(s[i].first, s[i].second, l.GetStart(), l.GetEnd());
             intersectionPoints.insert(intersectionPoints.end(), pts.begin(), pts.end());
@@ -595,7 +629,7 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     } else if (a.GetType() == ShapeType::LINE && b.GetType() == ShapeType::POLYLINE) {
         Line &l = static_cast<Line &>(a);
         Poly &p = static_cast<Poly &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s = edges(p);
+        EdgeList s = edges(p);
         for (size_t i = 0; i < s.size(); ++i) {
             std::vector<D2D1_POINT_2F> pts = lineLine(l.GetStart(), l.GetEnd(), s[i].first, s[i].second);
             intersectionPoints.insert(intersectionPoints.end(), pts.begin(), pts.end());
@@ -605,7 +639,7 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     else if (a.GetType() == ShapeType::POLYLINE && b.GetType() == ShapeType::CIRCLE) {
         Poly &p = static_cast<Poly &>(a);
         Circle &c = static_cast<Circle &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s = edges(p);
+        EdgeList s = edges(p);
         for (size_t i = 0; i < s.size(); ++i) {
             std::vector<D2D1_POINT_2F> pts = lineCircle(s[i].first, s[i].second, c.GetCenter(), c.GetRadius());
             intersectionPoints.insert(intersectionPoints.end(), pts.begin(), pts.end());
@@ -613,7 +647,7 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     } else if (a.GetType() == ShapeType::CIRCLE && b.GetType() == ShapeType::POLYLINE) {
         Circle &c = static_cast<Circle &>(a);
         Poly &p = static_cast<Poly &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s = edges(p);
+        EdgeList s = edges(p);
         for (size_t i = 0; i < s.size(); ++i) {
             std::vector<D2D1_POINT_2F> pts = lineCircle(s[i].first, s[i].second, c.GetCenter(), c.GetRadius());
             intersectionPoints.insert(intersectionPoints.end(), pts.begin(), pts.end());
@@ -623,8 +657,8 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     else if (a.GetType() == ShapeType::POLYLINE && b.GetType() == ShapeType::RECTANGLE) {
         Poly &p = static_cast<Poly &>(a);
         Rect &r = static_cast<Rect &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s1 = edges(p);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s2 = edges(r);
+        EdgeList s1 = edges(p);
+        EdgeList s2 = edges(r);
         for (size_t i = 0; i < s1.size(); ++i)
             for (size_t j = 0; j < s2.size(); ++j) {
                 std::vector<D2D1_POINT_2F> pts = lineLine(s1[i].first, s1[i].second, s2[j].first, s2[j].second);
@@ -633,8 +667,8 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     } else if (a.GetType() == ShapeType::RECTANGLE && b.GetType() == ShapeType::POLYLINE) {
         Rect &r = static_cast<Rect &>(a);
         Poly &p = static_cast<Poly &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s1 = edges(r);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s2 = edges(p);
+        EdgeList s1 = edges(r);
+        EdgeList s2 = edges(p);
         for (size_t i = 0; i < s1.size(); ++i)
             for (size_t j = 0; j < s2.size(); ++j) {
                 std::vector<D2D1_POINT_2F> pts = lineLine(s1[i].first, s1[i].second, s2[j].first, s2[j].second);
@@ -645,8 +679,8 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     else if (a.GetType() == ShapeType::POLYLINE && b.GetType() == ShapeType::TRIANGLE) {
         Poly &p = static_cast<Poly &>(a);
         Triangle &t = static_cast<Triangle &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s1 = edges(p);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s2 = edges(t);
+        EdgeList s1 = edges(p);
+        EdgeList s2 = edges(t);
         for (size_t i = 0; i < s1.size(); ++i)
             for (size_t j = 0; j < s2.size(); ++j) {
                 std::vector<D2D1_POINT_2F> pts = lineLine(s1[i].first, s1[i].second, s2[j].first, s2[j].second);
@@ -655,8 +689,8 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     } else if (a.GetType() == ShapeType::TRIANGLE && b.GetType() == ShapeType::POLYLINE) {
         Triangle &t = static_cast<Triangle &>(a);
         Poly &p = static_cast<Poly &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s1 = edges(t);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s2 = edges(p);
+        EdgeList s1 = edges(t);
+        EdgeList s2 = edges(p);
         for (size_t i = 0; i < s1.size(); ++i)
             for (size_t j = 0; j < s2.size(); ++j) {
                 std::vector<D2D1_POINT_2F> pts = lineLine(s1[i].first, s1[i].second, s2[j].first, s2[j].second);
@@ -667,8 +701,8 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     else if (a.GetType() == ShapeType::POLYLINE && b.GetType() == ShapeType::DIAMOND) {
         Poly &p = static_cast<Poly &>(a);
         Diamond &d = static_cast<Diamond &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s1 = edges(p);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s2 = edges(d);
+        EdgeList s1 = edges(p);
+        EdgeList s2 = edges(d);
         for (size_t i = 0; i < s1.size(); ++i)
             for (size_t j = 0; j < s2.size(); ++j) {
                 std::vector<D2D1_POINT_2F> pts = lineLine(s1[i].first, s1[i].second, s2[j].first, s2[j].second);
@@ -677,8 +711,8 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     } else if (a.GetType() == ShapeType::DIAMOND && b.GetType() == ShapeType::POLYLINE) {
         Diamond &d = static_cast<Diamond &>(a);
         Poly &p = static_cast<Poly &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s1 = edges(d);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s2 = edges(p);
+        EdgeList s1 = edges(d);
+        EdgeList s2 = edges(p);
         for (size_t i = 0; i < s1.size(); ++i)
             for (size_t j = 0; j < s2.size(); ++j) {
                 std::vector<D2D1_POINT_2F> pts = lineLine(s1[i].first, s1[i].second, s2[j].first, s2[j].second);
@@ -689,8 +723,8 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     else if (a.GetType() == ShapeType::POLYLINE && b.GetType() == ShapeType::PARALLELOGRAM) {
         Poly &p = static_cast<Poly &>(a);
         Parallelogram &pg = static_cast<Parallelogram &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s1 = edges(p);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s2 = edges(pg);
+        EdgeList s1 = edges(p);
+        EdgeList s2 = edges(pg);
         for (size_t i = 0; i < s1.size(); ++i)
             for (size_t j = 0; j < s2.size(); ++j) {
                 std::vector<D2D1_POINT_2F> pts = lineLine(s1[i].first, s1[i].second, s2[j].first, s2[j].second);
@@ -699,8 +733,8 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     } else if (a.GetType() == ShapeType::PARALLELOGRAM && b.GetType() == ShapeType::POLYLINE) {
         Parallelogram &pg = static_cast<Parallelogram &>(a);
         Poly &p = static_cast<Poly &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s1 = edges(pg);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s2 = edges(p);
+        EdgeList s1 = edges(pg);
+        EdgeList s2 = edges(p);
         for (size_t i = 0; i < s1.size(); ++i)
             for (size_t j = 0; j < s2.size(); ++j) {
                 std::vector<D2D1_POINT_2F> pts = lineLine(s1[i].first, s1[i].second, s2[j].first, s2[j].second);
@@ -711,8 +745,8 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     else if (a.GetType() == ShapeType::POLYLINE && b.GetType() == ShapeType::POLYLINE) {
         Poly &p1 = static_cast<Poly &>(a);
         Poly &p2 = static_cast<Poly &>(b);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s1 = edges(p1);
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> s2 = edges(p2);
+        EdgeList s1 = edges(p1);
+        EdgeList s2 = edges(p2);
         for (size_t i = 0; i < s1.size(); ++i)
             for (size_t j = 0; j < s2.size(); ++j) {
                 std::vector<D2D1_POINT_2F> pts = lineLine(s1[i].first, s1[i].second, s2[j].first, s2[j].second);
@@ -724,31 +758,31 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     else if (a.GetType() == ShapeType::CURVE && b.GetType() == ShapeType::LINE) {
         Curve &cv = static_cast<Curve &>(a);
         Line &l = static_cast<Line &>(b);
-        auto pts = cv.GetPoints(); //  4 Ƶ
+        std::vector<D2D1_POINT_2F> pts(cv.GetPoints().begin(), cv.GetPoints().end()); //  4 Ƶ
         intersectionPoints = curveLine(pts, l.GetStart(), l.GetEnd());
     } else if (a.GetType() == ShapeType::LINE && b.GetType() == ShapeType::CURVE) {
         Line &l = static_cast<Line &>(a);
         Curve &cv = static_cast<Curve &>(b);
-        auto pts = cv.GetPoints();
+        std::vector<D2D1_POINT_2F> pts(cv.GetPoints().begin(), cv.GetPoints().end());
         intersectionPoints = curveLine(pts, l.GetStart(), l.GetEnd());
     }
     //  vs Բ
     else if (a.GetType() == ShapeType::CURVE && b.GetType() == ShapeType::CIRCLE) {
         Curve &cv = static_cast<Curve &>(a);
         Circle &c = static_cast<Circle &>(b);
-        auto pts = cv.GetPoints();
+        std::vector<D2D1_POINT_2F> pts(cv.GetPoints().begin(), cv.GetPoints().end());
         intersectionPoints = curveCircle(pts, c.GetCenter(), c.GetRadius());
     } else if (a.GetType() == ShapeType::CIRCLE && b.GetType() == ShapeType::CURVE) {
         Circle &c = static_cast<Circle &>(a);
         Curve &cv = static_cast<Curve &>(b);
-        auto pts = cv.GetPoints();
+        std::vector<D2D1_POINT_2F> pts(cv.GetPoints().begin(), cv.GetPoints().end());
         intersectionPoints = curveCircle(pts, c.GetCenter(), c.GetRadius());
     }
     //  vs 
     else if (a.GetType() == ShapeType::CURVE && b.GetType() == ShapeType::RECTANGLE) {
         Curve &cv = static_cast<Curve &>(a);
         Rect &r = static_cast<Rect &>(b);
-        auto pts = cv.GetPoints();
+        std::vector<D2D1_POINT_2F> pts(cv.GetPoints().begin(), cv.GetPoints().end());
         auto segs = edges(r);
         for (size_t i = 0; i < segs.size(); ++i) {
             auto tmp = curveLine(pts, segs[i].first, segs[i].second);
@@ -757,7 +791,7 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     } else if (a.GetType() == ShapeType::RECTANGLE && b.GetType() == ShapeType::CURVE) {
         Rect &r = static_cast<Rect &>(a);
         Curve &cv = static_cast<Curve &>(b);
-        auto pts = cv.GetPoints();
+        std::vector<D2D1_POINT_2F> pts(cv.GetPoints().begin(), cv.GetPoints().end());
         auto segs = edges(r);
         for (size_t i = 0; i < segs.size(); ++i) {
             auto tmp = curveLine(pts, segs[i].first, segs[i].second);
@@ -768,7 +802,7 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     else if (a.GetType() == ShapeType::CURVE && b.GetType() == ShapeType::TRIANGLE) {
         Curve &cv = static_cast<Curve &>(a);
         Triangle &t = static_cast<Triangle &>(b);
-        auto pts = cv.GetPoints();
+        std::vector<D2D1_POINT_2F> pts(cv.GetPoints().begin(), cv.GetPoints().end());
         auto segs = edges(t);
         for (size_t i = 0; i < segs.size(); ++i) {
             auto tmp = curveLine(pts, segs[i].first, segs[i].second);
@@ -777,7 +811,7 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     } else if (a.GetType() == ShapeType::TRIANGLE && b.GetType() == ShapeType::CURVE) {
         Triangle &t = static_cast<Triangle &>(a);
         Curve &cv = static_cast<Curve &>(b);
-        auto pts = cv.GetPoints();
+        std::vector<D2D1_POINT_2F> pts(cv.GetPoints().begin(), cv.GetPoints().end());
         auto segs = edges(t);
         for (size_t i = 0; i < segs.size(); ++i) {
             auto tmp = curveLine(pts, segs[i].first, segs[i].second);
@@ -788,7 +822,7 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     else if (a.GetType() == ShapeType::CURVE && b.GetType() == ShapeType::DIAMOND) {
         Curve &cv = static_cast<Curve &>(a);
         Diamond &d = static_cast<Diamond &>(b);
-        auto pts = cv.GetPoints();
+        std::vector<D2D1_POINT_2F> pts(cv.GetPoints().begin(), cv.GetPoints().end());
         auto segs = edges(d);
         for (size_t i = 0; i < segs.size(); ++i) {
             auto tmp = curveLine(pts, segs[i].first, segs[i].second);
@@ -797,7 +831,7 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     } else if (a.GetType() == ShapeType::DIAMOND && b.GetType() == ShapeType::CURVE) {
         Diamond &d = static_cast<Diamond &>(a);
         Curve &cv = static_cast<Curve &>(b);
-        auto pts = cv.GetPoints();
+        std::vector<D2D1_POINT_2F> pts(cv.GetPoints().begin(), cv.GetPoints().end());
         auto segs = edges(d);
         for (size_t i = 0; i < segs.size(); ++i) {
             auto tmp = curveLine(pts, segs[i].first, segs[i].second);
@@ -808,7 +842,7 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     else if (a.GetType() == ShapeType::CURVE && b.GetType() == ShapeType::PARALLELOGRAM) {
         Curve &cv = static_cast<Curve &>(a);
         Parallelogram &p = static_cast<Parallelogram &>(b);
-        auto pts = cv.GetPoints();
+        std::vector<D2D1_POINT_2F> pts(cv.GetPoints().begin(), cv.GetPoints().end());
         auto segs = edges(p);
         for (size_t i = 0; i < segs.size(); ++i) {
             auto tmp = curveLine(pts, segs[i].first, segs[i].second);
@@ -817,7 +851,7 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     } else if (a.GetType() == ShapeType::PARALLELOGRAM && b.GetType() == ShapeType::CURVE) {
         Parallelogram &p = static_cast<Parallelogram &>(a);
         Curve &cv = static_cast<Curve &>(b);
-        auto pts = cv.GetPoints();
+        std::vector<D2D1_POINT_2F> pts(cv.GetPoints().begin(), cv.GetPoints().end());
         auto segs = edges(p);
         for (size_t i = 0; i < segs.size(); ++i) {
             auto tmp = curveLine(pts, segs[i].first, segs[i].second);
@@ -828,7 +862,7 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     else if (a.GetType() == ShapeType::CURVE && b.GetType() == ShapeType::POLYLINE) {
         Curve &cv = static_cast<Curve &>(a);
         Poly &p = static_cast<Poly &>(b);
-        auto pts = cv.GetPoints();
+        std::vector<D2D1_POINT_2F> pts(cv.GetPoints().begin(), cv.GetPoints().end());
         auto segs = edges(p);
         for (size_t i = 0; i < segs.size(); ++i) {
             auto tmp = curveLine(pts, segs[i].first, segs[i].second);
@@ -837,7 +871,7 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     } else if (a.GetType() == ShapeType::POLYLINE && b.GetType() == ShapeType::CURVE) {
         Poly &p = static_cast<Poly &>(a);
         Curve &cv = static_cast<Curve &>(b);
-        auto pts = cv.GetPoints();
+        std::vector<D2D1_POINT_2F> pts(cv.GetPoints().begin(), cv.GetPoints().end());
         auto segs = edges(p);
         for (size_t i = 0; i < segs.size(); ++i) {
             auto tmp = curveLine(pts, segs[i].first, segs[i].second);
@@ -848,8 +882,8 @@ std::vector<D2D1_POINT_2F> IntersectionManager::calculateIntersectionImpl() {
     else if (a.GetType() == ShapeType::CURVE && b.GetType() == ShapeType::CURVE) {
         Curve &cv1 = static_cast<Curve &>(a);
         Curve &cv2 = static_cast<Curve &>(b);
-        auto pts1 = cv1.GetPoints();
-        auto pts2 = cv2.GetPoints();
+        std::vector<D2D1_POINT_2F> pts1(cv1.GetPoints().begin(), cv1.GetPoints().end());
+        std::vector<D2D1_POINT_2F> pts2(cv2.GetPoints().begin(), cv2.GetPoints().end());
         D2D1_POINT_2F bez1[4] = {pts1[0], pts1[1], pts1[2], pts1[3]};
         D2D1_POINT_2F bez2[4] = {pts2[0], pts2[1], pts2[2], pts2[3]};
         CurveCurveRecursive(bez1, bez2, 0.3f, intersectionPoints);
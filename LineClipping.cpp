@@ -0,0 +1,449 @@
+#include "LineClipping.h"
+#include "Shape.h"
+#include <algorithm>
+#include <limits>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define LINECLIP_USE_SSE2 1
+#endif
+#if defined(__AVX__)
+#include <immintrin.h>
+#define LINECLIP_USE_AVX 1
+#endif
+
+namespace {
+    const float POS_INF = std::numeric_limits<float>::infinity();
+
+    // 可裁剪图形的种类
+    enum class ChainKind {
+        LINE,
+        MIDPOINT_LINE,
+        BRESENHAM_LINE,
+        POLYLINE,
+        CUBIC_BEZIER,
+        MULTI_BEZIER
+    };
+
+    // 一个图形展开得到的线段链，在线段批中占 [first, first + count)
+    struct SegmentChain {
+        size_t shapeIndex;
+        ChainKind kind;
+        uint32_t first;
+        uint32_t count;
+    };
+
+    // 链上的一段区间，位置的整数部分为线段序号，小数部分为线段内参数
+    struct ChainInterval {
+        double start, end;
+    };
+
+#if LINECLIP_USE_SSE2
+    // 对一条边界更新4条线段的参数区间，p/q 的含义与标量版本相同
+    inline void ClipEdge4(__m128 p, __m128 q, __m128 &u1, __m128 &u2, __m128 &reject) {
+        const __m128 zero = _mm_setzero_ps();
+        __m128 t = _mm_div_ps(q, p);
+        __m128 enter = _mm_cmplt_ps(p, zero);
+        __m128 leave = _mm_cmpgt_ps(p, zero);
+        __m128 parallel = _mm_cmpeq_ps(p, zero);
+        reject = _mm_or_ps(reject, _mm_and_ps(parallel, _mm_cmplt_ps(q, zero)));
+
+        // 不参与的通道换成 ∓inf；max(a, b) 在 a > b 时取 a，与标量的 if (t > u1) u1 = t 逐位一致
+        __m128 tEnter = _mm_or_ps(_mm_and_ps(enter, t), _mm_andnot_ps(enter, _mm_set1_ps(-POS_INF)));
+        __m128 tLeave = _mm_or_ps(_mm_and_ps(leave, t), _mm_andnot_ps(leave, _mm_set1_ps(POS_INF)));
+        u1 = _mm_max_ps(tEnter, u1);
+        u2 = _mm_min_ps(tLeave, u2);
+    }
+#endif
+
+#if LINECLIP_USE_AVX
+    inline void ClipEdge8(__m256 p, __m256 q, __m256 &u1, __m256 &u2, __m256 &reject) {
+        const __m256 zero = _mm256_setzero_ps();
+        __m256 t = _mm256_div_ps(q, p);
+        __m256 enter = _mm256_cmp_ps(p, zero, _CMP_LT_OQ);
+        __m256 leave = _mm256_cmp_ps(p, zero, _CMP_GT_OQ);
+        __m256 parallel = _mm256_cmp_ps(p, zero, _CMP_EQ_OQ);
+        reject = _mm256_or_ps(reject, _mm256_and_ps(parallel, _mm256_cmp_ps(q, zero, _CMP_LT_OQ)));
+
+        __m256 tEnter = _mm256_or_ps(_mm256_and_ps(enter, t), _mm256_andnot_ps(enter, _mm256_set1_ps(-POS_INF)));
+        __m256 tLeave = _mm256_or_ps(_mm256_and_ps(leave, t), _mm256_andnot_ps(leave, _mm256_set1_ps(POS_INF)));
+        u1 = _mm256_max_ps(tEnter, u1);
+        u2 = _mm256_min_ps(tLeave, u2);
+    }
+#endif
+
+    // 识别可裁剪的图形（直线、多段线、Bezier曲线）；圆和封闭多边形由多边形裁剪处理
+    bool GetChainKind(Shape *shape, ChainKind &kind) {
+        if (dynamic_cast<Line *>(shape)) {
+            kind = ChainKind::LINE;
+        } else if (dynamic_cast<MidpointLine *>(shape)) {
+            kind = ChainKind::MIDPOINT_LINE;
+        } else if (dynamic_cast<BresenhamLine *>(shape)) {
+            kind = ChainKind::BRESENHAM_LINE;
+        } else if (dynamic_cast<Poly *>(shape)) {
+            kind = ChainKind::POLYLINE;
+        } else if (dynamic_cast<Curve *>(shape)) {
+            kind = ChainKind::CUBIC_BEZIER;
+        } else if (dynamic_cast<MultiBezier *>(shape)) {
+            kind = ChainKind::MULTI_BEZIER;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    // 链上位置 s 处的点（按原始线段插值，直线的结果与逐条裁剪相同）
+    D2D1_POINT_2F PointOnChain(const SegmentBatch &batch, const SegmentChain &chain, double s) {
+        uint32_t k = s >= chain.count ? chain.count - 1 : static_cast<uint32_t>(s);
+        float t = static_cast<float>(s - k);
+        size_t i = chain.first + k;
+        float dx = batch.x1[i] - batch.x0[i];
+        float dy = batch.y1[i] - batch.y0[i];
+        return D2D1::Point2F(batch.x0[i] + t * dx, batch.y0[i] + t * dy);
+    }
+
+    // De Casteljau算法在 t 处把任意阶Bezier曲线分成两段
+    void SplitBezier(const std::vector<D2D1_POINT_2F> &points, float t,
+                     std::vector<D2D1_POINT_2F> &left, std::vector<D2D1_POINT_2F> &right) {
+        size_t n = points.size();
+        std::vector<D2D1_POINT_2F> work = points;
+        left.resize(n);
+        right.resize(n);
+        left[0] = work[0];
+        right[n - 1] = work[n - 1];
+        for (size_t level = 1; level < n; ++level) {
+            for (size_t i = 0; i + level < n; ++i) {
+                work[i].x = (1.0f - t) * work[i].x + t * work[i + 1].x;
+                work[i].y = (1.0f - t) * work[i].y + t * work[i + 1].y;
+            }
+            left[level] = work[0];
+            right[n - 1 - level] = work[n - 1 - level];
+        }
+    }
+
+    // 取Bezier曲线在参数区间 [a, b] 上的一段，阶数不变
+    std::vector<D2D1_POINT_2F> SubBezier(const std::vector<D2D1_POINT_2F> &points, float a, float b) {
+        std::vector<D2D1_POINT_2F> result = points;
+        std::vector<D2D1_POINT_2F> left, right;
+        if (b < 1.0f) {
+            SplitBezier(result, b, left, right);
+            result.swap(left);
+        }
+        if (a > 0.0f && b > 0.0f) {
+            SplitBezier(result, a / b, left, right);
+            result.swap(right);
+        }
+        return result;
+    }
+
+    // 把一段裁剪结果写回图形（inPlace）或生成同类型的新图形
+    std::shared_ptr<Shape> WritePiece(Shape *shape, bool inPlace, const SegmentChain &chain,
+                                      const SegmentBatch &batch, const ChainInterval &piece,
+                                      const std::vector<D2D1_POINT_2F> &controlPoints) {
+        std::shared_ptr<Shape> result;
+
+        switch (chain.kind) {
+        case ChainKind::LINE:
+        case ChainKind::MIDPOINT_LINE:
+        case ChainKind::BRESENHAM_LINE: {
+            D2D1_POINT_2F a = PointOnChain(batch, chain, piece.start);
+            D2D1_POINT_2F b = PointOnChain(batch, chain, piece.end);
+            if (chain.kind == ChainKind::LINE) {
+                if (inPlace) static_cast<Line *>(shape)->SetEndpoints(a, b);
+                else result = MakeDocumentShared<Line>(a, b);
+            } else if (chain.kind == ChainKind::MIDPOINT_LINE) {
+                if (inPlace) static_cast<MidpointLine *>(shape)->SetEndpoints(a, b);
+                else result = MakeDocumentShared<MidpointLine>(a, b);
+            } else {
+                if (inPlace) static_cast<BresenhamLine *>(shape)->SetEndpoints(a, b);
+                else result = MakeDocumentShared<BresenhamLine>(a, b);
+            }
+            break;
+        }
+        case ChainKind::POLYLINE: {
+            // 起点、区间内部的原始顶点、终点
+            std::vector<D2D1_POINT_2F> points;
+            points.push_back(PointOnChain(batch, chain, piece.start));
+            for (uint32_t k = static_cast<uint32_t>(piece.start) + 1; k < piece.end; ++k) {
+                points.push_back(D2D1::Point2F(batch.x0[chain.first + k], batch.y0[chain.first + k]));
+            }
+            points.push_back(PointOnChain(batch, chain, piece.end));
+            if (inPlace) static_cast<Poly *>(shape)->SetPoints(points);
+            else result = MakeDocumentShared<Poly>(points);
+            break;
+        }
+        case ChainKind::CUBIC_BEZIER:
+        case ChainKind::MULTI_BEZIER: {
+            // 展平线段按参数均匀划分，链上位置换算为曲线参数后取子曲线
+            float a = static_cast<float>(piece.start / chain.count);
+            float b = static_cast<float>(piece.end / chain.count);
+            std::vector<D2D1_POINT_2F> sub = SubBezier(controlPoints, a, b);
+            if (chain.kind == ChainKind::CUBIC_BEZIER) {
+                if (inPlace) static_cast<Curve *>(shape)->SetPoints(sub);
+                else result = MakeDocumentShared<Curve>(sub[0], sub[1], sub[2], sub[3]);
+            } else {
+                if (inPlace) {
+                    static_cast<MultiBezier *>(shape)->SetControlPoints(sub);
+                } else {
+                    auto bezier = MakeDocumentShared<MultiBezier>();
+                    for (const auto &point : sub) {
+                        bezier->AddControlPoint(point);
+                    }
+                    result = bezier;
+                }
+            }
+            break;
+        }
+        }
+
+        if (result) {
+            result->SetLineWidth(shape->GetLineWidth());
+            result->SetLineStyle(shape->GetLineStyle());
+        }
+        return result;
+    }
+}
+
+// Liang-Barsky裁剪算法实现
+bool LineClipping::ClipParams(D2D1_POINT_2F start, D2D1_POINT_2F end, const ClipWindow &window,
+                              float &t0, float &t1) {
+    float dx = end.x - start.x;
+    float dy = end.y - start.y;
+    float p[4] = {-dx, dx, -dy, dy};
+    float q[4] = {start.x - window.xmin, window.xmax - start.x, start.y - window.ymin, window.ymax - start.y};
+
+    float u1 = 0.0f, u2 = 1.0f;
+
+    for (int i = 0; i < 4; i++) {
+        if (p[i] == 0) {
+            // 线段平行于边界
+            if (q[i] < 0) {
+                return false; // 完全在外部
+            }
+        } else {
+            float t = q[i] / p[i];
+            if (p[i] < 0) {
+                // 从外部进入
+                if (t > u1) u1 = t;
+            } else {
+                // 从内部离开
+                if (t < u2) u2 = t;
+            }
+        }
+    }
+
+    if (u1 > u2) {
+        return false; // 线段完全在外部
+    }
+
+    t0 = u1;
+    t1 = u2;
+    return true;
+}
+
+void LineClipping::ClipParamsBatch(const SegmentBatch &segments, const ClipWindow &window,
+                                   float *t0, float *t1, uint8_t *accepted) {
+    size_t n = segments.Size();
+    const float *px0 = segments.x0.data();
+    const float *py0 = segments.y0.data();
+    const float *px1 = segments.x1.data();
+    const float *py1 = segments.y1.data();
+    size_t i = 0;
+
+#if LINECLIP_USE_AVX
+    {
+        const __m256 xmin = _mm256_set1_ps(window.xmin);
+        const __m256 ymin = _mm256_set1_ps(window.ymin);
+        const __m256 xmax = _mm256_set1_ps(window.xmax);
+        const __m256 ymax = _mm256_set1_ps(window.ymax);
+        const __m256 signMask = _mm256_set1_ps(-0.0f);
+        for (; i + 8 <= n; i += 8) {
+            __m256 x0 = _mm256_loadu_ps(px0 + i);
+            __m256 y0 = _mm256_loadu_ps(py0 + i);
+            __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(px1 + i), x0);
+            __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(py1 + i), y0);
+
+            __m256 u1 = _mm256_setzero_ps();
+            __m256 u2 = _mm256_set1_ps(1.0f);
+            __m256 reject = _mm256_setzero_ps();
+            ClipEdge8(_mm256_xor_ps(dx, signMask), _mm256_sub_ps(x0, xmin), u1, u2, reject);
+            ClipEdge8(dx, _mm256_sub_ps(xmax, x0), u1, u2, reject);
+            ClipEdge8(_mm256_xor_ps(dy, signMask), _mm256_sub_ps(y0, ymin), u1, u2, reject);
+            ClipEdge8(dy, _mm256_sub_ps(ymax, y0), u1, u2, reject);
+            reject = _mm256_or_ps(reject, _mm256_cmp_ps(u1, u2, _CMP_GT_OQ));
+
+            _mm256_storeu_ps(t0 + i, u1);
+            _mm256_storeu_ps(t1 + i, u2);
+            int mask = ~_mm256_movemask_ps(reject);
+            for (int k = 0; k < 8; ++k) {
+                accepted[i + k] = static_cast<uint8_t>((mask >> k) & 1);
+            }
+        }
+    }
+#endif
+
+#if LINECLIP_USE_SSE2
+    {
+        const __m128 xmin = _mm_set1_ps(window.xmin);
+        const __m128 ymin = _mm_set1_ps(window.ymin);
+        const __m128 xmax = _mm_set1_ps(window.xmax);
+        const __m128 ymax = _mm_set1_ps(window.ymax);
+        const __m128 signMask = _mm_set1_ps(-0.0f);
+        for (; i + 4 <= n; i += 4) {
+            __m128 x0 = _mm_loadu_ps(px0 + i);
+            __m128 y0 = _mm_loadu_ps(py0 + i);
+            __m128 dx = _mm_sub_ps(_mm_loadu_ps(px1 + i), x0);
+            __m128 dy = _mm_sub_ps(_mm_loadu_ps(py1 + i), y0);
+
+            __m128 u1 = _mm_setzero_ps();
+            __m128 u2 = _mm_set1_ps(1.0f);
+            __m128 reject = _mm_setzero_ps();
+            ClipEdge4(_mm_xor_ps(dx, signMask), _mm_sub_ps(x0, xmin), u1, u2, reject);
+            ClipEdge4(dx, _mm_sub_ps(xmax, x0), u1, u2, reject);
+            ClipEdge4(_mm_xor_ps(dy, signMask), _mm_sub_ps(y0, ymin), u1, u2, reject);
+            ClipEdge4(dy, _mm_sub_ps(ymax, y0), u1, u2, reject);
+            reject = _mm_or_ps(reject, _mm_cmpgt_ps(u1, u2));
+
+            _mm_storeu_ps(t0 + i, u1);
+            _mm_storeu_ps(t1 + i, u2);
+            int mask = ~_mm_movemask_ps(reject);
+            accepted[i] = static_cast<uint8_t>(mask & 1);
+            accepted[i + 1] = static_cast<uint8_t>((mask >> 1) & 1);
+            accepted[i + 2] = static_cast<uint8_t>((mask >> 2) & 1);
+            accepted[i + 3] = static_cast<uint8_t>((mask >> 3) & 1);
+        }
+    }
+#endif
+
+    // 剩余不足一组的线段
+    for (; i < n; ++i) {
+        accepted[i] = ClipParams(D2D1::Point2F(px0[i], py0[i]), D2D1::Point2F(px1[i], py1[i]),
+                                 window, t0[i], t1[i]) ? 1 : 0;
+    }
+}
+
+void LineClipping::ClipBatch(const SegmentBatch &segments, const ClipWindow *windows, size_t windowCount,
+                             ClippedSegments &out) {
+    out.Clear();
+    size_t n = segments.Size();
+    if (n == 0) return;
+
+    std::vector<float> t0(n), t1(n);
+    std::vector<uint8_t> accepted(n);
+    for (size_t w = 0; w < windowCount; ++w) {
+        ClipParamsBatch(segments, windows[w], t0.data(), t1.data(), accepted.data());
+        for (size_t i = 0; i < n; ++i) {
+            if (!accepted[i]) continue;
+
+            float x0 = segments.x0[i], y0 = segments.y0[i];
+            float dx = segments.x1[i] - x0;
+            float dy = segments.y1[i] - y0;
+            out.segments.Add(D2D1::Point2F(x0 + t0[i] * dx, y0 + t0[i] * dy),
+                             D2D1::Point2F(x0 + t1[i] * dx, y0 + t1[i] * dy));
+            out.source.push_back(static_cast<uint32_t>(i));
+            out.window.push_back(static_cast<uint32_t>(w));
+        }
+    }
+}
+
+size_t LineClipping::ClipShapes(std::vector<std::shared_ptr<Shape>> &shapes,
+                                const ClipWindow *windows, size_t windowCount) {
+    if (windowCount == 0 || shapes.empty()) return 0;
+
+    // 把所有可裁剪图形的线段收集到同一个线段批中
+    SegmentBatch batch;
+    std::vector<SegmentChain> chains;
+    for (size_t s = 0; s < shapes.size(); ++s) {
+        ChainKind kind;
+        if (!GetChainKind(shapes[s].get(), kind)) continue;
+
+        size_t first = batch.Size();
+        shapes[s]->ForEachIntersectionSegment([&](D2D1_POINT_2F a, D2D1_POINT_2F b) {
+            batch.Add(a, b);
+        });
+        if (batch.Size() == first) continue;
+
+        SegmentChain chain = {s, kind, static_cast<uint32_t>(first), static_cast<uint32_t>(batch.Size() - first)};
+        chains.push_back(chain);
+    }
+    if (chains.empty()) return 0;
+
+    // 每个窗口对整批线段求一次参数区间
+    size_t n = batch.Size();
+    std::vector<float> t0(n * windowCount), t1(n * windowCount);
+    std::vector<uint8_t> accepted(n * windowCount);
+    for (size_t w = 0; w < windowCount; ++w) {
+        ClipParamsBatch(batch, windows[w], &t0[w * n], &t1[w * n], &accepted[w * n]);
+    }
+
+    size_t modified = 0;
+    std::vector<std::pair<size_t, std::shared_ptr<Shape>>> inserts; // 需要插入到某个图形之后的新图形
+    std::vector<ChainInterval> intervals, pieces;
+    std::vector<D2D1_POINT_2F> controlPoints;
+
+    for (const auto &chain : chains) {
+        // 收集各窗口内的区间，按链上位置合并成窗口并集内的若干段
+        intervals.clear();
+        for (size_t w = 0; w < windowCount; ++w) {
+            for (uint32_t k = 0; k < chain.count; ++k) {
+                size_t idx = w * n + chain.first + k;
+                if (accepted[idx] && t1[idx] > t0[idx]) {
+                    intervals.push_back({k + static_cast<double>(t0[idx]), k + static_cast<double>(t1[idx])});
+                }
+            }
+        }
+        if (intervals.empty()) continue; // 与窗口不相交，保留原图形
+
+        std::sort(intervals.begin(), intervals.end(),
+                  [](const ChainInterval &a, const ChainInterval &b) { return a.start < b.start; });
+        pieces.clear();
+        pieces.push_back(intervals[0]);
+        for (size_t i = 1; i < intervals.size(); ++i) {
+            if (intervals[i].start <= pieces.back().end) {
+                pieces.back().end = (std::max)(pieces.back().end, intervals[i].end);
+            } else {
+                pieces.push_back(intervals[i]);
+            }
+        }
+        if (pieces.size() == 1 && pieces[0].start <= 0.0 && pieces[0].end >= chain.count) {
+            continue; // 整个图形都在窗口内
+        }
+
+        Shape *shape = shapes[chain.shapeIndex].get();
+        controlPoints.clear();
+        if (chain.kind == ChainKind::CUBIC_BEZIER) {
+            const PointVector &points = static_cast<Curve *>(shape)->GetPoints();
+            controlPoints.assign(points.begin(), points.end());
+        } else if (chain.kind == ChainKind::MULTI_BEZIER) {
+            const PointVector &points = static_cast<MultiBezier *>(shape)->GetControlPoints();
+            controlPoints.assign(points.begin(), points.end());
+        }
+
+        // 第一段写到原图形的副本上替换原图形（原对象可能被撤销历史引用，不能修改），其余段生成同类型的新图形
+        for (size_t i = 1; i < pieces.size(); ++i) {
+            inserts.emplace_back(chain.shapeIndex,
+                                 WritePiece(shape, false, chain, batch, pieces[i], controlPoints));
+        }
+        std::shared_ptr<Shape> copy = shape->Clone();
+        WritePiece(copy.get(), true, chain, batch, pieces[0], controlPoints);
+        shapes[chain.shapeIndex] = std::move(copy);
+        ++modified;
+    }
+
+    // 有图形被分成多段时，把新图形插入到各自原图形之后，保持绘制顺序
+    if (!inserts.empty()) {
+        std::vector<std::shared_ptr<Shape>> result;
+        result.reserve(shapes.size() + inserts.size());
+        size_t next = 0;
+        for (size_t s = 0; s < shapes.size(); ++s) {
+            result.push_back(std::move(shapes[s]));
+            while (next < inserts.size() && inserts[next].first == s) {
+                result.push_back(std::move(inserts[next].second));
+                ++next;
+            }
+        }
+        shapes.swap(result);
+    }
+
+    return modified;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <d2d1.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class Shape;
+
+// 轴对齐裁剪窗口（闭区间）
+struct ClipWindow {
+    float xmin, ymin, xmax, ymax;
+};
+
+// 结构数组形式的线段批：四个坐标分量各自连续存放，SIMD一次可处理4/8条线段
+struct SegmentBatch {
+    std::vector<float> x0, y0, x1, y1;
+
+    size_t Size() const {
+        return x0.size();
+    }
+    void Clear() {
+        x0.clear();
+        y0.clear();
+        x1.clear();
+        y1.clear();
+    }
+    void Reserve(size_t count) {
+        x0.reserve(count);
+        y0.reserve(count);
+        x1.reserve(count);
+        y1.reserve(count);
+    }
+    void Add(D2D1_POINT_2F start, D2D1_POINT_2F end) {
+        x0.push_back(start.x);
+        y0.push_back(start.y);
+        x1.push_back(end.x);
+        y1.push_back(end.y);
+    }
+};
+
+// 批量裁剪的输出：裁剪后的线段，以及每段对应的输入线段下标和窗口下标
+struct ClippedSegments {
+    SegmentBatch segments;
+    std::vector<uint32_t> source;
+    std::vector<uint32_t> window;
+
+    void Clear() {
+        segments.Clear();
+        source.clear();
+        window.clear();
+    }
+};
+
+// Liang-Barsky线段裁剪
+namespace LineClipping {
+    // 单条线段裁剪，得到窗口内部分的参数区间 [t0, t1]；整条在窗口外时返回 false
+    bool ClipParams(D2D1_POINT_2F start, D2D1_POINT_2F end, const ClipWindow &window,
+                    float &t0, float &t1);
+
+    // 批量裁剪到一个窗口：输出每条线段的参数区间，accepted[i] 为0表示整条在窗口外
+    // 内部用SSE2/AVX一次处理4/8条线段，结果与 ClipParams 逐位一致
+    void ClipParamsBatch(const SegmentBatch &segments, const ClipWindow &window,
+                         float *t0, float *t1, uint8_t *accepted);
+
+    // 批量裁剪到多个窗口：每个相交的（线段, 窗口）输出一段，按窗口顺序、窗口内按线段顺序排列
+    void ClipBatch(const SegmentBatch &segments, const ClipWindow *windows, size_t windowCount,
+                   ClippedSegments &out);
+
+    // 裁剪文档中所有产生线段的图形（各类直线、多段线、三次/多点Bezier曲线），保留窗口并集内的部分
+    // 与窗口不相交的图形保持不变；被裁剪的图形替换为写入第一段的副本（原图形对象不修改），其余段紧随其后插入
+    // 返回被修改的图形数
+    size_t ClipShapes(std::vector<std::shared_ptr<Shape>> &shapes,
+                      const ClipWindow *windows, size_t windowCount);
+}
@@ -0,0 +1,232 @@
+#include "Log.h"
+#include <windows.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+namespace {
+    const size_t QUEUE_CAPACITY = 1024; // 必须是2的幂
+    const size_t MESSAGE_SIZE = 512;
+
+    void DefaultSink(LogLevel, const char *message) {
+        OutputDebugStringA(message);
+    }
+
+    // 有界多生产者单消费者队列：每个槽位的序号表明它处于哪一轮，生产者用 CAS 抢占写入位置，
+    // 写完后发布序号；后台线程按顺序取出已发布的槽位
+    class LogQueue {
+    public:
+        LogQueue() : m_tail(0), m_head(0), m_dropped(0), m_sink(nullptr), m_running(true) {
+            for (size_t i = 0; i < QUEUE_CAPACITY; ++i) {
+                m_slots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+            m_thread = std::thread([this]() { Run(); });
+        }
+
+        ~LogQueue() {
+            m_running.store(false, std::memory_order_release);
+            if (m_thread.joinable()) m_thread.join();
+            Drain();
+        }
+
+        LogRecord *Acquire() {
+            size_t pos = m_tail.load(std::memory_order_relaxed);
+            for (;;) {
+                Slot &slot = m_slots[pos & (QUEUE_CAPACITY - 1)];
+                size_t sequence = slot.sequence.load(std::memory_order_acquire);
+                intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+                if (diff == 0) {
+                    if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        slot.position = pos;
+                        return &slot.record;
+                    }
+                } else if (diff < 0) {
+                    m_dropped.fetch_add(1, std::memory_order_relaxed); // 队列满
+                    return nullptr;
+                } else {
+                    pos = m_tail.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        void Publish(LogRecord *record) {
+            Slot *slot = reinterpret_cast<Slot *>(reinterpret_cast<char *>(record) - offsetof(Slot, record));
+            slot->sequence.store(slot->position + 1, std::memory_order_release);
+        }
+
+        void Flush() {
+            size_t target = m_tail.load(std::memory_order_acquire);
+            while (m_head.load(std::memory_order_acquire) < target) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+
+        void SetSink(Log::Sink sink) {
+            m_sink.store(sink, std::memory_order_release);
+        }
+
+        size_t Dropped() const {
+            return m_dropped.load(std::memory_order_relaxed);
+        }
+
+    private:
+        struct Slot {
+            std::atomic<size_t> sequence;
+            size_t position;
+            LogRecord record;
+        };
+
+        Slot m_slots[QUEUE_CAPACITY];
+        std::atomic<size_t> m_tail;
+        std::atomic<size_t> m_head; // 只由后台线程（或析构时）推进
+        std::atomic<size_t> m_dropped;
+        std::atomic<Log::Sink> m_sink;
+        std::atomic<bool> m_running;
+        std::thread m_thread;
+
+        // 输出所有已发布的记录，返回条数
+        size_t Drain() {
+            char message[MESSAGE_SIZE];
+            size_t count = 0;
+            size_t pos = m_head.load(std::memory_order_relaxed);
+            for (;;) {
+                Slot &slot = m_slots[pos & (QUEUE_CAPACITY - 1)];
+                if (slot.sequence.load(std::memory_order_acquire) != pos + 1) break;
+                Log::Format(slot.record, message, sizeof(message));
+                Log::Sink sink = m_sink.load(std::memory_order_acquire);
+                (sink ? sink : DefaultSink)(slot.record.level, message);
+                slot.sequence.store(pos + QUEUE_CAPACITY, std::memory_order_release);
+                m_head.store(++pos, std::memory_order_release);
+                ++count;
+            }
+            return count;
+        }
+
+        void Run() {
+            while (m_running.load(std::memory_order_acquire)) {
+                if (Drain() == 0) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                }
+            }
+        }
+    };
+
+    LogQueue &Queue() {
+        static LogQueue queue;
+        return queue;
+    }
+
+    bool IsOneOf(char c, const char *set) {
+        return c != '\0' && strchr(set, c) != nullptr;
+    }
+
+    // 按记录的参数类型输出一个转换，spec 为去掉长度修饰符的 "%[标志][宽度][.精度]"
+    int FormatArg(char *out, size_t size, std::string &spec, char conversion, const LogRecord &record, const LogArg &arg) {
+        bool integer = IsOneOf(conversion, "diouxX");
+        bool real = IsOneOf(conversion, "fFeEgGaA");
+        switch (arg.kind) {
+        case LogArg::INT:
+        case LogArg::UINT: {
+            long long i = arg.kind == LogArg::INT ? arg.i : static_cast<long long>(arg.u);
+            unsigned long long u = arg.kind == LogArg::UINT ? arg.u : static_cast<unsigned long long>(arg.i);
+            if (real) return snprintf(out, size, (spec + conversion).c_str(), static_cast<double>(i));
+            if (conversion == 'c') return snprintf(out, size, (spec + 'c').c_str(), static_cast<int>(i));
+            if (IsOneOf(conversion, "di")) return snprintf(out, size, (spec + "ll" + conversion).c_str(), i);
+            return snprintf(out, size, (spec + "ll" + (integer ? conversion : 'u')).c_str(), u);
+        }
+        case LogArg::DOUBLE:
+            if (integer) return snprintf(out, size, (spec + "lld").c_str(), static_cast<long long>(arg.d));
+            return snprintf(out, size, (spec + (real ? conversion : 'g')).c_str(), arg.d);
+        case LogArg::TEXT:
+            return snprintf(out, size, (spec + 's').c_str(), record.text + arg.textOffset);
+        case LogArg::POINTER:
+            return snprintf(out, size, "%p", arg.p);
+        }
+        return 0;
+    }
+}
+
+void LogRecord::Add(const char *value) {
+    LogArg &arg = Next(LogArg::TEXT);
+    if (!value) value = "(null)";
+    size_t available = TEXT_CAPACITY - textUsed;
+    if (available == 0) {
+        // 复制区已满，指向最后一个字节（总是0）
+        arg.textOffset = TEXT_CAPACITY - 1;
+        return;
+    }
+    size_t length = (std::min)(strlen(value), available - 1);
+    memcpy(text + textUsed, value, length);
+    text[textUsed + length] = '\0';
+    arg.textOffset = textUsed;
+    textUsed = static_cast<uint16_t>(textUsed + length + 1);
+}
+
+size_t Log::Format(const LogRecord &record, char *buffer, size_t size) {
+    if (size == 0) return 0;
+    size_t used = 0;
+    size_t argIndex = 0;
+    std::string spec;
+    auto append = [&](const char *text, size_t length) {
+        length = (std::min)(length, size - 1 - used);
+        memcpy(buffer + used, text, length);
+        used += length;
+    };
+
+    const char *p = record.format;
+    while (*p && used + 1 < size) {
+        if (*p != '%') {
+            const char *next = strchr(p, '%');
+            size_t length = next ? static_cast<size_t>(next - p) : strlen(p);
+            append(p, length);
+            p += length;
+            continue;
+        }
+        if (p[1] == '%') {
+            append("%", 1);
+            p += 2;
+            continue;
+        }
+        // %[标志][宽度][.精度][长度]转换
+        spec.assign(1, '%');
+        ++p;
+        while (IsOneOf(*p, "-+ #0")) spec += *p++;
+        while (*p >= '0' && *p <= '9') spec += *p++;
+        if (*p == '.') {
+            spec += *p++;
+            while (*p >= '0' && *p <= '9') spec += *p++;
+        }
+        while (IsOneOf(*p, "hljztL")) ++p;
+        char conversion = *p;
+        if (conversion == '\0') break;
+        ++p;
+        if (argIndex >= record.argCount) continue;
+        int written = FormatArg(buffer + used, size - used, spec, conversion, record, record.args[argIndex++]);
+        if (written > 0) used = (std::min)(used + static_cast<size_t>(written), size - 1);
+    }
+    buffer[used] = '\0';
+    return used;
+}
+
+LogRecord *Log::Acquire() {
+    return Queue().Acquire();
+}
+
+void Log::Publish(LogRecord *record) {
+    Queue().Publish(record);
+}
+
+void Log::Flush() {
+    Queue().Flush();
+}
+
+void Log::SetSink(Sink sink) {
+    Queue().SetSink(sink);
+}
+
+size_t Log::DroppedCount() {
+    return Queue().Dropped();
+}
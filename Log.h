@@ -0,0 +1,165 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+// 调试日志：级别在编译期过滤，低于 LOG_MIN_LEVEL 的 LOG_xxx 宏展开为空，参数不求值。
+// 启用的日志不在调用线程格式化：格式串指针和参数值写入无锁的多生产者队列，由后台线程格式化后输出，
+// 调用线程只做几次原子操作和参数复制（字符串参数截断复制到记录内）。队列满时丢弃并计数，不阻塞。
+// 格式串必须是字符串常量，支持 printf 的整数、浮点、字符和字符串转换，每条最多 MAX_ARGS 个参数
+
+#define LOG_LEVEL_TRACE 0
+#define LOG_LEVEL_DEBUG 1
+#define LOG_LEVEL_INFO  2
+#define LOG_LEVEL_WARN  3
+#define LOG_LEVEL_ERROR 4
+#define LOG_LEVEL_OFF   5
+
+// 默认调试版输出 DEBUG 及以上，发布版只输出 WARN 及以上；可在工程中预定义覆盖
+#ifndef LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define LOG_MIN_LEVEL LOG_LEVEL_WARN
+#else
+#define LOG_MIN_LEVEL LOG_LEVEL_DEBUG
+#endif
+#endif
+
+enum class LogLevel : uint8_t {
+    TRACE = LOG_LEVEL_TRACE,
+    DEBUG = LOG_LEVEL_DEBUG,
+    INFO = LOG_LEVEL_INFO,
+    WARN = LOG_LEVEL_WARN,
+    ERROR_ = LOG_LEVEL_ERROR // windows.h 定义了 ERROR 宏
+};
+
+// 一个尚未格式化的参数
+struct LogArg {
+    enum Kind : uint8_t { INT, UINT, DOUBLE, TEXT, POINTER };
+    Kind kind;
+    union {
+        long long i;
+        unsigned long long u;
+        double d;
+        const void *p;
+        uint32_t textOffset; // TEXT：在记录文本区中的偏移
+    };
+};
+
+// 队列中的一条日志
+struct LogRecord {
+    static const size_t MAX_ARGS = 8;
+    static const size_t TEXT_CAPACITY = 192; // 字符串参数的复制区
+
+    LogLevel level;
+    uint8_t argCount;
+    uint16_t textUsed;
+    const char *format;
+    LogArg args[MAX_ARGS];
+    char text[TEXT_CAPACITY];
+
+    void Add(long long value) {
+        LogArg &arg = Next(LogArg::INT);
+        arg.i = value;
+    }
+    void Add(unsigned long long value) {
+        LogArg &arg = Next(LogArg::UINT);
+        arg.u = value;
+    }
+    void Add(double value) {
+        LogArg &arg = Next(LogArg::DOUBLE);
+        arg.d = value;
+    }
+    void Add(const void *value) {
+        LogArg &arg = Next(LogArg::POINTER);
+        arg.p = value;
+    }
+    void Add(const char *value);
+    void Add(const std::string &value) {
+        Add(value.c_str());
+    }
+    void Add(char *value) {
+        Add(static_cast<const char *>(value));
+    }
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type Add(T value) {
+        Add(static_cast<long long>(value));
+    }
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type Add(T value) {
+        Add(static_cast<unsigned long long>(value));
+    }
+    template <typename T>
+    typename std::enable_if<std::is_enum<T>::value>::type Add(T value) {
+        Add(static_cast<long long>(value));
+    }
+    void Add(float value) {
+        Add(static_cast<double>(value));
+    }
+
+private:
+    LogArg &Next(LogArg::Kind kind) {
+        // 超出的参数写到最后一格，格式化时缺少的参数输出为空
+        LogArg &arg = args[argCount < MAX_ARGS ? argCount++ : MAX_ARGS - 1];
+        arg.kind = kind;
+        return arg;
+    }
+};
+
+class Log {
+public:
+    typedef void (*Sink)(LogLevel level, const char *message);
+
+    // 写入一条日志，不格式化；队列满时丢弃
+    template <typename... Args>
+    static void Write(LogLevel level, const char *format, const Args &...args) {
+        LogRecord *record = Acquire();
+        if (!record) return;
+        record->level = level;
+        record->format = format;
+        record->argCount = 0;
+        record->textUsed = 0;
+        int unused[] = {0, (record->Add(args), 0)...};
+        (void)unused;
+        Publish(record);
+    }
+
+    // 等待后台线程输出完已写入的日志
+    static void Flush();
+    // 替换输出目标（默认 OutputDebugStringA），传空恢复默认；输出目标在后台线程上调用
+    static void SetSink(Sink sink);
+    // 因队列满被丢弃的日志条数
+    static size_t DroppedCount();
+    // 按记录中的参数格式化，返回写入的字节数（不含结尾的0）
+    static size_t Format(const LogRecord &record, char *buffer, size_t size);
+
+private:
+    static LogRecord *Acquire();
+    static void Publish(LogRecord *record);
+};
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_TRACE
+#define LOG_TRACE(...) Log::Write(LogLevel::TRACE, __VA_ARGS__)
+#else
+#define LOG_TRACE(...) ((void)0)
+#endif
+#if LOG_MIN_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) Log::Write(LogLevel::DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) ((void)0)
+#endif
+#if LOG_MIN_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(...) Log::Write(LogLevel::INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) ((void)0)
+#endif
+#if LOG_MIN_LEVEL <= LOG_LEVEL_WARN
+#define LOG_WARN(...) Log::Write(LogLevel::WARN, __VA_ARGS__)
+#else
+#define LOG_WARN(...) ((void)0)
+#endif
+#if LOG_MIN_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) Log::Write(LogLevel::ERROR_, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) ((void)0)
+#endif
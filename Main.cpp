@@ -11,6 +11,15 @@
 #include "Shape.h"
 #include "Resource.h"
 #include "FillAlgorithms.h"
+#include "LineClipping.h"
+#include "PolygonClipping.h"
+#include "Profiler.h"
+#include "Log.h"
+
+// 后台填充结束，由工作线程投递，界面线程收到后写回结果
+static const UINT WM_FILL_DONE = WM_APP + 1;
+// 有填充未完成时定时重绘进度
+static const UINT_PTR FILL_PROGRESS_TIMER = 2;
 
 class MainWindow {
 public:
@@ -36,9 +45,6 @@ private:
     std::shared_ptr<Line> m_tempPolyLine;
     std::shared_ptr<MultiBezier> m_currentMultiBezier;
     bool m_isDrawingMultiBezier = false;
-    IDWriteFactory *m_pDW = nullptr;
-    IDWriteTextFormat *m_pTF = nullptr;
-    IDWriteTextLayout *m_pModeLayout = nullptr; // 缓存模式文本布局
 
     // 菱形绘制参数
     D2D1_POINT_2F m_diamondCenter;
@@ -82,12 +88,16 @@ private:
     bool m_isDrawingPolygon = false;
     std::shared_ptr<Polygon> m_currentPolygon;
     bool m_showInvalidPointFlash = false;
+    bool m_showProfiler = false; // F3 切换左上角的性能统计浮层
+    // 视图平移：按住中键拖动
+    bool m_isPanning = false;
+    POINT m_panLast = {};
     D2D1_POINT_2F m_invalidPoint;
     DWORD m_flashStartTime = 0;
 
     // 交点显示
-    void DrawIntersectionPoints(ID2D1RenderTarget *pRenderTarget);
-    void DrawSelectedIntersectionShapes(ID2D1RenderTarget *pRenderTarget);
+    void DrawIntersectionPoints(OverlayList &overlay);
+    void DrawSelectedIntersectionShapes(OverlayList &overlay);
 
     static LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
     LRESULT HandleMessage(UINT uMsg, WPARAM wParam, LPARAM lParam);
@@ -112,24 +122,20 @@ private:
     void CancelTransform();
 
     // Liang-Barsky裁剪方法
-    bool LiangBarskyClip(float &x1, float &y1, float &x2, float &y2, 
-                         float xmin, float ymin, float xmax, float ymax);
     void ApplyClipping();
 
     // Sutherland-Hodgman多边形裁剪方法
-    std::vector<D2D1_POINT_2F> SutherlandHodgmanClip(
-        const std::vector<D2D1_POINT_2F>& polygon,
-        float xmin, float ymin, float xmax, float ymax);
     void ApplyPolygonClippingSH();
 
     // Weiler-Atherton多边形裁剪方法
-    std::vector<D2D1_POINT_2F> WeilerAthertonClip(
-        const std::vector<D2D1_POINT_2F>& polygon,
-        float xmin, float ymin, float xmax, float ymax);
     void ApplyPolygonClippingWA();
 
     void SaveToFile();
     void LoadFromFile();
+
+    // 撤销/重做
+    void Undo();
+    void Redo();
 };
 
 MainWindow::MainWindow() {
@@ -159,11 +165,9 @@ LRESULT CALLBACK MainWindow::WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPA
 LRESULT MainWindow::HandleMessage(UINT uMsg, WPARAM wParam, LPARAM lParam) {
     switch (uMsg) {
     case WM_DESTROY:
+        m_graphicsEngine->Cleanup(); // 窗口销毁前停止绘制线程
+        Log::Flush(); // 退出前输出队列中剩余的日志
         PostQuitMessage(0);
-        if (m_pModeLayout) {
-            m_pModeLayout->Release();
-            m_pModeLayout = nullptr;
-        }
         return 0;
 
     case WM_PAINT:
@@ -179,9 +183,42 @@ LRESULT MainWindow::HandleMessage(UINT uMsg, WPARAM wParam, LPARAM lParam) {
         return 0;
 
     case WM_MOUSEMOVE:
+        if (m_isPanning) {
+            int x = GET_X_LPARAM(lParam), y = GET_Y_LPARAM(lParam);
+            m_graphicsEngine->PanView(static_cast<float>(x - m_panLast.x), static_cast<float>(y - m_panLast.y));
+            m_panLast.x = x;
+            m_panLast.y = y;
+            InvalidateRect(m_hwnd, nullptr, FALSE);
+            return 0;
+        }
         OnMouseMove(GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam));
         return 0;
 
+    case WM_MBUTTONDOWN:
+        m_isPanning = true;
+        m_panLast.x = GET_X_LPARAM(lParam);
+        m_panLast.y = GET_Y_LPARAM(lParam);
+        SetCapture(m_hwnd);
+        return 0;
+
+    case WM_MBUTTONUP:
+        if (m_isPanning) {
+            m_isPanning = false;
+            ReleaseCapture();
+        }
+        return 0;
+
+    case WM_MOUSEWHEEL: {
+        // 滚轮以光标为中心缩放，每格 1.2 倍；滚轮消息的坐标是屏幕坐标
+        POINT cursor = {GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam)};
+        ScreenToClient(m_hwnd, &cursor);
+        float steps = static_cast<float>(GET_WHEEL_DELTA_WPARAM(wParam)) / WHEEL_DELTA;
+        m_graphicsEngine->ZoomView(powf(1.2f, steps),
+                                   D2D1::Point2F(static_cast<float>(cursor.x), static_cast<float>(cursor.y)));
+        InvalidateRect(m_hwnd, nullptr, FALSE);
+        return 0;
+    }
+
     case WM_KEYDOWN:
         OnKeyDown(wParam);
         return 0;
@@ -202,9 +239,24 @@ LRESULT MainWindow::HandleMessage(UINT uMsg, WPARAM wParam, LPARAM lParam) {
             m_showInvalidPointFlash = false;
             KillTimer(m_hwnd, 1);
             InvalidateRect(m_hwnd, nullptr, FALSE);
+        } else if (wParam == FILL_PROGRESS_TIMER) {
+            if (m_graphicsEngine->GetFillProgress().empty()) {
+                KillTimer(m_hwnd, FILL_PROGRESS_TIMER);
+            }
+            InvalidateRect(m_hwnd, nullptr, FALSE);
         }
         return 0;
 
+    case WM_FILL_DONE: {
+        // 同一批结果可能对应多条消息，取空后的消息不做任何事
+        size_t applied = m_graphicsEngine->ApplyCompletedFills();
+        if (applied > 0) {
+            LOG_DEBUG("写回 %zu 个后台填充结果\n", applied);
+        }
+        InvalidateRect(m_hwnd, nullptr, FALSE);
+        return 0;
+    }
+
     case WM_ERASEBKGND:
         return 1; // 防止闪烁
     }
@@ -213,7 +265,8 @@ LRESULT MainWindow::HandleMessage(UINT uMsg, WPARAM wParam, LPARAM lParam) {
 }
 
 void MainWindow::OnLButtonDown(int x, int y) {
-    D2D1_POINT_2F currentPoint = D2D1::Point2F(static_cast<float>(x), static_cast<float>(y));
+    // 窗口坐标换算为文档坐标
+    D2D1_POINT_2F currentPoint = m_graphicsEngine->ScreenToWorld(D2D1::Point2F(static_cast<float>(x), static_cast<float>(y)));
 
     switch (m_currentMode) {
     case DrawingMode::SELECT:
@@ -257,9 +310,9 @@ void MainWindow::OnLButtonDown(int x, int y) {
             m_startPoint = currentPoint;
             m_clickCount = 1;
             m_isDrawing = true;
-            m_tempShape = std::make_shared<Line>(m_startPoint, currentPoint);
+            m_tempShape = MakeDocumentShared<Line>(m_startPoint, currentPoint);
         } else {
-            auto line = std::make_shared<Line>(m_startPoint, currentPoint);
+            auto line = MakeDocumentShared<Line>(m_startPoint, currentPoint);
             line->SetLineWidth(m_currentLineWidth);
             line->SetLineStyle(m_currentLineStyle);
             m_graphicsEngine->AddShape(line);
@@ -272,9 +325,9 @@ void MainWindow::OnLButtonDown(int x, int y) {
             m_startPoint = currentPoint;
             m_clickCount = 1;
             m_isDrawing = true;
-            m_tempShape = std::make_shared<MidpointLine>(m_startPoint, currentPoint);
+            m_tempShape = MakeDocumentShared<MidpointLine>(m_startPoint, currentPoint);
         } else {
-            auto line = std::make_shared<MidpointLine>(m_startPoint, currentPoint);
+            auto line = MakeDocumentShared<MidpointLine>(m_startPoint, currentPoint);
             line->SetLineWidth(m_currentLineWidth);
             line->SetLineStyle(m_currentLineStyle);
             m_graphicsEngine->AddShape(line);
@@ -287,9 +340,9 @@ void MainWindow::OnLButtonDown(int x, int y) {
             m_startPoint = currentPoint;
             m_clickCount = 1;
             m_isDrawing = true;
-            m_tempShape = std::make_shared<BresenhamLine>(m_startPoint, currentPoint);
+            m_tempShape = MakeDocumentShared<BresenhamLine>(m_startPoint, currentPoint);
         } else {
-            auto line = std::make_shared<BresenhamLine>(m_startPoint, currentPoint);
+            auto line = MakeDocumentShared<BresenhamLine>(m_startPoint, currentPoint);
             line->SetLineWidth(m_currentLineWidth);
             line->SetLineStyle(m_currentLineStyle);
             m_graphicsEngine->AddShape(line);
@@ -302,10 +355,10 @@ void MainWindow::OnLButtonDown(int x, int y) {
             m_startPoint = currentPoint;
             m_clickCount = 1;
             m_isDrawing = true;
-            m_tempShape = std::make_shared<MidpointCircle>(m_startPoint, 0);
+            m_tempShape = MakeDocumentShared<MidpointCircle>(m_startPoint, 0);
         } else {
             float radius = CalculateDistance(m_startPoint, currentPoint);
-            auto circle = std::make_shared<MidpointCircle>(m_startPoint, radius);
+            auto circle = MakeDocumentShared<MidpointCircle>(m_startPoint, radius);
             circle->SetLineWidth(m_currentLineWidth);
             circle->SetLineStyle(m_currentLineStyle);
             m_graphicsEngine->AddShape(circle);
@@ -318,10 +371,10 @@ void MainWindow::OnLButtonDown(int x, int y) {
             m_startPoint = currentPoint;
             m_clickCount = 1;
             m_isDrawing = true;
-            m_tempShape = std::make_shared<BresenhamCircle>(m_startPoint, 0);
+            m_tempShape = MakeDocumentShared<BresenhamCircle>(m_startPoint, 0);
         } else {
             float radius = CalculateDistance(m_startPoint, currentPoint);
-            auto circle = std::make_shared<BresenhamCircle>(m_startPoint, radius);
+            auto circle = MakeDocumentShared<BresenhamCircle>(m_startPoint, radius);
             circle->SetLineWidth(m_currentLineWidth);
             circle->SetLineStyle(m_currentLineStyle);
             m_graphicsEngine->AddShape(circle);
@@ -334,10 +387,10 @@ void MainWindow::OnLButtonDown(int x, int y) {
             m_startPoint = currentPoint;
             m_clickCount = 1;
             m_isDrawing = true;
-            m_tempShape = std::make_shared<Circle>(m_startPoint, 0);
+            m_tempShape = MakeDocumentShared<Circle>(m_startPoint, 0);
         } else {
             float radius = CalculateDistance(m_startPoint, currentPoint);
-            auto circle = std::make_shared<Circle>(m_startPoint, radius);
+            auto circle = MakeDocumentShared<Circle>(m_startPoint, radius);
             circle->SetLineWidth(m_currentLineWidth);
             circle->SetLineStyle(m_currentLineStyle);
             m_graphicsEngine->AddShape(circle);
@@ -350,9 +403,9 @@ void MainWindow::OnLButtonDown(int x, int y) {
             m_startPoint = currentPoint;
             m_clickCount = 1;
             m_isDrawing = true;
-            m_tempShape = std::make_shared<Rect>(m_startPoint, currentPoint);
+            m_tempShape = MakeDocumentShared<Rect>(m_startPoint, currentPoint);
         } else {
-            m_graphicsEngine->AddShape(std::make_shared<Rect>(m_startPoint, currentPoint));
+            m_graphicsEngine->AddShape(MakeDocumentShared<Rect>(m_startPoint, currentPoint));
             ResetDrawingState();
         }
         break;
@@ -383,11 +436,11 @@ void MainWindow::OnLButtonDown(int x, int y) {
             m_diamondRadiusX = hypotf(dx, dy);
             m_diamondRadiusY = m_diamondRadiusX * 0.6f;
             m_diamondAngle = atan2f(dy, dx);
-            m_tempShape = std::make_shared<Diamond>(
+            m_tempShape = MakeDocumentShared<Diamond>(
                 m_diamondCenter, m_diamondRadiusX, m_diamondRadiusY, m_diamondAngle);
         } else {
             // 第二次点击：固定参数并正式添加
-            m_graphicsEngine->AddShape(std::make_shared<Diamond>(
+            m_graphicsEngine->AddShape(MakeDocumentShared<Diamond>(
                 m_diamondCenter, m_diamondRadiusX, m_diamondRadiusY, m_diamondAngle));
             ResetDrawingState();
         }
@@ -399,14 +452,14 @@ void MainWindow::OnLButtonDown(int x, int y) {
             m_clickCount = 1;
             m_isDrawing = true;
             // 平行四边形需要第三个点，先用起点作为临时点
-            m_tempShape = std::make_shared<Parallelogram>(m_startPoint, currentPoint, currentPoint);
+            m_tempShape = MakeDocumentShared<Parallelogram>(m_startPoint, currentPoint, currentPoint);
         } else if (m_clickCount == 1) {
             m_midPoint = currentPoint;
             m_clickCount = 2;
             // 更新预览
-            m_tempShape = std::make_shared<Parallelogram>(m_startPoint, m_midPoint, currentPoint);
+            m_tempShape = MakeDocumentShared<Parallelogram>(m_startPoint, m_midPoint, currentPoint);
         } else {
-            m_graphicsEngine->AddShape(std::make_shared<Parallelogram>(m_startPoint, m_midPoint, currentPoint));
+            m_graphicsEngine->AddShape(MakeDocumentShared<Parallelogram>(m_startPoint, m_midPoint, currentPoint));
             ResetDrawingState();
         }
         break;
@@ -422,7 +475,7 @@ void MainWindow::OnLButtonDown(int x, int y) {
             m_bezierClickCount = 1;
             m_isDrawing = true;
             // 创建临时曲线预览，起点和终点相同，控制点也相同
-            m_tempShape = std::make_shared<Curve>(
+            m_tempShape = MakeDocumentShared<Curve>(
                 m_startPoint,
                 m_startPoint,
                 m_startPoint,
@@ -432,7 +485,7 @@ void MainWindow::OnLButtonDown(int x, int y) {
             m_bezierControl1 = currentPoint;
             m_bezierClickCount = 2;
             // 更新预览，起点到第一个控制点的直线
-            m_tempShape = std::make_shared<Curve>(
+            m_tempShape = MakeDocumentShared<Curve>(
                 m_startPoint,
                 m_bezierControl1,
                 m_bezierControl1,
@@ -442,14 +495,14 @@ void MainWindow::OnLButtonDown(int x, int y) {
             m_bezierControl2 = currentPoint;
             m_bezierClickCount = 3;
             // 更新预览，包含两个控制点的曲线
-            m_tempShape = std::make_shared<Curve>(
+            m_tempShape = MakeDocumentShared<Curve>(
                 m_startPoint,
                 m_bezierControl1,
                 m_bezierControl2,
                 m_bezierControl2);
         } else if (m_bezierClickCount == 3) {
             // 第四次点击：设置终点，完成曲线
-            m_graphicsEngine->AddShape(std::make_shared<Curve>(
+            m_graphicsEngine->AddShape(MakeDocumentShared<Curve>(
                 m_startPoint,
                 m_bezierControl1,
                 m_bezierControl2,
@@ -461,58 +514,50 @@ void MainWindow::OnLButtonDown(int x, int y) {
     case DrawingMode::MULTI_BEZIER:
         if (!m_isDrawingMultiBezier) {
             // 开始绘制新的多点Bezier曲线
-            m_currentMultiBezier = std::make_shared<MultiBezier>();
+            m_currentMultiBezier = MakeDocumentShared<MultiBezier>();
             m_currentMultiBezier->SetEditing(true); // 设置为编辑状态
             m_currentMultiBezier->AddControlPoint(currentPoint);
             m_isDrawingMultiBezier = true;
-            OutputDebugStringA("开始绘制多点Bezier曲线，添加第一个控制点\n");
+            LOG_DEBUG("开始绘制多点Bezier曲线，添加第一个控制点\n");
         } else {
             // 添加控制点
             m_currentMultiBezier->AddControlPoint(currentPoint);
-            int pointCount = m_currentMultiBezier->GetControlPoints().size();
-
-            char debugMsg[100];
-            sprintf_s(debugMsg, "添加控制点 #%d\n", pointCount);
-            OutputDebugStringA(debugMsg);
+            LOG_DEBUG("添加控制点 #%zu\n", m_currentMultiBezier->GetControlPoints().size());
         }
         InvalidateRect(m_hwnd, nullptr, FALSE);
         break;
     case DrawingMode::SCANLINE_FILL:
     case DrawingMode::SEED_FILL:
-        // 填充模式：查找点击位置的封闭图形并应用填充算法
+        // 填充模式：查找点击位置的封闭图形，提交后台填充，结果算完后由 WM_FILL_DONE 写回
         {
             bool foundShape = false;
-            for (const auto &shape : m_graphicsEngine->GetShapes()) {
+            const auto &shapes = m_graphicsEngine->GetShapes();
+            for (size_t index = 0; index < shapes.size(); ++index) {
+                const auto &shape = shapes[index];
                 ShapeType type = shape->GetType();
                 // 只对封闭图形进行填充（包括多义线组成的封闭多边形）
                 if (type == ShapeType::CIRCLE || type == ShapeType::RECTANGLE || type == ShapeType::TRIANGLE || type == ShapeType::DIAMOND || type == ShapeType::PARALLELOGRAM || type == ShapeType::POLYLINE) {
-                    // 简单检查点是否在边界框内
-                    D2D1_RECT_F bounds = shape->GetBounds();
-                    if (currentPoint.x >= bounds.left && currentPoint.x <= bounds.right && currentPoint.y >= bounds.top && currentPoint.y <= bounds.bottom) {
-                        // 应用填充算法
-                        std::vector<D2D1_POINT_2F> fillPixels;
+                    // 种子点在图形内部才提交（两种算法对种子点做同样的检查，不在内部时结果为空）
+                    if (FillAlgorithms::ContainsPoint(shape.get(), currentPoint)) {
+                        FillJobQueue::Algorithm algorithm = FillJobQueue::Algorithm::SEED;
                         if (m_currentMode == DrawingMode::SCANLINE_FILL) {
-                            fillPixels = FillAlgorithms::ScanlineFill(shape.get(), currentPoint);
-                            OutputDebugStringA("应用栅栏填充算法\n");
+                            algorithm = FillJobQueue::Algorithm::SCANLINE;
+                            LOG_DEBUG("提交扫描线填充\n");
                         } else {
-                            fillPixels = FillAlgorithms::SeedFill(shape.get(), currentPoint);
-                            OutputDebugStringA("应用种子填充算法\n");
-                        }
-
-                        if (!fillPixels.empty()) {
-                            shape->SetFillPixels(fillPixels);
-                            char debugMsg[100];
-                            sprintf_s(debugMsg, "填充了 %zu 个像素\n", fillPixels.size());
-                            OutputDebugStringA(debugMsg);
-                            foundShape = true;
-                            break;
+                            LOG_DEBUG("提交种子填充\n");
                         }
+                        // 同一图形上未完成的填充被这次点击取代
+                        m_graphicsEngine->SubmitFill(index, currentPoint, algorithm);
+                        SetTimer(m_hwnd, FILL_PROGRESS_TIMER, 100, nullptr);
+                        InvalidateRect(m_hwnd, nullptr, FALSE);
+                        foundShape = true;
+                        break;
                     }
                 }
             }
 
             if (!foundShape) {
-                OutputDebugStringA("未找到可填充的封闭图形\n");
+                LOG_INFO("未找到可填充的封闭图形\n");
             }
         }
         break;
@@ -598,16 +643,14 @@ void MainWindow::OnLButtonDown(int x, int y) {
             m_polygonPoints.clear();
             m_polygonPoints.push_back(currentPoint);
             m_isDrawingPolygon = true;
-            m_currentPolygon = std::make_shared<Polygon>(m_polygonPoints);
-            OutputDebugStringA("开始绘制多边形，添加第一个点\n");
+            m_currentPolygon = MakeDocumentShared<Polygon>(m_polygonPoints);
+            LOG_DEBUG("开始绘制多边形，添加第一个点\n");
         } else {
             // 用当前已确定的点创建临时多边形来检查相交
-            char debugMsg[200];
-            sprintf_s(debugMsg, "OnLButtonDown: m_polygonPoints有%zu个点, currentPoint=(%.1f,%.1f)\n", 
+            LOG_DEBUG("OnLButtonDown: m_polygonPoints有%zu个点, currentPoint=(%.1f,%.1f)\n",
                       m_polygonPoints.size(), currentPoint.x, currentPoint.y);
-            OutputDebugStringA(debugMsg);
             
-            auto tempPolygon = std::make_shared<Polygon>(m_polygonPoints);
+            auto tempPolygon = MakeDocumentShared<Polygon>(m_polygonPoints);
             
             // 检查是否会导致自相交
             if (tempPolygon->WouldCauseIntersection(currentPoint)) {
@@ -615,7 +658,7 @@ void MainWindow::OnLButtonDown(int x, int y) {
                 m_showInvalidPointFlash = true;
                 m_invalidPoint = currentPoint;
                 m_flashStartTime = GetTickCount();
-                OutputDebugStringA("检测到自相交，拒绝添加点\n");
+                LOG_INFO("检测到自相交，拒绝添加点\n");
                 // 触发重绘以显示闪烁效果
                 InvalidateRect(m_hwnd, nullptr, FALSE);
                 // 设置定时器以清除闪烁效果
@@ -623,10 +666,8 @@ void MainWindow::OnLButtonDown(int x, int y) {
             } else {
                 // 添加点
                 m_polygonPoints.push_back(currentPoint);
-                m_currentPolygon = std::make_shared<Polygon>(m_polygonPoints);
-                char debugMsg2[100];
-                sprintf_s(debugMsg2, "添加多边形顶点 #%zu\n", m_polygonPoints.size());
-                OutputDebugStringA(debugMsg2);
+                m_currentPolygon = MakeDocumentShared<Polygon>(m_polygonPoints);
+                LOG_DEBUG("添加多边形顶点 #%zu\n", m_polygonPoints.size());
             }
         }
         break;
@@ -674,7 +715,7 @@ void MainWindow::OnLButtonDown(int x, int y) {
 }
 
 void MainWindow::OnMouseMove(int x, int y) {
-    D2D1_POINT_2F currentPoint = D2D1::Point2F(static_cast<float>(x), static_cast<float>(y));
+    D2D1_POINT_2F currentPoint = m_graphicsEngine->ScreenToWorld(D2D1::Point2F(static_cast<float>(x), static_cast<float>(y)));
 
     // 在SELECT模式下检查鼠标是否悬停在图元上
     if (m_currentMode == DrawingMode::SELECT) {
@@ -706,37 +747,37 @@ void MainWindow::OnMouseMove(int x, int y) {
     if (m_isDrawing && m_tempShape) {
         switch (m_currentMode) {
         case DrawingMode::LINE:
-            m_tempShape = std::make_shared<Line>(m_startPoint, currentPoint);
+            m_tempShape = MakeDocumentShared<Line>(m_startPoint, currentPoint);
             break;
 
         case DrawingMode::MIDPOINT_LINE:
-            m_tempShape = std::make_shared<MidpointLine>(m_startPoint, currentPoint);
+            m_tempShape = MakeDocumentShared<MidpointLine>(m_startPoint, currentPoint);
             break;
 
         case DrawingMode::BRESENHAM_LINE:
-            m_tempShape = std::make_shared<BresenhamLine>(m_startPoint, currentPoint);
+            m_tempShape = MakeDocumentShared<BresenhamLine>(m_startPoint, currentPoint);
             break;
 
         case DrawingMode::MIDPOINT_CIRCLE: {
             float radius = CalculateDistance(m_startPoint, currentPoint);
-            m_tempShape = std::make_shared<MidpointCircle>(m_startPoint, radius);
+            m_tempShape = MakeDocumentShared<MidpointCircle>(m_startPoint, radius);
             break;
         }
 
         case DrawingMode::BRESENHAM_CIRCLE: {
             float radius = CalculateDistance(m_startPoint, currentPoint);
-            m_tempShape = std::make_shared<BresenhamCircle>(m_startPoint, radius);
+            m_tempShape = MakeDocumentShared<BresenhamCircle>(m_startPoint, radius);
             break;
         }
 
         case DrawingMode::CIRCLE: {
             float radius = CalculateDistance(m_startPoint, currentPoint);
-            m_tempShape = std::make_shared<Circle>(m_startPoint, radius);
+            m_tempShape = MakeDocumentShared<Circle>(m_startPoint, radius);
             break;
         }
 
         case DrawingMode::RECTANGLE:
-            m_tempShape = std::make_shared<Rect>(m_startPoint, currentPoint);
+            m_tempShape = MakeDocumentShared<Rect>(m_startPoint, currentPoint);
             break;
 
         case DrawingMode::TRIANGLE:
@@ -751,7 +792,7 @@ void MainWindow::OnMouseMove(int x, int y) {
                 m_diamondRadiusX = hypotf(dx, dy);
                 m_diamondRadiusY = m_diamondRadiusX * 0.6f;
                 m_diamondAngle = atan2f(dy, dx);
-                m_tempShape = std::make_shared<Diamond>(
+                m_tempShape = MakeDocumentShared<Diamond>(
                     m_diamondCenter, m_diamondRadiusX, m_diamondRadiusY, m_diamondAngle);
             }
             break;
@@ -759,10 +800,10 @@ void MainWindow::OnMouseMove(int x, int y) {
         case DrawingMode::PARALLELOGRAM:
             if (m_clickCount == 1) {
                 // 第一次点击后移动：确定平行四边形的一条边
-                m_tempShape = std::make_shared<Parallelogram>(m_startPoint, currentPoint, currentPoint);
+                m_tempShape = MakeDocumentShared<Parallelogram>(m_startPoint, currentPoint, currentPoint);
             } else if (m_clickCount == 2) {
                 // 第二次点击后移动：确定平行四边形的形状
-                m_tempShape = std::make_shared<Parallelogram>(m_startPoint, m_midPoint, currentPoint);
+                m_tempShape = MakeDocumentShared<Parallelogram>(m_startPoint, m_midPoint, currentPoint);
             }
             break;
         }
@@ -774,21 +815,21 @@ void MainWindow::OnMouseMove(int x, int y) {
     if (m_currentMode == DrawingMode::CURVE && m_isDrawing && m_tempShape) {
         if (m_bezierClickCount == 1) {
             // 第一次点击后移动：预览从起点到当前点的直线
-            m_tempShape = std::make_shared<Curve>(
+            m_tempShape = MakeDocumentShared<Curve>(
                 m_startPoint,
                 currentPoint,
                 currentPoint,
                 currentPoint);
         } else if (m_bezierClickCount == 2) {
             // 第二次点击后移动：预览包含第一个控制点的曲线
-            m_tempShape = std::make_shared<Curve>(
+            m_tempShape = MakeDocumentShared<Curve>(
                 m_startPoint,
                 m_bezierControl1,
                 currentPoint,
                 currentPoint);
         } else if (m_bezierClickCount == 3) {
             // 第三次点击后移动：预览包含两个控制点的完整曲线
-            m_tempShape = std::make_shared<Curve>(
+            m_tempShape = MakeDocumentShared<Curve>(
                 m_startPoint,
                 m_bezierControl1,
                 m_bezierControl2,
@@ -800,7 +841,7 @@ void MainWindow::OnMouseMove(int x, int y) {
     // 多段线模式：实时预览当前线段
     if (m_currentMode == DrawingMode::POLYLINE && !m_polyPoints.empty()) {
         // 创建从最后一个点到当前鼠标位置的预览线段
-        m_tempPolyLine = std::make_shared<Line>(m_polyPoints.back(), currentPoint);
+        m_tempPolyLine = MakeDocumentShared<Line>(m_polyPoints.back(), currentPoint);
         InvalidateRect(m_hwnd, nullptr, FALSE);
     }
 
@@ -816,11 +857,11 @@ void MainWindow::OnMouseMove(int x, int y) {
         // 更新当前多边形预览（包含鼠标位置）
         std::vector<D2D1_POINT_2F> previewPoints = m_polygonPoints;
         previewPoints.push_back(currentPoint);
-        m_currentPolygon = std::make_shared<Polygon>(previewPoints);
+        m_currentPolygon = MakeDocumentShared<Polygon>(previewPoints);
         
         // 如果已有至少3个点，检测闭合边是否会相交
         if (m_polygonPoints.size() >= 3) {
-            auto tempPolygon = std::make_shared<Polygon>(m_polygonPoints);
+            auto tempPolygon = MakeDocumentShared<Polygon>(m_polygonPoints);
             // 检查从当前鼠标位置到第一个点的闭合边是否会相交
             if (tempPolygon->WouldCauseIntersection(currentPoint, true)) {
                 // 闭合边会相交，显示红色提示（但不设置定时器，因为鼠标一直在移动）
@@ -889,7 +930,7 @@ std::shared_ptr<Triangle> MainWindow::CreateEquilateralTriangle(D2D1_POINT_2F p1
     p3.x = p1.x + dx / 2 - height * (p2.y - p1.y) / sideLength;
     p3.y = p1.y + dy / 2 + height * (p2.x - p1.x) / sideLength;
 
-    return std::make_shared<Triangle>(p1, p2, p3);
+    return MakeDocumentShared<Triangle>(p1, p2, p3);
 }
 
 void MainWindow::ResetDrawingState() {
@@ -915,6 +956,25 @@ void MainWindow::ResetDrawingState() {
     m_showInvalidPointFlash = false;
 }
 
+// 撤销/重做：结束进行中的拖动变换，文档恢复后清除引用旧图形的临时状态
+void MainWindow::Undo() {
+    m_isTransforming = false;
+    if (m_graphicsEngine->Undo()) {
+        ResetTangentState();
+        ResetCenterState();
+    }
+    InvalidateRect(m_hwnd, nullptr, FALSE);
+}
+
+void MainWindow::Redo() {
+    m_isTransforming = false;
+    if (m_graphicsEngine->Redo()) {
+        ResetTangentState();
+        ResetCenterState();
+    }
+    InvalidateRect(m_hwnd, nullptr, FALSE);
+}
+
 void MainWindow::ResetTangentState() {
     m_isDrawingTangent = false;
     m_selectedCircleForTangent.reset();
@@ -933,9 +993,9 @@ void MainWindow::OnRButtonDown(int x, int y) {
         m_currentMultiBezier->SetEditing(false);   // 清除编辑状态
         if (m_currentMultiBezier->GetControlPoints().size() >= 2) {
             m_graphicsEngine->AddShape(m_currentMultiBezier);
-            OutputDebugStringA("多点Bezier曲线绘制完成（使用De Casteljau算法）\n");
+            LOG_INFO("多点Bezier曲线绘制完成（使用De Casteljau算法）\n");
         } else {
-            OutputDebugStringA("控制点不足2个，无法形成曲线\n");
+            LOG_INFO("控制点不足2个，无法形成曲线\n");
         }
         m_currentMultiBezier.reset();
         m_isDrawingMultiBezier = false;
@@ -949,7 +1009,7 @@ void MainWindow::OnRButtonDown(int x, int y) {
     } else if (m_currentMode == DrawingMode::POLYLINE) {
         // 结束多段线绘制
         if (m_polyPoints.size() >= 2) {
-            auto polyline = std::make_shared<Poly>(m_polyPoints);
+            auto polyline = MakeDocumentShared<Poly>(m_polyPoints);
             m_graphicsEngine->AddShape(polyline);
         }
         m_polyPoints.clear();
@@ -958,7 +1018,7 @@ void MainWindow::OnRButtonDown(int x, int y) {
         // 右键完成多边形绘制
         if (m_polygonPoints.size() >= 3) {
             // 检查闭合边是否会导致自相交
-            auto tempPolygon = std::make_shared<Polygon>(m_polygonPoints);
+            auto tempPolygon = MakeDocumentShared<Polygon>(m_polygonPoints);
             D2D1_POINT_2F lastPoint = m_polygonPoints.back();
             
             // 使用checkClosingEdge=true来检查从lastPoint到firstPoint的闭合边
@@ -967,16 +1027,16 @@ void MainWindow::OnRButtonDown(int x, int y) {
                 m_showInvalidPointFlash = true;
                 m_invalidPoint = lastPoint;
                 m_flashStartTime = GetTickCount();
-                OutputDebugStringA("闭合边会导致自相交，无法完成多边形\n");
+                LOG_INFO("闭合边会导致自相交，无法完成多边形\n");
                 InvalidateRect(m_hwnd, nullptr, FALSE);
                 SetTimer(m_hwnd, 1, 300, nullptr);
             } else {
                 // 创建最终的多边形
-                auto finalPolygon = std::make_shared<Polygon>(m_polygonPoints);
+                auto finalPolygon = MakeDocumentShared<Polygon>(m_polygonPoints);
                 finalPolygon->SetLineWidth(m_currentLineWidth);
                 finalPolygon->SetLineStyle(m_currentLineStyle);
                 m_graphicsEngine->AddShape(finalPolygon);
-                OutputDebugStringA("多边形绘制完成\n");
+                LOG_INFO("多边形绘制完成\n");
                 
                 // 清理状态
                 m_polygonPoints.clear();
@@ -985,7 +1045,7 @@ void MainWindow::OnRButtonDown(int x, int y) {
                 m_showInvalidPointFlash = false;
             }
         } else {
-            OutputDebugStringA("顶点不足3个，无法形成多边形\n");
+            LOG_INFO("顶点不足3个，无法形成多边形\n");
             // 清理状态
             m_polygonPoints.clear();
             m_currentPolygon.reset();
@@ -1003,6 +1063,30 @@ void MainWindow::OnRButtonDown(int x, int y) {
     InvalidateRect(m_hwnd, nullptr, FALSE);
 }
 void MainWindow::OnKeyDown(WPARAM wParam) {
+    // Ctrl+Z 撤销，Ctrl+Y 重做（不带Ctrl的Z键仍为缩小），Ctrl+0 恢复默认视图
+    if (GetKeyState(VK_CONTROL) & 0x8000) {
+        if (wParam == 'Z' || wParam == 'Y') {
+            if (wParam == 'Z') {
+                Undo();
+            } else {
+                Redo();
+            }
+            return;
+        }
+        if (wParam == '0') {
+            m_graphicsEngine->ResetView();
+            InvalidateRect(m_hwnd, nullptr, FALSE);
+            return;
+        }
+    }
+
+    // Home 缩放到显示全部图形
+    if (wParam == VK_HOME) {
+        m_graphicsEngine->ZoomToFit();
+        InvalidateRect(m_hwnd, nullptr, FALSE);
+        return;
+    }
+
     // 测试线宽功能的键盘快捷键
     if (wParam >= '1' && wParam <= '5') {
         if (m_graphicsEngine->IsShapeSelected()) {
@@ -1018,12 +1102,11 @@ void MainWindow::OnKeyDown(WPARAM wParam) {
                     case '4': newWidth = LineWidth::WIDTH_8PX; break;
                     case '5': newWidth = LineWidth::WIDTH_16PX; break;
                     }
-                    selectedShape->SetLineWidth(newWidth);
+                    m_graphicsEngine->EditSelectedShape()->SetLineWidth(newWidth);
+                    m_graphicsEngine->UpdateSelectedShape();
                     m_currentLineWidth = newWidth;
 
-                    char debugMsg[100];
-                    sprintf_s(debugMsg, "Line width set to %dpx via keyboard\n", static_cast<int>(newWidth));
-                    OutputDebugStringA(debugMsg);
+                    LOG_INFO("Line width set to %dpx via keyboard\n", static_cast<int>(newWidth));
 
                     InvalidateRect(m_hwnd, nullptr, FALSE);
                     return;
@@ -1032,11 +1115,26 @@ void MainWindow::OnKeyDown(WPARAM wParam) {
         }
     }
 
+    // F3 显示/隐藏性能统计，F4 把计时事件导出为 Chrome trace JSON（当前目录下的 trace.json）
+    if (wParam == VK_F3) {
+        m_showProfiler = !m_showProfiler;
+        InvalidateRect(m_hwnd, nullptr, FALSE);
+        return;
+    }
+    if (wParam == VK_F4) {
+        if (Profiler::DumpChromeTrace("trace.json")) {
+            LOG_INFO("已导出 trace.json\n");
+        } else {
+            LOG_WARN("导出 trace.json 失败\n");
+        }
+        return;
+    }
+
     // 按C键清除所有选择，确保图形显示为黑色
     if (wParam == 'C') {
         m_graphicsEngine->ClearSelection();
         InvalidateRect(m_hwnd, nullptr, FALSE);
-        OutputDebugStringA("All selections cleared\n");
+        LOG_INFO("All selections cleared\n");
         return;
     }
     const float MOVE_STEP = 5.0f;   // 移动步长
@@ -1045,9 +1143,12 @@ void MainWindow::OnKeyDown(WPARAM wParam) {
 
     switch (wParam) {
     case VK_ESCAPE:
-        // ESC键：取消选择和变换
+        // ESC键：取消选择和变换，以及未完成的后台填充
         m_graphicsEngine->ClearSelection();
         CancelTransform();
+        if (size_t cancelled = m_graphicsEngine->CancelFills()) {
+            LOG_INFO("取消了 %zu 个后台填充\n", cancelled);
+        }
         break;
 
     case VK_DELETE:
@@ -1204,61 +1305,31 @@ void MainWindow::UpdateTransform(D2D1_POINT_2F point) {
 
 void MainWindow::EndTransform() {
     m_isTransforming = false;
+    // 拖动过程中只累积了保留变换，此时一次写回几何
+    m_graphicsEngine->CommitSelectedTransform();
     // 注意：不重置 m_transformMode，保持当前变换模式
 }
 
 void MainWindow::CancelTransform() {
     m_isTransforming = false;
+    m_graphicsEngine->CommitSelectedTransform();
     m_transformMode = TransformMode::NONE;
 }
 
-// Liang-Barsky裁剪算法实现
-bool MainWindow::LiangBarskyClip(float &x1, float &y1, float &x2, float &y2,
-                                  float xmin, float ymin, float xmax, float ymax) {
-    float dx = x2 - x1;
-    float dy = y2 - y1;
-    float p[4] = {-dx, dx, -dy, dy};
-    float q[4] = {x1 - xmin, xmax - x1, y1 - ymin, ymax - y1};
-    
-    float u1 = 0.0f, u2 = 1.0f;
-    
-    for (int i = 0; i < 4; i++) {
-        if (p[i] == 0) {
-            // 线段平行于边界
-            if (q[i] < 0) {
-                return false; // 完全在外部
-            }
-        } else {
-            float t = q[i] / p[i];
-            if (p[i] < 0) {
-                // 从外部进入
-                if (t > u1) u1 = t;
-            } else {
-                // 从内部离开
-                if (t < u2) u2 = t;
-            }
-        }
-    }
-    
-    if (u1 > u2) {
-        return false; // 线段完全在外部
-    }
-    
-    // 计算裁剪后的端点
-    float newX1 = x1 + u1 * dx;
-    float newY1 = y1 + u1 * dy;
-    float newX2 = x1 + u2 * dx;
-    float newY2 = y1 + u2 * dy;
-    
-    x1 = newX1;
-    y1 = newY1;
-    x2 = newX2;
-    y2 = newY2;
-    
-    return true;
+// Liang-Barsky裁剪：所有直线、多段线和曲线一起按结构数组批量裁剪，被裁剪的图形替换为副本（可撤销）
+void MainWindow::ApplyClipping() {
+    ClipWindow window;
+    window.xmin = min(m_clipRectStart.x, m_clipRectEnd.x);
+    window.ymin = min(m_clipRectStart.y, m_clipRectEnd.y);
+    window.xmax = max(m_clipRectStart.x, m_clipRectEnd.x);
+    window.ymax = max(m_clipRectStart.y, m_clipRectEnd.y);
+
+    size_t clippedCount = m_graphicsEngine->ClipSegmentShapes(&window, 1);
+
+    LOG_INFO("Liang-Barsky裁剪完成，修改图形 %zu 个\n", clippedCount);
 }
 
-void MainWindow::ApplyClipping() {
+void MainWindow::ApplyPolygonClippingSH() {
     float xmin = min(m_clipRectStart.x, m_clipRectEnd.x);
     float ymin = min(m_clipRectStart.y, m_clipRectEnd.y);
     float xmax = max(m_clipRectStart.x, m_clipRectEnd.x);
@@ -1267,142 +1338,41 @@ void MainWindow::ApplyClipping() {
     auto &shapes = m_graphicsEngine->GetShapes();
     std::vector<std::shared_ptr<Shape>> newShapes;
     
+    // 所有多边形的顶点收集到一个缓冲中，一次批量裁剪
+    std::vector<std::shared_ptr<Polygon>> polygons;
+    PolygonArena input, output;
     for (const auto &shape : shapes) {
-        ShapeType type = shape->GetType();
-        
-        // 对所有直线类型进行裁剪
-        if (type == ShapeType::LINE) {
-            D2D1_POINT_2F start, end;
-            LineWidth lineWidth = LineWidth::WIDTH_1PX;
-            LineStyle lineStyle = LineStyle::SOLID;
-            std::shared_ptr<Shape> clippedShape;
-            
-            // 尝试转换为不同类型的直线并获取端点
-            if (auto line = std::dynamic_pointer_cast<Line>(shape)) {
-                start = line->GetStart();
-                end = line->GetEnd();
-                lineWidth = line->GetLineWidth();
-                lineStyle = line->GetLineStyle();
-                
-                float x1 = start.x, y1 = start.y;
-                float x2 = end.x, y2 = end.y;
-                
-                if (LiangBarskyClip(x1, y1, x2, y2, xmin, ymin, xmax, ymax)) {
-                    // 创建裁剪后的Line
-                    clippedShape = std::make_shared<Line>(
-                        D2D1::Point2F(x1, y1),
-                        D2D1::Point2F(x2, y2)
-                    );
-                } else {
-                    // 完全在外部，保留原始直线
-                    clippedShape = line;
-                }
-            } else if (auto midLine = std::dynamic_pointer_cast<MidpointLine>(shape)) {
-                start = midLine->GetStart();
-                end = midLine->GetEnd();
-                lineWidth = midLine->GetLineWidth();
-                lineStyle = midLine->GetLineStyle();
-                
-                float x1 = start.x, y1 = start.y;
-                float x2 = end.x, y2 = end.y;
-                
-                if (LiangBarskyClip(x1, y1, x2, y2, xmin, ymin, xmax, ymax)) {
-                    // 创建裁剪后的MidpointLine
-                    clippedShape = std::make_shared<MidpointLine>(
-                        D2D1::Point2F(x1, y1),
-                        D2D1::Point2F(x2, y2)
-                    );
-                } else {
-                    // 完全在外部，保留原始直线
-                    clippedShape = midLine;
-                }
-            } else if (auto bresLine = std::dynamic_pointer_cast<BresenhamLine>(shape)) {
-                start = bresLine->GetStart();
-                end = bresLine->GetEnd();
-                lineWidth = bresLine->GetLineWidth();
-                lineStyle = bresLine->GetLineStyle();
-                
-                float x1 = start.x, y1 = start.y;
-                float x2 = end.x, y2 = end.y;
-                
-                if (LiangBarskyClip(x1, y1, x2, y2, xmin, ymin, xmax, ymax)) {
-                    // 创建裁剪后的BresenhamLine
-                    clippedShape = std::make_shared<BresenhamLine>(
-                        D2D1::Point2F(x1, y1),
-                        D2D1::Point2F(x2, y2)
-                    );
-                } else {
-                    // 完全在外部，保留原始直线
-                    clippedShape = bresLine;
-                }
-            }
-            
-            if (clippedShape) {
-                clippedShape->SetLineWidth(lineWidth);
-                clippedShape->SetLineStyle(lineStyle);
-                newShapes.push_back(clippedShape);
+        if (shape->GetType() == ShapeType::POLYGON) {
+            if (auto polygon = std::dynamic_pointer_cast<Polygon>(shape)) {
+                const auto &points = polygon->GetPoints();
+                input.Add(points.data(), points.size());
+                polygons.push_back(polygon);
             }
-        } else {
-            // 保留其他类型的图元
-            newShapes.push_back(shape);
         }
     }
+    PolygonClipping::SutherlandHodgmanClipBatch(input, xmin, ymin, xmax, ymax, output);
     
-    // 清空原有图元并添加裁剪后的图元
-    m_graphicsEngine->ClearAllShapes();
-    for (const auto &shape : newShapes) {
-        m_graphicsEngine->AddShape(shape);
-    }
-    
-    OutputDebugStringA("Liang-Barsky裁剪完成\n");
-}
-
-void MainWindow::ApplyPolygonClippingSH() {
-    float xmin = min(m_clipRectStart.x, m_clipRectEnd.x);
-    float ymin = min(m_clipRectStart.y, m_clipRectEnd.y);
-    float xmax = max(m_clipRectStart.x, m_clipRectEnd.x);
-    float ymax = max(m_clipRectStart.y, m_clipRectEnd.y);
-    
-    char debugMsg[256];
-    sprintf_s(debugMsg, "开始SH裁剪，裁剪区域: (%.1f,%.1f)-(%.1f,%.1f)\n", xmin, ymin, xmax, ymax);
-    OutputDebugStringA(debugMsg);
-    
-    auto &shapes = m_graphicsEngine->GetShapes();
-    auto selectedShape = m_graphicsEngine->GetSelectedShape();
-    std::vector<std::shared_ptr<Shape>> newShapes;
-    
-    int polygonCount = 0;
+    size_t next = 0;
     int clippedCount = 0;
-    
     for (const auto &shape : shapes) {
         if (shape->GetType() == ShapeType::POLYGON) {
-            polygonCount++;
-            auto polygon = std::dynamic_pointer_cast<Polygon>(shape);
-            if (polygon) {
-                auto points = polygon->GetPoints();
-                sprintf_s(debugMsg, "处理多边形 #%d，原始顶点数: %zu\n", polygonCount, points.size());
-                OutputDebugStringA(debugMsg);
+            if (next < polygons.size() && polygons[next] == shape) {
+                const auto &polygon = polygons[next];
+                size_t count = output.Size(next);
+                const D2D1_POINT_2F *clippedPoints = output.Points(next);
+                ++next;
                 
-                auto clippedPoints = SutherlandHodgmanClip(points, xmin, ymin, xmax, ymax);
-                
-                sprintf_s(debugMsg, "裁剪后顶点数: %zu\n", clippedPoints.size());
-                OutputDebugStringA(debugMsg);
-                
-                if (clippedPoints.size() >= 3) {
+                if (count >= 3) {
                     // 创建裁剪后的多边形（Polygon类会自动封闭）
-                    auto clippedPolygon = std::make_shared<Polygon>(clippedPoints);
+                    auto clippedPolygon = MakeDocumentShared<Polygon>(
+                        std::vector<D2D1_POINT_2F>(clippedPoints, clippedPoints + count));
                     clippedPolygon->SetLineWidth(polygon->GetLineWidth());
                     clippedPolygon->SetLineStyle(polygon->GetLineStyle());
                     newShapes.push_back(clippedPolygon);
                     clippedCount++;
-                    OutputDebugStringA("  -> 裁剪后保留（有效多边形）\n");
-                } else if (clippedPoints.empty()) {
+                } else if (count == 0) {
                     // 多边形完全在裁剪窗口外，保留原多边形
                     newShapes.push_back(shape);
-                    OutputDebugStringA("  -> 保留原多边形（完全在窗口外）\n");
-                } else {
-                    sprintf_s(debugMsg, "  -> 丢弃（裁剪后顶点数=%zu，无效）\n", clippedPoints.size());
-                    OutputDebugStringA(debugMsg);
                 }
                 // 如果裁剪后顶点数在1-2之间，说明多边形与裁剪窗口相交但被裁剪成无效图形，不保留
             }
@@ -1412,16 +1382,10 @@ void MainWindow::ApplyPolygonClippingSH() {
         }
     }
     
-    sprintf_s(debugMsg, "找到 %d 个多边形，裁剪后保留 %d 个\n", polygonCount, clippedCount);
-    OutputDebugStringA(debugMsg);
+    // 用裁剪后的图元替换原有图元
+    m_graphicsEngine->ReplaceShapes(std::move(newShapes));
     
-    // 清空原有图元并添加裁剪后的图元
-    m_graphicsEngine->ClearAllShapes();
-    for (const auto &shape : newShapes) {
-        m_graphicsEngine->AddShape(shape);
-    }
-    
-    OutputDebugStringA("Sutherland-Hodgman多边形裁剪完成\n");
+    LOG_INFO("Sutherland-Hodgman多边形裁剪完成，%zu 个多边形，保留 %d 个\n", polygons.size(), clippedCount);
 }
 
 void MainWindow::ApplyPolygonClippingWA() {
@@ -1430,27 +1394,47 @@ void MainWindow::ApplyPolygonClippingWA() {
     float xmax = max(m_clipRectStart.x, m_clipRectEnd.x);
     float ymax = max(m_clipRectStart.y, m_clipRectEnd.y);
     
+    // 裁剪窗口作为一般多边形参与裁剪
+    std::vector<D2D1_POINT_2F> clipPolygon = PolygonClipping::RectPolygon(xmin, ymin, xmax, ymax);
+
     auto &shapes = m_graphicsEngine->GetShapes();
     std::vector<std::shared_ptr<Shape>> newShapes;
+    int fallbackCount = 0;
+    int droppedCount = 0;
     
     for (const auto &shape : shapes) {
         if (shape->GetType() == ShapeType::POLYGON) {
             auto polygon = std::dynamic_pointer_cast<Polygon>(shape);
             if (polygon) {
-                auto points = polygon->GetPoints();
-                auto clippedPoints = WeilerAthertonClip(points, xmin, ymin, xmax, ymax);
+                // 凹多边形被窗口切开时会得到多个结果多边形
+                const auto &points = polygon->GetPoints();
+                std::vector<D2D1_POINT_2F> subject(points.begin(), points.end());
+                std::vector<std::vector<D2D1_POINT_2F>> clippedPolygons;
+                if (!PolygonClipping::WeilerAthertonClip(subject, clipPolygon, clippedPolygons)) {
+                    ++fallbackCount;
+                    // 顶点恰好落在窗口边上等退化情况无法消除：窗口是矩形，改用Sutherland-Hodgman裁剪
+                    // （凹多边形被切成多块时结果会带有沿窗口边的连接边）
+                    std::vector<D2D1_POINT_2F> clipped = PolygonClipping::SutherlandHodgmanClip(subject, xmin, ymin, xmax, ymax);
+                    if (clipped.size() >= 3) {
+                        clippedPolygons.push_back(std::move(clipped));
+                    } else if (!clipped.empty()) {
+                        // 与窗口相交但裁剪成无效图形，不保留
+                        ++droppedCount;
+                        continue;
+                    }
+                }
                 
-                if (clippedPoints.size() >= 3) {
+                if (clippedPolygons.empty()) {
+                    // 多边形完全在裁剪窗口外，保留原多边形
+                    newShapes.push_back(shape);
+                }
+                for (const auto &clippedPoints : clippedPolygons) {
                     // 创建裁剪后的多边形（Polygon类会自动封闭）
-                    auto clippedPolygon = std::make_shared<Polygon>(clippedPoints);
+                    auto clippedPolygon = MakeDocumentShared<Polygon>(clippedPoints);
                     clippedPolygon->SetLineWidth(polygon->GetLineWidth());
                     clippedPolygon->SetLineStyle(polygon->GetLineStyle());
                     newShapes.push_back(clippedPolygon);
-                } else if (clippedPoints.empty()) {
-                    // 多边形完全在裁剪窗口外，保留原多边形
-                    newShapes.push_back(shape);
                 }
-                // 如果裁剪后顶点数在1-2之间，说明多边形与裁剪窗口相交但被裁剪成无效图形，不保留
             }
         } else {
             // 保留其他类型的图元
@@ -1458,568 +1442,260 @@ void MainWindow::ApplyPolygonClippingWA() {
         }
     }
     
-    // 清空原有图元并添加裁剪后的图元
-    m_graphicsEngine->ClearAllShapes();
-    for (const auto &shape : newShapes) {
-        m_graphicsEngine->AddShape(shape);
-    }
-    
-    OutputDebugStringA("Weiler-Atherton多边形裁剪完成\n");
-}
-
-// Sutherland-Hodgman多边形裁剪算法
-std::vector<D2D1_POINT_2F> MainWindow::SutherlandHodgmanClip(
-    const std::vector<D2D1_POINT_2F>& polygon,
-    float xmin, float ymin, float xmax, float ymax) {
+    // 用裁剪后的图元替换原有图元
+    m_graphicsEngine->ReplaceShapes(std::move(newShapes));
     
-    if (polygon.size() < 3) return polygon;
-    
-    std::vector<D2D1_POINT_2F> output = polygon;
-    
-    // 对四条边界依次裁剪：左、右、下、上
-    for (int edge = 0; edge < 4; edge++) {
-        if (output.empty()) break;
-        
-        std::vector<D2D1_POINT_2F> input = output;
-        output.clear();
-        
-        for (size_t i = 0; i < input.size(); i++) {
-            D2D1_POINT_2F current = input[i];
-            D2D1_POINT_2F next = input[(i + 1) % input.size()];
-            
-            bool currentInside = false;
-            bool nextInside = false;
-            D2D1_POINT_2F intersection;
-            
-            // 根据当前边界判断点是否在内侧，并计算交点
-            switch (edge) {
-            case 0: // 左边界 x = xmin
-                currentInside = (current.x >= xmin);
-                nextInside = (next.x >= xmin);
-                if (currentInside != nextInside) {
-                    float t = (xmin - current.x) / (next.x - current.x);
-                    intersection = D2D1::Point2F(xmin, current.y + t * (next.y - current.y));
-                }
-                break;
-            case 1: // 右边界 x = xmax
-                currentInside = (current.x <= xmax);
-                nextInside = (next.x <= xmax);
-                if (currentInside != nextInside) {
-                    float t = (xmax - current.x) / (next.x - current.x);
-                    intersection = D2D1::Point2F(xmax, current.y + t * (next.y - current.y));
-                }
-                break;
-            case 2: // 下边界 y = ymin
-                currentInside = (current.y >= ymin);
-                nextInside = (next.y >= ymin);
-                if (currentInside != nextInside) {
-                    float t = (ymin - current.y) / (next.y - current.y);
-                    intersection = D2D1::Point2F(current.x + t * (next.x - current.x), ymin);
-                }
-                break;
-            case 3: // 上边界 y = ymax
-                currentInside = (current.y <= ymax);
-                nextInside = (next.y <= ymax);
-                if (currentInside != nextInside) {
-                    float t = (ymax - current.y) / (next.y - current.y);
-                    intersection = D2D1::Point2F(current.x + t * (next.x - current.x), ymax);
-                }
-                break;
-            }
-            
-            // 根据当前点和下一点的位置关系添加顶点
-            if (currentInside) {
-                output.push_back(current);
-                if (!nextInside) {
-                    // 从内到外，添加交点
-                    output.push_back(intersection);
-                }
-            } else if (nextInside) {
-                // 从外到内，添加交点
-                output.push_back(intersection);
-            }
-        }
+    if (fallbackCount > 0) {
+        LOG_WARN("Weiler-Atherton裁剪遇到无法消除的退化情况，%d 个多边形改用Sutherland-Hodgman裁剪，其中 %d 个裁剪后无效已丢弃\n",
+                 fallbackCount, droppedCount);
     }
-    
-    return output;
+    LOG_INFO("Weiler-Atherton多边形裁剪完成\n");
 }
 
-// Weiler-Atherton多边形裁剪算法（简化版本）
-std::vector<D2D1_POINT_2F> MainWindow::WeilerAthertonClip(
-    const std::vector<D2D1_POINT_2F>& polygon,
-    float xmin, float ymin, float xmax, float ymax) {
-    
-    // 对于简化实现，我们使用Sutherland-Hodgman算法
-    // 完整的Weiler-Atherton算法较为复杂，需要处理多个输出多边形
-    // 这里先使用SH算法作为基础实现
-    return SutherlandHodgmanClip(polygon, xmin, ymin, xmax, ymax);
-}
-
-void MainWindow::DrawIntersectionPoints(ID2D1RenderTarget *rt) {
-    auto points = m_graphicsEngine->getIntersectionPoints();
+void MainWindow::DrawIntersectionPoints(OverlayList &overlay) {
+    const auto &points = m_graphicsEngine->getIntersectionPoints();
     if (points.empty()) return;
 
-    // 惰性初始化 DirectWrite
-    if (!m_pDW) {
-        DWriteCreateFactory(
-            DWRITE_FACTORY_TYPE_SHARED,
-            __uuidof(IDWriteFactory),
-            reinterpret_cast<IUnknown **>(&m_pDW));
-        if (m_pDW)
-            m_pDW->CreateTextFormat(
-                L"Consolas", nullptr,
-                DWRITE_FONT_WEIGHT_NORMAL,
-                DWRITE_FONT_STYLE_NORMAL,
-                DWRITE_FONT_STRETCH_NORMAL,
-                12.0f, L"en-us", &m_pTF);
-    }
-    if (!m_pTF) return;
-
-    ID2D1SolidColorBrush *br = nullptr;
-    ID2D1SolidColorBrush *bg = nullptr;
-    rt->CreateSolidColorBrush(D2D1::ColorF(D2D1::ColorF::Red), &br);
-    rt->CreateSolidColorBrush(D2D1::ColorF(D2D1::ColorF::White, 0.9f), &bg);
-    if (!br || !bg) {
-        if (br) br->Release();
-        if (bg) bg->Release();
-        return;
-    }
-
+    const D2D1_COLOR_F red = D2D1::ColorF(D2D1::ColorF::Red);
     for (const auto &p : points) {
         // 十字
         float sz = 8.0f;
-        rt->DrawLine({p.x - sz, p.y}, {p.x + sz, p.y}, br, 2.0f);
-        rt->DrawLine({p.x, p.y - sz}, {p.x, p.y + sz}, br, 2.0f);
-        rt->FillEllipse(D2D1::Ellipse(p, 4.0f, 4.0f), br);
+        overlay.DrawLine({p.x - sz, p.y}, {p.x + sz, p.y}, red, 2.0f);
+        overlay.DrawLine({p.x, p.y - sz}, {p.x, p.y + sz}, red, 2.0f);
+        overlay.FillEllipse(p, 4.0f, 4.0f, red);
 
-        // 坐标文本
+        // 坐标文本（布局按文本缓存，交点不变时复用）
         WCHAR txt[64];
         swprintf_s(txt, L"%.1f, %.1f", p.x, p.y);
-        IDWriteTextLayout *layout = nullptr;
-        m_pDW->CreateTextLayout(txt, wcslen(txt), m_pTF, 200, 30, &layout);
-        if (layout) {
-            DWRITE_TEXT_METRICS m;
-            layout->GetMetrics(&m);
-            D2D1_RECT_F rc = {p.x + 10, p.y - 20, p.x + 10 + m.width + 4, p.y - 20 + m.height + 4};
-            rt->FillRectangle(&rc, bg);
-            rt->DrawRectangle(&rc, br, 1.0f);
-            rt->DrawTextLayout({p.x + 12, p.y - 18}, layout, br);
-            layout->Release();
-        }
+        overlay.DrawLabel(txt, L"Consolas", 12.0f, D2D1::Point2F(p.x + 12, p.y - 18), false, 200, 30, 2.0f,
+                          red, D2D1::ColorF(D2D1::ColorF::White, 0.9f));
     }
-    br->Release();
-    bg->Release();
 }
-void MainWindow::DrawSelectedIntersectionShapes(ID2D1RenderTarget *pRenderTarget) {
+void MainWindow::DrawSelectedIntersectionShapes(OverlayList &overlay) {
     if (m_currentMode != DrawingMode::INTERSECT) return;
 
     auto shape1 = m_graphicsEngine->getFirstIntersectionShape();
     auto shape2 = m_graphicsEngine->getSecondIntersectionShape();
 
-    if (!shape1 && !shape2) return;
-
-    ID2D1SolidColorBrush *highlightBrush = nullptr;
-    HRESULT hr = pRenderTarget->CreateSolidColorBrush(
-        D2D1::ColorF(D2D1::ColorF::Yellow), &highlightBrush);
-
-    if (SUCCEEDED(hr) && highlightBrush) {
-        // 创建虚线笔划样式用于高亮
-        ID2D1StrokeStyle *dashStrokeStyle = nullptr;
-        ID2D1Factory *factory = nullptr;
-        pRenderTarget->GetFactory(&factory);
-
-        if (factory) {
-            float dashes[] = {5.0f, 5.0f};
-            factory->CreateStrokeStyle(
-                D2D1::StrokeStyleProperties(
-                    D2D1_CAP_STYLE_FLAT,
-                    D2D1_CAP_STYLE_FLAT,
-                    D2D1_CAP_STYLE_ROUND,
-                    D2D1_LINE_JOIN_MITER,
-                    10.0f,
-                    D2D1_DASH_STYLE_CUSTOM,
-                    0.0f),
-                dashes,
-                ARRAYSIZE(dashes),
-                &dashStrokeStyle);
-        }
-
-        // 绘制选中的图元
-        if (shape1) {
-            shape1->Draw(pRenderTarget, highlightBrush, highlightBrush, dashStrokeStyle);
-        }
-        if (shape2) {
-            shape2->Draw(pRenderTarget, highlightBrush, highlightBrush, dashStrokeStyle);
-        }
-
-        if (dashStrokeStyle) dashStrokeStyle->Release();
-        if (factory) factory->Release();
-        highlightBrush->Release();
+    // 以高亮虚线绘制选中的图元；浮层中放副本，绘制线程读取时这里的图形仍可被编辑
+    const D2D1_COLOR_F yellow = D2D1::ColorF(D2D1::ColorF::Yellow);
+    if (shape1) {
+        overlay.DrawShape(shape1->Clone(), yellow, true);
+    }
+    if (shape2) {
+        overlay.DrawShape(shape2->Clone(), yellow, true);
     }
 }
 
 void MainWindow::OnPaint() {
-    if (m_graphicsEngine) {
-        m_graphicsEngine->BeginDraw();
-        m_graphicsEngine->Render();
-
-        // 绘制临时形状（预览）
-        if (m_isDrawing && m_tempShape) {
-            ID2D1SolidColorBrush *tempBrush = nullptr;
-            HRESULT hr = m_graphicsEngine->GetRenderTarget()->CreateSolidColorBrush(
-                D2D1::ColorF(D2D1::ColorF::LightBlue), &tempBrush);
-
-            if (SUCCEEDED(hr) && tempBrush) {
-                m_tempShape->Draw(m_graphicsEngine->GetRenderTarget(), tempBrush, tempBrush, nullptr);
-                tempBrush->Release();
-            }
-        }
-
-        // 绘制当前正在绘制的曲线
-        if (m_isDrawingCurve && m_currentCurve) {
-            ID2D1SolidColorBrush *tempBrush = nullptr;
-            HRESULT hr = m_graphicsEngine->GetRenderTarget()->CreateSolidColorBrush(
-                D2D1::ColorF(D2D1::ColorF::Blue), &tempBrush);
-
-            if (SUCCEEDED(hr) && tempBrush) {
-                m_currentCurve->Draw(m_graphicsEngine->GetRenderTarget(), tempBrush, tempBrush, nullptr);
-                tempBrush->Release();
-            }
-        }
-
-        // 绘制多段线预览（已确定的线段）
-        if (m_currentMode == DrawingMode::POLYLINE && m_polyPoints.size() >= 2) {
-            ID2D1SolidColorBrush *polyBrush = nullptr;
-            HRESULT hr = m_graphicsEngine->GetRenderTarget()->CreateSolidColorBrush(
-                D2D1::ColorF(D2D1::ColorF::Green), &polyBrush);
+    // 这里只记录浮层并把帧交给绘制线程，不等待绘制
+    ValidateRect(m_hwnd, nullptr);
+    if (!m_graphicsEngine) return;
 
-            if (SUCCEEDED(hr) && polyBrush) {
-                // 绘制已确定的多段线线段
-                for (size_t i = 1; i < m_polyPoints.size(); i++) {
-                    m_graphicsEngine->GetRenderTarget()->DrawLine(
-                        m_polyPoints[i - 1], m_polyPoints[i], polyBrush, 2.0f);
-                }
-                polyBrush->Release();
-            }
-        }
-
-        // 绘制多段线当前线段预览
-        if (m_currentMode == DrawingMode::POLYLINE && m_tempPolyLine) {
-            ID2D1SolidColorBrush *tempBrush = nullptr;
-            HRESULT hr = m_graphicsEngine->GetRenderTarget()->CreateSolidColorBrush(
-                D2D1::ColorF(D2D1::ColorF::LightBlue), &tempBrush);
-
-            if (SUCCEEDED(hr) && tempBrush) {
-                m_tempPolyLine->Draw(m_graphicsEngine->GetRenderTarget(), tempBrush, tempBrush, nullptr);
-                tempBrush->Release();
-            }
-        }
+    // 预览和标记都在文档坐标中，与图形使用同一视图变换。
+    // 预览图形随鼠标原地修改，浮层中一律放副本
+    OverlayList overlay;
 
-        // 绘制正在编辑的多点Bezier曲线
-        if (m_isDrawingMultiBezier && m_currentMultiBezier) {
-            ID2D1SolidColorBrush *tempBrush = nullptr;
-            HRESULT hr = m_graphicsEngine->GetRenderTarget()->CreateSolidColorBrush(
-                D2D1::ColorF(D2D1::ColorF::Blue), &tempBrush);
-
-            if (SUCCEEDED(hr) && tempBrush) {
-                m_currentMultiBezier->Draw(m_graphicsEngine->GetRenderTarget(), tempBrush, tempBrush, nullptr);
-                tempBrush->Release();
-            }
-        }
+    // 绘制临时形状（预览）
+    if (m_isDrawing && m_tempShape) {
+        overlay.DrawShape(m_tempShape->Clone(), D2D1::ColorF(D2D1::ColorF::LightBlue));
+    }
 
-        // 绘制正在绘制的多边形预览
-        if (m_currentMode == DrawingMode::POLYGON && m_isDrawingPolygon && m_currentPolygon) {
-            ID2D1SolidColorBrush *tempBrush = nullptr;
-            HRESULT hr = m_graphicsEngine->GetRenderTarget()->CreateSolidColorBrush(
-                D2D1::ColorF(D2D1::ColorF::Green), &tempBrush);
+    // 绘制当前正在绘制的曲线
+    if (m_isDrawingCurve && m_currentCurve) {
+        overlay.DrawShape(m_currentCurve->Clone(), D2D1::ColorF(D2D1::ColorF::Blue));
+    }
 
-            if (SUCCEEDED(hr) && tempBrush) {
-                m_currentPolygon->Draw(m_graphicsEngine->GetRenderTarget(), tempBrush, tempBrush, nullptr);
-                tempBrush->Release();
-            }
+    // 绘制多段线预览（已确定的线段）
+    if (m_currentMode == DrawingMode::POLYLINE && m_polyPoints.size() >= 2) {
+        for (size_t i = 1; i < m_polyPoints.size(); i++) {
+            overlay.DrawLine(m_polyPoints[i - 1], m_polyPoints[i], D2D1::ColorF(D2D1::ColorF::Green), 2.0f);
         }
+    }
 
-        // 绘制红色闪烁的非法点提示
-        if (m_showInvalidPointFlash) {
-            ID2D1SolidColorBrush *redBrush = nullptr;
-            HRESULT hr = m_graphicsEngine->GetRenderTarget()->CreateSolidColorBrush(
-                D2D1::ColorF(D2D1::ColorF::Red), &redBrush);
-
-            if (SUCCEEDED(hr) && redBrush) {
-                D2D1_ELLIPSE ellipse = D2D1::Ellipse(m_invalidPoint, 8.0f, 8.0f);
-                m_graphicsEngine->GetRenderTarget()->FillEllipse(ellipse, redBrush);
-                redBrush->Release();
-            }
-        }
+    // 绘制多段线当前线段预览
+    if (m_currentMode == DrawingMode::POLYLINE && m_tempPolyLine) {
+        overlay.DrawShape(m_tempPolyLine->Clone(), D2D1::ColorF(D2D1::ColorF::LightBlue));
+    }
 
-        // 绘制切线预览和切点坐标
-        if (m_currentMode == DrawingMode::TANGENT && m_isDrawingTangent && m_selectedCircleForTangent && !m_tempTangents.empty()) {
-            ID2D1RenderTarget *pRenderTarget = m_graphicsEngine->GetRenderTarget();
+    // 绘制正在编辑的多点Bezier曲线
+    if (m_isDrawingMultiBezier && m_currentMultiBezier) {
+        overlay.DrawShape(m_currentMultiBezier->Clone(), D2D1::ColorF(D2D1::ColorF::Blue));
+    }
 
-            ID2D1SolidColorBrush *tempBrush = nullptr;
-            HRESULT hr = pRenderTarget->CreateSolidColorBrush(D2D1::ColorF(D2D1::ColorF::Orange), &tempBrush);
+    // 绘制正在绘制的多边形预览
+    if (m_currentMode == DrawingMode::POLYGON && m_isDrawingPolygon && m_currentPolygon) {
+        overlay.DrawShape(m_currentPolygon->Clone(), D2D1::ColorF(D2D1::ColorF::Green));
+    }
 
-            if (SUCCEEDED(hr) && tempBrush) {
-                // 确保 DirectWrite 工厂和文本格式已初始化
-                if (!m_pDW) {
-                    DWriteCreateFactory(
-                        DWRITE_FACTORY_TYPE_SHARED,
-                        __uuidof(IDWriteFactory),
-                        reinterpret_cast<IUnknown **>(&m_pDW));
-                }
-                if (!m_pTF && m_pDW) {
-                    m_pDW->CreateTextFormat(
-                        L"Consolas", nullptr,
-                        DWRITE_FONT_WEIGHT_NORMAL,
-                        DWRITE_FONT_STYLE_NORMAL,
-                        DWRITE_FONT_STRETCH_NORMAL,
-                        12.0f, L"en-us", &m_pTF);
-                }
+    // 绘制红色闪烁的非法点提示
+    if (m_showInvalidPointFlash) {
+        overlay.FillEllipse(m_invalidPoint, 8.0f, 8.0f, D2D1::ColorF(D2D1::ColorF::Red));
+    }
 
-                for (auto &tangent : m_tempTangents) {
-                    if (!tangent) continue;
+    // 绘制切线预览和切点坐标
+    if (m_currentMode == DrawingMode::TANGENT && m_isDrawingTangent && m_selectedCircleForTangent && !m_tempTangents.empty()) {
+        const D2D1_COLOR_F orange = D2D1::ColorF(D2D1::ColorF::Orange);
+        for (auto &tangent : m_tempTangents) {
+            if (!tangent) continue;
 
-                    // 绘制切线
-                    tangent->Draw(pRenderTarget, tempBrush, tempBrush, nullptr);
+            // 绘制切线
+            overlay.DrawShape(tangent->Clone(), orange);
 
-                    // 获取切点
-                    D2D1_POINT_2F endPoint = tangent->GetEnd();
+            // 获取切点
+            D2D1_POINT_2F endPoint = tangent->GetEnd();
 
-                    // 绘制切点标记
-                    D2D1_ELLIPSE tangentPoint = D2D1::Ellipse(endPoint, 4.0f, 4.0f);
-                    pRenderTarget->FillEllipse(tangentPoint, tempBrush);
+            // 绘制切点标记
+            overlay.FillEllipse(endPoint, 4.0f, 4.0f, orange);
 
-                    // 绘制坐标文本
-                    if (m_pTF) {
-                        WCHAR coordText[100];
-                        swprintf_s(coordText, L"切点: (%.1f, %.1f)", endPoint.x, endPoint.y);
+            // 绘制坐标文本
+            WCHAR coordText[100];
+            swprintf_s(coordText, L"切点: (%.1f, %.1f)", endPoint.x, endPoint.y);
 
-                        // 计算文本位置
-                        float textX = endPoint.x + 10.0f;
-                        float textY = endPoint.y - 15.0f;
+            // 计算文本位置
+            float textX = endPoint.x + 10.0f;
+            float textY = endPoint.y - 15.0f;
 
-                        // 绘制文本背景
-                        ID2D1SolidColorBrush *bgBrush = nullptr;
-                        if (SUCCEEDED(pRenderTarget->CreateSolidColorBrush(D2D1::ColorF(D2D1::ColorF::White, 0.8f), &bgBrush))) {
-                            D2D1_RECT_F textRect = {textX, textY, textX + 120.0f, textY + 20.0f};
-                            pRenderTarget->FillRectangle(textRect, bgBrush);
-                            pRenderTarget->DrawRectangle(textRect, tempBrush, 1.0f);
-                            bgBrush->Release();
-                        }
+            // 绘制文本背景
+            D2D1_RECT_F textRect = {textX, textY, textX + 120.0f, textY + 20.0f};
+            overlay.FillRectangle(textRect, D2D1::ColorF(D2D1::ColorF::White, 0.8f));
+            overlay.DrawRectangle(textRect, orange, 1.0f);
 
-                        // 绘制文本
-                        pRenderTarget->DrawText(
-                            coordText,
-                            wcslen(coordText),
-                            m_pTF,
-                            D2D1::RectF(textX + 2, textY + 2, textX + 120.0f, textY + 20.0f),
-                            tempBrush);
-                    }
-                }
-                tempBrush->Release();
-            }
+            // 绘制文本
+            overlay.DrawString(coordText, L"Consolas", 12.0f,
+                               D2D1::RectF(textX + 2, textY + 2, textX + 120.0f, textY + 20.0f), orange);
         }
+    }
 
-        // 绘制圆心标记和坐标
-        if (m_currentMode == DrawingMode::CENTER && m_showingCenter && m_selectedCircle) {
-            ID2D1RenderTarget *pRenderTarget = m_graphicsEngine->GetRenderTarget();
-
-            // 创建红色画笔用于绘制圆心标记
-            ID2D1SolidColorBrush *centerBrush = nullptr;
-            HRESULT hr = pRenderTarget->CreateSolidColorBrush(
-                D2D1::ColorF(D2D1::ColorF::Red), &centerBrush);
-
-            if (SUCCEEDED(hr) && centerBrush) {
-                // 绘制圆心十字标记
-                float crossSize = 8.0f;
-                pRenderTarget->DrawLine(
-                    D2D1::Point2F(m_centerPoint.x - crossSize, m_centerPoint.y),
-                    D2D1::Point2F(m_centerPoint.x + crossSize, m_centerPoint.y),
-                    centerBrush, 2.0f);
-
-                pRenderTarget->DrawLine(
-                    D2D1::Point2F(m_centerPoint.x, m_centerPoint.y - crossSize),
-                    D2D1::Point2F(m_centerPoint.x, m_centerPoint.y + crossSize),
-                    centerBrush, 2.0f);
-
-                // 绘制圆心点
-                D2D1_ELLIPSE centerDot = D2D1::Ellipse(m_centerPoint, 3.0f, 3.0f);
-                pRenderTarget->FillEllipse(centerDot, centerBrush);
-
-                // 创建文本格式和画笔
-                IDWriteTextFormat *pTextFormat = nullptr;
-                IDWriteFactory *pDWriteFactory = nullptr;
-                DWriteCreateFactory(
-                    DWRITE_FACTORY_TYPE_SHARED,
-                    __uuidof(IDWriteFactory),
-                    reinterpret_cast<IUnknown **>(&pDWriteFactory));
-
-                if (pDWriteFactory) {
-                    pDWriteFactory->CreateTextFormat(
-                        L"Arial",
-                        NULL,
-                        DWRITE_FONT_WEIGHT_NORMAL,
-                        DWRITE_FONT_STYLE_NORMAL,
-                        DWRITE_FONT_STRETCH_NORMAL,
-                        12.0f,
-                        L"en-us",
-                        &pTextFormat);
-                }
+    // 绘制圆心标记和坐标
+    if (m_currentMode == DrawingMode::CENTER && m_showingCenter && m_selectedCircle) {
+        // 红色画笔用于绘制圆心标记
+        const D2D1_COLOR_F red = D2D1::ColorF(D2D1::ColorF::Red);
+
+        // 绘制圆心十字标记
+        float crossSize = 8.0f;
+        overlay.DrawLine(
+            D2D1::Point2F(m_centerPoint.x - crossSize, m_centerPoint.y),
+            D2D1::Point2F(m_centerPoint.x + crossSize, m_centerPoint.y),
+            red, 2.0f);
+
+        overlay.DrawLine(
+            D2D1::Point2F(m_centerPoint.x, m_centerPoint.y - crossSize),
+            D2D1::Point2F(m_centerPoint.x, m_centerPoint.y + crossSize),
+            red, 2.0f);
+
+        // 绘制圆心点
+        overlay.FillEllipse(m_centerPoint, 3.0f, 3.0f, red);
+
+        // 格式化坐标文本
+        WCHAR coordText[100];
+        swprintf_s(coordText, L"圆心: (%.1f, %.1f)", m_centerPoint.x, m_centerPoint.y);
+
+        D2D1_RECT_F textRect = D2D1::RectF(
+            m_centerPoint.x + 10.0f,
+            m_centerPoint.y - 20.0f,
+            m_centerPoint.x + 150.0f,
+            m_centerPoint.y);
+
+        // 绘制坐标文本背景和文本
+        overlay.FillRectangle(textRect, D2D1::ColorF(D2D1::ColorF::White, 0.7f));
+        overlay.DrawString(coordText, L"Arial", 12.0f, textRect, red);
+    }
 
-                if (pTextFormat) {
-                    // 格式化坐标文本
-                    WCHAR coordText[100];
-                    swprintf_s(coordText, L"圆心: (%.1f, %.1f)", m_centerPoint.x, m_centerPoint.y);
-
-                    // 绘制坐标文本背景
-                    ID2D1SolidColorBrush *textBgBrush = nullptr;
-                    pRenderTarget->CreateSolidColorBrush(
-                        D2D1::ColorF(D2D1::ColorF::White, 0.7f), &textBgBrush);
-
-                    if (textBgBrush) {
-                        D2D1_RECT_F textRect = D2D1::RectF(
-                            m_centerPoint.x + 10.0f,
-                            m_centerPoint.y - 20.0f,
-                            m_centerPoint.x + 150.0f,
-                            m_centerPoint.y);
-
-                        pRenderTarget->FillRectangle(textRect, textBgBrush);
-                        textBgBrush->Release();
-                    }
+    // 绘制交点
+    DrawIntersectionPoints(overlay);
+    DrawSelectedIntersectionShapes(overlay);
 
-                    // 绘制坐标文本
-                    D2D1_RECT_F textRect = D2D1::RectF(
-                        m_centerPoint.x + 10.0f,
-                        m_centerPoint.y - 20.0f,
-                        m_centerPoint.x + 150.0f,
-                        m_centerPoint.y);
-
-                    pRenderTarget->DrawText(
-                        coordText,
-                        wcslen(coordText),
-                        pTextFormat,
-                        textRect,
-                        centerBrush);
-
-                    pTextFormat->Release();
-                }
+    // 绘制裁剪矩形预览（包括直线裁剪和多边形裁剪）
+    if ((m_currentMode == DrawingMode::CLIP_LINES ||
+         m_currentMode == DrawingMode::CLIP_POLYGON_SH ||
+         m_currentMode == DrawingMode::CLIP_POLYGON_WA) && m_clipRectDrawing) {
+        D2D1::ColorF brushColor = (m_currentMode == DrawingMode::CLIP_LINES) ?
+            D2D1::ColorF(D2D1::ColorF::Blue, 0.5f) :
+            D2D1::ColorF(D2D1::ColorF::Green, 0.5f);
+
+        D2D1_RECT_F clipRect = D2D1::RectF(
+            min(m_clipRectStart.x, m_clipRectEnd.x),
+            min(m_clipRectStart.y, m_clipRectEnd.y),
+            max(m_clipRectStart.x, m_clipRectEnd.x),
+            max(m_clipRectStart.y, m_clipRectEnd.y)
+        );
+        overlay.DrawRectangle(clipRect, brushColor, 2.0f);
+    }
 
-                if (pDWriteFactory) pDWriteFactory->Release();
-                centerBrush->Release();
-            }
-        }
-        
-        // 绘制交点
-        DrawIntersectionPoints(m_graphicsEngine->GetRenderTarget());
-        DrawSelectedIntersectionShapes(m_graphicsEngine->GetRenderTarget());
-        
-        // 绘制裁剪矩形预览（包括直线裁剪和多边形裁剪）
-        if ((m_currentMode == DrawingMode::CLIP_LINES ||
-             m_currentMode == DrawingMode::CLIP_POLYGON_SH ||
-             m_currentMode == DrawingMode::CLIP_POLYGON_WA) && m_clipRectDrawing) {
-            ID2D1SolidColorBrush *clipBrush = nullptr;
-            D2D1::ColorF brushColor = (m_currentMode == DrawingMode::CLIP_LINES) ? 
-                D2D1::ColorF(D2D1::ColorF::Blue, 0.5f) : 
-                D2D1::ColorF(D2D1::ColorF::Green, 0.5f);
-            HRESULT hr = m_graphicsEngine->GetRenderTarget()->CreateSolidColorBrush(
-                brushColor, &clipBrush);
-            
-            if (SUCCEEDED(hr) && clipBrush) {
-                D2D1_RECT_F clipRect = D2D1::RectF(
-                    min(m_clipRectStart.x, m_clipRectEnd.x),
-                    min(m_clipRectStart.y, m_clipRectEnd.y),
-                    max(m_clipRectStart.x, m_clipRectEnd.x),
-                    max(m_clipRectStart.y, m_clipRectEnd.y)
-                );
-                m_graphicsEngine->GetRenderTarget()->DrawRectangle(clipRect, clipBrush, 2.0f);
-                clipBrush->Release();
-            }
-        }
-        
-        /* ----- 右上角模式提示 ----- */
-        ID2D1RenderTarget *rt = m_graphicsEngine->GetRenderTarget();
-        static IDWriteFactory *pDW = nullptr;
-        static IDWriteTextFormat *pTF = nullptr;
-        if (!pDW) {
-            DWriteCreateFactory(
-                DWRITE_FACTORY_TYPE_SHARED,
-                __uuidof(IDWriteFactory),
-                reinterpret_cast<IUnknown **>(&pDW));
-            if (pDW)
-                pDW->CreateTextFormat(
-                    L"Consolas", nullptr,
-                    DWRITE_FONT_WEIGHT_NORMAL,
-                    DWRITE_FONT_STYLE_NORMAL,
-                    DWRITE_FONT_STRETCH_NORMAL,
-                    14.0f, L"en-us", &pTF);
-        }
-
-        // 2. 组装当前模式字符串
-        const wchar_t *name = L"UNKNOWN";
-        switch (m_currentMode) {
-        case DrawingMode::SELECT: name = L"SELECT"; break;
-        case DrawingMode::LINE: name = L"LINE"; break;
-        case DrawingMode::MIDPOINT_LINE: name = L"MIDPOINT_LINE"; break;
-        case DrawingMode::BRESENHAM_LINE: name = L"BRESENHAM_LINE"; break;
-        case DrawingMode::MIDPOINT_CIRCLE: name = L"MIDPOINT_CIRCLE"; break;
-        case DrawingMode::BRESENHAM_CIRCLE: name = L"BRESENHAM_CIRCLE"; break;
-        case DrawingMode::CIRCLE: name = L"CIRCLE"; break;
-        case DrawingMode::RECTANGLE: name = L"RECTANGLE"; break;
-        case DrawingMode::TRIANGLE: name = L"TRIANGLE"; break;
-        case DrawingMode::DIAMOND: name = L"DIAMOND"; break;
-        case DrawingMode::PARALLELOGRAM: name = L"PARALLELOGRAM"; break;
-        case DrawingMode::POLYLINE: name = L"POLYLINE"; break;
-        case DrawingMode::CURVE: name = L"CURVE"; break;
-        case DrawingMode::PERPENDICULAR: name = L"PERPENDICULAR"; break;
-        case DrawingMode::TANGENT: name = L"TANGENT"; break;
-        case DrawingMode::CENTER: name = L"CENTER"; break;
-        case DrawingMode::INTERSECT: name = L"INTERSECT"; break;
-        case DrawingMode::MULTI_BEZIER: name = L"MULTI_BEZIER"; break;
-        case DrawingMode::SCANLINE_FILL: name = L"SCANLINE_FILL"; break;
-        case DrawingMode::SEED_FILL: name = L"SEED_FILL"; break;
-        case DrawingMode::POLYGON: name = L"POLYGON"; break;
-        case DrawingMode::CLIP_LINES: name = L"CLIP_LINES"; break;
-        case DrawingMode::CLIP_POLYGON_SH: name = L"CLIP_POLYGON_SH"; break;
-        case DrawingMode::CLIP_POLYGON_WA: name = L"CLIP_POLYGON_WA"; break;
-        }
-        WCHAR txt[64];
-        swprintf_s(txt, L"Mode: %s", name);
-
-        // 3. 建文本布局（每次重建，因为字符串会变）
-        IDWriteTextLayout *lay = nullptr;
-        pDW->CreateTextLayout(txt, wcslen(txt), pTF, 300, 30, &lay);
-
-        DWRITE_TEXT_METRICS m;
-        lay->GetMetrics(&m);
-
-        // 4. 右上角定位
-        D2D1_SIZE_F sz = rt->GetSize();
-        float left = sz.width - m.width - 10.0f;
-        float top = 10.0f;
-
-        // 5. 画背景
-        ID2D1SolidColorBrush *bgBr = nullptr;
-        ID2D1SolidColorBrush *txtBr = nullptr;
-        rt->CreateSolidColorBrush(D2D1::ColorF(D2D1::ColorF::White, 0.9f), &bgBr);
-        rt->CreateSolidColorBrush(D2D1::ColorF(D2D1::ColorF::Black), &txtBr);
-        if (bgBr && txtBr) {
-            D2D1_RECT_F rc = {left - 4, top - 4, left + m.width + 4, top + m.height + 4};
-            rt->FillRectangle(&rc, bgBr);
-            rt->DrawRectangle(&rc, txtBr, 1.0f);
-            rt->DrawTextLayout({left, top}, lay, txtBr);
-        }
-        if (bgBr) bgBr->Release();
-        if (txtBr) txtBr->Release();
-
-        lay->Release();
-        /* ------------------------- */
-
-        m_graphicsEngine->EndDraw();
+    // 以下浮层固定在窗口上，不随视图变换
+    overlay.SetScreenSpace(true);
+
+    /* ----- 左上角性能统计（绘制线程最近画完的一帧） ----- */
+    if (m_showProfiler) {
+        FrameStats stats = Profiler::GetFrameStats();
+        GraphicsEngine::FrameThread::Stats frames = m_graphicsEngine->GetRenderStats();
+        WCHAR statsText[200];
+        swprintf_s(statsText, L"frame %.2f ms  p50 %.2f  p99 %.2f  draws %u  culled %u  coalesced %llu",
+                   stats.lastMs, stats.p50Ms, stats.p99Ms, stats.drawCalls, stats.shapesCulled,
+                   static_cast<unsigned long long>(frames.coalesced));
+        overlay.FillRectangle(D2D1::RectF(10.0f, 10.0f, 530.0f, 30.0f), D2D1::ColorF(D2D1::ColorF::Black, 0.7f));
+        overlay.DrawString(statsText, L"Consolas", 12.0f, D2D1::RectF(14.0f, 12.0f, 530.0f, 30.0f),
+                           D2D1::ColorF(D2D1::ColorF::White));
     }
+
+    /* ----- 右上角模式提示 ----- */
+    // 1. 组装当前模式字符串
+    const wchar_t *name = L"UNKNOWN";
+    switch (m_currentMode) {
+    case DrawingMode::SELECT: name = L"SELECT"; break;
+    case DrawingMode::LINE: name = L"LINE"; break;
+    case DrawingMode::MIDPOINT_LINE: name = L"MIDPOINT_LINE"; break;
+    case DrawingMode::BRESENHAM_LINE: name = L"BRESENHAM_LINE"; break;
+    case DrawingMode::MIDPOINT_CIRCLE: name = L"MIDPOINT_CIRCLE"; break;
+    case DrawingMode::BRESENHAM_CIRCLE: name = L"BRESENHAM_CIRCLE"; break;
+    case DrawingMode::CIRCLE: name = L"CIRCLE"; break;
+    case DrawingMode::RECTANGLE: name = L"RECTANGLE"; break;
+    case DrawingMode::TRIANGLE: name = L"TRIANGLE"; break;
+    case DrawingMode::DIAMOND: name = L"DIAMOND"; break;
+    case DrawingMode::PARALLELOGRAM: name = L"PARALLELOGRAM"; break;
+    case DrawingMode::POLYLINE: name = L"POLYLINE"; break;
+    case DrawingMode::CURVE: name = L"CURVE"; break;
+    case DrawingMode::PERPENDICULAR: name = L"PERPENDICULAR"; break;
+    case DrawingMode::TANGENT: name = L"TANGENT"; break;
+    case DrawingMode::CENTER: name = L"CENTER"; break;
+    case DrawingMode::INTERSECT: name = L"INTERSECT"; break;
+    case DrawingMode::MULTI_BEZIER: name = L"MULTI_BEZIER"; break;
+    case DrawingMode::SCANLINE_FILL: name = L"SCANLINE_FILL"; break;
+    case DrawingMode::SEED_FILL: name = L"SEED_FILL"; break;
+    case DrawingMode::POLYGON: name = L"POLYGON"; break;
+    case DrawingMode::CLIP_LINES: name = L"CLIP_LINES"; break;
+    case DrawingMode::CLIP_POLYGON_SH: name = L"CLIP_POLYGON_SH"; break;
+    case DrawingMode::CLIP_POLYGON_WA: name = L"CLIP_POLYGON_WA"; break;
+    }
+    WCHAR txt[64];
+    swprintf_s(txt, L"Mode: %s  %.0f%%", name, m_graphicsEngine->GetZoom() * 100.0f);
+
+    // 2. 右上角定位，背景和边框按文字大小在绘制线程上计算
+    overlay.DrawLabel(txt, L"Consolas", 14.0f, D2D1::Point2F(10.0f, 10.0f), true, 300, 30, 4.0f,
+                      D2D1::ColorF(D2D1::ColorF::Black), D2D1::ColorF(D2D1::ColorF::White, 0.9f));
+    /* ------------------------- */
+
+    /* ----- 右上角后台填充进度（模式提示下方），取最慢的任务 ----- */
+    std::vector<FillJobQueue::Progress> fills = m_graphicsEngine->GetFillProgress();
+    if (!fills.empty()) {
+        float slowest = 1.0f;
+        for (const auto &fill : fills) {
+            slowest = (std::min)(slowest, fill.progress);
+        }
+        WCHAR fillText[64];
+        swprintf_s(fillText, L"Filling %zu  %.0f%%  (Esc to cancel)", fills.size(), slowest * 100.0f);
+        overlay.DrawLabel(fillText, L"Consolas", 12.0f, D2D1::Point2F(10.0f, 44.0f), true, 300, 30, 4.0f,
+                          D2D1::ColorF(D2D1::ColorF::Black), D2D1::ColorF(D2D1::ColorF::Yellow, 0.8f));
+    }
+
+    m_graphicsEngine->SubmitFrame(std::move(overlay));
 }
 
 void MainWindow::OnCommand(WPARAM wParam) {
     DrawingMode previousMode = m_currentMode;
+    // 菜单命令（切换模式、保存、裁剪等）都要读取图形几何，先提交未写回的变换
+    m_graphicsEngine->CommitSelectedTransform();
     switch (LOWORD(wParam)) {
     case 32772: m_currentMode = DrawingMode::LINE; break;
     case 32773: m_currentMode = DrawingMode::CIRCLE; break;
@@ -2082,8 +1758,9 @@ void MainWindow::OnCommand(WPARAM wParam) {
                 ShapeType type = selectedShape->GetType();
                 // 支持所有类型的直线和圆形
                 if (type == ShapeType::LINE || type == ShapeType::CIRCLE) {
-                    selectedShape->SetLineWidth(m_currentLineWidth);
-                    OutputDebugStringA("Line width set to 1PX\n");
+                    m_graphicsEngine->EditSelectedShape()->SetLineWidth(m_currentLineWidth);
+                    m_graphicsEngine->UpdateSelectedShape();
+                    LOG_INFO("Line width set to 1PX\n");
                 }
             }
         }
@@ -2095,7 +1772,8 @@ void MainWindow::OnCommand(WPARAM wParam) {
             if (selectedShape) {
                 ShapeType type = selectedShape->GetType();
                 if (type == ShapeType::LINE || type == ShapeType::CIRCLE) {
-                    selectedShape->SetLineWidth(m_currentLineWidth);
+                    m_graphicsEngine->EditSelectedShape()->SetLineWidth(m_currentLineWidth);
+                    m_graphicsEngine->UpdateSelectedShape();
                 }
             }
         }
@@ -2107,7 +1785,8 @@ void MainWindow::OnCommand(WPARAM wParam) {
             if (selectedShape) {
                 ShapeType type = selectedShape->GetType();
                 if (type == ShapeType::LINE || type == ShapeType::CIRCLE) {
-                    selectedShape->SetLineWidth(m_currentLineWidth);
+                    m_graphicsEngine->EditSelectedShape()->SetLineWidth(m_currentLineWidth);
+                    m_graphicsEngine->UpdateSelectedShape();
                 }
             }
         }
@@ -2119,7 +1798,8 @@ void MainWindow::OnCommand(WPARAM wParam) {
             if (selectedShape) {
                 ShapeType type = selectedShape->GetType();
                 if (type == ShapeType::LINE || type == ShapeType::CIRCLE) {
-                    selectedShape->SetLineWidth(m_currentLineWidth);
+                    m_graphicsEngine->EditSelectedShape()->SetLineWidth(m_currentLineWidth);
+                    m_graphicsEngine->UpdateSelectedShape();
                 }
             }
         }
@@ -2131,7 +1811,8 @@ void MainWindow::OnCommand(WPARAM wParam) {
             if (selectedShape) {
                 ShapeType type = selectedShape->GetType();
                 if (type == ShapeType::LINE || type == ShapeType::CIRCLE) {
-                    selectedShape->SetLineWidth(m_currentLineWidth);
+                    m_graphicsEngine->EditSelectedShape()->SetLineWidth(m_currentLineWidth);
+                    m_graphicsEngine->UpdateSelectedShape();
                 }
             }
         }
@@ -2143,7 +1824,8 @@ void MainWindow::OnCommand(WPARAM wParam) {
             if (selectedShape) {
                 ShapeType type = selectedShape->GetType();
                 if (type == ShapeType::LINE || type == ShapeType::CIRCLE) {
-                    selectedShape->SetLineStyle(m_currentLineStyle);
+                    m_graphicsEngine->EditSelectedShape()->SetLineStyle(m_currentLineStyle);
+                    m_graphicsEngine->UpdateSelectedShape();
                 }
             }
         }
@@ -2155,7 +1837,8 @@ void MainWindow::OnCommand(WPARAM wParam) {
             if (selectedShape) {
                 ShapeType type = selectedShape->GetType();
                 if (type == ShapeType::LINE || type == ShapeType::CIRCLE) {
-                    selectedShape->SetLineStyle(m_currentLineStyle);
+                    m_graphicsEngine->EditSelectedShape()->SetLineStyle(m_currentLineStyle);
+                    m_graphicsEngine->UpdateSelectedShape();
                 }
             }
         }
@@ -2167,7 +1850,8 @@ void MainWindow::OnCommand(WPARAM wParam) {
             if (selectedShape) {
                 ShapeType type = selectedShape->GetType();
                 if (type == ShapeType::LINE || type == ShapeType::CIRCLE) {
-                    selectedShape->SetLineStyle(m_currentLineStyle);
+                    m_graphicsEngine->EditSelectedShape()->SetLineStyle(m_currentLineStyle);
+                    m_graphicsEngine->UpdateSelectedShape();
                 }
             }
         }
@@ -2179,22 +1863,23 @@ void MainWindow::OnCommand(WPARAM wParam) {
             if (selectedShape) {
                 ShapeType type = selectedShape->GetType();
                 if (type == ShapeType::LINE || type == ShapeType::CIRCLE) {
-                    selectedShape->SetLineStyle(m_currentLineStyle);
+                    m_graphicsEngine->EditSelectedShape()->SetLineStyle(m_currentLineStyle);
+                    m_graphicsEngine->UpdateSelectedShape();
                 }
             }
         }
         break;
     case 32810: // 多点Bezier曲线
         m_currentMode = DrawingMode::MULTI_BEZIER;
-        OutputDebugStringA("多点Bezier曲线模式已激活\n");
+        LOG_INFO("多点Bezier曲线模式已激活\n");
         break;
-    case 32811: // 栅栏填充法
+    case 32811: // 扫描线填充法
         m_currentMode = DrawingMode::SCANLINE_FILL;
-        OutputDebugStringA("栅栏填充模式已激活\n");
+        LOG_INFO("扫描线填充模式已激活\n");
         break;
     case 32812: // 种子填充法
         m_currentMode = DrawingMode::SEED_FILL;
-        OutputDebugStringA("种子填充模式已激活\n");
+        LOG_INFO("种子填充模式已激活\n");
         break;
     case 32813: // 选中图元后，再用鼠标指定旋转点，让图元绕该点旋转
         m_transformMode = TransformMode::ROTATE_AROUND_POINT;
@@ -2203,22 +1888,28 @@ void MainWindow::OnCommand(WPARAM wParam) {
         break;
     case 32814: // 绘制任意多边形
         m_currentMode = DrawingMode::POLYGON;
-        OutputDebugStringA("多边形绘制模式已激活\n");
+        LOG_INFO("多边形绘制模式已激活\n");
         break;
     case 32816: // 利用LiangBarsky算法裁剪矩形框内直线
         m_currentMode = DrawingMode::CLIP_LINES;
         m_clipRectDrawing = false;
-        OutputDebugStringA("Liang-Barsky裁剪模式已激活\n");
+        LOG_INFO("Liang-Barsky裁剪模式已激活\n");
         break;
     case 32817: // 利用Sutherland-Hodgman算法裁剪矩形框内多边形
         m_currentMode = DrawingMode::CLIP_POLYGON_SH;
         m_clipRectDrawing = false;
-        OutputDebugStringA("Sutherland-Hodgman多边形裁剪模式已激活\n");
+        LOG_INFO("Sutherland-Hodgman多边形裁剪模式已激活\n");
         break;
     case 32818: // 利用Weiler-Atherton算法裁剪矩形内多边形
         m_currentMode = DrawingMode::CLIP_POLYGON_WA;
         m_clipRectDrawing = false;
-        OutputDebugStringA("Weiler-Atherton多边形裁剪模式已激活\n");
+        LOG_INFO("Weiler-Atherton多边形裁剪模式已激活\n");
+        break;
+    case 32821: // 撤销
+        Undo();
+        break;
+    case 32822: // 重做
+        Redo();
         break;
     case 5: m_graphicsEngine->DeleteSelectedShape(); break;
     }
@@ -2261,6 +1952,7 @@ void MainWindow::SaveToFile() {
     ofn.lpstrDefExt = L"drawing";
 
     if (GetSaveFileName(&ofn)) {
+        PROFILE_SCOPE("MainWindow::SaveToFile");
         std::wofstream out(szFile);
         if (out) {
             for (const auto &shape : m_graphicsEngine->GetShapes()) {
@@ -2268,12 +1960,9 @@ void MainWindow::SaveToFile() {
                 out << StringToWString(serialized) << L'\n';
                 
                 // 调试输出
-                char debugMsg[200];
-                sprintf_s(debugMsg, "保存图形: %s (填充像素数: %zu)\n", 
-                         serialized.substr(0, 50).c_str(), shape->GetFillPixels().size());
-                OutputDebugStringA(debugMsg);
+                LOG_DEBUG("保存图形: %.50s (填充像素数: %zu)\n", serialized, shape->GetFillPixels().size());
             }
-            OutputDebugStringA("文件保存完成\n");
+            LOG_INFO("文件保存完成\n");
         }
     }
 }
@@ -2290,29 +1979,29 @@ void MainWindow::LoadFromFile() {
     ofn.Flags = OFN_FILEMUSTEXIST | OFN_PATHMUSTEXIST;
 
     if (GetOpenFileName(&ofn)) {
+        PROFILE_SCOPE("MainWindow::LoadFromFile");
         std::wifstream inFile(szFile);
         if (!inFile) return;
 
         // 1. 清空画布
         m_graphicsEngine->ClearAllShapes();
 
-        // 2. 加载新数据
+        // 2. 加载新数据，全部读完后一次放入（撤销历史只记录一步）
+        std::vector<std::shared_ptr<Shape>> loaded;
         std::wstring line;
         int lineNum = 0;
         while (std::getline(inFile, line)) {
             lineNum++;
             std::string lineStr = WStringToString(line);
             if (auto shape = Shape::Deserialize(lineStr)) {
-                m_graphicsEngine->AddShape(shape);
+                loaded.push_back(shape);
                 
                 // 调试输出
-                char debugMsg[200];
-                sprintf_s(debugMsg, "加载图形 #%d: %s (填充像素数: %zu)\n", 
-                         lineNum, lineStr.substr(0, 50).c_str(), shape->GetFillPixels().size());
-                OutputDebugStringA(debugMsg);
+                LOG_DEBUG("加载图形 #%d: %.50s (填充像素数: %zu)\n", lineNum, lineStr, shape->GetFillPixels().size());
             }
         }
-        OutputDebugStringA("文件加载完成\n");
+        m_graphicsEngine->ReplaceShapes(std::move(loaded));
+        LOG_INFO("文件加载完成\n");
 
         // 3. 重置交互状态
         m_graphicsEngine->ClearSelection();
@@ -2350,6 +2039,11 @@ HRESULT MainWindow::Initialize(HINSTANCE hInstance, int nCmdShow) {
     if (FAILED(hr)) {
         return hr;
     }
+    // 后台填充结束时唤醒界面线程（在工作线程上调用，只投递消息）
+    HWND hwnd = m_hwnd;
+    m_graphicsEngine->SetFillNotify([hwnd]() {
+        PostMessage(hwnd, WM_FILL_DONE, 0, 0);
+    });
 
     ShowWindow(m_hwnd, nCmdShow);
     UpdateWindow(m_hwnd);
@@ -0,0 +1,138 @@
+#include "Overlay.h"
+#include "DeviceResourceCache.h"
+#include "Shape.h"
+#include <cwchar>
+
+OverlayList::Op &OverlayList::Add(OpKind kind, const D2D1_COLOR_F &color) {
+    m_ops.emplace_back();
+    Op &op = m_ops.back();
+    op.kind = kind;
+    op.screenSpace = m_screenSpace;
+    op.flag = false;
+    op.color = color;
+    op.background = color;
+    op.width = 1.0f;
+    op.p0 = op.p1 = D2D1::Point2F(0, 0);
+    op.rect = D2D1::RectF(0, 0, 0, 0);
+    op.family = nullptr;
+    op.fontSize = 0.0f;
+    return op;
+}
+
+void OverlayList::DrawLine(D2D1_POINT_2F p0, D2D1_POINT_2F p1, const D2D1_COLOR_F &color, float width) {
+    Op &op = Add(OpKind::LINE, color);
+    op.p0 = p0;
+    op.p1 = p1;
+    op.width = width;
+}
+
+void OverlayList::DrawRectangle(const D2D1_RECT_F &rect, const D2D1_COLOR_F &color, float width) {
+    Op &op = Add(OpKind::RECTANGLE, color);
+    op.rect = rect;
+    op.width = width;
+}
+
+void OverlayList::FillRectangle(const D2D1_RECT_F &rect, const D2D1_COLOR_F &color) {
+    Add(OpKind::FILL_RECTANGLE, color).rect = rect;
+}
+
+void OverlayList::FillEllipse(D2D1_POINT_2F center, float radiusX, float radiusY, const D2D1_COLOR_F &color) {
+    Op &op = Add(OpKind::FILL_ELLIPSE, color);
+    op.p0 = center;
+    op.p1 = D2D1::Point2F(radiusX, radiusY);
+}
+
+void OverlayList::DrawString(const wchar_t *text, const wchar_t *family, float size, const D2D1_RECT_F &rect,
+                             const D2D1_COLOR_F &color) {
+    Op &op = Add(OpKind::TEXT, color);
+    op.text = text;
+    op.family = family;
+    op.fontSize = size;
+    op.rect = rect;
+}
+
+void OverlayList::DrawLabel(const wchar_t *text, const wchar_t *family, float size, D2D1_POINT_2F origin, bool alignRight,
+                            float maxWidth, float maxHeight, float padding,
+                            const D2D1_COLOR_F &color, const D2D1_COLOR_F &background) {
+    Op &op = Add(OpKind::LABEL, color);
+    op.text = text;
+    op.family = family;
+    op.fontSize = size;
+    op.p0 = origin;
+    op.p1 = D2D1::Point2F(maxWidth, maxHeight);
+    op.flag = alignRight;
+    op.width = padding;
+    op.background = background;
+}
+
+void OverlayList::DrawShape(std::shared_ptr<Shape> shape, const D2D1_COLOR_F &color, bool highlight) {
+    if (!shape) return;
+    Op &op = Add(OpKind::SHAPE, color);
+    op.shape = std::move(shape);
+    op.flag = highlight;
+}
+
+void OverlayList::Replay(ID2D1RenderTarget *pTarget, DeviceResourceCache &resources, const D2D1_MATRIX_3X2_F &view,
+                         ID2D1StrokeStyle *pHighlightStyle) const {
+    // 画刷、文本格式和布局都取自资源缓存，跨帧复用
+    bool screenSpace = true;
+    pTarget->SetTransform(D2D1::IdentityMatrix());
+    for (const Op &op : m_ops) {
+        if (op.screenSpace != screenSpace) {
+            screenSpace = op.screenSpace;
+            if (screenSpace) {
+                pTarget->SetTransform(D2D1::IdentityMatrix());
+            } else {
+                pTarget->SetTransform(view);
+            }
+        }
+        ID2D1SolidColorBrush *brush = resources.GetBrush(op.color);
+        if (!brush) continue;
+
+        switch (op.kind) {
+        case OpKind::LINE:
+            pTarget->DrawLine(op.p0, op.p1, brush, op.width);
+            break;
+        case OpKind::RECTANGLE:
+            pTarget->DrawRectangle(op.rect, brush, op.width);
+            break;
+        case OpKind::FILL_RECTANGLE:
+            pTarget->FillRectangle(op.rect, brush);
+            break;
+        case OpKind::FILL_ELLIPSE:
+            pTarget->FillEllipse(D2D1::Ellipse(op.p0, op.p1.x, op.p1.y), brush);
+            break;
+        case OpKind::TEXT: {
+            IDWriteTextFormat *format = resources.GetTextFormat(op.family, op.fontSize);
+            if (format) {
+                pTarget->DrawText(op.text.c_str(), static_cast<UINT32>(op.text.size()), format, op.rect, brush);
+            }
+            break;
+        }
+        case OpKind::LABEL: {
+            // 文字大小要排版后才知道，背景和右对齐的位置在回放时计算；布局按文字缓存，内容不变时复用
+            IDWriteTextLayout *layout =
+                resources.GetTextLayout(resources.GetTextFormat(op.family, op.fontSize), op.text.c_str(), op.p1.x, op.p1.y);
+            ID2D1SolidColorBrush *background = resources.GetBrush(op.background);
+            if (!layout || !background) break;
+            DWRITE_TEXT_METRICS metrics;
+            layout->GetMetrics(&metrics);
+            float left = op.p0.x;
+            if (op.flag) {
+                left = pTarget->GetSize().width - metrics.width - op.p0.x;
+            }
+            float top = op.p0.y;
+            D2D1_RECT_F rc = D2D1::RectF(left - op.width, top - op.width,
+                                         left + metrics.width + op.width, top + metrics.height + op.width);
+            pTarget->FillRectangle(rc, background);
+            pTarget->DrawRectangle(rc, brush, 1.0f);
+            pTarget->DrawTextLayout(D2D1::Point2F(left, top), layout, brush);
+            break;
+        }
+        case OpKind::SHAPE:
+            op.shape->Draw(pTarget, brush, brush, op.flag ? pHighlightStyle : nullptr);
+            break;
+        }
+    }
+    pTarget->SetTransform(D2D1::IdentityMatrix());
+}
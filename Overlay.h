@@ -0,0 +1,78 @@
+#pragma once
+#include <d2d1.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Shape;
+class DeviceResourceCache;
+
+// 浮层：图形之上的预览、标记和提示文字。界面线程按绘制顺序记录命令，随帧交给绘制线程在图形之上回放，
+// 记录时不访问任何设备资源。坐标默认为文档坐标（随视图变换），SetScreenSpace(true) 之后记录的命令为窗口坐标。
+// 字体名必须是字符串常量（只保存指针）
+class OverlayList {
+public:
+    OverlayList() : m_screenSpace(false) {
+    }
+
+    void SetScreenSpace(bool screen) {
+        m_screenSpace = screen;
+    }
+
+    void DrawLine(D2D1_POINT_2F p0, D2D1_POINT_2F p1, const D2D1_COLOR_F &color, float width = 1.0f);
+    void DrawRectangle(const D2D1_RECT_F &rect, const D2D1_COLOR_F &color, float width = 1.0f);
+    void FillRectangle(const D2D1_RECT_F &rect, const D2D1_COLOR_F &color);
+    void FillEllipse(D2D1_POINT_2F center, float radiusX, float radiusY, const D2D1_COLOR_F &color);
+    // 在 rect 内绘制文字
+    void DrawString(const wchar_t *text, const wchar_t *family, float size, const D2D1_RECT_F &rect, const D2D1_COLOR_F &color);
+    // 带背景和边框的文字标签，背景按文字实际大小四周外扩 padding。
+    // alignRight 时 origin.x 为文字右端到窗口右边的距离，否则为文字左端；文字排版限制在 maxWidth x maxHeight 内
+    void DrawLabel(const wchar_t *text, const wchar_t *family, float size, D2D1_POINT_2F origin, bool alignRight,
+                   float maxWidth, float maxHeight, float padding,
+                   const D2D1_COLOR_F &color, const D2D1_COLOR_F &background);
+    // 绘制图形，浮层持有图形直到回放结束，调用方之后不能再修改它（传入副本）；
+    // highlight 时以高亮虚线描边
+    void DrawShape(std::shared_ptr<Shape> shape, const D2D1_COLOR_F &color, bool highlight = false);
+
+    bool Empty() const {
+        return m_ops.empty();
+    }
+    size_t Size() const {
+        return m_ops.size();
+    }
+
+    // 在 pTarget 上回放，文档坐标的命令使用 view 变换；结束时变换恢复为单位矩阵
+    void Replay(ID2D1RenderTarget *pTarget, DeviceResourceCache &resources, const D2D1_MATRIX_3X2_F &view,
+                ID2D1StrokeStyle *pHighlightStyle) const;
+
+private:
+    enum class OpKind {
+        LINE,
+        RECTANGLE,
+        FILL_RECTANGLE,
+        FILL_ELLIPSE,
+        TEXT,
+        LABEL,
+        SHAPE
+    };
+
+    struct Op {
+        OpKind kind;
+        bool screenSpace;
+        bool flag;              // LABEL：右对齐；SHAPE：高亮
+        D2D1_COLOR_F color;
+        D2D1_COLOR_F background; // LABEL 的背景
+        float width;            // 线宽；LABEL 的外扩距离
+        D2D1_POINT_2F p0, p1;   // 端点；椭圆的中心和半径；标签的位置和排版大小
+        D2D1_RECT_F rect;
+        const wchar_t *family;
+        float fontSize;
+        std::wstring text;
+        std::shared_ptr<Shape> shape;
+    };
+
+    std::vector<Op> m_ops;
+    bool m_screenSpace;
+
+    Op &Add(OpKind kind, const D2D1_COLOR_F &color);
+};
@@ -0,0 +1,192 @@
+#include "PixelPattern.h"
+#include <algorithm>
+#include <cstdlib>
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+    // 按整数半径缓存的圆模板，只持有弱引用
+    class CirclePatternCache {
+    public:
+        typedef void (*Generator)(int radius, PixelPattern &pattern);
+
+        explicit CirclePatternCache(Generator generator) : m_generator(generator), m_sweepAt(64) {
+        }
+
+        PixelPatternPtr Get(int radius) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            std::weak_ptr<const PixelPattern> &entry = m_entries[radius];
+            PixelPatternPtr pattern = entry.lock();
+            if (pattern) return pattern;
+
+            auto created = std::make_shared<PixelPattern>();
+            m_generator(radius, *created);
+            pattern = created;
+            entry = pattern;
+
+            // 条目数翻倍时清理已失效的条目，缓存大小随正在使用的半径数而不是历史上出现过的半径数增长
+            if (m_entries.size() >= m_sweepAt) {
+                for (auto it = m_entries.begin(); it != m_entries.end();) {
+                    if (it->second.expired()) {
+                        it = m_entries.erase(it);
+                    } else {
+                        ++it;
+                    }
+                }
+                m_sweepAt = (std::max)(static_cast<size_t>(64), m_entries.size() * 2);
+            }
+            return pattern;
+        }
+
+    private:
+        Generator m_generator;
+        std::mutex m_mutex;
+        std::unordered_map<int, std::weak_ptr<const PixelPattern>> m_entries;
+        size_t m_sweepAt;
+    };
+
+    // 八分圆上的一点 (px,py) 展开为8个对称点
+    void AddSymmetricPoints(PixelPattern &pattern, int px, int py) {
+        pattern.push_back(D2D1::Point2F(static_cast<float>(px), static_cast<float>(py)));
+        pattern.push_back(D2D1::Point2F(static_cast<float>(-px), static_cast<float>(py)));
+        pattern.push_back(D2D1::Point2F(static_cast<float>(px), static_cast<float>(-py)));
+        pattern.push_back(D2D1::Point2F(static_cast<float>(-px), static_cast<float>(-py)));
+        pattern.push_back(D2D1::Point2F(static_cast<float>(py), static_cast<float>(px)));
+        pattern.push_back(D2D1::Point2F(static_cast<float>(-py), static_cast<float>(px)));
+        pattern.push_back(D2D1::Point2F(static_cast<float>(py), static_cast<float>(-px)));
+        pattern.push_back(D2D1::Point2F(static_cast<float>(-py), static_cast<float>(-px)));
+    }
+
+    void GenerateMidpointCircle(int r, PixelPattern &pattern) {
+        int x = 0;
+        int y = r;
+        int d = 1 - r;  // 初始判别式
+        pattern.reserve(8 * (static_cast<size_t>(r * 0.7072f) + 2)); // 每个八分之一圆弧约 r/√2 步，一次分配
+
+        AddSymmetricPoints(pattern, x, y);
+
+        while (x < y) {
+            if (d < 0) {
+                d += 2 * x + 3;
+            } else {
+                d += 2 * (x - y) + 5;
+                y--;
+            }
+            x++;
+            AddSymmetricPoints(pattern, x, y);
+        }
+    }
+
+    void GenerateBresenhamCircle(int r, PixelPattern &pattern) {
+        int x = 0;
+        int y = r;
+        int d = 3 - 2 * r;  // Bresenham判别式
+        pattern.reserve(8 * (static_cast<size_t>(r * 0.7072f) + 2)); // 每个八分之一圆弧约 r/√2 步，一次分配
+
+        AddSymmetricPoints(pattern, x, y);
+
+        while (x <= y) {
+            x++;
+            if (d > 0) {
+                y--;
+                d = d + 4 * (x - y) + 10;
+            } else {
+                d = d + 4 * x + 6;
+            }
+            AddSymmetricPoints(pattern, x, y);
+        }
+    }
+}
+
+PixelPatternPtr PixelPatterns::MidpointLine(int x1, int y1) {
+    auto pattern = std::make_shared<PixelPattern>();
+
+    int dx = abs(x1);
+    int dy = abs(y1);
+    int sx = (0 < x1) ? 1 : -1;
+    int sy = (0 < y1) ? 1 : -1;
+    pattern->reserve((std::max)(dx, dy) + 1); // 像素数已知，一次分配
+
+    int x = 0, y = 0;
+    pattern->push_back(D2D1::Point2F(0.0f, 0.0f));
+    if (dx > dy) {
+        // 斜率 <= 1 的情况
+        int d = 2 * dy - dx;
+        while (x != x1) {
+            x += sx;
+            if (d > 0) {
+                y += sy;
+                d += 2 * (dy - dx);
+            } else {
+                d += 2 * dy;
+            }
+            pattern->push_back(D2D1::Point2F(static_cast<float>(x), static_cast<float>(y)));
+        }
+    } else {
+        // 斜率 > 1 的情况
+        int d = 2 * dx - dy;
+        while (y != y1) {
+            y += sy;
+            if (d > 0) {
+                x += sx;
+                d += 2 * (dx - dy);
+            } else {
+                d += 2 * dx;
+            }
+            pattern->push_back(D2D1::Point2F(static_cast<float>(x), static_cast<float>(y)));
+        }
+    }
+    return pattern;
+}
+
+PixelPatternPtr PixelPatterns::BresenhamLine(int x1, int y1) {
+    auto pattern = std::make_shared<PixelPattern>();
+
+    int dx = abs(x1);
+    int dy = abs(y1);
+    int sx = (0 < x1) ? 1 : -1;
+    int sy = (0 < y1) ? 1 : -1;
+    pattern->reserve((std::max)(dx, dy) + 1); // 像素数已知，一次分配
+    int err = dx - dy;
+
+    int x = 0, y = 0;
+    while (true) {
+        pattern->push_back(D2D1::Point2F(static_cast<float>(x), static_cast<float>(y)));
+
+        if (x == x1 && y == y1) break;
+
+        int e2 = 2 * err;
+        if (e2 > -dy) {
+            err -= dy;
+            x += sx;
+        }
+        if (e2 < dx) {
+            err += dx;
+            y += sy;
+        }
+    }
+    return pattern;
+}
+
+PixelPatternPtr PixelPatterns::MidpointCircle(int radius) {
+    static CirclePatternCache cache(GenerateMidpointCircle);
+    return cache.Get(radius);
+}
+
+PixelPatternPtr PixelPatterns::BresenhamCircle(int radius) {
+    static CirclePatternCache cache(GenerateBresenhamCircle);
+    return cache.Get(radius);
+}
+
+void PixelPatterns::Expand(const PixelPattern &pattern, D2D1_POINT_2F origin, std::vector<D2D1_POINT_2F> &out) {
+    out.resize(pattern.size());
+    for (size_t i = 0; i < pattern.size(); ++i) {
+        out[i].x = origin.x + pattern[i].x;
+        out[i].y = origin.y + pattern[i].y;
+    }
+}
+
+size_t PixelPatterns::OwnedBytes(const PixelPatternPtr &pattern) {
+    if (!pattern || pattern.use_count() > 1) return 0;
+    return sizeof(PixelPattern) + pattern->capacity() * sizeof(D2D1_POINT_2F);
+}
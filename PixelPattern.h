@@ -0,0 +1,27 @@
+#pragma once
+#include <d2d1.h>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// 像素模板：光栅化算法生成的像素相对原点的整数偏移，创建后不再修改，可被多个图形共享。
+// 直线的原点是取整后的起点，圆的原点是圆心；平移只改变原点，不重新生成模板
+typedef std::vector<D2D1_POINT_2F> PixelPattern;
+typedef std::shared_ptr<const PixelPattern> PixelPatternPtr;
+
+namespace PixelPatterns {
+    // 直线模板：从 (0,0) 到 (dx,dy) 的像素序列，只取决于取整后端点的差
+    PixelPatternPtr MidpointLine(int dx, int dy);
+    PixelPatternPtr BresenhamLine(int dx, int dy);
+
+    // 圆模板：按整数半径缓存，同一半径的圆共享同一份八分圆展开结果。
+    // 缓存只持有弱引用，没有图形使用的模板随最后一个图形释放；可在任意线程调用
+    PixelPatternPtr MidpointCircle(int radius);
+    PixelPatternPtr BresenhamCircle(int radius);
+
+    // 把模板平移到原点处展开为绝对坐标
+    void Expand(const PixelPattern &pattern, D2D1_POINT_2F origin, std::vector<D2D1_POINT_2F> &out);
+
+    // 图形计入内存统计的模板字节数：与其他图形共享的模板不计入，避免复制出的图形重复计算
+    size_t OwnedBytes(const PixelPatternPtr &pattern);
+}
@@ -0,0 +1,463 @@
+#include "PolygonClipping.h"
+#include "Profiler.h"
+#include <d2d1helper.h>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // 求交参数落在端点附近时视为退化（顶点在另一多边形的边上、边重合），需要微移裁剪多边形后重算
+    const double DEGENERATE_EPS = 1e-9;
+    const int MAX_PERTURB_ATTEMPTS = 8;
+
+    struct Vec2 {
+        double x, y;
+    };
+
+    double Cross(Vec2 a, Vec2 b) {
+        return a.x * b.y - a.y * b.x;
+    }
+
+    Vec2 Sub(Vec2 a, Vec2 b) {
+        return {a.x - b.x, a.y - b.y};
+    }
+
+    // 两个多边形的边交点
+    struct Crossing {
+        Vec2 point;
+        int subjectEdge, clipEdge;
+        double subjectAlpha, clipAlpha;
+    };
+
+    // 环形链表节点：两个多边形的顶点和交点放在同一个数组中
+    struct Node {
+        Vec2 point;
+        int next, prev;
+        int neighbor;      // 交点在另一个多边形链表中的对应节点，顶点为-1
+        bool entry;        // 沿本多边形前进时，该交点是否进入另一个多边形
+        bool visited;
+    };
+
+    // 扫描用的边
+    struct SweepEdge {
+        double xmin, xmax, ymin, ymax;
+        int polygon; // 0 主多边形，1 裁剪多边形
+        int index;
+    };
+
+    // 射线法（奇偶规则）判断点是否在多边形内
+    bool PointInPolygon(Vec2 p, const std::vector<Vec2> &polygon) {
+        bool inside = false;
+        size_t n = polygon.size();
+        for (size_t i = 0, j = n - 1; i < n; j = i++) {
+            const Vec2 &a = polygon[i];
+            const Vec2 &b = polygon[j];
+            if ((a.y > p.y) != (b.y > p.y)) {
+                double x = a.x + (p.y - a.y) * (b.x - a.x) / (b.y - a.y);
+                if (p.x < x) inside = !inside;
+            }
+        }
+        return inside;
+    }
+
+    // 求两条边的交点；返回 false 表示遇到退化情况
+    bool IntersectEdges(Vec2 s0, Vec2 s1, Vec2 c0, Vec2 c1,
+                        std::vector<Crossing> &crossings, int subjectEdge, int clipEdge) {
+        Vec2 r = Sub(s1, s0);
+        Vec2 t = Sub(c1, c0);
+        Vec2 qp = Sub(c0, s0);
+        double denom = Cross(r, t);
+        double scale = (std::fabs(r.x) + std::fabs(r.y)) * (std::fabs(t.x) + std::fabs(t.y));
+
+        if (std::fabs(denom) <= DEGENERATE_EPS * scale) {
+            // 平行：共线且有重叠时为退化
+            double rr = r.x * r.x + r.y * r.y;
+            if (std::fabs(Cross(qp, r)) > DEGENERATE_EPS * (rr + 1.0)) return true;
+            if (rr == 0) return true;
+            double a0 = (qp.x * r.x + qp.y * r.y) / rr;
+            double a1 = a0 + (t.x * r.x + t.y * r.y) / rr;
+            if ((std::max)(a0, a1) < 0 || (std::min)(a0, a1) > 1) return true;
+            return false;
+        }
+
+        double alphaS = Cross(qp, t) / denom;
+        double alphaC = Cross(qp, r) / denom;
+        if (alphaS < -DEGENERATE_EPS || alphaS > 1 + DEGENERATE_EPS ||
+            alphaC < -DEGENERATE_EPS || alphaC > 1 + DEGENERATE_EPS) {
+            return true;
+        }
+        if (alphaS <= DEGENERATE_EPS || alphaS >= 1 - DEGENERATE_EPS ||
+            alphaC <= DEGENERATE_EPS || alphaC >= 1 - DEGENERATE_EPS) {
+            return false;
+        }
+
+        crossings.push_back({{s0.x + alphaS * r.x, s0.y + alphaS * r.y}, subjectEdge, clipEdge, alphaS, alphaC});
+        return true;
+    }
+
+    // 扫描求交：边按包围盒左端排序，只对x区间重叠的活动边做y区间检查和精确求交
+    bool FindCrossings(const std::vector<Vec2> &subject, const std::vector<Vec2> &clip,
+                       std::vector<Crossing> &crossings) {
+        const std::vector<Vec2> *polygons[2] = {&subject, &clip};
+        std::vector<SweepEdge> edges;
+        edges.reserve(subject.size() + clip.size());
+        for (int p = 0; p < 2; ++p) {
+            const std::vector<Vec2> &poly = *polygons[p];
+            for (size_t i = 0; i < poly.size(); ++i) {
+                Vec2 a = poly[i];
+                Vec2 b = poly[(i + 1) % poly.size()];
+                edges.push_back({(std::min)(a.x, b.x), (std::max)(a.x, b.x),
+                                 (std::min)(a.y, b.y), (std::max)(a.y, b.y), p, static_cast<int>(i)});
+            }
+        }
+        std::sort(edges.begin(), edges.end(),
+                  [](const SweepEdge &a, const SweepEdge &b) { return a.xmin < b.xmin; });
+
+        crossings.clear();
+        // 活动边按 xmax 组成小顶堆：扫过的边总在堆顶，每条边只出堆一次，移除的总代价为 O(E log E)
+        std::vector<int> active[2];
+        auto laterEnd = [&edges](int a, int b) { return edges[a].xmax > edges[b].xmax; };
+        for (size_t e = 0; e < edges.size(); ++e) {
+            const SweepEdge &edge = edges[e];
+
+            // 移除已经扫过的边
+            for (auto &heap : active) {
+                while (!heap.empty() && edges[heap.front()].xmax < edge.xmin) {
+                    std::pop_heap(heap.begin(), heap.end(), laterEnd);
+                    heap.pop_back();
+                }
+            }
+
+            int other = 1 - edge.polygon;
+            for (int idx : active[other]) {
+                const SweepEdge &cand = edges[idx];
+                if (cand.ymax < edge.ymin || cand.ymin > edge.ymax) continue;
+
+                const SweepEdge &s = edge.polygon == 0 ? edge : cand;
+                const SweepEdge &c = edge.polygon == 0 ? cand : edge;
+                Vec2 s0 = subject[s.index];
+                Vec2 s1 = subject[(s.index + 1) % subject.size()];
+                Vec2 c0 = clip[c.index];
+                Vec2 c1 = clip[(c.index + 1) % clip.size()];
+                if (!IntersectEdges(s0, s1, c0, c1, crossings, s.index, c.index)) {
+                    return false;
+                }
+            }
+            active[edge.polygon].push_back(static_cast<int>(e));
+            std::push_heap(active[edge.polygon].begin(), active[edge.polygon].end(), laterEnd);
+        }
+        return true;
+    }
+
+    // 把一个多边形的顶点和交点按顺序串成环形链表，交点按边上的参数排序
+    void BuildList(const std::vector<Vec2> &polygon, const std::vector<Crossing> &crossings,
+                   bool isSubject, std::vector<Node> &nodes, std::vector<int> &crossingNode) {
+        std::vector<std::pair<double, int>> order; // (边序号 + 参数, 交点下标)
+        order.reserve(crossings.size());
+        for (size_t k = 0; k < crossings.size(); ++k) {
+            const Crossing &c = crossings[k];
+            order.emplace_back(isSubject ? c.subjectEdge + c.subjectAlpha : c.clipEdge + c.clipAlpha,
+                               static_cast<int>(k));
+        }
+        std::sort(order.begin(), order.end());
+
+        int first = static_cast<int>(nodes.size());
+        size_t next = 0;
+        for (size_t i = 0; i < polygon.size(); ++i) {
+            nodes.push_back({polygon[i], 0, 0, -1, false, false});
+            while (next < order.size() && order[next].first < static_cast<double>(i + 1)) {
+                crossingNode[order[next].second] = static_cast<int>(nodes.size());
+                nodes.push_back({crossings[order[next].second].point, 0, 0, -1, false, false});
+                ++next;
+            }
+        }
+        int last = static_cast<int>(nodes.size()) - 1;
+        for (int i = first; i <= last; ++i) {
+            nodes[i].next = i == last ? first : i + 1;
+            nodes[i].prev = i == first ? last : i - 1;
+        }
+    }
+
+    // 沿链表标记交点的进入/离开状态
+    void MarkEntries(std::vector<Node> &nodes, int first, Vec2 start, const std::vector<Vec2> &other) {
+        bool inside = PointInPolygon(start, other);
+        int i = first;
+        do {
+            if (nodes[i].neighbor >= 0) {
+                nodes[i].entry = !inside;
+                inside = !inside;
+            }
+            i = nodes[i].next;
+        } while (i != first);
+    }
+
+    // 一次完整的Greiner-Hormann裁剪；遇到退化情况返回 false
+    bool ClipOnce(const std::vector<Vec2> &subject, const std::vector<Vec2> &clip,
+                  std::vector<std::vector<D2D1_POINT_2F>> &result) {
+        std::vector<Crossing> crossings;
+        if (!FindCrossings(subject, clip, crossings)) return false;
+
+        result.clear();
+        if (crossings.empty()) {
+            // 没有边相交：一个多边形完全包含另一个，或者两者分离
+            const std::vector<Vec2> *inner = nullptr;
+            if (PointInPolygon(subject[0], clip)) {
+                inner = &subject;
+            } else if (PointInPolygon(clip[0], subject)) {
+                inner = &clip;
+            }
+            if (inner) {
+                std::vector<D2D1_POINT_2F> polygon;
+                for (const Vec2 &p : *inner) {
+                    polygon.push_back(D2D1::Point2F(static_cast<float>(p.x), static_cast<float>(p.y)));
+                }
+                result.push_back(polygon);
+            }
+            return true;
+        }
+
+        std::vector<Node> nodes;
+        nodes.reserve(subject.size() + clip.size() + crossings.size() * 2);
+        std::vector<int> subjectNode(crossings.size()), clipNode(crossings.size());
+        BuildList(subject, crossings, true, nodes, subjectNode);
+        int clipFirst = static_cast<int>(nodes.size());
+        BuildList(clip, crossings, false, nodes, clipNode);
+        for (size_t k = 0; k < crossings.size(); ++k) {
+            nodes[subjectNode[k]].neighbor = clipNode[k];
+            nodes[clipNode[k]].neighbor = subjectNode[k];
+        }
+        MarkEntries(nodes, 0, subject[0], clip);
+        MarkEntries(nodes, clipFirst, clip[0], subject);
+
+        // 从每个未访问的交点出发：进入点沿当前多边形向前走，离开点向后走，遇到交点切换到另一个多边形
+        for (size_t k = 0; k < crossings.size(); ++k) {
+            int start = subjectNode[k];
+            if (nodes[start].visited) continue;
+
+            std::vector<D2D1_POINT_2F> polygon;
+            int cur = start;
+            polygon.push_back(D2D1::Point2F(static_cast<float>(nodes[cur].point.x),
+                                            static_cast<float>(nodes[cur].point.y)));
+            do {
+                nodes[cur].visited = true;
+                nodes[nodes[cur].neighbor].visited = true;
+                bool forward = nodes[cur].entry;
+                do {
+                    cur = forward ? nodes[cur].next : nodes[cur].prev;
+                    polygon.push_back(D2D1::Point2F(static_cast<float>(nodes[cur].point.x),
+                                                    static_cast<float>(nodes[cur].point.y)));
+                } while (nodes[cur].neighbor < 0);
+                cur = nodes[cur].neighbor;
+            } while (!nodes[cur].visited);
+
+            polygon.pop_back(); // 最后回到起点，去掉重复点
+            if (polygon.size() >= 3) {
+                result.push_back(polygon);
+            }
+        }
+        return true;
+    }
+}
+
+PolygonClipping::SutherlandHodgmanClipper::SutherlandHodgmanClipper(float xmin, float ymin, float xmax, float ymax) :
+    m_xmin(xmin), m_ymin(ymin), m_xmax(xmax), m_ymax(ymax), m_out(nullptr) {
+}
+
+// 边界 0~3 依次为左、右、下、上，判断条件和交点公式与逐边整表裁剪相同
+template <int EDGE>
+bool PolygonClipping::SutherlandHodgmanClipper::Inside(D2D1_POINT_2F p) const {
+    switch (EDGE) {
+    case 0: return p.x >= m_xmin;
+    case 1: return p.x <= m_xmax;
+    case 2: return p.y >= m_ymin;
+    default: return p.y <= m_ymax;
+    }
+}
+
+template <int EDGE>
+D2D1_POINT_2F PolygonClipping::SutherlandHodgmanClipper::Intersect(D2D1_POINT_2F a, D2D1_POINT_2F b) const {
+    switch (EDGE) {
+    case 0: {
+        float t = (m_xmin - a.x) / (b.x - a.x);
+        return D2D1::Point2F(m_xmin, a.y + t * (b.y - a.y));
+    }
+    case 1: {
+        float t = (m_xmax - a.x) / (b.x - a.x);
+        return D2D1::Point2F(m_xmax, a.y + t * (b.y - a.y));
+    }
+    case 2: {
+        float t = (m_ymin - a.y) / (b.y - a.y);
+        return D2D1::Point2F(a.x + t * (b.x - a.x), m_ymin);
+    }
+    default: {
+        float t = (m_ymax - a.y) / (b.y - a.y);
+        return D2D1::Point2F(a.x + t * (b.x - a.x), m_ymax);
+    }
+    }
+}
+
+// 一级的输出送入下一级，最后一级写入输出缓冲
+template <int EDGE>
+void PolygonClipping::SutherlandHodgmanClipper::Emit(D2D1_POINT_2F p) {
+    Push<EDGE + 1>(p);
+}
+
+template <>
+void PolygonClipping::SutherlandHodgmanClipper::Emit<3>(D2D1_POINT_2F p) {
+    m_out->push_back(p);
+}
+
+// 处理边 a -> b：a 在内侧时输出 a，跨越边界时输出交点
+template <int EDGE>
+void PolygonClipping::SutherlandHodgmanClipper::ProcessEdge(D2D1_POINT_2F a, D2D1_POINT_2F b) {
+    bool aInside = Inside<EDGE>(a);
+    bool bInside = Inside<EDGE>(b);
+    if (aInside) {
+        Emit<EDGE>(a);
+        if (!bInside) {
+            Emit<EDGE>(Intersect<EDGE>(a, b));
+        }
+    } else if (bInside) {
+        Emit<EDGE>(Intersect<EDGE>(a, b));
+    }
+}
+
+template <int EDGE>
+void PolygonClipping::SutherlandHodgmanClipper::Push(D2D1_POINT_2F p) {
+    Stage &stage = m_stages[EDGE];
+    if (stage.passThrough) {
+        Emit<EDGE>(p);
+        return;
+    }
+    if (stage.hasFirst) {
+        ProcessEdge<EDGE>(stage.prev, p);
+    } else {
+        stage.first = p;
+        stage.hasFirst = true;
+    }
+    stage.prev = p;
+}
+
+// 闭合一级：处理最后一点回到首点的边
+template <int EDGE>
+void PolygonClipping::SutherlandHodgmanClipper::Close() {
+    Stage &stage = m_stages[EDGE];
+    if (stage.hasFirst && !stage.passThrough) {
+        ProcessEdge<EDGE>(stage.prev, stage.first);
+    }
+}
+
+size_t PolygonClipping::SutherlandHodgmanClipper::Clip(const D2D1_POINT_2F *polygon, size_t count, PolygonArena &out) {
+    m_out = &out.points;
+    size_t start = out.points.size();
+    if (count == 0) return 0;
+
+    // 先求包围盒：完全在某条边界外侧时结果为空；完全在某条边界内侧时该级直接透传
+    float minX = polygon[0].x, maxX = polygon[0].x;
+    float minY = polygon[0].y, maxY = polygon[0].y;
+    for (size_t i = 1; i < count; ++i) {
+        minX = (std::min)(minX, polygon[i].x);
+        maxX = (std::max)(maxX, polygon[i].x);
+        minY = (std::min)(minY, polygon[i].y);
+        maxY = (std::max)(maxY, polygon[i].y);
+    }
+    if (maxX < m_xmin || minX > m_xmax || maxY < m_ymin || minY > m_ymax) return 0;
+
+    m_stages[0].passThrough = minX >= m_xmin;
+    m_stages[1].passThrough = maxX <= m_xmax;
+    m_stages[2].passThrough = minY >= m_ymin;
+    m_stages[3].passThrough = maxY <= m_ymax;
+    if (m_stages[0].passThrough && m_stages[1].passThrough &&
+        m_stages[2].passThrough && m_stages[3].passThrough) {
+        out.points.insert(out.points.end(), polygon, polygon + count);
+        return count;
+    }
+    for (auto &stage : m_stages) {
+        stage.hasFirst = false;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        Push<0>(polygon[i]);
+    }
+    // 按级依次闭合，前一级闭合时输出的顶点还会流入后面的级
+    Close<0>();
+    Close<1>();
+    Close<2>();
+    Close<3>();
+
+    return out.points.size() - start;
+}
+
+std::vector<D2D1_POINT_2F> PolygonClipping::SutherlandHodgmanClip(
+    const std::vector<D2D1_POINT_2F> &polygon,
+    float xmin, float ymin, float xmax, float ymax) {
+    PROFILE_SCOPE("PolygonClipping::SutherlandHodgmanClip");
+
+    if (polygon.size() < 3) return polygon;
+
+    PolygonArena out;
+    out.Reserve(polygon.size() * 2, 1);
+    SutherlandHodgmanClipper clipper(xmin, ymin, xmax, ymax);
+    clipper.Clip(polygon.data(), polygon.size(), out);
+    return out.points;
+}
+
+void PolygonClipping::SutherlandHodgmanClipBatch(const PolygonArena &input,
+                                                 float xmin, float ymin, float xmax, float ymax,
+                                                 PolygonArena &output) {
+    PROFILE_SCOPE("PolygonClipping::SutherlandHodgmanClipBatch");
+    output.Clear();
+    // 按输入顶点数预留输出：裁剪结果通常不比输入多，避免大批量时缓冲从空开始反复扩容复制
+    output.Reserve(input.points.size() + 4 * input.Count(), input.Count());
+    SutherlandHodgmanClipper clipper(xmin, ymin, xmax, ymax);
+    for (size_t i = 0; i < input.Count(); ++i) {
+        size_t count = input.Size(i);
+        if (count < 3) {
+            output.Add(input.Points(i), count);
+            continue;
+        }
+        clipper.Clip(input.Points(i), count, output);
+        output.EndPolygon();
+    }
+}
+
+bool PolygonClipping::WeilerAthertonClip(
+    const std::vector<D2D1_POINT_2F> &subject,
+    const std::vector<D2D1_POINT_2F> &clip,
+    std::vector<std::vector<D2D1_POINT_2F>> &result) {
+    PROFILE_SCOPE("PolygonClipping::WeilerAthertonClip");
+
+    result.clear();
+    if (subject.size() < 3 || clip.size() < 3) return true;
+
+    std::vector<Vec2> s, c;
+    double extent = 1.0;
+    for (const auto &p : subject) {
+        s.push_back({p.x, p.y});
+        extent = (std::max)(extent, static_cast<double>((std::max)(std::fabs(p.x), std::fabs(p.y))));
+    }
+    for (const auto &p : clip) {
+        c.push_back({p.x, p.y});
+    }
+
+    // 退化时把裁剪多边形沿不同方向微移后重算，位移远小于一个像素
+    std::vector<Vec2> moved = c;
+    for (int attempt = 0; attempt < MAX_PERTURB_ATTEMPTS; ++attempt) {
+        if (ClipOnce(s, moved, result)) return true;
+
+        double offset = extent * 1e-7 * (attempt + 1);
+        double angle = 2.39996 * (attempt + 1); // 黄金角，每次换一个方向
+        for (size_t i = 0; i < c.size(); ++i) {
+            moved[i].x = c[i].x + offset * std::cos(angle);
+            moved[i].y = c[i].y + offset * std::sin(angle);
+        }
+    }
+
+    // 每次微移后仍然退化，不能把空结果当作“不相交”
+    result.clear();
+    return false;
+}
+
+std::vector<D2D1_POINT_2F> PolygonClipping::RectPolygon(float xmin, float ymin, float xmax, float ymax) {
+    return {D2D1::Point2F(xmin, ymin), D2D1::Point2F(xmax, ymin),
+            D2D1::Point2F(xmax, ymax), D2D1::Point2F(xmin, ymax)};
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <d2d1.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 批量多边形缓冲：所有多边形的顶点连续存放，第 i 个多边形为 points[offsets[i]] ~ points[offsets[i + 1]]
+// 预先 Reserve 后反复 Clear 复用，裁剪大批多边形时不再分配内存
+struct PolygonArena {
+    std::vector<D2D1_POINT_2F> points;
+    std::vector<uint32_t> offsets = {0};
+
+    size_t Count() const {
+        return offsets.size() - 1;
+    }
+    const D2D1_POINT_2F *Points(size_t i) const {
+        return points.data() + offsets[i];
+    }
+    size_t Size(size_t i) const {
+        return offsets[i + 1] - offsets[i];
+    }
+    void Clear() {
+        points.clear();
+        offsets.assign(1, 0);
+    }
+    void Reserve(size_t pointCount, size_t polygonCount) {
+        points.reserve(pointCount);
+        offsets.reserve(polygonCount + 1);
+    }
+    void Add(const D2D1_POINT_2F *polygon, size_t count) {
+        points.insert(points.end(), polygon, polygon + count);
+        EndPolygon();
+    }
+    // 直接向 points 追加顶点后调用，结束当前多边形
+    void EndPolygon() {
+        offsets.push_back(static_cast<uint32_t>(points.size()));
+    }
+};
+
+// 多边形裁剪算法
+namespace PolygonClipping {
+    // 流水线式Sutherland-Hodgman裁剪器（轴对齐矩形窗口）
+    // 左、右、下、上四条边界各是一级，顶点逐个流过四级，每级只保存首点和前一点，不产生中间数组；
+    // 输出顶点的顺序和数值与逐边整表裁剪完全相同。裁剪器不含共享状态，不同线程各用一个即可
+    class SutherlandHodgmanClipper {
+    public:
+        SutherlandHodgmanClipper(float xmin, float ymin, float xmax, float ymax);
+
+        // 裁剪一个多边形，结果顶点追加到 out.points 末尾（不结束多边形），返回追加的顶点数
+        size_t Clip(const D2D1_POINT_2F *polygon, size_t count, PolygonArena &out);
+
+    private:
+        struct Stage {
+            D2D1_POINT_2F first, prev;
+            bool hasFirst;
+            bool passThrough; // 多边形整个在这条边界内侧，顶点直接送到下一级
+        };
+
+        float m_xmin, m_ymin, m_xmax, m_ymax;
+        Stage m_stages[4];
+        std::vector<D2D1_POINT_2F> *m_out;
+
+        template <int EDGE> bool Inside(D2D1_POINT_2F p) const;
+        template <int EDGE> D2D1_POINT_2F Intersect(D2D1_POINT_2F a, D2D1_POINT_2F b) const;
+        template <int EDGE> void Push(D2D1_POINT_2F p);
+        template <int EDGE> void Emit(D2D1_POINT_2F p);
+        template <int EDGE> void ProcessEdge(D2D1_POINT_2F a, D2D1_POINT_2F b);
+        template <int EDGE> void Close();
+    };
+
+    // 单个多边形的Sutherland-Hodgman裁剪；顶点数少于3时原样返回
+    std::vector<D2D1_POINT_2F> SutherlandHodgmanClip(
+        const std::vector<D2D1_POINT_2F> &polygon,
+        float xmin, float ymin, float xmax, float ymax);
+
+    // 批量裁剪：input 中每个多边形在 output 中对应一个结果（可能为空），output 先被清空
+    // 省下的是逐个多边形的分配，多边形小而多时明显；每个多边形上千顶点时与逐个调用相当，
+    // 输出缓冲要反复使用才不付缺页的代价
+    void SutherlandHodgmanClipBatch(const PolygonArena &input,
+                                    float xmin, float ymin, float xmax, float ymax,
+                                    PolygonArena &output);
+
+    // Weiler-Atherton多边形裁剪（Greiner-Hormann实现）：求主多边形与裁剪多边形的交
+    // 两者都可以是任意简单多边形（凹多边形也可以），结果可能是多个多边形，放入 result；不相交时 result 为空
+    // 顶点落在另一多边形的边上等退化情况先微移裁剪多边形重算，多次微移后仍退化则返回 false，result 为空
+    // 边的求交阶段按x方向扫描，只对包围盒重叠的边对求交，顶点数上千时仍然很快
+    bool WeilerAthertonClip(const std::vector<D2D1_POINT_2F> &subject,
+                            const std::vector<D2D1_POINT_2F> &clip,
+                            std::vector<std::vector<D2D1_POINT_2F>> &result);
+
+    // 轴对齐矩形对应的裁剪多边形
+    std::vector<D2D1_POINT_2F> RectPolygon(float xmin, float ymin, float xmax, float ymax);
+}
@@ -0,0 +1,168 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+
+namespace {
+    // 环形缓冲的槽位，用序号做顺序锁：写入前置为奇数，写完置为偶数。
+    // 读者前后两次读到同一个偶数序号才认为事件完整，被覆盖到一半的槽位跳过
+    struct Slot {
+        std::atomic<uint64_t> sequence;
+        TraceEvent event;
+    };
+
+    Slot g_slots[Profiler::EVENT_CAPACITY];
+    std::atomic<uint64_t> g_nextSlot(0);
+
+    const std::chrono::steady_clock::time_point g_origin = std::chrono::steady_clock::now();
+
+    std::atomic<uint32_t> g_nextThreadId(1);
+
+    uint32_t CurrentThreadId() {
+        thread_local uint32_t id = g_nextThreadId.fetch_add(1, std::memory_order_relaxed);
+        return id;
+    }
+
+    // 帧边界在绘制线程上，帧统计可以在任意线程读取，由 g_frameMutex 保护；计数可以在任意线程累加
+    std::mutex g_frameMutex;
+    int64_t g_frameStart = 0;
+    double g_frameMs[Profiler::FRAME_HISTORY];
+    size_t g_frameCount = 0;
+    std::atomic<uint32_t> g_drawCalls(0);
+    std::atomic<uint32_t> g_culled(0);
+    uint32_t g_lastDrawCalls = 0;
+    uint32_t g_lastCulled = 0;
+
+    void WriteJsonString(std::ostream &out, const char *text) {
+        out << '"';
+        for (const char *p = text; *p; ++p) {
+            if (*p == '"' || *p == '\\') {
+                out << '\\' << *p;
+            } else if (static_cast<unsigned char>(*p) < 0x20) {
+                char escaped[8];
+                snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned char>(*p));
+                out << escaped;
+            } else {
+                out << *p;
+            }
+        }
+        out << '"';
+    }
+}
+
+int64_t Profiler::Now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - g_origin).count();
+}
+
+void Profiler::Record(const char *name, int64_t start, int64_t end) {
+    uint64_t index = g_nextSlot.fetch_add(1, std::memory_order_relaxed);
+    Slot &slot = g_slots[index & (EVENT_CAPACITY - 1)];
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.event.name = name;
+    slot.event.start = start;
+    slot.event.duration = end - start;
+    slot.event.threadId = CurrentThreadId();
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+}
+
+void Profiler::BeginFrame() {
+    g_frameStart = Now();
+}
+
+void Profiler::EndFrame() {
+    int64_t end = Now();
+    Record("Frame", g_frameStart, end);
+    std::lock_guard<std::mutex> lock(g_frameMutex);
+    g_frameMs[g_frameCount % FRAME_HISTORY] = (end - g_frameStart) / 1e6;
+    ++g_frameCount;
+    g_lastDrawCalls = g_drawCalls.exchange(0, std::memory_order_relaxed);
+    g_lastCulled = g_culled.exchange(0, std::memory_order_relaxed);
+}
+
+void Profiler::CountDrawCalls(uint32_t count) {
+    g_drawCalls.fetch_add(count, std::memory_order_relaxed);
+}
+
+void Profiler::CountCulled(uint32_t count) {
+    g_culled.fetch_add(count, std::memory_order_relaxed);
+}
+
+FrameStats Profiler::GetFrameStats() {
+    std::lock_guard<std::mutex> lock(g_frameMutex);
+    FrameStats stats = {};
+    stats.drawCalls = g_lastDrawCalls;
+    stats.shapesCulled = g_lastCulled;
+    size_t n = (std::min)(g_frameCount, FRAME_HISTORY);
+    stats.frameCount = n;
+    if (n == 0) return stats;
+
+    stats.lastMs = g_frameMs[(g_frameCount - 1) % FRAME_HISTORY];
+    double sorted[FRAME_HISTORY];
+    std::copy(g_frameMs, g_frameMs + n, sorted);
+    size_t p50 = n / 2;
+    size_t p99 = (std::min)(n - 1, n * 99 / 100);
+    std::nth_element(sorted, sorted + p50, sorted + n);
+    stats.p50Ms = sorted[p50];
+    std::nth_element(sorted, sorted + p99, sorted + n);
+    stats.p99Ms = sorted[p99];
+    return stats;
+}
+
+size_t Profiler::Snapshot(std::vector<TraceEvent> &events) {
+    events.clear();
+    uint64_t end = g_nextSlot.load(std::memory_order_acquire);
+    uint64_t begin = end > EVENT_CAPACITY ? end - EVENT_CAPACITY : 0;
+    events.reserve(static_cast<size_t>(end - begin));
+    for (uint64_t index = begin; index < end; ++index) {
+        const Slot &slot = g_slots[index & (EVENT_CAPACITY - 1)];
+        uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before != 2 * index + 2) continue; // 尚未写完或已被覆盖
+        TraceEvent event = slot.event;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != before) continue;
+        events.push_back(event);
+    }
+    std::sort(events.begin(), events.end(), [](const TraceEvent &a, const TraceEvent &b) {
+        return a.start < b.start;
+    });
+    return events.size();
+}
+
+bool Profiler::DumpChromeTrace(const char *path) {
+    std::vector<TraceEvent> events;
+    Snapshot(events);
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    char fields[160];
+    for (size_t i = 0; i < events.size(); ++i) {
+        const TraceEvent &e = events[i];
+        out << "{\"name\":";
+        WriteJsonString(out, e.name);
+        // 完整事件（ph:X），时间单位为微秒
+        snprintf(fields, sizeof(fields), ",\"cat\":\"app\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}%s\n",
+                 e.start / 1000.0, e.duration / 1000.0, e.threadId, i + 1 < events.size() ? "," : "");
+        out << fields;
+    }
+    out << "]}\n";
+    out.flush();
+    return static_cast<bool>(out);
+}
+
+void Profiler::Reset() {
+    for (Slot &slot : g_slots) {
+        slot.sequence.store(0, std::memory_order_relaxed);
+    }
+    g_nextSlot.store(0, std::memory_order_release);
+    std::lock_guard<std::mutex> lock(g_frameMutex);
+    g_frameCount = 0;
+    g_drawCalls.store(0, std::memory_order_relaxed);
+    g_culled.store(0, std::memory_order_relaxed);
+    g_lastDrawCalls = 0;
+    g_lastCulled = 0;
+}
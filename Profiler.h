@@ -0,0 +1,74 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 轻量级性能剖析：作用域计时写入定长的无锁环形缓冲（写满后覆盖最旧的事件），另外统计每帧耗时和计数，
+// 可在画布上显示，也可导出为 Chrome trace-event JSON（chrome://tracing 或 Perfetto 打开）。
+// 始终编译；记录一个事件只有两次读时钟和一次原子递增，任意线程都可以记录
+
+// 一个计时事件，时间为相对进程起点的纳秒
+struct TraceEvent {
+    const char *name; // 必须是静态字符串
+    int64_t start;
+    int64_t duration;
+    uint32_t threadId;
+};
+
+// 最近若干帧的统计
+struct FrameStats {
+    double lastMs;          // 上一帧耗时
+    double p50Ms;           // 最近 FRAME_HISTORY 帧的中位数
+    double p99Ms;
+    size_t frameCount;      // 参与统计的帧数
+    uint32_t drawCalls;     // 上一帧绘制的图形数
+    uint32_t shapesCulled;  // 上一帧剔除的图形数
+};
+
+class Profiler {
+public:
+    static const size_t EVENT_CAPACITY = 1 << 16; // 环形缓冲容量，必须是2的幂
+    static const size_t FRAME_HISTORY = 256;      // 参与分位数统计的帧数
+
+    // 相对进程起点的纳秒
+    static int64_t Now();
+    // 记录一个事件（ScopedTimer 析构时调用）
+    static void Record(const char *name, int64_t start, int64_t end);
+
+    // 帧边界，在绘制线程调用；EndFrame 记录帧耗时并清零本帧计数
+    static void BeginFrame();
+    static void EndFrame();
+    static void CountDrawCalls(uint32_t count = 1);
+    static void CountCulled(uint32_t count = 1);
+    // 可在任意线程调用（界面线程显示统计浮层时读取上一帧）
+    static FrameStats GetFrameStats();
+
+    // 复制缓冲中已写完的事件，按开始时间排序；返回事件数
+    static size_t Snapshot(std::vector<TraceEvent> &events);
+    // 导出为 Chrome trace-event JSON，失败返回 false
+    static bool DumpChromeTrace(const char *path);
+    // 清空事件和帧统计
+    static void Reset();
+};
+
+// 作用域计时：构造时记下开始时间，析构时写入一个事件
+class ScopedTimer {
+public:
+    explicit ScopedTimer(const char *name) : m_name(name), m_start(Profiler::Now()) {
+    }
+    ~ScopedTimer() {
+        Profiler::Record(m_name, m_start, Profiler::Now());
+    }
+
+    ScopedTimer(const ScopedTimer &) = delete;
+    ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+private:
+    const char *m_name;
+    int64_t m_start;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+// 计时到当前作用域结束，name 必须是静态字符串
+#define PROFILE_SCOPE(name) ScopedTimer PROFILE_CONCAT(profileScope_, __LINE__)(name)
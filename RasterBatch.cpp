@@ -0,0 +1,242 @@
+#include "RasterBatch.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define RASTERBATCH_USE_SSE2 1
+#endif
+
+namespace {
+    const size_t BLOCK_SIZE = 256; // 每次准备的线段数，准备结果放在栈上
+
+    // 一块线段的准备结果：取整后的起点和端点差，以及段数
+    struct LineBlock {
+        int32_t x0[BLOCK_SIZE], y0[BLOCK_SIZE];
+        int32_t dx[BLOCK_SIZE], dy[BLOCK_SIZE];
+        uint32_t runs[BLOCK_SIZE];
+    };
+
+    // 端点截断取整（与 static_cast<int> 相同），求端点差和段数 min(|dx|,|dy|)+1
+    void PrepareLines(const SegmentBatch &lines, size_t first, size_t count, LineBlock &block) {
+        const float *px0 = lines.x0.data() + first;
+        const float *py0 = lines.y0.data() + first;
+        const float *px1 = lines.x1.data() + first;
+        const float *py1 = lines.y1.data() + first;
+        size_t i = 0;
+
+#if RASTERBATCH_USE_SSE2
+        const __m128i one = _mm_set1_epi32(1);
+        for (; i + 4 <= count; i += 4) {
+            __m128i x0 = _mm_cvttps_epi32(_mm_loadu_ps(px0 + i));
+            __m128i y0 = _mm_cvttps_epi32(_mm_loadu_ps(py0 + i));
+            __m128i dx = _mm_sub_epi32(_mm_cvttps_epi32(_mm_loadu_ps(px1 + i)), x0);
+            __m128i dy = _mm_sub_epi32(_mm_cvttps_epi32(_mm_loadu_ps(py1 + i)), y0);
+
+            // SSE2没有整数绝对值和最小值指令，用符号掩码和比较掩码代替
+            __m128i sx = _mm_srai_epi32(dx, 31);
+            __m128i sy = _mm_srai_epi32(dy, 31);
+            __m128i adx = _mm_sub_epi32(_mm_xor_si128(dx, sx), sx);
+            __m128i ady = _mm_sub_epi32(_mm_xor_si128(dy, sy), sy);
+            __m128i xLarger = _mm_cmpgt_epi32(adx, ady);
+            __m128i minor = _mm_or_si128(_mm_and_si128(xLarger, ady), _mm_andnot_si128(xLarger, adx));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(block.x0 + i), x0);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(block.y0 + i), y0);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(block.dx + i), dx);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(block.dy + i), dy);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(block.runs + i), _mm_add_epi32(minor, one));
+        }
+#endif
+
+        // 剩余不足一组的线段
+        for (; i < count; ++i) {
+            block.x0[i] = static_cast<int>(px0[i]);
+            block.y0[i] = static_cast<int>(py0[i]);
+            block.dx[i] = static_cast<int>(px1[i]) - block.x0[i];
+            block.dy[i] = static_cast<int>(py1[i]) - block.y0[i];
+            block.runs[i] = static_cast<uint32_t>((std::min)(abs(block.dx[i]), abs(block.dy[i]))) + 1;
+        }
+    }
+
+    // 按段步进：主方向从 m0 走 amajor 步，次方向从 n0 走 aminor 步，每个次方向坐标输出一段。
+    // 第 j 段（j >= 1）从主方向第 K(j) = ceil(((2j-1)*amajor + 1) / (2*aminor)) 步开始，
+    // 与中点画线法的判别式 d > 0 时才走次方向一致；K 用商和余数无分支递推，每段一次加法和比较。
+    // VERTICAL：主方向为y；FORWARD：主方向为正方向（段从起点一侧开始）
+    template <bool VERTICAL, bool FORWARD>
+    PixelRun *EmitSlices(int m0, int n0, int amajor, int aminor, int sminor, PixelRun *out) {
+        int start = 0;
+        int minor = n0;
+        if (aminor > 0) {
+            int64_t denom = 2 * static_cast<int64_t>(aminor);
+            int64_t step = 2 * static_cast<int64_t>(amajor);
+            int64_t q = step / denom;
+            int64_t r = step % denom;
+            int64_t numer = static_cast<int64_t>(amajor) + 1;
+            int64_t next = (numer + denom - 1) / denom;
+            int64_t rem = next * denom - numer;
+
+            for (int j = 0; j < aminor; ++j) {
+                int end = static_cast<int>(next);
+                int from = FORWARD ? m0 + start : m0 - (end - 1);
+                *out++ = VERTICAL ? PixelRun{minor, from, end - start, 1} : PixelRun{from, minor, end - start, 0};
+                start = end;
+                minor += sminor;
+
+                rem -= r;
+                int64_t borrow = rem >> 63; // rem < 0 时为 -1
+                next += q - borrow;
+                rem += denom & borrow;
+            }
+        }
+        // 最后一段到终点为止
+        int end = amajor + 1;
+        int from = FORWARD ? m0 + start : m0 - (end - 1);
+        *out++ = VERTICAL ? PixelRun{minor, from, end - start, 1} : PixelRun{from, minor, end - start, 0};
+        return out;
+    }
+
+    PixelRun *EmitLine(int x0, int y0, int dx, int dy, PixelRun *out) {
+        int sx = dx > 0 ? 1 : -1;
+        int sy = dy > 0 ? 1 : -1;
+        int adx = abs(dx);
+        int ady = abs(dy);
+        if (adx > ady) {
+            // 斜率 <= 1：每行一段水平段
+            return sx > 0 ? EmitSlices<false, true>(x0, y0, adx, ady, sy, out)
+                          : EmitSlices<false, false>(x0, y0, adx, ady, sy, out);
+        }
+        // 斜率 > 1：每列一段竖直段
+        return sy > 0 ? EmitSlices<true, true>(y0, x0, ady, adx, sx, out)
+                      : EmitSlices<true, false>(y0, x0, ady, adx, sx, out);
+    }
+
+    // 八分之一圆弧上 y 不变、x 从 a 到 b 的一串像素，按8个对称位置各输出一段
+    PixelRun *EmitOctantRuns(int cx, int cy, int y, int a, int b, PixelRun *out) {
+        int length = b - a + 1;
+        out[0] = {cx + a, cy + y, length, 0};
+        out[1] = {cx - b, cy + y, length, 0};
+        out[2] = {cx + a, cy - y, length, 0};
+        out[3] = {cx - b, cy - y, length, 0};
+        out[4] = {cx + y, cy + a, length, 1};
+        out[5] = {cx - y, cy + a, length, 1};
+        out[6] = {cx + y, cy - b, length, 1};
+        out[7] = {cx - y, cy - b, length, 1};
+        return out + 8;
+    }
+
+    PixelRun *EmitMidpointCircle(int cx, int cy, int r, PixelRun *out) {
+        int x = 0;
+        int y = r;
+        int d = 1 - r;
+        int runStart = 0;
+        while (x < y) {
+            int previousY = y;
+            if (d < 0) {
+                d += 2 * x + 3;
+            } else {
+                d += 2 * (x - y) + 5;
+                y--;
+            }
+            x++;
+            if (y != previousY) {
+                out = EmitOctantRuns(cx, cy, previousY, runStart, x - 1, out);
+                runStart = x;
+            }
+        }
+        return EmitOctantRuns(cx, cy, y, runStart, x, out);
+    }
+
+    PixelRun *EmitBresenhamCircle(int cx, int cy, int r, PixelRun *out) {
+        int x = 0;
+        int y = r;
+        int d = 3 - 2 * r;
+        int runStart = 0;
+        while (x <= y) {
+            int previousY = y;
+            x++;
+            if (d > 0) {
+                y--;
+                d = d + 4 * (x - y) + 10;
+            } else {
+                d = d + 4 * x + 6;
+            }
+            if (y != previousY) {
+                out = EmitOctantRuns(cx, cy, previousY, runStart, x - 1, out);
+                runStart = x;
+            }
+        }
+        return EmitOctantRuns(cx, cy, y, runStart, x, out);
+    }
+
+    // 八分之一圆弧上不同 y 的个数不超过 r - floor(r/√2) + 2，每个 y 输出8段
+    uint32_t CircleRunBound(float radius) {
+        int r = static_cast<int>(radius);
+        if (r < 0) return 8;
+        return 8 * static_cast<uint32_t>(r - static_cast<int>(r * 0.7071f) + 3);
+    }
+}
+
+size_t RasterBatch::CountLineRuns(const SegmentBatch &lines, uint32_t *runCounts) {
+    size_t n = lines.Size();
+    size_t total = 0;
+    LineBlock block;
+    for (size_t first = 0; first < n; first += BLOCK_SIZE) {
+        size_t count = (std::min)(BLOCK_SIZE, n - first);
+        PrepareLines(lines, first, count, block);
+        for (size_t i = 0; i < count; ++i) {
+            total += block.runs[i];
+        }
+        if (runCounts) {
+            std::copy(block.runs, block.runs + count, runCounts + first);
+        }
+    }
+    return total;
+}
+
+size_t RasterBatch::RasterizeLines(const SegmentBatch &lines, PixelRun *runs, uint32_t *runOffsets) {
+    size_t n = lines.Size();
+    PixelRun *out = runs;
+    LineBlock block;
+    for (size_t first = 0; first < n; first += BLOCK_SIZE) {
+        size_t count = (std::min)(BLOCK_SIZE, n - first);
+        PrepareLines(lines, first, count, block);
+        for (size_t i = 0; i < count; ++i) {
+            if (runOffsets) runOffsets[first + i] = static_cast<uint32_t>(out - runs);
+            out = EmitLine(block.x0[i], block.y0[i], block.dx[i], block.dy[i], out);
+        }
+    }
+    if (runOffsets) runOffsets[n] = static_cast<uint32_t>(out - runs);
+    return static_cast<size_t>(out - runs);
+}
+
+size_t RasterBatch::CircleRunCapacity(const CircleBatch &circles, uint32_t *runCounts) {
+    size_t total = 0;
+    for (size_t i = 0; i < circles.Size(); ++i) {
+        uint32_t bound = CircleRunBound(circles.radius[i]);
+        if (runCounts) runCounts[i] = bound;
+        total += bound;
+    }
+    return total;
+}
+
+size_t RasterBatch::RasterizeCircles(const CircleBatch &circles, CircleAlgorithm algorithm,
+                                     PixelRun *runs, uint32_t *runOffsets) {
+    // 每个圆的工作量正比于半径，逐段步进占绝大部分，准备工作不值得向量化
+    size_t n = circles.Size();
+    PixelRun *out = runs;
+    for (size_t i = 0; i < n; ++i) {
+        if (runOffsets) runOffsets[i] = static_cast<uint32_t>(out - runs);
+        int cx = static_cast<int>(floorf(circles.cx[i]));
+        int cy = static_cast<int>(floorf(circles.cy[i]));
+        int r = static_cast<int>(circles.radius[i]);
+        if (algorithm == CircleAlgorithm::MIDPOINT) {
+            out = EmitMidpointCircle(cx, cy, r, out);
+        } else {
+            out = EmitBresenhamCircle(cx, cy, r, out);
+        }
+    }
+    if (runOffsets) runOffsets[n] = static_cast<uint32_t>(out - runs);
+    return static_cast<size_t>(out - runs);
+}
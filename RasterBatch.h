@@ -0,0 +1,64 @@
+#pragma once
+#include <d2d1.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "LineClipping.h" // SegmentBatch
+
+// 整数像素段：从 (x, y) 起沿x正方向（水平段）或y正方向（竖直段）连续 length 个像素，16字节
+struct PixelRun {
+    int32_t x, y;
+    int32_t length;
+    int32_t vertical; // 0：水平段  1：竖直段
+};
+
+// 结构数组形式的圆批
+struct CircleBatch {
+    std::vector<float> cx, cy, radius;
+
+    size_t Size() const {
+        return cx.size();
+    }
+    void Clear() {
+        cx.clear();
+        cy.clear();
+        radius.clear();
+    }
+    void Reserve(size_t count) {
+        cx.reserve(count);
+        cy.reserve(count);
+        radius.reserve(count);
+    }
+    void Add(D2D1_POINT_2F center, float r) {
+        cx.push_back(center.x);
+        cy.push_back(center.y);
+        radius.push_back(r);
+    }
+};
+
+enum class CircleAlgorithm {
+    MIDPOINT,
+    BRESENHAM
+};
+
+// 直线、圆的批量光栅化：输出整数像素段而不是逐个像素点，写入调用方提供的缓冲，不做任何分配。
+// 直线用按段步进的Bresenham（run-slice）：主方向上每一行（列）的像素一次算出一段，每段一次加法和比较；
+// 端点取整、差值和段数的准备工作用SSE2一次处理4条线段
+namespace RasterBatch {
+    // 每条线段的段数（次方向跨度+1）写入 runCounts（可为空），返回总段数，用于分配 runs
+    size_t CountLineRuns(const SegmentBatch &lines, uint32_t *runCounts);
+
+    // 批量光栅化直线，像素与 MidpointLine / BresenhamLine 相同（两者对同一对端点生成相同的像素）。
+    // runs 的容量至少为 CountLineRuns 的返回值；runOffsets（可为空，n+1 项）返回第 i 条线段的段位于
+    // [runOffsets[i], runOffsets[i+1])；返回写入的段数
+    size_t RasterizeLines(const SegmentBatch &lines, PixelRun *runs, uint32_t *runOffsets);
+
+    // 每个圆段数的上界写入 runCounts（可为空），返回总和，用于分配 runs
+    size_t CircleRunCapacity(const CircleBatch &circles, uint32_t *runCounts);
+
+    // 批量光栅化圆：按所选算法走八分之一圆弧，y 不变的一串像素按8个对称位置各输出一段。
+    // 像素与 MidpointCircle / BresenhamCircle 生成后按整数像素取整（向下）的结果相同，即圆心取整到所在像素、半径截断为整数。
+    // runs 的容量至少为 CircleRunCapacity 的返回值；runOffsets 含义同 RasterizeLines；返回写入的段数
+    size_t RasterizeCircles(const CircleBatch &circles, CircleAlgorithm algorithm,
+                            PixelRun *runs, uint32_t *runOffsets);
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <d2d1.h>
+#include <cstddef>
+#include "CommonType.h"
+
+// 与设备无关的绘制后端接口
+// Shape::DrawTo 通过它输出图元，可由软件光栅化（离屏/缩略图/导出）等不同后端实现
+class RenderBackend {
+public:
+    virtual ~RenderBackend() = default;
+
+    // 用指定颜色清空当前绘制区域
+    virtual void Clear(const D2D1_COLOR_F &color) = 0;
+
+    // 描边操作：width 为像素线宽，style 为线型（虚线模式以线宽为单位，与D2D笔划样式一致）
+    virtual void DrawLine(D2D1_POINT_2F p0, D2D1_POINT_2F p1,
+                          const D2D1_COLOR_F &color, float width, LineStyle style) = 0;
+    virtual void DrawPolyline(const D2D1_POINT_2F *points, size_t count, bool closed,
+                              const D2D1_COLOR_F &color, float width, LineStyle style) = 0;
+    virtual void DrawEllipse(D2D1_POINT_2F center, float radiusX, float radiusY,
+                             const D2D1_COLOR_F &color, float width, LineStyle style) = 0;
+    // 三次Bezier曲线（起点、两个控制点、终点）
+    virtual void DrawBezier(D2D1_POINT_2F p0, D2D1_POINT_2F p1, D2D1_POINT_2F p2, D2D1_POINT_2F p3,
+                            const D2D1_COLOR_F &color, float width, LineStyle style) = 0;
+
+    // 填充操作
+    virtual void FillPolygon(const D2D1_POINT_2F *points, size_t count, const D2D1_COLOR_F &color) = 0;
+    // 逐像素填充（每个点对应 [x, x+1) x [y, y+1) 的像素方块），用于填充算法结果和像素级画线/画圆算法
+    virtual void FillPixels(const D2D1_POINT_2F *pixels, size_t count, const D2D1_COLOR_F &color) = 0;
+};
@@ -0,0 +1,129 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+// 绘制线程：界面线程提交帧，绘制线程取出最新的一帧交给绘制函数。
+// 只有一个待绘制的槽位：绘制期间提交的帧互相覆盖（计入 coalesced），无论鼠标消息多密集，最多只有一帧在等待，
+// 提交只在锁内交换一次，不等待绘制。帧应在提交前构造完整、之后不再修改，绘制线程只读。
+// 帧类型和绘制函数由使用者给出，本身与 D2D 无关，可以脱离窗口单独测试
+template <typename Frame>
+class RenderThread {
+public:
+    typedef std::function<void(const Frame &)> RenderFunction;
+
+    struct Stats {
+        uint64_t submitted; // 提交的帧数
+        uint64_t rendered;  // 交给绘制函数的帧数
+        uint64_t coalesced; // 未绘制就被后来的帧替换的帧数
+    };
+
+    RenderThread() : m_hasPending(false), m_busy(false), m_stop(false), m_stats() {
+    }
+    ~RenderThread() {
+        Stop();
+    }
+
+    RenderThread(const RenderThread &) = delete;
+    RenderThread &operator=(const RenderThread &) = delete;
+
+    // 启动绘制线程；已在运行时不做任何事
+    void Start(RenderFunction render) {
+        if (m_thread.joinable()) return;
+        m_render = std::move(render);
+        m_stop = false;
+        m_thread = std::thread(&RenderThread::Run, this);
+    }
+
+    // 丢弃尚未开始绘制的帧，等正在绘制的帧画完后结束线程
+    void Stop() {
+        if (!m_thread.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+            if (m_hasPending) {
+                m_pending = Frame();
+                m_hasPending = false;
+            }
+        }
+        m_wake.notify_all();
+        m_thread.join();
+        m_render = nullptr;
+    }
+
+    bool IsRunning() const {
+        return m_thread.joinable();
+    }
+
+    // 提交一帧，替换尚未开始绘制的上一帧；返回是否替换了帧。线程未运行时丢弃
+    bool Submit(Frame frame) {
+        Frame replaced;
+        bool coalesced;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_stop || !m_thread.joinable()) return false;
+            coalesced = m_hasPending;
+            // 被替换的帧换到锁外释放，界面线程持锁时间与帧内容无关
+            std::swap(replaced, m_pending);
+            m_pending = std::move(frame);
+            m_hasPending = true;
+            ++m_stats.submitted;
+            if (coalesced) ++m_stats.coalesced;
+        }
+        m_wake.notify_one();
+        return coalesced;
+    }
+
+    // 等待已提交的帧画完（或被替换），用于修改帧中共享的数据之前
+    void WaitIdle() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_idle.wait(lock, [this]() {
+            return m_stop || (!m_hasPending && !m_busy);
+        });
+    }
+
+    Stats GetStats() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+private:
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake; // 有新帧或要求停止
+    std::condition_variable m_idle; // 槽位为空且没有正在绘制的帧
+    Frame m_pending;
+    bool m_hasPending;
+    bool m_busy;
+    bool m_stop;
+    Stats m_stats;
+    RenderFunction m_render;
+    std::thread m_thread;
+
+    void Run() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;) {
+            m_wake.wait(lock, [this]() {
+                return m_stop || m_hasPending;
+            });
+            if (m_stop) break;
+            Frame frame = std::move(m_pending);
+            m_pending = Frame();
+            m_hasPending = false;
+            m_busy = true;
+            ++m_stats.rendered;
+            lock.unlock();
+
+            m_render(frame);
+            frame = Frame(); // 在绘制线程上释放帧，不在持锁时析构
+
+            lock.lock();
+            m_busy = false;
+            if (!m_hasPending) m_idle.notify_all();
+        }
+        m_busy = false;
+        m_idle.notify_all();
+    }
+};
@@ -1,65 +1,571 @@
 #include "Shape.h"
+#include "RenderBackend.h"
+#include "StrokeSpans.h"
+#include "DashPattern.h"
+#include "DeviceResourceCache.h"
+#include "Log.h"
 #include <cmath>
 #include <sstream>
 #include <algorithm>
 #include <vector>
+#include <atomic>
 
 // ɨ丨
 namespace {
-    // ص㼯
-    void DrawPixels(ID2D1RenderTarget* pRenderTarget, ID2D1SolidColorBrush* pBrush,
-                    const std::vector<D2D1_POINT_2F>& pixels) {
-        for (const auto& pixel : pixels) {
-            D2D1_ELLIPSE ellipse = D2D1::Ellipse(pixel, 0.5f, 0.5f);
-            pRenderTarget->FillEllipse(ellipse, pBrush);
+    const float PIXEL_PI = 3.14159265358979323846f;
+
+    // λԲ CIRCLE_SEGMENTS ȷֵ (cos, sin) ״ʹʱһΣֲ̬ĳʼ̰߳ȫģ
+    const D2D1_POINT_2F *UnitCircle() {
+        struct Table {
+            D2D1_POINT_2F points[Shape::CIRCLE_SEGMENTS];
+            Table() {
+                for (int i = 0; i < Shape::CIRCLE_SEGMENTS; ++i) {
+                    float angle = 2.0f * 3.14159265358979323846f * i / Shape::CIRCLE_SEGMENTS;
+                    points[i] = D2D1::Point2F(cosf(angle), sinf(angle));
+                }
+            }
+        };
+        static const Table table;
+        return table.points;
+    }
+
+    // segments + 1 ȷֲ degree  Bernstein ֵд (degree + 1) 
+    // ˫ȵĵ B(i,n) = (1-t)B(i,n-1) + tB(i-1,n-1) 㣬 De Casteljau ͬȶ
+    // ÿ̻߳һεĽɢͬʱÿֻ degree + 1 γ˼
+    const float *BernsteinTable(size_t degree, int segments) {
+        thread_local std::vector<float> table;
+        thread_local size_t tableDegree = 0;
+        thread_local int tableSegments = 0;
+        if (tableSegments != segments || tableDegree != degree) {
+            table.resize((degree + 1) * (segments + 1));
+            std::vector<double> basis(degree + 1);
+            for (int i = 0; i <= segments; ++i) {
+                double t = static_cast<double>(i) / segments;
+                std::fill(basis.begin(), basis.end(), 0.0);
+                basis[0] = 1.0;
+                for (size_t n = 1; n <= degree; ++n) {
+                    for (size_t k = n; k > 0; --k) {
+                        basis[k] = (1.0 - t) * basis[k] + t * basis[k - 1];
+                    }
+                    basis[0] *= 1.0 - t;
+                }
+                for (size_t k = 0; k <= degree; ++k) {
+                    table[i * (degree + 1) + k] = static_cast<float>(basis[k]);
+                }
+            }
+            tableDegree = degree;
+            tableSegments = segments;
+        }
+        return table.data();
+    }
+
+    // ؼֱƽα꣬visit(ƫ, Ƿʵ)
+    // ÿǰһ񣬻ӹ̶ |d| / max(|dx|, |dy|)Ҫؿ
+    template <typename Visit>
+    void WalkLinePixels(const PixelPattern &pattern, LineStyle lineStyle, Visit visit) {
+        DashCursor dash(DashPatterns::Pixel(lineStyle));
+        const D2D1_POINT_2F &last = pattern.back();
+        float major = (std::max)(fabsf(last.x), fabsf(last.y));
+        float step = major > 0 ? sqrtf(last.x * last.x + last.y * last.y) / major : 0.0f;
+        for (const auto &offset : pattern) {
+            visit(offset, dash.IsOn());
+            dash.Advance(step);
         }
     }
-    
-    // ʽǷĳλõ
-    bool ShouldDrawPixelForLineStyle(float distance, LineStyle lineStyle) {
-        const float dashLength = 8.0f;    // ߶γ
-        const float dotLength = 2.0f;     // ĳ
-        const float gapLength = 4.0f;     // 
-        
-        // תΪģʽλ
-        float position = fmod(distance, dashLength + gapLength);
-        
-        switch (lineStyle) {
-            case LineStyle::SOLID:
-                return true;
-                
-            case LineStyle::DASH:
-                // ߣ8߶ + 4ؼ
-                return position < dashLength;
-                
-            case LineStyle::DOT:
-                // ߣ2ص + 4ؼ
-                position = fmod(distance, dotLength + gapLength);
-                return position < dotLength;
-                
-            case LineStyle::DASH_DOT: {
-                // 㻮ߣ8߶ + 2ؼ + 2ص + 2ؼ
-                float pattern = dashLength + gapLength + dotLength + gapLength; // 16
-                position = fmod(distance, pattern);
-                if (position < dashLength) return true; // ߶β
-                if (position >= dashLength + gapLength && position < dashLength + gapLength + dotLength) return true; // 㲿
-                return false;
+
+    // ؼԲǶ˳ƽα꣨x𣬻 = Ƕ * radius
+    // ģÿ8ԳƵ8˷ԲڽǶ [k/4, (k+1)/4] кβӣ
+    // ˷ԲеϡԽϵֻһΣԽԽߵĲڰ˷Բߡ
+    // ˷Բ u ÿһ񣬻 du * r / vv Ϊһ꣬ȡƽ
+    // ֻһγص atan2 ȡģ˷Բ֮䰴صľƽ
+    template <typename Visit>
+    void WalkCirclePixels(const PixelPattern &pattern, float radius, LineStyle lineStyle, Visit visit) {
+        // Ƕ k Ӧİ˷Բһ8еλãԼǷ˳
+        static const int OCTANT[8] = {4, 0, 1, 5, 7, 3, 2, 6};
+        static const bool REVERSED[8] = {false, true, false, true, false, true, false, true};
+
+        // ÿ0Ϊ (u, v)u 0ʼv  r ʼݼֻȡ u <= v Ĳ
+        size_t steps = 0;
+        while (steps < pattern.size() / 8 && pattern[steps * 8].x <= pattern[steps * 8].y) ++steps;
+        if (steps == 0) return;
+        bool diagonal = pattern[(steps - 1) * 8].x == pattern[(steps - 1) * 8].y;
+        // ˳ߵİ˷Բȡ [0, steps)ߵȥԽߺϵĵ㣬ȡ [1, reversedEnd)
+        size_t reversedEnd = diagonal ? steps - 1 : steps;
+
+        auto arcStep = [&](size_t j) {
+            const D2D1_POINT_2F &a = pattern[j * 8];
+            const D2D1_POINT_2F &b = pattern[(j + 1) * 8];
+            float v = 0.5f * (a.y + b.y);
+            return v > 0 ? (b.x - a.x) * radius / v : 0.0f;
+        };
+
+        DashCursor dash(DashPatterns::Pixel(lineStyle));
+        const D2D1_POINT_2F *previous = nullptr;
+        for (int k = 0; k < 8; ++k) {
+            size_t first = REVERSED[k] ? 1 : 0;
+            size_t count = REVERSED[k] ? reversedEnd : steps;
+            for (size_t i = first; i < count; ++i) {
+                size_t j = REVERSED[k] ? count - i : i;
+                const D2D1_POINT_2F &point = pattern[j * 8 + OCTANT[k]];
+                if (previous) {
+                    if (i > first) {
+                        dash.Advance(arcStep(REVERSED[k] ? j : j - 1));
+                    } else {
+                        float dx = point.x - previous->x;
+                        float dy = point.y - previous->y;
+                        dash.Advance(sqrtf(dx * dx + dy * dy));
+                    }
+                }
+                visit(point, dash.IsOn());
+                previous = &point;
             }
-            
-            case LineStyle::DASH_DOT_DOT: {
-                // ˫㻮ߣ8߶ + 2ؼ + 2ص + 2ؼ + 2ص + 2ؼ
-                float pattern = dashLength + gapLength + dotLength + gapLength + dotLength + gapLength; // 20
-                position = fmod(distance, pattern);
-                if (position < dashLength) return true; // ߶β
-                if (position >= dashLength + gapLength && position < dashLength + gapLength + dotLength) return true; // һ
-                if (position >= dashLength + gapLength + dotLength + gapLength && 
-                    position < dashLength + gapLength + dotLength + gapLength + dotLength) return true; // ڶ
-                return false;
+        }
+    }
+
+    // ģƽƵԭأÿ̸߳һ黺壬߳Ⱦʱ
+    std::vector<D2D1_POINT_2F> &ScratchPixels() {
+        thread_local std::vector<D2D1_POINT_2F> pixels;
+        return pixels;
+    }
+
+    // ͨƺؼֱ/Բأֻʵϵ
+    void FillStyledLinePixels(RenderBackend &backend, const PixelPattern &pattern, D2D1_POINT_2F origin,
+                              LineStyle lineStyle, const D2D1_COLOR_F &color) {
+        std::vector<D2D1_POINT_2F> &visible = ScratchPixels();
+        if (lineStyle == LineStyle::SOLID) {
+            PixelPatterns::Expand(pattern, origin, visible);
+        } else {
+            visible.clear();
+            WalkLinePixels(pattern, lineStyle, [&](const D2D1_POINT_2F &offset, bool on) {
+                if (on) visible.push_back(D2D1::Point2F(origin.x + offset.x, origin.y + offset.y));
+            });
+        }
+        backend.FillPixels(visible.data(), visible.size(), color);
+    }
+
+    void FillStyledCirclePixels(RenderBackend &backend, const PixelPattern &pattern, D2D1_POINT_2F center,
+                                float radius, LineStyle lineStyle, const D2D1_COLOR_F &color) {
+        std::vector<D2D1_POINT_2F> &visible = ScratchPixels();
+        if (lineStyle == LineStyle::SOLID) {
+            PixelPatterns::Expand(pattern, center, visible);
+        } else {
+            visible.clear();
+            WalkCirclePixels(pattern, radius, lineStyle, [&](const D2D1_POINT_2F &offset, bool on) {
+                if (on) visible.push_back(D2D1::Point2F(center.x + offset.x, center.y + offset.y));
+            });
+        }
+        backend.FillPixels(visible.data(), visible.size(), color);
+    }
+
+    // õضλ壬ÿ̸߳һ
+    StrokeSpans &ScratchSpans() {
+        thread_local StrokeSpans spans;
+        return spans;
+    }
+
+    // ·Σǰ̵߳Դ󶨵ȾĿ꣨ݵĿ꣩ʱ (version, variant) ãʱ
+    // صļɵ÷ ReleaseʧʱΪ
+    template <typename Build>
+    ID2D1PathGeometry *AcquirePathGeometry(ID2D1RenderTarget *pRenderTarget, uint64_t version, uint32_t variant, Build build) {
+        DeviceResourceCache *cache = DeviceResourceCache::Current();
+        if (cache && cache->IsBoundTo(pRenderTarget)) {
+            ID2D1PathGeometry *pGeometry = cache->GetPathGeometry(version, variant, build);
+            if (pGeometry) pGeometry->AddRef();
+            return pGeometry;
+        }
+        ID2D1Factory *pFactory = nullptr;
+        pRenderTarget->GetFactory(&pFactory);
+        ID2D1PathGeometry *pGeometry = DeviceResourceCache::CreatePathGeometry(pFactory, build);
+        if (pFactory) pFactory->Release();
+        return pGeometry;
+    }
+
+    // ɫˢȡͬ AcquirePathGeometryصĻˢɵ÷ Release
+    ID2D1SolidColorBrush *AcquireBrush(ID2D1RenderTarget *pRenderTarget, const D2D1_COLOR_F &color) {
+        DeviceResourceCache *cache = DeviceResourceCache::Current();
+        ID2D1SolidColorBrush *pBrush = nullptr;
+        if (cache && cache->IsBoundTo(pRenderTarget)) {
+            pBrush = cache->GetBrush(color);
+            if (pBrush) pBrush->AddRef();
+        } else {
+            pRenderTarget->CreateSolidColorBrush(color, &pBrush);
+        }
+        return pBrush;
+    }
+
+    // ͬһִߵ߿
+    uint32_t StrokeVariant(int lineWidth, LineStyle lineStyle) {
+        return static_cast<uint32_t>(lineWidth) << 8 | static_cast<uint32_t>(lineStyle);
+    }
+
+    // ϸڲΣͼС߰ϵĳɢÿԼ LOD_FLATTEN_PIXELS أ LOD_MIN_FLATTEN_SEGS 
+    const float LOD_FLATTEN_PIXELS = 6.0f;
+    const int LOD_MIN_FLATTEN_SEGS = 4;
+    // ͼθĻλͼʱཱུ 2^-MAX_MASK_LEVEL߳Գ MAX_MASK_SIZE վػ
+    const int MAX_MASK_LEVEL = 10;
+    const UINT32 MAX_MASK_SIZE = 2048;
+    // صλͼعüΰ汾
+    const uint32_t FILL_MASK_VARIANT = 0;
+
+    // ǰԴ¼ͼţ治ȾĿ꣨ƵȣʱԭʼС
+    float ViewScaleFor(ID2D1RenderTarget *pRenderTarget) {
+        DeviceResourceCache *cache = DeviceResourceCache::Current();
+        return cache && cache->IsBoundTo(pRenderTarget) ? cache->GetViewScale() : 1.0f;
+    }
+
+    // D2Dߵ߿ȾĿͼα任ʱС任дغ߿һ
+    float StrokeWidthFor(ID2D1RenderTarget *pRenderTarget, float width) {
+        DeviceResourceCache *cache = DeviceResourceCache::Current();
+        return cache && cache->IsBoundTo(pRenderTarget) ? width / cache->GetStrokeScale() : width;
+    }
+
+    // ߵɢͼδСʱΪ maxSegmentsС󰴿ƶڴϵĳȼ٣
+    // ȡ2ݣͬһڱ仯ʱ䣬·ؽ
+    int FlattenSegments(ID2D1RenderTarget *pRenderTarget, const D2D1_POINT_2F *points, size_t count, int maxSegments) {
+        float zoom = ViewScaleFor(pRenderTarget);
+        if (zoom >= 1.0f) return maxSegments;
+        float length = 0.0f;
+        for (size_t i = 1; i < count; ++i) {
+            float dx = points[i].x - points[i - 1].x;
+            float dy = points[i].y - points[i - 1].y;
+            length += sqrtf(dx * dx + dy * dy);
+        }
+        float wanted = length * zoom / LOD_FLATTEN_PIXELS;
+        int segments = LOD_MIN_FLATTEN_SEGS;
+        while (segments < maxSegments && segments < wanted) segments *= 2;
+        return (std::min)(segments, maxSegments);
+    }
+
+    // ͼСʱػƵĵ㣨ؼֱ/ԲأϳһA8λͼһ FillOpacityMask 
+    // λͼ 2^-level level ȡԲͼŵֵͬһλͼصĵϲΪһϸ߲Ͽ
+    // λͼ (version, variant, level) 档bounds ΪķΧemit(put) ÿ put(x, y)
+    // ͼδСǰ治ȾĿλͼʱ falseɵ÷ػ
+    template <typename Emit>
+    bool DrawPixelsAsMask(ID2D1RenderTarget *pRenderTarget, ID2D1Brush *pBrush, uint64_t version, uint32_t variant,
+                          const D2D1_RECT_F &bounds, Emit emit) {
+        DeviceResourceCache *cache = DeviceResourceCache::Current();
+        if (!cache || !cache->IsBoundTo(pRenderTarget)) return false;
+        float zoom = cache->GetViewScale();
+        if (zoom >= 1.0f) return false;
+
+        int level = 0;
+        while (level < MAX_MASK_LEVEL && zoom * static_cast<float>(2 << level) <= 1.0f) ++level;
+        float scale = 1.0f / static_cast<float>(1 << level);
+        // ÿռΪĵĵλ񣬷Χһ
+        float left = bounds.left - 1.0f;
+        float top = bounds.top - 1.0f;
+        UINT32 width = static_cast<UINT32>((bounds.right - bounds.left + 2.0f) * scale) + 1;
+        UINT32 height = static_cast<UINT32>((bounds.bottom - bounds.top + 2.0f) * scale) + 1;
+        if (width > MAX_MASK_SIZE || height > MAX_MASK_SIZE) return false;
+
+        ID2D1Bitmap *pMask = cache->GetMaskBitmap(version, variant << 4 | static_cast<uint32_t>(level), width, height,
+            [&](uint8_t *pixels, UINT32 pitch) {
+                emit([&](float x, float y) {
+                    int bx = static_cast<int>((x - left) * scale);
+                    int by = static_cast<int>((y - top) * scale);
+                    if (bx >= 0 && by >= 0 && static_cast<UINT32>(bx) < width && static_cast<UINT32>(by) < height) {
+                        pixels[by * pitch + bx] = 255;
+                    }
+                });
+            });
+        if (!pMask) return false;
+
+        D2D1_RECT_F dest = D2D1::RectF(left, top, left + width / scale, top + height / scale);
+        // FillOpacityMask ҪȾĿΪģʽ
+        D2D1_ANTIALIAS_MODE mode = pRenderTarget->GetAntialiasMode();
+        pRenderTarget->SetAntialiasMode(D2D1_ANTIALIAS_MODE_ALIASED);
+        pRenderTarget->FillOpacityMask(pMask, pBrush, D2D1_OPACITY_MASK_CONTENT_GRAPHICS, &dest, nullptr);
+        pRenderTarget->SetAntialiasMode(mode);
+        return true;
+    }
+
+    bool DrawLinePixelsAsMask(ID2D1RenderTarget *pRenderTarget, ID2D1Brush *pBrush, uint64_t version,
+                              const PixelPattern &pattern, D2D1_POINT_2F origin, const D2D1_RECT_F &bounds, LineStyle lineStyle) {
+        return DrawPixelsAsMask(pRenderTarget, pBrush, version, StrokeVariant(1, lineStyle), bounds, [&](auto put) {
+            WalkLinePixels(pattern, lineStyle, [&](const D2D1_POINT_2F &offset, bool on) {
+                if (on) put(origin.x + offset.x, origin.y + offset.y);
+            });
+        });
+    }
+
+    bool DrawCirclePixelsAsMask(ID2D1RenderTarget *pRenderTarget, ID2D1Brush *pBrush, uint64_t version,
+                                const PixelPattern &pattern, D2D1_POINT_2F center, float radius, LineStyle lineStyle) {
+        D2D1_RECT_F bounds = D2D1::RectF(center.x - radius, center.y - radius, center.x + radius, center.y + radius);
+        return DrawPixelsAsMask(pRenderTarget, pBrush, version, StrokeVariant(1, lineStyle), bounds, [&](auto put) {
+            WalkCirclePixels(pattern, radius, lineStyle, [&](const D2D1_POINT_2F &offset, bool on) {
+                if (on) put(center.x + offset.x, center.y + offset.y);
+            });
+        });
+    }
+
+    // ضд· originÿΪĵĵλ񣬶֮以ص
+    void AddSpans(ID2D1GeometrySink *pSink, const std::vector<PixelRun> &spans, D2D1_POINT_2F origin) {
+        for (const PixelRun &span : spans) {
+            float left = origin.x + span.x - 0.5f;
+            float top = origin.y + span.y - 0.5f;
+            float right = left + span.length;
+            float bottom = top + 1.0f;
+            D2D1_POINT_2F corners[3] = {
+                D2D1::Point2F(right, top), D2D1::Point2F(right, bottom), D2D1::Point2F(left, bottom)
+            };
+            pSink->BeginFigure(D2D1::Point2F(left, top), D2D1_FIGURE_BEGIN_FILLED);
+            pSink->AddLines(corners, 3);
+            pSink->EndFigure(D2D1_FIGURE_END_CLOSED);
+        }
+    }
+
+    // һ·һضΣΰͼεļΰ汾棬ֻмα仯¼ض
+    template <typename ComputeSpans>
+    void FillSpans(ID2D1RenderTarget *pRenderTarget, ID2D1Brush *pBrush, uint64_t version, uint32_t variant,
+                   ComputeSpans computeSpans, D2D1_POINT_2F origin) {
+        ID2D1PathGeometry *pPathGeometry = AcquirePathGeometry(pRenderTarget, version, variant,
+            [&](ID2D1GeometrySink *pSink) {
+                AddSpans(pSink, computeSpans(), origin);
+            });
+        if (pPathGeometry) {
+            pRenderTarget->FillGeometry(pPathGeometry, pBrush);
+            pPathGeometry->Release();
+        }
+    }
+
+    // ؼֱߵĴߣʵΪβ֮һԲͷ߶Σ
+    // ߰ʵϵغϳһƽͷ߶Σ˸أסβأ
+    const std::vector<PixelRun> &ThickPixelLineSpans(const PixelPattern &pattern, int lineWidth, LineStyle lineStyle) {
+        StrokeSpans &spans = ScratchSpans();
+        spans.Clear();
+        float halfWidth = lineWidth / 2.0f;
+        D2D1_POINT_2F last = pattern.back();
+
+        if (lineStyle == LineStyle::SOLID) {
+            spans.AddSegment(D2D1::Point2F(0.0f, 0.0f), last, halfWidth, LineCap::ROUND);
+        } else {
+            float length = sqrtf(last.x * last.x + last.y * last.y);
+            float ex = length > 0 ? 0.5f * last.x / length : 0.0f;
+            float ey = length > 0 ? 0.5f * last.y / length : 0.0f;
+            bool inDash = false;
+            D2D1_POINT_2F dashFirst = {}, previous = {};
+            auto closeDash = [&]() {
+                spans.AddSegment(D2D1::Point2F(dashFirst.x - ex, dashFirst.y - ey),
+                                 D2D1::Point2F(previous.x + ex, previous.y + ey), halfWidth, LineCap::FLAT);
+            };
+            WalkLinePixels(pattern, lineStyle, [&](const D2D1_POINT_2F &offset, bool on) {
+                if (on && !inDash) dashFirst = offset;
+                if (!on && inDash) closeDash();
+                inDash = on;
+                previous = offset;
+            });
+            if (inDash) closeDash();
+        }
+        return spans.Finish();
+    }
+
+    void DrawThickPixelLine(ID2D1RenderTarget *pRenderTarget, ID2D1Brush *pBrush, uint64_t version,
+                            const PixelPattern &pattern, D2D1_POINT_2F origin, int lineWidth, LineStyle lineStyle) {
+        FillSpans(pRenderTarget, pBrush, version, StrokeVariant(lineWidth, lineStyle), [&]() -> const std::vector<PixelRun> & {
+            return ThickPixelLineSpans(pattern, lineWidth, lineStyle);
+        }, origin);
+    }
+
+    // ؼԲĴߣ뾶ΪߵԲ߰ƽα꣬
+    // ÿʵһԲƽͷҶƴӣҶӴӳШȱڣ
+    const std::vector<PixelRun> &ThickPixelCircleSpans(float radius, int lineWidth, LineStyle lineStyle) {
+        StrokeSpans &spans = ScratchSpans();
+        spans.Clear();
+        float ring = static_cast<float>(static_cast<int>(radius));
+        float halfWidth = lineWidth / 2.0f;
+
+        if (lineStyle == LineStyle::SOLID || radius <= 0) {
+            spans.AddRing(D2D1::Point2F(0.0f, 0.0f), ring, halfWidth);
+        } else {
+            // ҵĽǶȲҸ߲0.1أШȱڲ
+            float maxStep = (std::min)(sqrtf(0.8f / (std::max)(ring, 1.0f)), 0.5f / halfWidth);
+            DashCursor dash(DashPatterns::Pixel(lineStyle));
+            float total = 2.0f * PIXEL_PI * radius;
+            float s = 0.0f;
+            while (s < total) {
+                float length = (std::min)(dash.Remaining(), total - s);
+                if (dash.IsOn()) {
+                    float a0 = s / radius;
+                    float a1 = (s + length) / radius;
+                    int n = (std::max)(1, static_cast<int>(ceilf((a1 - a0) / maxStep)));
+                    float delta = (a1 - a0) / n;
+                    float extend = halfWidth * tanf(0.5f * delta) + 0.05f;
+                    D2D1_POINT_2F p = D2D1::Point2F(ring * cosf(a0), ring * sinf(a0));
+                    for (int i = 0; i < n; ++i) {
+                        float angle = a0 + delta * (i + 1);
+                        D2D1_POINT_2F q = D2D1::Point2F(ring * cosf(angle), ring * sinf(angle));
+                        float cx = q.x - p.x, cy = q.y - p.y;
+                        float chord = sqrtf(cx * cx + cy * cy);
+                        D2D1_POINT_2F a = p, b = q;
+                        if (chord > 0) {
+                            cx *= extend / chord;
+                            cy *= extend / chord;
+                            if (i > 0) a = D2D1::Point2F(p.x - cx, p.y - cy);
+                            if (i + 1 < n) b = D2D1::Point2F(q.x + cx, q.y + cy);
+                        }
+                        spans.AddSegment(a, b, halfWidth, LineCap::FLAT);
+                        p = q;
+                    }
+                }
+                s += length;
+                dash.Advance(length);
             }
-            
-            default:
-                return true;
         }
+        return spans.Finish();
+    }
+
+    void DrawThickPixelCircle(ID2D1RenderTarget *pRenderTarget, ID2D1Brush *pBrush, uint64_t version,
+                              D2D1_POINT_2F center, float radius, int lineWidth, LineStyle lineStyle) {
+        FillSpans(pRenderTarget, pBrush, version, StrokeVariant(lineWidth, lineStyle), [&]() -> const std::vector<PixelRun> & {
+            return ThickPixelCircleSpans(radius, lineWidth, lineStyle);
+        }, center);
+    }
+
+    // 㼯İΧУn 0
+    D2D1_RECT_F PointsBounds(const D2D1_POINT_2F *points, size_t n) {
+        D2D1_RECT_F r = D2D1::RectF(points[0].x, points[0].y, points[0].x, points[0].y);
+        for (size_t i = 1; i < n; ++i) {
+            r.left = (std::min)(r.left, points[i].x);
+            r.top = (std::min)(r.top, points[i].y);
+            r.right = (std::max)(r.right, points[i].x);
+            r.bottom = (std::max)(r.bottom, points[i].y);
+        }
+        return r;
+    }
+
+    void UnionRect(D2D1_RECT_F &r, const D2D1_RECT_F &other) {
+        r.left = (std::min)(r.left, other.left);
+        r.top = (std::min)(r.top, other.top);
+        r.right = (std::max)(r.right, other.right);
+        r.bottom = (std::max)(r.bottom, other.bottom);
+    }
+
+    // BezierһϵļֵB'(t)/3 = a t^2 + b t + c  (0,1) ڵ㴦ȡֵ [lo, hi]
+    void ExtendCubicAxis(float p0, float p1, float p2, float p3, float &lo, float &hi) {
+        float a = -p0 + 3.0f * p1 - 3.0f * p2 + p3;
+        float b = 2.0f * (p0 - 2.0f * p1 + p2);
+        float c = p1 - p0;
+        float roots[2];
+        int count = 0;
+        if (fabsf(a) < 1e-6f) {
+            if (fabsf(b) > 1e-6f) roots[count++] = -c / b;
+        } else {
+            float disc = b * b - 4.0f * a * c;
+            if (disc >= 0.0f) {
+                float sq = sqrtf(disc);
+                roots[count++] = (-b + sq) / (2.0f * a);
+                roots[count++] = (-b - sq) / (2.0f * a);
+            }
+        }
+        for (int i = 0; i < count; ++i) {
+            float t = roots[i];
+            if (t <= 0.0f || t >= 1.0f) continue;
+            float u = 1.0f - t;
+            float v = u * u * u * p0 + 3.0f * u * u * t * p1 + 3.0f * u * t * t * p2 + t * t * t * p3;
+            lo = (std::min)(lo, v);
+            hi = (std::max)(hi, v);
+        }
+    }
+
+    // BezierߵĽΧУڿƵ͹ڣߵĿƵΧѱǰʱϸ֣
+    //  t=0.5  De Casteljau ֱ֣ƵΧСݲֱӲ
+    void ExtendBezierBounds(const D2D1_POINT_2F *points, size_t n, D2D1_RECT_F &bounds, int depth) {
+        const float TOLERANCE = 0.01f;
+        const int MAX_DEPTH = 24;
+
+        D2D1_RECT_F hull = PointsBounds(points, n);
+        if (hull.left >= bounds.left && hull.right <= bounds.right &&
+            hull.top >= bounds.top && hull.bottom <= bounds.bottom) {
+            return;
+        }
+        if (depth >= MAX_DEPTH ||
+            (hull.right - hull.left <= TOLERANCE && hull.bottom - hull.top <= TOLERANCE)) {
+            UnionRect(bounds, hull);
+            return;
+        }
+
+        std::vector<D2D1_POINT_2F> work(points, points + n), left(n), right(n);
+        for (size_t level = 0; level < n; ++level) {
+            left[level] = work[0];
+            right[n - 1 - level] = work[n - 1 - level];
+            for (size_t i = 0; i + 1 < n - level; ++i) {
+                work[i] = D2D1::Point2F((work[i].x + work[i + 1].x) * 0.5f, (work[i].y + work[i + 1].y) * 0.5f);
+            }
+        }
+        ExtendBezierBounds(left.data(), n, bounds, depth + 1);
+        ExtendBezierBounds(right.data(), n, bounds, depth + 1);
+    }
+}
+
+std::atomic<BoundsMode> Shape::s_boundsMode(BoundsMode::CONTROL_HULL);
+std::atomic<unsigned> Shape::s_boundsEpoch(1);
+
+uint64_t Shape::NextGeometryVersion() {
+    static std::atomic<uint64_t> s_nextVersion(1);
+    return s_nextVersion.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Shape::SetBoundsMode(BoundsMode mode) {
+    if (mode == s_boundsMode) return;
+    s_boundsMode = mode;
+    // ԪʹлʧЧ0 ʧЧ
+    if (++s_boundsEpoch == 0) s_boundsEpoch = 1;
+}
+
+D2D1_RECT_F Shape::GetBounds() const {
+    const D2D1_RECT_F &r = GetLocalBounds();
+    if (!m_hasTransform) {
+        return r;
+    }
+    const D2D1_MATRIX_3X2_F &m = m_transform;
+    D2D1_POINT_2F corners[4] = {
+        D2D1::Point2F(r.left, r.top), D2D1::Point2F(r.right, r.top),
+        D2D1::Point2F(r.right, r.bottom), D2D1::Point2F(r.left, r.bottom)};
+    for (auto &p : corners) {
+        p = D2D1::Point2F(p.x * m._11 + p.y * m._21 + m._31, p.x * m._12 + p.y * m._22 + m._32);
+    }
+    return PointsBounds(corners, 4);
+}
+
+void Shape::ComposeTransform(const D2D1_MATRIX_3X2_F &t) {
+    const D2D1_MATRIX_3X2_F &m = m_transform;
+    D2D1_MATRIX_3X2_F r;
+    r._11 = m._11 * t._11 + m._12 * t._21;
+    r._12 = m._11 * t._12 + m._12 * t._22;
+    r._21 = m._21 * t._11 + m._22 * t._21;
+    r._22 = m._21 * t._12 + m._22 * t._22;
+    r._31 = m._31 * t._11 + m._32 * t._21 + t._31;
+    r._32 = m._31 * t._12 + m._32 * t._22 + t._32;
+    m_transform = r;
+    m_hasTransform = true;
+}
+
+void Shape::BakeTransform() {
+    if (!m_hasTransform) return;
+    D2D1_MATRIX_3X2_F m = m_transform;
+    m_transform = D2D1::IdentityMatrix();
+    m_hasTransform = false;
+
+    // Ʊ任 p -> sRp + t ֽΪȱšתƽ
+    // һ㣬Ķ֮ӳ䣬ź c1  p -> c1 + s(p - c)
+    //  c1 תΪ c1 + sR(p - c)ƽƵ M(c) һ
+    float scale = sqrtf(m._11 * m._11 + m._12 * m._12);
+    float angle = atan2f(m._12, m._11);
+    D2D1_POINT_2F c = GetCenter();
+    D2D1_POINT_2F target = D2D1::Point2F(c.x * m._11 + c.y * m._21 + m._31,
+                                         c.x * m._12 + c.y * m._22 + m._32);
+
+    if (fabsf(scale - 1.0f) > 1e-6f) {
+        Scale(scale);
+    }
+    D2D1_POINT_2F c1 = GetCenter();
+    if (fabsf(angle) > 1e-7f) {
+        RotateAroundPoint(angle, c1);
+    }
+    float dx = target.x - c1.x;
+    float dy = target.y - c1.y;
+    if (dx != 0.0f || dy != 0.0f) {
+        Move(dx, dy);
     }
 }
 
@@ -112,54 +618,54 @@ std::shared_ptr<Shape> Shape::Deserialize(const std::string &data) {
     if (type == "Line") {
         D2D1_POINT_2F start, end;
         iss >> start.x >> start.y >> end.x >> end.y;
-        shape = std::make_shared<Line>(start, end);
+        shape = MakeDocumentShared<Line>(start, end);
     } else if (type == "MidpointLine") {
         D2D1_POINT_2F start, end;
         iss >> start.x >> start.y >> end.x >> end.y;
-        shape = std::make_shared<MidpointLine>(start, end);
+        shape = MakeDocumentShared<MidpointLine>(start, end);
     } else if (type == "BresenhamLine") {
         D2D1_POINT_2F start, end;
         iss >> start.x >> start.y >> end.x >> end.y;
-        shape = std::make_shared<BresenhamLine>(start, end);
+        shape = MakeDocumentShared<BresenhamLine>(start, end);
     } else if (type == "MidpointCircle") {
         D2D1_POINT_2F center;
         float radius;
         iss >> center.x >> center.y >> radius;
-        shape = std::make_shared<MidpointCircle>(center, radius);
+        shape = MakeDocumentShared<MidpointCircle>(center, radius);
     } else if (type == "BresenhamCircle") {
         D2D1_POINT_2F center;
         float radius;
         iss >> center.x >> center.y >> radius;
-        shape = std::make_shared<BresenhamCircle>(center, radius);
+        shape = MakeDocumentShared<BresenhamCircle>(center, radius);
     } else if (type == "Circle") {
         D2D1_POINT_2F center;
         float radius;
         iss >> center.x >> center.y >> radius;
-        shape = std::make_shared<Circle>(center, radius);
+        shape = MakeDocumentShared<Circle>(center, radius);
     } else if (type == "Rectangle") {
         // Rectangleлʱ4㣬캯ֻҪԽ
         D2D1_POINT_2F p1, p2, p3, p4;
         iss >> p1.x >> p1.y >> p2.x >> p2.y >> p3.x >> p3.y >> p4.x >> p4.y;
         // ʹϽǺ½ؽ
-        shape = std::make_shared<Rect>(p1, p3);
+        shape = MakeDocumentShared<Rect>(p1, p3);
     } else if (type == "Triangle") {
         D2D1_POINT_2F p1, p2, p3;
         iss >> p1.x >> p1.y >> p2.x >> p2.y >> p3.x >> p3.y;
-        shape = std::make_shared<Triangle>(p1, p2, p3);
+        shape = MakeDocumentShared<Triangle>(p1, p2, p3);
     } else if (type == "Diamond") {
         D2D1_POINT_2F center;
         float radiusX, radiusY, angle;
         iss >> center.x >> center.y >> radiusX >> radiusY >> angle;
-        shape = std::make_shared<Diamond>(center, radiusX, radiusY, angle);
+        shape = MakeDocumentShared<Diamond>(center, radiusX, radiusY, angle);
     } else if (type == "Parallelogram") {
         D2D1_POINT_2F p1, p2, p3;
         iss >> p1.x >> p1.y >> p2.x >> p2.y >> p3.x >> p3.y;
-        shape = std::make_shared<Parallelogram>(p1, p2, p3);
+        shape = MakeDocumentShared<Parallelogram>(p1, p2, p3);
     } else if (type == "Curve") {
         D2D1_POINT_2F start, control1, control2, end;
         iss >> start.x >> start.y >> control1.x >> control1.y
             >> control2.x >> control2.y >> end.x >> end.y;
-        shape = std::make_shared<Curve>(start, control1, control2, end);
+        shape = MakeDocumentShared<Curve>(start, control1, control2, end);
     } else if (type == "Polyline") {
         std::vector<D2D1_POINT_2F> points;
         size_t pointCount;
@@ -169,7 +675,7 @@ std::shared_ptr<Shape> Shape::Deserialize(const std::string &data) {
             iss >> point.x >> point.y;
             points.push_back(point);
         }
-        shape = std::make_shared<Poly>(points);
+        shape = MakeDocumentShared<Poly>(points);
     } else if (type == "MultiBezier") {
         std::vector<D2D1_POINT_2F> points;
         size_t pointCount;
@@ -179,7 +685,7 @@ std::shared_ptr<Shape> Shape::Deserialize(const std::string &data) {
             iss >> point.x >> point.y;
             points.push_back(point);
         }
-        auto multiBezier = std::make_shared<MultiBezier>();
+        auto multiBezier = MakeDocumentShared<MultiBezier>();
         for (const auto& point : points) {
             multiBezier->AddControlPoint(point);
         }
@@ -193,7 +699,7 @@ std::shared_ptr<Shape> Shape::Deserialize(const std::string &data) {
             iss >> point.x >> point.y;
             points.push_back(point);
         }
-        shape = std::make_shared<Polygon>(points);
+        shape = MakeDocumentShared<Polygon>(points);
     }
 
     // ɹͼΣԶȡ
@@ -204,6 +710,95 @@ std::shared_ptr<Shape> Shape::Deserialize(const std::string &data) {
     return shape;
 }
 
+void Shape::DrawFillPixels(ID2D1RenderTarget* pRenderTarget) const {
+    if (!IsFilled() || m_fillPixels.empty() || !pRenderTarget) return;
+
+    ID2D1SolidColorBrush* fillBrush = AcquireBrush(pRenderTarget, D2D1::ColorF(D2D1::ColorF::LightBlue, 0.6f));
+    if (fillBrush) {
+        // Сʾʱ仭һŻλͼضͼεİΧڣ (x, y)  [x, x+1)
+        if (!DrawPixelsAsMask(pRenderTarget, fillBrush, m_geometryVersion, FILL_MASK_VARIANT, GetLocalBounds(),
+                              [this](auto put) {
+                                  for (const auto &pixel : m_fillPixels) put(pixel.x + 0.5f, pixel.y + 0.5f);
+                              })) {
+            for (const auto& pixel : m_fillPixels) {
+                D2D1_RECT_F pixelRect = D2D1::RectF(pixel.x, pixel.y, pixel.x + 1.0f, pixel.y + 1.0f);
+                pRenderTarget->FillRectangle(pixelRect, fillBrush);
+            }
+        }
+        fillBrush->Release();
+    }
+}
+
+void Shape::DrawFillPixelsTo(RenderBackend &backend) const {
+    if (!IsFilled()) return;
+    backend.FillPixels(m_fillPixels.data(), m_fillPixels.size(), D2D1::ColorF(D2D1::ColorF::LightBlue, 0.6f));
+}
+
+// Ĭϵɢ߶Σ߽4
+void Shape::VisitIntersectionSegments(SegmentVisitor visit, void *context) const {
+    D2D1_RECT_F bounds = GetBounds();
+    D2D1_POINT_2F corners[4] = {
+        {bounds.left, bounds.top}, {bounds.right, bounds.top}, {bounds.right, bounds.bottom}, {bounds.left, bounds.bottom}
+    };
+    VisitClosedPolyline(corners, 4, visit, context);
+}
+
+std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> Shape::GetIntersectionSegments() const {
+    std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> segments;
+    ForEachIntersectionSegment([&](D2D1_POINT_2F a, D2D1_POINT_2F b) {
+        segments.push_back({a, b});
+    });
+    return segments;
+}
+
+void Shape::VisitClosedPolyline(const D2D1_POINT_2F *points, size_t count, SegmentVisitor visit, void *context) {
+    for (size_t i = 0; i < count; ++i) {
+        visit(context, points[i], points[i + 1 == count ? 0 : i + 1]);
+    }
+}
+
+void Shape::VisitCircleSegments(D2D1_POINT_2F center, float radius, SegmentVisitor visit, void *context) {
+    const D2D1_POINT_2F *unit = UnitCircle();
+    D2D1_POINT_2F first = D2D1::Point2F(center.x + radius * unit[0].x, center.y + radius * unit[0].y);
+    D2D1_POINT_2F previous = first;
+    for (int i = 1; i < CIRCLE_SEGMENTS; ++i) {
+        D2D1_POINT_2F point = D2D1::Point2F(center.x + radius * unit[i].x, center.y + radius * unit[i].y);
+        visit(context, previous, point);
+        previous = point;
+    }
+    visit(context, previous, first);
+}
+
+// Ĭϵĺ˻ƣβӵɢ߶λԭΪߺ
+void Shape::DrawTo(RenderBackend &backend, const D2D1_COLOR_F &color) const {
+    DrawFillPixelsTo(backend);
+
+    float width = (float)GetLineWidthValue();
+    // ߵ㻺ÿ̸߳һݣظƲٷ
+    thread_local std::vector<D2D1_POINT_2F> points;
+    points.clear();
+
+    auto flush = [&]() {
+        if (points.size() >= 2) {
+            // յص˵Ǳպͼ
+            bool closed = points.size() >= 4 &&
+                          points.front().x == points.back().x && points.front().y == points.back().y;
+            if (closed) points.pop_back();
+            backend.DrawPolyline(points.data(), points.size(), closed, color, width, m_lineStyle);
+        }
+        points.clear();
+    };
+
+    ForEachIntersectionSegment([&](D2D1_POINT_2F a, D2D1_POINT_2F b) {
+        if (!points.empty() && (points.back().x != a.x || points.back().y != a.y)) {
+            flush();
+        }
+        if (points.empty()) points.push_back(a);
+        points.push_back(b);
+    });
+    flush();
+}
+
 // 㵽߶ξƽ < distThresh 
 static bool PointNearSegment(D2D1_POINT_2F p,
                              D2D1_POINT_2F a,
@@ -240,7 +835,7 @@ void Line::Draw(ID2D1RenderTarget *pRenderTarget,
     int lineWidth = GetLineWidthValue();
     
     // ʹDirect2DDrawLine֧ͺ߿
-    pRenderTarget->DrawLine(m_start, m_end, currentBrush, (float)lineWidth, pStrokeStyle);
+    pRenderTarget->DrawLine(m_start, m_end, currentBrush, StrokeWidthFor(pRenderTarget, (float)lineWidth), pStrokeStyle);
 }
 
 bool Line::HitTest(D2D1_POINT_2F point) {
@@ -275,6 +870,7 @@ bool Line::HitTest(D2D1_POINT_2F point) {
 }
 
 void Line::Move(float dx, float dy) {
+    InvalidateBounds();
     m_start.x += dx;
     m_start.y += dy;
     m_end.x += dx;
@@ -282,6 +878,7 @@ void Line::Move(float dx, float dy) {
 }
 
 void Line::Rotate(float angle) {
+    InvalidateBounds();
     // תĵ
     D2D1_POINT_2F center = {(m_start.x + m_end.x) / 2, (m_start.y + m_end.y) / 2};
     float s = sinf(angle);
@@ -307,6 +904,7 @@ void Line::Rotate(float angle) {
 }
 
 void Line::Scale(float scale) {
+    InvalidateBounds();
     D2D1_POINT_2F center = {(m_start.x + m_end.x) / 2, (m_start.y + m_end.y) / 2};
     m_start.x = center.x + (m_start.x - center.x) * scale;
     m_start.y = center.y + (m_start.y - center.y) * scale;
@@ -315,6 +913,7 @@ void Line::Scale(float scale) {
 }
 
 void Line::RotateAroundPoint(float angle, D2D1_POINT_2F center) {
+    InvalidateBounds();
     float s = sinf(angle);
     float c = cosf(angle);
     
@@ -340,58 +939,22 @@ std::string Line::Serialize() {
 
 // MidpointLine ʵ
 MidpointLine::MidpointLine(D2D1_POINT_2F start, D2D1_POINT_2F end) :
-    Shape(ShapeType::LINE), m_start(start), m_end(end) {
+    Shape(ShapeType::LINE), m_start(start), m_end(end), m_pixelDx(0), m_pixelDy(0) {
     CalculateMidpointPixels();
 }
 
 void MidpointLine::CalculateMidpointPixels() {
-    m_pixels.clear();
-    
     int x0 = static_cast<int>(m_start.x);
     int y0 = static_cast<int>(m_start.y);
     int x1 = static_cast<int>(m_end.x);
     int y1 = static_cast<int>(m_end.y);
-    
-    int dx = abs(x1 - x0);
-    int dy = abs(y1 - y0);
-    int sx = (x0 < x1) ? 1 : -1;
-    int sy = (y0 < y1) ? 1 : -1;
-    
-    if (dx > dy) {
-        // б <= 1 
-        int d = 2 * dy - dx;
-        int x = x0, y = y0;
-        
-        m_pixels.push_back(D2D1::Point2F(static_cast<float>(x), static_cast<float>(y)));
-        
-        while (x != x1) {
-            x += sx;
-            if (d > 0) {
-                y += sy;
-                d += 2 * (dy - dx);
-            } else {
-                d += 2 * dy;
-            }
-            m_pixels.push_back(D2D1::Point2F(static_cast<float>(x), static_cast<float>(y)));
-        }
-    } else {
-        // б > 1 
-        int d = 2 * dx - dy;
-        int x = x0, y = y0;
-        
-        m_pixels.push_back(D2D1::Point2F(static_cast<float>(x), static_cast<float>(y)));
-        
-        while (y != y1) {
-            y += sy;
-            if (d > 0) {
-                x += sx;
-                d += 2 * (dx - dy);
-            } else {
-                d += 2 * dx;
-            }
-            m_pixels.push_back(D2D1::Point2F(static_cast<float>(x), static_cast<float>(y)));
-        }
-    }
+    m_pixelOrigin = D2D1::Point2F(static_cast<float>(x0), static_cast<float>(y0));
+
+    // ȡĶ˵䣨ƽƣʱֻƽƣԭģ
+    if (m_pattern && x1 - x0 == m_pixelDx && y1 - y0 == m_pixelDy) return;
+    m_pixelDx = x1 - x0;
+    m_pixelDy = y1 - y0;
+    m_pattern = PixelPatterns::MidpointLine(m_pixelDx, m_pixelDy);
 }
 
 void MidpointLine::Draw(ID2D1RenderTarget *pRenderTarget,
@@ -405,55 +968,32 @@ void MidpointLine::Draw(ID2D1RenderTarget *pRenderTarget,
     
     // е㻭߷㷨ɵÿص㶼ģʽǷ
     
-    // ߶εܳȺͷ
-    float lineLength = sqrtf((m_end.x - m_start.x) * (m_end.x - m_start.x) + 
-                            (m_end.y - m_start.y) * (m_end.y - m_start.y));
-    
+    // ͣƽαֻ꣬ʵϵ
+    LineStyle lineStyle = pStrokeStyle ? GetLineStyle() : LineStyle::SOLID;
     if (lineWidth == 1) {
-        for (const auto& pixel : m_pixels) {
-            // 㵱ǰ߶ϵλñ
-            float pixelDistance = sqrtf((pixel.x - m_start.x) * (pixel.x - m_start.x) + 
-                                      (pixel.y - m_start.y) * (pixel.y - m_start.y));
-            
-            // ʽǷ
-            bool shouldDraw = true;
-            if (pStrokeStyle && GetLineStyle() != LineStyle::SOLID) {
-                shouldDraw = ShouldDrawPixelForLineStyle(pixelDistance, GetLineStyle());
-            }
-            
-            if (shouldDraw) {
-                D2D1_ELLIPSE ellipse = D2D1::Ellipse(pixel, 0.8f, 0.8f);
-                pRenderTarget->FillEllipse(ellipse, currentBrush);
-            }
+        // Сʾʱ߻һŻλͼػ
+        if (DrawLinePixelsAsMask(pRenderTarget, currentBrush, m_geometryVersion, *m_pattern, m_pixelOrigin,
+                                 GetLocalBounds(), lineStyle)) {
+            return;
         }
+        WalkLinePixels(*m_pattern, lineStyle, [&](const D2D1_POINT_2F &offset, bool on) {
+            if (!on) return;
+            D2D1_POINT_2F pixel = D2D1::Point2F(m_pixelOrigin.x + offset.x, m_pixelOrigin.y + offset.y);
+            pRenderTarget->FillEllipse(D2D1::Ellipse(pixel, 0.8f, 0.8f), currentBrush);
+        });
     } else {
-        // ߿1ʱΪÿصչ
-        std::vector<D2D1_POINT_2F> expandedPixels;
-        float halfWidth = lineWidth / 2.0f;
-        
-        for (const auto& pixel : m_pixels) {
-            // 㵱ǰ߶ϵλ
-            float pixelDistance = sqrtf((pixel.x - m_start.x) * (pixel.x - m_start.x) + 
-                                      (pixel.y - m_start.y) * (pixel.y - m_start.y));
-            
-            // ʽǷ
-            bool shouldDraw = true;
-            if (pStrokeStyle && GetLineStyle() != LineStyle::SOLID) {
-                shouldDraw = ShouldDrawPixelForLineStyle(pixelDistance, GetLineStyle());
-            }
-            
-            if (shouldDraw) {
-                for (int dy = -static_cast<int>(halfWidth); dy <= static_cast<int>(halfWidth); ++dy) {
-                    for (int dx = -static_cast<int>(halfWidth); dx <= static_cast<int>(halfWidth); ++dx) {
-                        if (dx * dx + dy * dy <= halfWidth * halfWidth) {
-                            expandedPixels.push_back({pixel.x + dx, pixel.y + dy});
-                        }
-                    }
-                }
-            }
-        }
-        DrawPixels(pRenderTarget, currentBrush, expandedPixels);
+        // ߿1ʱɨֱߵضΣһ
+        DrawThickPixelLine(pRenderTarget, currentBrush, m_geometryVersion, *m_pattern, m_pixelOrigin, lineWidth, lineStyle);
+    }
+}
+
+void MidpointLine::DrawTo(RenderBackend &backend, const D2D1_COLOR_F &color) const {
+    int lineWidth = GetLineWidthValue();
+    if (lineWidth > 1) {
+        backend.DrawLine(m_start, m_end, color, (float)lineWidth, GetLineStyle());
+        return;
     }
+    FillStyledLinePixels(backend, *m_pattern, m_pixelOrigin, GetLineStyle(), color);
 }
 
 bool MidpointLine::HitTest(D2D1_POINT_2F point) {
@@ -461,14 +1001,16 @@ bool MidpointLine::HitTest(D2D1_POINT_2F point) {
 }
 
 void MidpointLine::Move(float dx, float dy) {
+    InvalidateBounds();
     m_start.x += dx;
     m_start.y += dy;
     m_end.x += dx;
     m_end.y += dy;
-    CalculateMidpointPixels(); // ¼ص
+    CalculateMidpointPixels(); // ƽʱԭģ壬ֻԭ
 }
 
 void MidpointLine::Rotate(float angle) {
+    InvalidateBounds();
     // Χĵת
     D2D1_POINT_2F center = {(m_start.x + m_end.x) / 2, (m_start.y + m_end.y) / 2};
     float s = sinf(angle);
@@ -490,6 +1032,7 @@ void MidpointLine::Rotate(float angle) {
 }
 
 void MidpointLine::Scale(float scale) {
+    InvalidateBounds();
     D2D1_POINT_2F center = {(m_start.x + m_end.x) / 2, (m_start.y + m_end.y) / 2};
     m_start.x = center.x + (m_start.x - center.x) * scale;
     m_start.y = center.y + (m_start.y - center.y) * scale;
@@ -499,6 +1042,7 @@ void MidpointLine::Scale(float scale) {
 }
 
 void MidpointLine::RotateAroundPoint(float angle, D2D1_POINT_2F center) {
+    InvalidateBounds();
     float s = sinf(angle);
     float c = cosf(angle);
     
@@ -525,46 +1069,29 @@ std::string MidpointLine::Serialize() {
 }
 
 std::vector<D2D1_POINT_2F> MidpointLine::GetMidpointPixels() const {
-    return m_pixels;
+    std::vector<D2D1_POINT_2F> pixels;
+    PixelPatterns::Expand(*m_pattern, m_pixelOrigin, pixels);
+    return pixels;
 }
 
 // BresenhamLine ʵ
 BresenhamLine::BresenhamLine(D2D1_POINT_2F start, D2D1_POINT_2F end) :
-    Shape(ShapeType::LINE), m_start(start), m_end(end) {
+    Shape(ShapeType::LINE), m_start(start), m_end(end), m_pixelDx(0), m_pixelDy(0) {
     CalculateBresenhamPixels();
 }
 
 void BresenhamLine::CalculateBresenhamPixels() {
-    m_pixels.clear();
-    
     int x0 = static_cast<int>(m_start.x);
     int y0 = static_cast<int>(m_start.y);
     int x1 = static_cast<int>(m_end.x);
     int y1 = static_cast<int>(m_end.y);
-    
-    int dx = abs(x1 - x0);
-    int dy = abs(y1 - y0);
-    int sx = (x0 < x1) ? 1 : -1;
-    int sy = (y0 < y1) ? 1 : -1;
-    int err = dx - dy;
-    
-    int x = x0, y = y0;
-    
-    while (true) {
-        m_pixels.push_back(D2D1::Point2F(static_cast<float>(x), static_cast<float>(y)));
-        
-        if (x == x1 && y == y1) break;
-        
-        int e2 = 2 * err;
-        if (e2 > -dy) {
-            err -= dy;
-            x += sx;
-        }
-        if (e2 < dx) {
-            err += dx;
-            y += sy;
-        }
-    }
+    m_pixelOrigin = D2D1::Point2F(static_cast<float>(x0), static_cast<float>(y0));
+
+    // ȡĶ˵䣨ƽƣʱֻƽƣԭģ
+    if (m_pattern && x1 - x0 == m_pixelDx && y1 - y0 == m_pixelDy) return;
+    m_pixelDx = x1 - x0;
+    m_pixelDy = y1 - y0;
+    m_pattern = PixelPatterns::BresenhamLine(m_pixelDx, m_pixelDy);
 }
 
 void BresenhamLine::Draw(ID2D1RenderTarget *pRenderTarget,
@@ -578,55 +1105,32 @@ void BresenhamLine::Draw(ID2D1RenderTarget *pRenderTarget,
     
     // Bresenham߷㷨ɵÿص㶼ģʽǷ
     
-    // ߶εܳȺͷ
-    float lineLength = sqrtf((m_end.x - m_start.x) * (m_end.x - m_start.x) + 
-                            (m_end.y - m_start.y) * (m_end.y - m_start.y));
-    
+    // ͣƽαֻ꣬ʵϵ
+    LineStyle lineStyle = pStrokeStyle ? GetLineStyle() : LineStyle::SOLID;
     if (lineWidth == 1) {
-        for (const auto& pixel : m_pixels) {
-            // 㵱ǰ߶ϵλñ
-            float pixelDistance = sqrtf((pixel.x - m_start.x) * (pixel.x - m_start.x) + 
-                                      (pixel.y - m_start.y) * (pixel.y - m_start.y));
-            
-            // ʽǷ
-            bool shouldDraw = true;
-            if (pStrokeStyle && GetLineStyle() != LineStyle::SOLID) {
-                shouldDraw = ShouldDrawPixelForLineStyle(pixelDistance, GetLineStyle());
-            }
-            
-            if (shouldDraw) {
-                D2D1_ELLIPSE ellipse = D2D1::Ellipse(pixel, 0.8f, 0.8f);
-                pRenderTarget->FillEllipse(ellipse, currentBrush);
-            }
+        // Сʾʱ߻һŻλͼػ
+        if (DrawLinePixelsAsMask(pRenderTarget, currentBrush, m_geometryVersion, *m_pattern, m_pixelOrigin,
+                                 GetLocalBounds(), lineStyle)) {
+            return;
         }
+        WalkLinePixels(*m_pattern, lineStyle, [&](const D2D1_POINT_2F &offset, bool on) {
+            if (!on) return;
+            D2D1_POINT_2F pixel = D2D1::Point2F(m_pixelOrigin.x + offset.x, m_pixelOrigin.y + offset.y);
+            pRenderTarget->FillEllipse(D2D1::Ellipse(pixel, 0.8f, 0.8f), currentBrush);
+        });
     } else {
-        // ߿1ʱΪÿصչ
-        std::vector<D2D1_POINT_2F> expandedPixels;
-        float halfWidth = lineWidth / 2.0f;
-        
-        for (const auto& pixel : m_pixels) {
-            // 㵱ǰ߶ϵλ
-            float pixelDistance = sqrtf((pixel.x - m_start.x) * (pixel.x - m_start.x) + 
-                                      (pixel.y - m_start.y) * (pixel.y - m_start.y));
-            
-            // ʽǷ
-            bool shouldDraw = true;
-            if (pStrokeStyle && GetLineStyle() != LineStyle::SOLID) {
-                shouldDraw = ShouldDrawPixelForLineStyle(pixelDistance, GetLineStyle());
-            }
-            
-            if (shouldDraw) {
-                for (int dy = -static_cast<int>(halfWidth); dy <= static_cast<int>(halfWidth); ++dy) {
-                    for (int dx = -static_cast<int>(halfWidth); dx <= static_cast<int>(halfWidth); ++dx) {
-                        if (dx * dx + dy * dy <= halfWidth * halfWidth) {
-                            expandedPixels.push_back({pixel.x + dx, pixel.y + dy});
-                        }
-                    }
-                }
-            }
-        }
-        DrawPixels(pRenderTarget, currentBrush, expandedPixels);
+        // ߿1ʱɨֱߵضΣһ
+        DrawThickPixelLine(pRenderTarget, currentBrush, m_geometryVersion, *m_pattern, m_pixelOrigin, lineWidth, lineStyle);
+    }
+}
+
+void BresenhamLine::DrawTo(RenderBackend &backend, const D2D1_COLOR_F &color) const {
+    int lineWidth = GetLineWidthValue();
+    if (lineWidth > 1) {
+        backend.DrawLine(m_start, m_end, color, (float)lineWidth, GetLineStyle());
+        return;
     }
+    FillStyledLinePixels(backend, *m_pattern, m_pixelOrigin, GetLineStyle(), color);
 }
 
 bool BresenhamLine::HitTest(D2D1_POINT_2F point) {
@@ -634,14 +1138,16 @@ bool BresenhamLine::HitTest(D2D1_POINT_2F point) {
 }
 
 void BresenhamLine::Move(float dx, float dy) {
+    InvalidateBounds();
     m_start.x += dx;
     m_start.y += dy;
     m_end.x += dx;
     m_end.y += dy;
-    CalculateBresenhamPixels(); // ¼ص
+    CalculateBresenhamPixels(); // ƽʱԭģ壬ֻԭ
 }
 
 void BresenhamLine::Rotate(float angle) {
+    InvalidateBounds();
     // Χĵת
     D2D1_POINT_2F center = {(m_start.x + m_end.x) / 2, (m_start.y + m_end.y) / 2};
     float s = sinf(angle);
@@ -663,6 +1169,7 @@ void BresenhamLine::Rotate(float angle) {
 }
 
 void BresenhamLine::Scale(float scale) {
+    InvalidateBounds();
     D2D1_POINT_2F center = {(m_start.x + m_end.x) / 2, (m_start.y + m_end.y) / 2};
     m_start.x = center.x + (m_start.x - center.x) * scale;
     m_start.y = center.y + (m_start.y - center.y) * scale;
@@ -672,6 +1179,7 @@ void BresenhamLine::Scale(float scale) {
 }
 
 void BresenhamLine::RotateAroundPoint(float angle, D2D1_POINT_2F center) {
+    InvalidateBounds();
     float s = sinf(angle);
     float c = cosf(angle);
     
@@ -698,7 +1206,9 @@ std::string BresenhamLine::Serialize() {
 }
 
 std::vector<D2D1_POINT_2F> BresenhamLine::GetBresenhamPixels() const {
-    return m_pixels;
+    std::vector<D2D1_POINT_2F> pixels;
+    PixelPatterns::Expand(*m_pattern, m_pixelOrigin, pixels);
+    return pixels;
 }
 
 // MidpointCircle ʵ
@@ -708,37 +1218,7 @@ MidpointCircle::MidpointCircle(D2D1_POINT_2F center, float radius) :
 }
 
 void MidpointCircle::CalculateMidpointPixels() {
-    m_pixels.clear();
-    
-    int r = static_cast<int>(m_radius);
-    int x = 0;
-    int y = r;
-    int d = 1 - r;  // ʼбʽ
-    
-    // 8ԳƵĸ
-    auto addSymmetricPoints = [&](int px, int py) {
-        m_pixels.push_back(D2D1::Point2F(m_center.x + px, m_center.y + py));
-        m_pixels.push_back(D2D1::Point2F(m_center.x - px, m_center.y + py));
-        m_pixels.push_back(D2D1::Point2F(m_center.x + px, m_center.y - py));
-        m_pixels.push_back(D2D1::Point2F(m_center.x - px, m_center.y - py));
-        m_pixels.push_back(D2D1::Point2F(m_center.x + py, m_center.y + px));
-        m_pixels.push_back(D2D1::Point2F(m_center.x - py, m_center.y + px));
-        m_pixels.push_back(D2D1::Point2F(m_center.x + py, m_center.y - px));
-        m_pixels.push_back(D2D1::Point2F(m_center.x - py, m_center.y - px));
-    };
-    
-    addSymmetricPoints(x, y);
-    
-    while (x < y) {
-        if (d < 0) {
-            d += 2 * x + 3;
-        } else {
-            d += 2 * (x - y) + 5;
-            y--;
-        }
-        x++;
-        addSymmetricPoints(x, y);
-    }
+    m_pattern = PixelPatterns::MidpointCircle(static_cast<int>(m_radius));
 }
 
 void MidpointCircle::Draw(ID2D1RenderTarget *pRenderTarget,
@@ -755,61 +1235,33 @@ void MidpointCircle::Draw(ID2D1RenderTarget *pRenderTarget,
     
     // е㻭Բ㷨ɵÿص㶼ģʽǷ
     
+    // ͣǶ˳Բƽαֻ꣬ʵϵ
+    LineStyle lineStyle = pStrokeStyle ? GetLineStyle() : LineStyle::SOLID;
     if (lineWidth == 1) {
-        for (const auto& pixel : m_pixels) {
-            // 㵱ǰԲĵĽǶ
-            float dx = pixel.x - m_center.x;
-            float dy = pixel.y - m_center.y;
-            float angle = atan2f(dy, dx);
-            if (angle < 0) angle += 2.0f * 3.14159f; // תΪ0-2зΧ
-            
-            // ǶתΪԲϵĻ
-            float arcDistance = angle * m_radius;
-            
-            // ʽǷ
-            bool shouldDraw = true;
-            if (pStrokeStyle && GetLineStyle() != LineStyle::SOLID) {
-                shouldDraw = ShouldDrawPixelForLineStyle(arcDistance, GetLineStyle());
-            }
-            
-            if (shouldDraw) {
-                D2D1_ELLIPSE ellipse = D2D1::Ellipse(pixel, 0.8f, 0.8f);
-                pRenderTarget->FillEllipse(ellipse, currentBrush);
-            }
+        // СʾʱԲһŻλͼػ
+        if (DrawCirclePixelsAsMask(pRenderTarget, currentBrush, m_geometryVersion, *m_pattern, m_center, m_radius, lineStyle)) {
+            return;
         }
+        WalkCirclePixels(*m_pattern, m_radius, lineStyle, [&](const D2D1_POINT_2F &offset, bool on) {
+            if (!on) return;
+            D2D1_POINT_2F pixel = D2D1::Point2F(m_center.x + offset.x, m_center.y + offset.y);
+            pRenderTarget->FillEllipse(D2D1::Ellipse(pixel, 0.8f, 0.8f), currentBrush);
+        });
     } else {
-        // ߿1ʱΪÿصչ
-        std::vector<D2D1_POINT_2F> expandedPixels;
-        float halfWidth = lineWidth / 2.0f;
-        
-        for (const auto& pixel : m_pixels) {
-            // 㵱ǰԲĵĽǶ
-            float dx = pixel.x - m_center.x;
-            float dy = pixel.y - m_center.y;
-            float angle = atan2f(dy, dx);
-            if (angle < 0) angle += 2.0f * 3.14159f; // תΪ0-2зΧ
-            
-            // ǶתΪԲϵĻ
-            float arcDistance = angle * m_radius;
-            
-            // ʽǷ
-            bool shouldDraw = true;
-            if (pStrokeStyle && GetLineStyle() != LineStyle::SOLID) {
-                shouldDraw = ShouldDrawPixelForLineStyle(arcDistance, GetLineStyle());
-            }
-            
-            if (shouldDraw) {
-                for (int dy = -static_cast<int>(halfWidth); dy <= static_cast<int>(halfWidth); ++dy) {
-                    for (int dx = -static_cast<int>(halfWidth); dx <= static_cast<int>(halfWidth); ++dx) {
-                        if (dx * dx + dy * dy <= halfWidth * halfWidth) {
-                            expandedPixels.push_back({pixel.x + dx, pixel.y + dy});
-                        }
-                    }
-                }
-            }
-        }
-        DrawPixels(pRenderTarget, currentBrush, expandedPixels);
+        // ߿1ʱɨֱߵضΣһ
+        DrawThickPixelCircle(pRenderTarget, currentBrush, m_geometryVersion, m_center, m_radius, lineWidth, lineStyle);
+    }
+}
+
+void MidpointCircle::DrawTo(RenderBackend &backend, const D2D1_COLOR_F &color) const {
+    DrawFillPixelsTo(backend);
+
+    int lineWidth = GetLineWidthValue();
+    if (lineWidth > 1) {
+        backend.DrawEllipse(m_center, m_radius, m_radius, color, (float)lineWidth, GetLineStyle());
+        return;
     }
+    FillStyledCirclePixels(backend, *m_pattern, m_center, m_radius, GetLineStyle(), color);
 }
 
 bool MidpointCircle::HitTest(D2D1_POINT_2F point) {
@@ -820,27 +1272,28 @@ bool MidpointCircle::HitTest(D2D1_POINT_2F point) {
 }
 
 void MidpointCircle::Move(float dx, float dy) {
+    InvalidateBounds();
     m_center.x += dx;
-    m_center.y += dy;
-    CalculateMidpointPixels(); // ؼص
+    m_center.y += dy; // ģԲģƽ¼
     TransformFillPixelsMove(dx, dy);  // ƶ
 }
 
 void MidpointCircle::Scale(float scale) {
+    InvalidateBounds();
     m_radius *= scale;
     CalculateMidpointPixels(); // ¼ص
     TransformFillPixelsScale(scale, m_center);  // 
 }
 
 void MidpointCircle::RotateAroundPoint(float angle, D2D1_POINT_2F center) {
+    InvalidateBounds();
     // ԲָתֻҪƶԲ
     float s = sinf(angle);
     float c = cosf(angle);
     float dx = m_center.x - center.x;
     float dy = m_center.y - center.y;
     m_center.x = center.x + dx * c - dy * s;
-    m_center.y = center.y + dx * s + dy * c;
-    CalculateMidpointPixels(); // ¼ص
+    m_center.y = center.y + dx * s + dy * c; // ģԲƶ
     TransformFillPixelsRotate(angle, center);  // ת
 }
 
@@ -852,7 +1305,9 @@ std::string MidpointCircle::Serialize() {
 }
 
 std::vector<D2D1_POINT_2F> MidpointCircle::GetMidpointPixels() const {
-    return m_pixels;
+    std::vector<D2D1_POINT_2F> pixels;
+    PixelPatterns::Expand(*m_pattern, m_center, pixels);
+    return pixels;
 }
 
 // BresenhamCircle ʵ
@@ -862,37 +1317,7 @@ BresenhamCircle::BresenhamCircle(D2D1_POINT_2F center, float radius) :
 }
 
 void BresenhamCircle::CalculateBresenhamPixels() {
-    m_pixels.clear();
-    
-    int r = static_cast<int>(m_radius);
-    int x = 0;
-    int y = r;
-    int d = 3 - 2 * r;  // Bresenhamбʽ
-    
-    // 8ԳƵĸ
-    auto addSymmetricPoints = [&](int px, int py) {
-        m_pixels.push_back(D2D1::Point2F(m_center.x + px, m_center.y + py));
-        m_pixels.push_back(D2D1::Point2F(m_center.x - px, m_center.y + py));
-        m_pixels.push_back(D2D1::Point2F(m_center.x + px, m_center.y - py));
-        m_pixels.push_back(D2D1::Point2F(m_center.x - px, m_center.y - py));
-        m_pixels.push_back(D2D1::Point2F(m_center.x + py, m_center.y + px));
-        m_pixels.push_back(D2D1::Point2F(m_center.x - py, m_center.y + px));
-        m_pixels.push_back(D2D1::Point2F(m_center.x + py, m_center.y - px));
-        m_pixels.push_back(D2D1::Point2F(m_center.x - py, m_center.y - px));
-    };
-    
-    addSymmetricPoints(x, y);
-    
-    while (x <= y) {
-        x++;
-        if (d > 0) {
-            y--;
-            d = d + 4 * (x - y) + 10;
-        } else {
-            d = d + 4 * x + 6;
-        }
-        addSymmetricPoints(x, y);
-    }
+    m_pattern = PixelPatterns::BresenhamCircle(static_cast<int>(m_radius));
 }
 
 void BresenhamCircle::Draw(ID2D1RenderTarget *pRenderTarget,
@@ -909,61 +1334,33 @@ void BresenhamCircle::Draw(ID2D1RenderTarget *pRenderTarget,
     
     // BresenhamԲ㷨ɵÿص㶼ģʽǷ
     
+    // ͣǶ˳Բƽαֻ꣬ʵϵ
+    LineStyle lineStyle = pStrokeStyle ? GetLineStyle() : LineStyle::SOLID;
     if (lineWidth == 1) {
-        for (const auto& pixel : m_pixels) {
-            // 㵱ǰԲĵĽǶ
-            float dx = pixel.x - m_center.x;
-            float dy = pixel.y - m_center.y;
-            float angle = atan2f(dy, dx);
-            if (angle < 0) angle += 2.0f * 3.14159f; // תΪ0-2зΧ
-            
-            // ǶתΪԲϵĻ
-            float arcDistance = angle * m_radius;
-            
-            // ʽǷ
-            bool shouldDraw = true;
-            if (pStrokeStyle && GetLineStyle() != LineStyle::SOLID) {
-                shouldDraw = ShouldDrawPixelForLineStyle(arcDistance, GetLineStyle());
-            }
-            
-            if (shouldDraw) {
-                D2D1_ELLIPSE ellipse = D2D1::Ellipse(pixel, 0.8f, 0.8f);
-                pRenderTarget->FillEllipse(ellipse, currentBrush);
-            }
+        // СʾʱԲһŻλͼػ
+        if (DrawCirclePixelsAsMask(pRenderTarget, currentBrush, m_geometryVersion, *m_pattern, m_center, m_radius, lineStyle)) {
+            return;
         }
+        WalkCirclePixels(*m_pattern, m_radius, lineStyle, [&](const D2D1_POINT_2F &offset, bool on) {
+            if (!on) return;
+            D2D1_POINT_2F pixel = D2D1::Point2F(m_center.x + offset.x, m_center.y + offset.y);
+            pRenderTarget->FillEllipse(D2D1::Ellipse(pixel, 0.8f, 0.8f), currentBrush);
+        });
     } else {
-        // ߿1ʱΪÿصչ
-        std::vector<D2D1_POINT_2F> expandedPixels;
-        float halfWidth = lineWidth / 2.0f;
-        
-        for (const auto& pixel : m_pixels) {
-            // 㵱ǰԲĵĽǶ
-            float dx = pixel.x - m_center.x;
-            float dy = pixel.y - m_center.y;
-            float angle = atan2f(dy, dx);
-            if (angle < 0) angle += 2.0f * 3.14159f; // תΪ0-2зΧ
-            
-            // ǶתΪԲϵĻ
-            float arcDistance = angle * m_radius;
-            
-            // ʽǷ
-            bool shouldDraw = true;
-            if (pStrokeStyle && GetLineStyle() != LineStyle::SOLID) {
-                shouldDraw = ShouldDrawPixelForLineStyle(arcDistance, GetLineStyle());
-            }
-            
-            if (shouldDraw) {
-                for (int dy = -static_cast<int>(halfWidth); dy <= static_cast<int>(halfWidth); ++dy) {
-                    for (int dx = -static_cast<int>(halfWidth); dx <= static_cast<int>(halfWidth); ++dx) {
-                        if (dx * dx + dy * dy <= halfWidth * halfWidth) {
-                            expandedPixels.push_back({pixel.x + dx, pixel.y + dy});
-                        }
-                    }
-                }
-            }
-        }
-        DrawPixels(pRenderTarget, currentBrush, expandedPixels);
+        // ߿1ʱɨֱߵضΣһ
+        DrawThickPixelCircle(pRenderTarget, currentBrush, m_geometryVersion, m_center, m_radius, lineWidth, lineStyle);
+    }
+}
+
+void BresenhamCircle::DrawTo(RenderBackend &backend, const D2D1_COLOR_F &color) const {
+    DrawFillPixelsTo(backend);
+
+    int lineWidth = GetLineWidthValue();
+    if (lineWidth > 1) {
+        backend.DrawEllipse(m_center, m_radius, m_radius, color, (float)lineWidth, GetLineStyle());
+        return;
     }
+    FillStyledCirclePixels(backend, *m_pattern, m_center, m_radius, GetLineStyle(), color);
 }
 
 bool BresenhamCircle::HitTest(D2D1_POINT_2F point) {
@@ -974,27 +1371,28 @@ bool BresenhamCircle::HitTest(D2D1_POINT_2F point) {
 }
 
 void BresenhamCircle::Move(float dx, float dy) {
+    InvalidateBounds();
     m_center.x += dx;
-    m_center.y += dy;
-    CalculateBresenhamPixels(); // ؼص
+    m_center.y += dy; // ģԲģƽ¼
     TransformFillPixelsMove(dx, dy);  // ƶ
 }
 
 void BresenhamCircle::Scale(float scale) {
+    InvalidateBounds();
     m_radius *= scale;
     CalculateBresenhamPixels(); // ¼ص
     TransformFillPixelsScale(scale, m_center);  // 
 }
 
 void BresenhamCircle::RotateAroundPoint(float angle, D2D1_POINT_2F center) {
+    InvalidateBounds();
     // ԲָתֻҪƶԲ
     float s = sinf(angle);
     float c = cosf(angle);
     float dx = m_center.x - center.x;
     float dy = m_center.y - center.y;
     m_center.x = center.x + dx * c - dy * s;
-    m_center.y = center.y + dx * s + dy * c;
-    CalculateBresenhamPixels(); // ¼ص
+    m_center.y = center.y + dx * s + dy * c; // ģԲƶ
     TransformFillPixelsRotate(angle, center);  // ת
 }
 
@@ -1006,7 +1404,9 @@ std::string BresenhamCircle::Serialize() {
 }
 
 std::vector<D2D1_POINT_2F> BresenhamCircle::GetBresenhamPixels() const {
-    return m_pixels;
+    std::vector<D2D1_POINT_2F> pixels;
+    PixelPatterns::Expand(*m_pattern, m_center, pixels);
+    return pixels;
 }
 
 // Circle ʵ
@@ -1027,7 +1427,12 @@ void Circle::Draw(ID2D1RenderTarget *pRenderTarget,
     int lineWidth = GetLineWidthValue();
     
     // ʹDirect2DDrawEllipse֧ͺ߿
-    pRenderTarget->DrawEllipse(D2D1::Ellipse(m_center, m_radius, m_radius), currentBrush, (float)lineWidth, pStrokeStyle);
+    pRenderTarget->DrawEllipse(D2D1::Ellipse(m_center, m_radius, m_radius), currentBrush, StrokeWidthFor(pRenderTarget, (float)lineWidth), pStrokeStyle);
+}
+
+void Circle::DrawTo(RenderBackend &backend, const D2D1_COLOR_F &color) const {
+    DrawFillPixelsTo(backend);
+    backend.DrawEllipse(m_center, m_radius, m_radius, color, (float)GetLineWidthValue(), GetLineStyle());
 }
 
 bool Circle::HitTest(D2D1_POINT_2F point) {
@@ -1038,17 +1443,20 @@ bool Circle::HitTest(D2D1_POINT_2F point) {
 }
 
 void Circle::Move(float dx, float dy) {
+    InvalidateBounds();
     m_center.x += dx;
     m_center.y += dy;
     TransformFillPixelsMove(dx, dy);  // ƶ
 }
 
 void Circle::Scale(float scale) {
+    InvalidateBounds();
     m_radius *= scale;
     TransformFillPixelsScale(scale, m_center);  // 
 }
 
 void Circle::RotateAroundPoint(float angle, D2D1_POINT_2F center) {
+    InvalidateBounds();
     // ԲָתֻҪƶԲ
     float s = sinf(angle);
     float c = cosf(angle);
@@ -1087,30 +1495,22 @@ void Rect::Draw(ID2D1RenderTarget *pRenderTarget,
     
     ID2D1SolidColorBrush *currentBrush = m_isSelected ? pSelectedBrush : pNormalBrush;
 
-    // ·
-    ID2D1PathGeometry *pPathGeometry = nullptr;
-    ID2D1Factory *pFactory = nullptr;
-    pRenderTarget->GetFactory(&pFactory);
-
-    if (SUCCEEDED(pFactory->CreatePathGeometry(&pPathGeometry))) {
-        ID2D1GeometrySink *pSink = nullptr;
-        if (SUCCEEDED(pPathGeometry->Open(&pSink))) {
+    // ·ΰ汾棩
+    ID2D1PathGeometry *pPathGeometry = AcquirePathGeometry(pRenderTarget, m_geometryVersion, 0,
+        [this](ID2D1GeometrySink *pSink) {
             pSink->BeginFigure(m_points[0], D2D1_FIGURE_BEGIN_FILLED);
             for (int i = 1; i < 4; i++) {
                 pSink->AddLine(m_points[i]);
             }
             pSink->EndFigure(D2D1_FIGURE_END_CLOSED);
-            pSink->Close();
-            pSink->Release();
-        }
+        });
+    if (pPathGeometry) {
         if (m_isSelected && pDashStrokeStyle)
-            pRenderTarget->DrawGeometry(pPathGeometry, currentBrush, 2.0f, pDashStrokeStyle);
+            pRenderTarget->DrawGeometry(pPathGeometry, currentBrush, StrokeWidthFor(pRenderTarget, 2.0f), pDashStrokeStyle);
         else
-            pRenderTarget->DrawGeometry(pPathGeometry, currentBrush, 2.0f);
+            pRenderTarget->DrawGeometry(pPathGeometry, currentBrush, StrokeWidthFor(pRenderTarget, 2.0f));
         pPathGeometry->Release();
     }
-
-    if (pFactory) pFactory->Release();
 }
 
 bool Rect::HitTest(D2D1_POINT_2F point) {
@@ -1122,6 +1522,7 @@ bool Rect::HitTest(D2D1_POINT_2F point) {
 }
 
 void Rect::Move(float dx, float dy) {
+    InvalidateBounds();
     for (int i = 0; i < 4; i++) {
         m_points[i].x += dx;
         m_points[i].y += dy;
@@ -1130,6 +1531,7 @@ void Rect::Move(float dx, float dy) {
 }
 
 void Rect::Rotate(float angle) {
+    InvalidateBounds();
     D2D1_POINT_2F center = GetCenter();
     float s = sinf(angle);
     float c = cosf(angle);
@@ -1151,6 +1553,7 @@ void Rect::Rotate(float angle) {
 }
 
 void Rect::Scale(float scale) {
+    InvalidateBounds();
     D2D1_POINT_2F center = GetCenter();
     for (int i = 0; i < 4; i++) {
         m_points[i].x = center.x + (m_points[i].x - center.x) * scale;
@@ -1160,6 +1563,7 @@ void Rect::Scale(float scale) {
 }
 
 void Rect::RotateAroundPoint(float angle, D2D1_POINT_2F center) {
+    InvalidateBounds();
     float s = sinf(angle);
     float c = cosf(angle);
     
@@ -1201,29 +1605,21 @@ void Triangle::Draw(ID2D1RenderTarget *pRenderTarget,
 
     ID2D1SolidColorBrush *currentBrush = m_isSelected ? pSelectedBrush : pNormalBrush;
 
-    // ·
-    ID2D1PathGeometry *pPathGeometry = nullptr;
-    ID2D1Factory *pFactory = nullptr;
-    pRenderTarget->GetFactory(&pFactory);
-
-    if (SUCCEEDED(pFactory->CreatePathGeometry(&pPathGeometry))) {
-        ID2D1GeometrySink *pSink = nullptr;
-        if (SUCCEEDED(pPathGeometry->Open(&pSink))) {
+    // ·ΰ汾棩
+    ID2D1PathGeometry *pPathGeometry = AcquirePathGeometry(pRenderTarget, m_geometryVersion, 0,
+        [this](ID2D1GeometrySink *pSink) {
             pSink->BeginFigure(m_points[0], D2D1_FIGURE_BEGIN_FILLED);
             pSink->AddLine(m_points[1]);
             pSink->AddLine(m_points[2]);
             pSink->EndFigure(D2D1_FIGURE_END_CLOSED);
-            pSink->Close();
-            pSink->Release();
-        }
+        });
+    if (pPathGeometry) {
         if (m_isSelected && pDashStrokeStyle)
-            pRenderTarget->DrawGeometry(pPathGeometry, currentBrush, 2.0f, pDashStrokeStyle);
+            pRenderTarget->DrawGeometry(pPathGeometry, currentBrush, StrokeWidthFor(pRenderTarget, 2.0f), pDashStrokeStyle);
         else
-            pRenderTarget->DrawGeometry(pPathGeometry, currentBrush, 2.0f);
+            pRenderTarget->DrawGeometry(pPathGeometry, currentBrush, StrokeWidthFor(pRenderTarget, 2.0f));
         pPathGeometry->Release();
     }
-
-    if (pFactory) pFactory->Release();
 }
 
 bool Triangle::HitTest(D2D1_POINT_2F point) {
@@ -1234,6 +1630,7 @@ bool Triangle::HitTest(D2D1_POINT_2F point) {
 }
 
 void Triangle::Move(float dx, float dy) {
+    InvalidateBounds();
     for (int i = 0; i < 3; i++) {
         m_points[i].x += dx;
         m_points[i].y += dy;
@@ -1242,6 +1639,7 @@ void Triangle::Move(float dx, float dy) {
 }
 
 void Triangle::Rotate(float angle) {
+    InvalidateBounds();
     // ĵ
     D2D1_POINT_2F center = {
         (m_points[0].x + m_points[1].x + m_points[2].x) / 3,
@@ -1267,6 +1665,7 @@ void Triangle::Rotate(float angle) {
 }
 
 void Triangle::Scale(float scale) {
+    InvalidateBounds();
     D2D1_POINT_2F center = {
         (m_points[0].x + m_points[1].x + m_points[2].x) / 3,
         (m_points[0].y + m_points[1].y + m_points[2].y) / 3};
@@ -1279,6 +1678,7 @@ void Triangle::Scale(float scale) {
 }
 
 void Triangle::RotateAroundPoint(float angle, D2D1_POINT_2F center) {
+    InvalidateBounds();
     float s = sinf(angle);
     float c = cosf(angle);
     
@@ -1330,28 +1730,21 @@ void Diamond::Draw(ID2D1RenderTarget *rt,
     DrawFillPixels(rt);
     
     ID2D1SolidColorBrush *cur = m_isSelected ? sel : nrm;
-    D2D1_POINT_2F pts[4];
-    GetDiamondPoints(m_center, m_radiusX, m_radiusY, m_angle, pts);
 
-    ID2D1Factory *f = nullptr;
-    rt->GetFactory(&f);
-    ID2D1PathGeometry *geo = nullptr;
-    if (SUCCEEDED(f->CreatePathGeometry(&geo))) {
-        ID2D1GeometrySink *s = nullptr;
-        if (SUCCEEDED(geo->Open(&s))) {
-            s->BeginFigure(pts[0], D2D1_FIGURE_BEGIN_FILLED);
-            for (int i = 1; i < 4; ++i) s->AddLine(pts[i]);
-            s->EndFigure(D2D1_FIGURE_END_CLOSED);
-            s->Close();
-            s->Release();
-        }
+    ID2D1PathGeometry *geo = AcquirePathGeometry(rt, m_geometryVersion, 0, [this](ID2D1GeometrySink *s) {
+        D2D1_POINT_2F pts[4];
+        GetDiamondPoints(m_center, m_radiusX, m_radiusY, m_angle, pts);
+        s->BeginFigure(pts[0], D2D1_FIGURE_BEGIN_FILLED);
+        for (int i = 1; i < 4; ++i) s->AddLine(pts[i]);
+        s->EndFigure(D2D1_FIGURE_END_CLOSED);
+    });
+    if (geo) {
         if (m_isSelected && dash)
-            rt->DrawGeometry(geo, cur, 2.0f, dash);
+            rt->DrawGeometry(geo, cur, StrokeWidthFor(rt, 2.0f), dash);
         else
-            rt->DrawGeometry(geo, cur, 2.0f);
+            rt->DrawGeometry(geo, cur, StrokeWidthFor(rt, 2.0f));
         geo->Release();
     }
-    if (f) f->Release();
 }
 
 // HitTestתη
@@ -1366,6 +1759,7 @@ bool Diamond::HitTest(D2D1_POINT_2F p) {
 
 // Move
 void Diamond::Move(float dx, float dy) {
+    InvalidateBounds();
     m_center.x += dx;
     m_center.y += dy;
     TransformFillPixelsMove(dx, dy);  // ƶ
@@ -1373,18 +1767,21 @@ void Diamond::Move(float dx, float dy) {
 
 // Rotate
 void Diamond::Rotate(float angle) {
+    InvalidateBounds();
     m_angle += angle;
     TransformFillPixelsRotate(angle, m_center);  // ת
 }
 
 // Scale
 void Diamond::Scale(float scale) {
+    InvalidateBounds();
     m_radiusX *= scale;
     m_radiusY *= scale;
     TransformFillPixelsScale(scale, m_center);  // 
 }
 
 void Diamond::RotateAroundPoint(float angle, D2D1_POINT_2F center) {
+    InvalidateBounds();
     // ƶ
     float s = sinf(angle);
     float c = cosf(angle);
@@ -1398,7 +1795,7 @@ void Diamond::RotateAroundPoint(float angle, D2D1_POINT_2F center) {
 }
 
 // Χ
-D2D1_RECT_F Diamond::GetBounds() const {
+D2D1_RECT_F Diamond::ComputeBounds() const {
     D2D1_POINT_2F pts[4];
     GetDiamondPoints(m_center, m_radiusX, m_radiusY, m_angle, pts);
     float minX = pts[0].x, maxX = pts[0].x;
@@ -1413,13 +1810,10 @@ D2D1_RECT_F Diamond::GetBounds() const {
 }
 
 // ɢ߶
-std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> Diamond::GetIntersectionSegments() const {
-    std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> segs;
+void Diamond::VisitIntersectionSegments(SegmentVisitor visit, void *context) const {
     D2D1_POINT_2F pts[4];
     GetDiamondPoints(m_center, m_radiusX, m_radiusY, m_angle, pts);
-    for (int i = 0; i < 4; ++i)
-        segs.push_back(std::make_pair(pts[i], pts[(i + 1) & 3]));
-    return segs;
+    VisitClosedPolyline(pts, 4, visit, context);
 }
 
 // лDiamond center.x center.y radiusX radiusY angle
@@ -1454,30 +1848,22 @@ void Parallelogram::Draw(ID2D1RenderTarget *pRenderTarget,
 
     ID2D1SolidColorBrush *currentBrush = m_isSelected ? pSelectedBrush : pNormalBrush;
 
-    // ƽı·
-    ID2D1PathGeometry *pPathGeometry = nullptr;
-    ID2D1Factory *pFactory = nullptr;
-    pRenderTarget->GetFactory(&pFactory);
-
-    if (SUCCEEDED(pFactory->CreatePathGeometry(&pPathGeometry))) {
-        ID2D1GeometrySink *pSink = nullptr;
-        if (SUCCEEDED(pPathGeometry->Open(&pSink))) {
+    // ƽı·ΰ汾棩
+    ID2D1PathGeometry *pPathGeometry = AcquirePathGeometry(pRenderTarget, m_geometryVersion, 0,
+        [this](ID2D1GeometrySink *pSink) {
             pSink->BeginFigure(m_points[0], D2D1_FIGURE_BEGIN_FILLED);
             for (int i = 1; i < 4; i++) {
                 pSink->AddLine(m_points[i]);
             }
             pSink->EndFigure(D2D1_FIGURE_END_CLOSED);
-            pSink->Close();
-            pSink->Release();
-        }
+        });
+    if (pPathGeometry) {
         if (m_isSelected && pDashStrokeStyle)
-            pRenderTarget->DrawGeometry(pPathGeometry, currentBrush, 2.0f, pDashStrokeStyle);
+            pRenderTarget->DrawGeometry(pPathGeometry, currentBrush, StrokeWidthFor(pRenderTarget, 2.0f), pDashStrokeStyle);
         else
-            pRenderTarget->DrawGeometry(pPathGeometry, currentBrush, 2.0f);
+            pRenderTarget->DrawGeometry(pPathGeometry, currentBrush, StrokeWidthFor(pRenderTarget, 2.0f));
         pPathGeometry->Release();
     }
-
-    if (pFactory) pFactory->Release();
 }
 
 bool Parallelogram::HitTest(D2D1_POINT_2F point) {
@@ -1488,6 +1874,7 @@ bool Parallelogram::HitTest(D2D1_POINT_2F point) {
 }
 
 void Parallelogram::Move(float dx, float dy) {
+    InvalidateBounds();
     for (int i = 0; i < 4; i++) {
         m_points[i].x += dx;
         m_points[i].y += dy;
@@ -1496,6 +1883,7 @@ void Parallelogram::Move(float dx, float dy) {
 }
 
 void Parallelogram::Rotate(float angle) {
+    InvalidateBounds();
     // ĵ
     D2D1_POINT_2F center = {0, 0};
     for (int i = 0; i < 4; i++) {
@@ -1525,6 +1913,7 @@ void Parallelogram::Rotate(float angle) {
 }
 
 void Parallelogram::Scale(float scale) {
+    InvalidateBounds();
     D2D1_POINT_2F center = {0, 0};
     for (int i = 0; i < 4; i++) {
         center.x += m_points[i].x;
@@ -1541,6 +1930,7 @@ void Parallelogram::Scale(float scale) {
 }
 
 void Parallelogram::RotateAroundPoint(float angle, D2D1_POINT_2F center) {
+    InvalidateBounds();
     float s = sinf(angle);
     float c = cosf(angle);
     
@@ -1596,13 +1986,10 @@ void Curve::Draw(ID2D1RenderTarget *pRenderTarget,
 
     ID2D1SolidColorBrush *currentBrush = m_isSelected ? pSelectedBrush : pNormalBrush;
 
-    ID2D1Factory *pFactory = nullptr;
-    pRenderTarget->GetFactory(&pFactory);
-
-    ID2D1PathGeometry *pPathGeometry = nullptr;
-    if (SUCCEEDED(pFactory->CreatePathGeometry(&pPathGeometry))) {
-        ID2D1GeometrySink *pSink = nullptr;
-        if (SUCCEEDED(pPathGeometry->Open(&pSink))) {
+    // ɢ·ΰ汾Ͷ棬Ƶ㲻ʱֵͼСýٵĶ
+    int segments = FlattenSegments(pRenderTarget, m_points.data(), m_points.size(), CURVE_FLATTEN_SEGS);
+    ID2D1PathGeometry *pPathGeometry = AcquirePathGeometry(pRenderTarget, m_geometryVersion, static_cast<uint32_t>(segments),
+        [this, segments](ID2D1GeometrySink *pSink) {
             // ֹɢ Bzier
             const D2D1_POINT_2F &p0 = m_points[0];
             const D2D1_POINT_2F &p1 = m_points[1];
@@ -1611,26 +1998,29 @@ void Curve::Draw(ID2D1RenderTarget *pRenderTarget,
 
             pSink->BeginFigure(p0, D2D1_FIGURE_BEGIN_HOLLOW);
 
-            for (int i = 1; i <= CURVE_FLATTEN_SEGS; ++i) {
-                float t = float(i) / CURVE_FLATTEN_SEGS;
+            for (int i = 1; i <= segments; ++i) {
+                float t = float(i) / segments;
                 D2D1_POINT_2F pt = EvaluateCubicBezier(p0, p1, p2, p3, t);
                 pSink->AddLine(pt);
             }
 
             pSink->EndFigure(D2D1_FIGURE_END_OPEN);
-            pSink->Close();
-            pSink->Release();
-        }
-
+        });
+    if (pPathGeometry) {
         if (m_isSelected && pDashStrokeStyle)
-            pRenderTarget->DrawGeometry(pPathGeometry, currentBrush, 2.0f, pDashStrokeStyle);
+            pRenderTarget->DrawGeometry(pPathGeometry, currentBrush, StrokeWidthFor(pRenderTarget, 2.0f), pDashStrokeStyle);
         else
-            pRenderTarget->DrawGeometry(pPathGeometry, currentBrush, 2.0f);
+            pRenderTarget->DrawGeometry(pPathGeometry, currentBrush, StrokeWidthFor(pRenderTarget, 2.0f));
 
         pPathGeometry->Release();
     }
+}
 
-    if (pFactory) pFactory->Release();
+void Curve::DrawTo(RenderBackend &backend, const D2D1_COLOR_F &color) const {
+    if (m_points.size() != 4) return;
+    DrawFillPixelsTo(backend);
+    backend.DrawBezier(m_points[0], m_points[1], m_points[2], m_points[3],
+                       color, (float)GetLineWidthValue(), GetLineStyle());
 }
 
 bool Curve::HitTest(D2D1_POINT_2F point) {
@@ -1699,6 +2089,7 @@ D2D1_POINT_2F Curve::CalculateBezierPoint(float t) const {
 }
 
 void Curve::Move(float dx, float dy) {
+    InvalidateBounds();
     for (auto &point : m_points) {
         point.x += dx;
         point.y += dy;
@@ -1706,6 +2097,7 @@ void Curve::Move(float dx, float dy) {
 }
 
 void Curve::Rotate(float angle) {
+    InvalidateBounds();
     // ĵ
     D2D1_POINT_2F center = {0, 0};
     for (const auto &point : m_points) {
@@ -1734,6 +2126,7 @@ void Curve::Rotate(float angle) {
 }
 
 void Curve::Scale(float scale) {
+    InvalidateBounds();
     D2D1_POINT_2F center = {0, 0};
     for (const auto &point : m_points) {
         center.x += point.x;
@@ -1749,6 +2142,7 @@ void Curve::Scale(float scale) {
 }
 
 void Curve::RotateAroundPoint(float angle, D2D1_POINT_2F center) {
+    InvalidateBounds();
     float s = sinf(angle);
     float c = cosf(angle);
     
@@ -1770,21 +2164,37 @@ std::string Curve::Serialize() {
     return oss.str();
 }
 
-std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> Curve::GetIntersectionSegments() const {
-    std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> segs;
+D2D1_RECT_F Curve::ComputeBounds() const {
+    if (m_points.empty()) {
+        return D2D1::RectF(0, 0, 0, 0);
+    }
+
+    D2D1_RECT_F bounds;
+    if (s_boundsMode == BoundsMode::TIGHT && m_points.size() == 4) {
+        // ˵һϣٲϵļֵ
+        bounds = PointsBounds(&m_points[0], 1);
+        UnionRect(bounds, PointsBounds(&m_points[3], 1));
+        ExtendCubicAxis(m_points[0].x, m_points[1].x, m_points[2].x, m_points[3].x, bounds.left, bounds.right);
+        ExtendCubicAxis(m_points[0].y, m_points[1].y, m_points[2].y, m_points[3].y, bounds.top, bounds.bottom);
+    } else {
+        bounds = PointsBounds(m_points.data(), m_points.size());
+    }
+    return bounds;
+}
+
+void Curve::VisitIntersectionSegments(SegmentVisitor visit, void *context) const {
     const int n = CURVE_FLATTEN_SEGS;
+    D2D1_POINT_2F previous = CalculateBezierPoint(0.0f);
     for (int i = 0; i < n; ++i) {
-        float t1 = float(i) / n;
-        float t2 = float(i + 1) / n;
-        segs.emplace_back(CalculateBezierPoint(t1),
-                          CalculateBezierPoint(t2));
+        D2D1_POINT_2F point = CalculateBezierPoint(float(i + 1) / n);
+        visit(context, previous, point);
+        previous = point;
     }
-    return segs;
 }
 
 // Polyline ʵ
 Poly::Poly(const std::vector<D2D1_POINT_2F> &points) :
-    Shape(ShapeType::POLYLINE), m_points(points) {
+    Shape(ShapeType::POLYLINE), m_points(points.begin(), points.end()) {
 }
 
 void Poly::Draw(ID2D1RenderTarget *pRenderTarget,
@@ -1798,20 +2208,20 @@ void Poly::Draw(ID2D1RenderTarget *pRenderTarget,
     DrawFillPixels(pRenderTarget);
 
     ID2D1SolidColorBrush *currentBrush = m_isSelected ? pSelectedBrush : pNormalBrush;
+    float strokeWidth = StrokeWidthFor(pRenderTarget, 2.0f);
 
     // ߶
     for (size_t i = 1; i < m_points.size(); i++) {
         if (m_isSelected && pDashStrokeStyle)
-            pRenderTarget->DrawLine(m_points[i - 1], m_points[i], currentBrush, 2.0f, pDashStrokeStyle);
+            pRenderTarget->DrawLine(m_points[i - 1], m_points[i], currentBrush, strokeWidth, pDashStrokeStyle);
         else
-            pRenderTarget->DrawLine(m_points[i - 1], m_points[i], currentBrush, 2.0f);
+            pRenderTarget->DrawLine(m_points[i - 1], m_points[i], currentBrush, strokeWidth);
     }
 
     // ѡУӶӾЧƵ
     if (m_isSelected) {
         // ƶƵ
-        ID2D1SolidColorBrush *controlBrush = nullptr;
-        pRenderTarget->CreateSolidColorBrush(D2D1::ColorF(D2D1::ColorF::Red), &controlBrush);
+        ID2D1SolidColorBrush *controlBrush = AcquireBrush(pRenderTarget, D2D1::ColorF(D2D1::ColorF::Red));
         if (controlBrush) {
             for (const auto &point : m_points) {
                 D2D1_ELLIPSE ellipse = D2D1::Ellipse(point, 3.0f, 3.0f);
@@ -1863,6 +2273,7 @@ bool Poly::HitTest(D2D1_POINT_2F point) {
 }
 
 void Poly::Move(float dx, float dy) {
+    InvalidateBounds();
     for (auto &point : m_points) {
         point.x += dx;
         point.y += dy;
@@ -1871,6 +2282,7 @@ void Poly::Move(float dx, float dy) {
 }
 
 void Poly::Rotate(float angle) {
+    InvalidateBounds();
     // ĵ
     D2D1_POINT_2F center = {0, 0};
     for (const auto &point : m_points) {
@@ -1900,6 +2312,7 @@ void Poly::Rotate(float angle) {
 }
 
 void Poly::Scale(float scale) {
+    InvalidateBounds();
     D2D1_POINT_2F center = {0, 0};
     for (const auto &point : m_points) {
         center.x += point.x;
@@ -1916,6 +2329,7 @@ void Poly::Scale(float scale) {
 }
 
 void Poly::RotateAroundPoint(float angle, D2D1_POINT_2F center) {
+    InvalidateBounds();
     float s = sinf(angle);
     float c = cosf(angle);
     
@@ -1929,6 +2343,7 @@ void Poly::RotateAroundPoint(float angle, D2D1_POINT_2F center) {
 }
 
 void Poly::AddPoint(D2D1_POINT_2F point) {
+    InvalidateBounds();
     m_points.push_back(point);
 }
 
@@ -1948,7 +2363,13 @@ MultiBezier::MultiBezier() : Shape(ShapeType::MULTI_BEZIER) {
 
 // De Casteljau㷨ݹBezierڲtĵ
 D2D1_POINT_2F MultiBezier::DeCasteljau(
-    const std::vector<D2D1_POINT_2F>& controlPoints, float t) {
+    const PointVector& controlPoints, float t) {
+    std::vector<D2D1_POINT_2F> tempPoints;
+    return DeCasteljau(controlPoints, t, tempPoints);
+}
+
+D2D1_POINT_2F MultiBezier::DeCasteljau(
+    const PointVector& controlPoints, float t, std::vector<D2D1_POINT_2F>& tempPoints) {
     if (controlPoints.empty()) {
         return D2D1::Point2F(0, 0);
     }
@@ -1956,8 +2377,8 @@ D2D1_POINT_2F MultiBezier::DeCasteljau(
         return controlPoints[0];
     }
     
-    // ʱ洢ÿһĲֵ
-    std::vector<D2D1_POINT_2F> tempPoints = controlPoints;
+    // ʱ洢ÿһĲֵ
+    tempPoints.assign(controlPoints.begin(), controlPoints.end());
     int n = static_cast<int>(tempPoints.size());
     
     // Բֵ
@@ -1972,6 +2393,7 @@ D2D1_POINT_2F MultiBezier::DeCasteljau(
 }
 
 void MultiBezier::AddControlPoint(D2D1_POINT_2F point) {
+    InvalidateBounds();
     m_controlPoints.push_back(point);
 }
 
@@ -1984,8 +2406,7 @@ void MultiBezier::Draw(ID2D1RenderTarget *pRenderTarget,
     // ֻڱ༭״̬»ƿƵԤ
     if (m_isEditing) {
         // еĿƵ㣨СԲȦǣ
-        ID2D1SolidColorBrush *controlBrush = nullptr;
-        pRenderTarget->CreateSolidColorBrush(D2D1::ColorF(D2D1::ColorF::Red, 0.7f), &controlBrush);
+        ID2D1SolidColorBrush *controlBrush = AcquireBrush(pRenderTarget, D2D1::ColorF(D2D1::ColorF::Red, 0.7f));
         if (controlBrush) {
             for (const auto& point : m_controlPoints) {
                 D2D1_ELLIPSE ellipse = D2D1::Ellipse(point, 4.0f, 4.0f);
@@ -1996,8 +2417,7 @@ void MultiBezier::Draw(ID2D1RenderTarget *pRenderTarget,
         
         // Ԥ߶Σһ㵽λã
         if (m_hasPreview && !m_controlPoints.empty()) {
-            ID2D1SolidColorBrush *previewBrush = nullptr;
-            pRenderTarget->CreateSolidColorBrush(D2D1::ColorF(D2D1::ColorF::Gray, 0.5f), &previewBrush);
+            ID2D1SolidColorBrush *previewBrush = AcquireBrush(pRenderTarget, D2D1::ColorF(D2D1::ColorF::Gray, 0.5f));
             if (previewBrush) {
                 pRenderTarget->DrawLine(m_controlPoints.back(), m_previewPoint, previewBrush, 1.0f, pDashStrokeStyle);
                 
@@ -2016,15 +2436,16 @@ void MultiBezier::Draw(ID2D1RenderTarget *pRenderTarget,
     ID2D1SolidColorBrush *currentBrush = m_isSelected ? pSelectedBrush : pNormalBrush;
     
     // ʹDe Casteljau㷨Bezier
-    // ɢΪ߶
+    // ɢΪ߶ΣͼС٣
     if (m_controlPoints.size() >= 2) {
         D2D1_POINT_2F prevPoint = DeCasteljau(m_controlPoints, 0.0f);
+        int segments = FlattenSegments(pRenderTarget, m_controlPoints.data(), m_controlPoints.size(), CURVE_SEGMENTS);
         
-        for (int i = 1; i <= CURVE_SEGMENTS; ++i) {
-            float t = static_cast<float>(i) / CURVE_SEGMENTS;
+        for (int i = 1; i <= segments; ++i) {
+            float t = static_cast<float>(i) / segments;
             D2D1_POINT_2F currentPoint = DeCasteljau(m_controlPoints, t);
             
-            float strokeWidth = m_isSelected ? 2.0f : 2.0f;
+            float strokeWidth = StrokeWidthFor(pRenderTarget, m_isSelected ? 2.0f : 2.0f);
             if (m_isSelected && pDashStrokeStyle) {
                 pRenderTarget->DrawLine(prevPoint, currentPoint, currentBrush, strokeWidth, pDashStrokeStyle);
             } else {
@@ -2036,8 +2457,7 @@ void MultiBezier::Draw(ID2D1RenderTarget *pRenderTarget,
     }
     
     if (m_isSelected) {
-        ID2D1SolidColorBrush *controlBrush = nullptr;
-        pRenderTarget->CreateSolidColorBrush(D2D1::ColorF(D2D1::ColorF::Red), &controlBrush);
+        ID2D1SolidColorBrush *controlBrush = AcquireBrush(pRenderTarget, D2D1::ColorF(D2D1::ColorF::Red));
         if (controlBrush) {
             for (const auto& point : m_controlPoints) {
                 D2D1_ELLIPSE ellipse = D2D1::Ellipse(point, 3.0f, 3.0f);
@@ -2080,6 +2500,7 @@ bool MultiBezier::HitTest(D2D1_POINT_2F point) {
 }
 
 void MultiBezier::Move(float dx, float dy) {
+    InvalidateBounds();
     for (auto& point : m_controlPoints) {
         point.x += dx;
         point.y += dy;
@@ -2087,6 +2508,7 @@ void MultiBezier::Move(float dx, float dy) {
 }
 
 void MultiBezier::Rotate(float angle) {
+    InvalidateBounds();
     if (m_controlPoints.empty()) return;
     
     D2D1_POINT_2F center = GetCenter();
@@ -2106,6 +2528,7 @@ void MultiBezier::Rotate(float angle) {
 }
 
 void MultiBezier::Scale(float scale) {
+    InvalidateBounds();
     if (m_controlPoints.empty()) return;
     
     D2D1_POINT_2F center = GetCenter();
@@ -2117,6 +2540,7 @@ void MultiBezier::Scale(float scale) {
 }
 
 void MultiBezier::RotateAroundPoint(float angle, D2D1_POINT_2F center) {
+    InvalidateBounds();
     float s = sinf(angle);
     float c = cosf(angle);
     
@@ -2142,43 +2566,39 @@ D2D1_POINT_2F MultiBezier::GetCenter() const {
     return D2D1::Point2F(sumX / m_controlPoints.size(), sumY / m_controlPoints.size());
 }
 
-D2D1_RECT_F MultiBezier::GetBounds() const {
+D2D1_RECT_F MultiBezier::ComputeBounds() const {
     if (m_controlPoints.empty()) {
         return D2D1::RectF(0, 0, 0, 0);
     }
-    
-    float minX = m_controlPoints[0].x;
-    float minY = m_controlPoints[0].y;
-    float maxX = m_controlPoints[0].x;
-    float maxY = m_controlPoints[0].y;
-    
-    for (const auto& point : m_controlPoints) {
-        minX = min(minX, point.x);
-        minY = min(minY, point.y);
-        maxX = max(maxX, point.x);
-        maxY = max(maxY, point.y);
+
+    if (s_boundsMode == BoundsMode::TIGHT && m_controlPoints.size() > 2) {
+        // ˵ֻϸֿƵΧгǰĲ
+        D2D1_RECT_F bounds = PointsBounds(&m_controlPoints.front(), 1);
+        UnionRect(bounds, PointsBounds(&m_controlPoints.back(), 1));
+        ExtendBezierBounds(m_controlPoints.data(), m_controlPoints.size(), bounds, 0);
+        return bounds;
     }
-    
-    return D2D1::RectF(minX, minY, maxX, maxY);
+    return PointsBounds(m_controlPoints.data(), m_controlPoints.size());
 }
 
-std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> MultiBezier::GetIntersectionSegments() const {
-    std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> segments;
-    
-    if (m_controlPoints.size() < 2) return segments;
+void MultiBezier::VisitIntersectionSegments(SegmentVisitor visit, void *context) const {
+    if (m_controlPoints.size() < 2) return;
     
-    // ʹDe Casteljau㷨ɢ
-    for (int i = 0; i < CURVE_SEGMENTS; ++i) {
-        float t1 = static_cast<float>(i) / CURVE_SEGMENTS;
-        float t2 = static_cast<float>(i + 1) / CURVE_SEGMENTS;
-        
-        D2D1_POINT_2F pt1 = DeCasteljau(m_controlPoints, t1);
-        D2D1_POINT_2F pt2 = DeCasteljau(m_controlPoints, t2);
-        
-        segments.push_back({pt1, pt2});
+    // ڹ̶ĵȷֲɢ߶ιö˵㣻
+    // ɻ Bernstein Ȩͣ O(n^2)  De Casteljau ֵ
+    size_t count = m_controlPoints.size();
+    const float *basis = BernsteinTable(count - 1, CURVE_SEGMENTS);
+    D2D1_POINT_2F previous = m_controlPoints[0];
+    for (int i = 1; i <= CURVE_SEGMENTS; ++i) {
+        const float *weights = basis + i * count;
+        D2D1_POINT_2F point = D2D1::Point2F(0.0f, 0.0f);
+        for (size_t k = 0; k < count; ++k) {
+            point.x += weights[k] * m_controlPoints[k].x;
+            point.y += weights[k] * m_controlPoints[k].y;
+        }
+        visit(context, previous, point);
+        previous = point;
     }
-    
-    return segments;
 }
 
 std::string MultiBezier::Serialize() {
@@ -2194,7 +2614,7 @@ std::string MultiBezier::Serialize() {
 // ==================== Polygon ʵ ====================
 
 Polygon::Polygon(const std::vector<D2D1_POINT_2F> &points) : Shape(ShapeType::POLYGON) {
-    m_points = points;
+    m_points.assign(points.begin(), points.end());
 }
 
 void Polygon::Draw(ID2D1RenderTarget *pRenderTarget,
@@ -2207,7 +2627,7 @@ void Polygon::Draw(ID2D1RenderTarget *pRenderTarget,
     DrawFillPixels(pRenderTarget);
 
     ID2D1SolidColorBrush *drawBrush = m_isSelected ? pSelectedBrush : pBrush;
-    float strokeWidth = static_cast<float>(GetLineWidthValue());
+    float strokeWidth = StrokeWidthFor(pRenderTarget, static_cast<float>(GetLineWidthValue()));
 
     // ƶεı
     for (size_t i = 1; i < m_points.size(); ++i) {
@@ -2275,6 +2695,7 @@ bool Polygon::HitTest(D2D1_POINT_2F point) {
 }
 
 void Polygon::Move(float dx, float dy) {
+    InvalidateBounds();
     for (auto &point : m_points) {
         point.x += dx;
         point.y += dy;
@@ -2283,6 +2704,7 @@ void Polygon::Move(float dx, float dy) {
 }
 
 void Polygon::Rotate(float angle) {
+    InvalidateBounds();
     if (m_points.empty()) return;
 
     D2D1_POINT_2F center = GetCenter();
@@ -2303,6 +2725,7 @@ void Polygon::Rotate(float angle) {
 }
 
 void Polygon::Scale(float scale) {
+    InvalidateBounds();
     if (m_points.empty()) return;
 
     D2D1_POINT_2F center = GetCenter();
@@ -2315,6 +2738,7 @@ void Polygon::Scale(float scale) {
 }
 
 void Polygon::RotateAroundPoint(float angle, D2D1_POINT_2F center) {
+    InvalidateBounds();
     float s = sinf(angle);
     float c = cosf(angle);
     
@@ -2328,6 +2752,7 @@ void Polygon::RotateAroundPoint(float angle, D2D1_POINT_2F center) {
 }
 
 void Polygon::AddPoint(D2D1_POINT_2F point) {
+    InvalidateBounds();
     m_points.push_back(point);
 }
 
@@ -2348,10 +2773,8 @@ bool Polygon::WouldCauseIntersection(D2D1_POINT_2F newPoint, bool checkClosingEd
     D2D1_POINT_2F lastPoint = m_points.back();
     D2D1_POINT_2F firstPoint = m_points[0];
     
-    char debugMsg[200];
-    sprintf_s(debugMsg, "ཻ: ǰ%zu, ±ߴ(%.1f,%.1f)(%.1f,%.1f), պϱ=%d\n", 
+    LOG_TRACE("ཻ: ǰ%zu, ±ߴ(%.1f,%.1f)(%.1f,%.1f), պϱ=%d\n",
               m_points.size(), lastPoint.x, lastPoint.y, newPoint.x, newPoint.y, checkClosingEdge);
-    OutputDebugStringA(debugMsg);
     
     // 1. ± lastPoint -> newPoint Ƿеıཻ
     for (size_t i = 0; i < m_points.size() - 1; ++i) {
@@ -2360,45 +2783,40 @@ bool Polygon::WouldCauseIntersection(D2D1_POINT_2F newPoint, bool checkClosingEd
         
         // һߣ±߹lastPoint˵㣩
         if (i == m_points.size() - 2) {
-            sprintf_s(debugMsg, "  һ[%zu]: (%.1f,%.1f)(%.1f,%.1f)\n", 
+            LOG_TRACE("  һ[%zu]: (%.1f,%.1f)(%.1f,%.1f)\n",
                       i, edgeStart.x, edgeStart.y, edgeEnd.x, edgeEnd.y);
-            OutputDebugStringA(debugMsg);
             continue;
         }
         
-        sprintf_s(debugMsg, "  ±[%zu]: (%.1f,%.1f)(%.1f,%.1f)\n", 
+        LOG_TRACE("  ±[%zu]: (%.1f,%.1f)(%.1f,%.1f)\n",
                   i, edgeStart.x, edgeStart.y, edgeEnd.x, edgeEnd.y);
-        OutputDebugStringA(debugMsg);
         
         if (SegmentsIntersect(lastPoint, newPoint, edgeStart, edgeEnd)) {
-            OutputDebugStringA("  >>> ±߷ཻ\n");
+            LOG_TRACE("  >>> ±߷ཻ\n");
             return true;
         }
     }
 
     // 2. Ҫպϱ newPoint -> firstPoint Ƿбཻ
     if (checkClosingEdge && m_points.size() >= 2) {
-        sprintf_s(debugMsg, "  պϱ: (%.1f,%.1f)(%.1f,%.1f)\n", 
-                  newPoint.x, newPoint.y, firstPoint.x, firstPoint.y);
-        OutputDebugStringA(debugMsg);
+        LOG_TRACE("  պϱ: (%.1f,%.1f)(%.1f,%.1f)\n", newPoint.x, newPoint.y, firstPoint.x, firstPoint.y);
         
         // պϱҪб߼飬˵һߣfirstPointһߣlastPoint
         for (size_t i = 1; i < m_points.size() - 1; ++i) {
             D2D1_POINT_2F edgeStart = m_points[i];
             D2D1_POINT_2F edgeEnd = m_points[i + 1];
             
-            sprintf_s(debugMsg, "    պϱ[%zu]: (%.1f,%.1f)(%.1f,%.1f)\n", 
+            LOG_TRACE("    պϱ[%zu]: (%.1f,%.1f)(%.1f,%.1f)\n",
                       i, edgeStart.x, edgeStart.y, edgeEnd.x, edgeEnd.y);
-            OutputDebugStringA(debugMsg);
             
             if (SegmentsIntersect(newPoint, firstPoint, edgeStart, edgeEnd)) {
-                OutputDebugStringA("  >>> պϱ߷ཻ\n");
+                LOG_TRACE("  >>> պϱ߷ཻ\n");
                 return true;
             }
         }
     }
 
-    OutputDebugStringA("  ûзཻ\n");
+    LOG_TRACE("  ûзཻ\n");
     return false;
 }
 
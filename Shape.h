@@ -5,12 +5,23 @@
 #include <vector>
 #include <memory>
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include "CommonType.h" // Ͷ
+#include "DocumentArena.h"
+#include "PixelPattern.h"
+
+class RenderBackend;
+
+// ͼγеĵУ洢ڵǰĵ
+typedef std::vector<D2D1_POINT_2F, ArenaAllocator<D2D1_POINT_2F>> PointVector;
 
 class Shape {
 public:
     Shape(ShapeType type) :
-        m_type(type), m_isSelected(false), m_lineWidth(LineWidth::WIDTH_1PX), m_lineStyle(LineStyle::SOLID) {
+        m_type(type), m_isSelected(false), m_lineWidth(LineWidth::WIDTH_1PX), m_lineStyle(LineStyle::SOLID),
+        m_transform(D2D1::IdentityMatrix()), m_hasTransform(false), m_bounds(D2D1::RectF(0, 0, 0, 0)), m_boundsEpoch(0),
+        m_geometryVersion(NextGeometryVersion()) {
     }
     virtual ~Shape() = default;
 
@@ -24,7 +35,31 @@ public:
     virtual void Scale(float scale) = 0;
     virtual void RotateAroundPoint(float angle, D2D1_POINT_2F center) = 0;  // ָת
     virtual D2D1_POINT_2F GetCenter() const = 0;
-    virtual D2D1_RECT_F GetBounds() const = 0;
+
+    // ΧУ任ʱΪ任İΧУ
+    // ΰΧлڶڣֻڼα޸ĺ㣬ظѯΪ O(1)
+    D2D1_RECT_F GetBounds() const;
+    // δӦñ任ļΰΧУ棩
+    const D2D1_RECT_F &GetLocalBounds() const {
+        unsigned epoch = s_boundsEpoch.load(std::memory_order_relaxed);
+        if (m_boundsEpoch != epoch) {
+            m_bounds = ComputeBounds();
+            m_boundsEpoch = epoch;
+        }
+        return m_bounds;
+    }
+
+    // ΰ汾ȫΨһÿ޸ĺֵԴ水汾·Ρ
+    // ͼμͬͬһ汾
+    uint64_t GetGeometryVersion() const {
+        return m_geometryVersion;
+    }
+
+    // ΧģʽлͼεĻһʧЧͼο SyncAll
+    static void SetBoundsMode(BoundsMode mode);
+    static BoundsMode GetBoundsMode() {
+        return s_boundsMode;
+    }
 
     ShapeType GetType() const {
         return m_type;
@@ -36,24 +71,25 @@ public:
         m_isSelected = selected;
     }
 
-    // ṩĬʵַر߽д
-    virtual std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> GetIntersectionSegments() const {
-        D2D1_RECT_F bounds = GetBounds();
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> segments;
+    static const int CIRCLE_SEGMENTS = 32; // ԲɢΪεı
 
-        D2D1_POINT_2F p1 = {bounds.left, bounds.top};
-        D2D1_POINT_2F p2 = {bounds.right, bounds.top};
-        D2D1_POINT_2F p3 = {bounds.right, bounds.bottom};
-        D2D1_POINT_2F p4 = {bounds.left, bounds.bottom};
+    // ɢ߶εķʻصvisit(context, , յ)
+    typedef void (*SegmentVisitor)(void *context, D2D1_POINT_2F a, D2D1_POINT_2F b);
 
-        segments.push_back({p1, p2});
-        segments.push_back({p2, p3});
-        segments.push_back({p3, p4});
-        segments.push_back({p4, p1});
+    // ɢ߶Σڴ棻ĬΪ߽4ߣд
+    virtual void VisitIntersectionSegments(SegmentVisitor visit, void *context) const;
 
-        return segments;
+    // Կɵö f(, յ) ɢ߶
+    template <typename F>
+    void ForEachIntersectionSegment(F f) const {
+        VisitIntersectionSegments([](void *context, D2D1_POINT_2F a, D2D1_POINT_2F b) {
+            (*static_cast<F *>(context))(a, b);
+        }, &f);
     }
 
+    // ɢ߶飬Ҫ߶ʱʹãֻʱ ForEachIntersectionSegment
+    std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> GetIntersectionSegments() const;
+
     // ĬϷfalseCircleд
     virtual bool HasCircleProperties() const {
         return false;
@@ -66,6 +102,14 @@ public:
     virtual std::string Serialize() = 0;
     static std::shared_ptr<Shape> Deserialize(const std::string &data);
 
+    // ͼΣʷдʱʱʹãзڵǰĵ
+    virtual std::shared_ptr<Shape> Clone() const = 0;
+    // ͼռõڴֽ͵ʷͳÿһڴ
+    virtual size_t GetMemoryBytes() const = 0;
+
+    // 豸޹صĻƣդȺʹãĬϰɢ߶ߣд
+    virtual void DrawTo(RenderBackend &backend, const D2D1_COLOR_F &color) const;
+
     // ߿
     void SetLineWidth(LineWidth width) { m_lineWidth = width; }
     LineWidth GetLineWidth() const { return m_lineWidth; }
@@ -76,35 +120,67 @@ public:
     LineStyle GetLineStyle() const { return m_lineStyle; }
     
     // ䷽
-    void SetFillPixels(const std::vector<D2D1_POINT_2F>& pixels) { m_fillPixels = pixels; }
-    const std::vector<D2D1_POINT_2F>& GetFillPixels() const { return m_fillPixels; }
-    void ClearFillPixels() { m_fillPixels.clear(); }
+    // ر仯ʱµļΰ汾汾λͼ֮ʧЧ
+    void SetFillPixels(const std::vector<D2D1_POINT_2F>& pixels) {
+        m_fillPixels.assign(pixels.begin(), pixels.end());
+        m_geometryVersion = NextGeometryVersion();
+    }
+    const PointVector& GetFillPixels() const { return m_fillPixels; }
+    void ClearFillPixels() {
+        m_fillPixels.clear();
+        m_geometryVersion = NextGeometryVersion();
+    }
     bool IsFilled() const { return !m_fillPixels.empty(); }
     
     // лصĸ
     std::string SerializeFillPixels() const;
     void DeserializeFillPixels(std::istringstream& iss);
 
+    // 任϶ʱƶ/ת/ۻ 3x2 ԼӦб任
+    // Ρصضдʱɾ任ύʱ BakeTransform һдؼ
+    // ֻ֧Ʊ任ƽơתȱţ Move/Rotate/Scale/RotateAroundPoint ܱһ
+    void ComposeTransform(const D2D1_MATRIX_3X2_F &transform);
+    bool HasTransform() const { return m_hasTransform; }
+    const D2D1_MATRIX_3X2_F &GetTransform() const { return m_transform; }
+    // ѱ任дؼΣλΪλ
+    void BakeTransform();
+
 protected:
+    // 㼸ΰΧУ޸ļεĳԱ InvalidateBounds
+    virtual D2D1_RECT_F ComputeBounds() const = 0;
+    void InvalidateBounds() {
+        m_boundsEpoch = 0;
+        m_geometryVersion = NextGeometryVersion();
+    }
+    static uint64_t NextGeometryVersion();
+    // βӵıպߣθߣ
+    static void VisitClosedPolyline(const D2D1_POINT_2F *points, size_t count, SegmentVisitor visit, void *context);
+    // ԲɢΪ CIRCLE_SEGMENTS ΣȡԻĵλԲǺ
+    static void VisitCircleSegments(D2D1_POINT_2F center, float radius, SegmentVisitor visit, void *context);
+
     ShapeType m_type;
     bool m_isSelected;
     LineWidth m_lineWidth;
     LineStyle m_lineStyle;  // ΪԤ
-    std::vector<D2D1_POINT_2F> m_fillPixels;  // ص
+    PointVector m_fillPixels;  // ص
+    D2D1_MATRIX_3X2_F m_transform; // δдؼεı任
+    bool m_hasTransform;
+    mutable D2D1_RECT_F m_bounds;     // ΰΧл
+    mutable unsigned m_boundsEpoch;   // ʱģʽԪ0 ʾʧЧ
+    uint64_t m_geometryVersion;       // ΰ汾 GetGeometryVersion
+
+    // ̨ͼθϲѯΧУģʽͼԪ̶ܱ߳ȡ
+    static std::atomic<BoundsMode> s_boundsMode;
+    static std::atomic<unsigned> s_boundsEpoch; // лΧģʽʱ1ʼ
     
     // ͨõƷDrawеã
-    void DrawFillPixels(ID2D1RenderTarget* pRenderTarget) const {
-        if (!IsFilled() || m_fillPixels.empty() || !pRenderTarget) return;
-        
-        ID2D1SolidColorBrush* fillBrush = nullptr;
-        pRenderTarget->CreateSolidColorBrush(D2D1::ColorF(D2D1::ColorF::LightBlue, 0.6f), &fillBrush);
-        if (fillBrush) {
-            for (const auto& pixel : m_fillPixels) {
-                D2D1_RECT_F pixelRect = D2D1::RectF(pixel.x, pixel.y, pixel.x + 1.0f, pixel.y + 1.0f);
-                pRenderTarget->FillRectangle(pixelRect, fillBrush);
-            }
-            fillBrush->Release();
-        }
+    void DrawFillPixels(ID2D1RenderTarget* pRenderTarget) const;
+
+    // ͨƺ
+    void DrawFillPixelsTo(RenderBackend &backend) const;
+
+    static size_t PointBytes(const PointVector &points) {
+        return points.capacity() * sizeof(D2D1_POINT_2F);
     }
     
     // ر任ڱ任ʱã
@@ -153,6 +229,12 @@ public:
     void RotateAroundPoint(float angle, D2D1_POINT_2F center) override;
 
     std::string Serialize() override;
+    std::shared_ptr<Shape> Clone() const override {
+        return MakeDocumentShared<Line>(*this);
+    }
+    size_t GetMemoryBytes() const override {
+        return sizeof(*this) + PointBytes(m_fillPixels);
+    }
 
     D2D1_POINT_2F GetStart() const {
         return m_start;
@@ -160,12 +242,18 @@ public:
     D2D1_POINT_2F GetEnd() const {
         return m_end;
     }
+    // ö˵㣨üʱԭ޸ģ
+    void SetEndpoints(D2D1_POINT_2F start, D2D1_POINT_2F end) {
+        m_start = start;
+        m_end = end;
+        InvalidateBounds();
+    }
 
     D2D1_POINT_2F GetCenter() const override {
         return D2D1::Point2F((m_start.x + m_end.x) / 2, (m_start.y + m_end.y) / 2);
     }
 
-    D2D1_RECT_F GetBounds() const override {
+    D2D1_RECT_F ComputeBounds() const override {
         return D2D1::RectF(
             min(m_start.x, m_end.x),
             min(m_start.y, m_end.y),
@@ -174,10 +262,8 @@ public:
     }
 
     // дɢ߶κ
-    std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> GetIntersectionSegments() const override {
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> segments;
-        segments.push_back({m_start, m_end});
-        return segments;
+    void VisitIntersectionSegments(SegmentVisitor visit, void *context) const override {
+        visit(context, m_start, m_end);
     }
 
 private:
@@ -193,6 +279,7 @@ public:
               ID2D1SolidColorBrush *pBrush,
               ID2D1SolidColorBrush *pSelectedBrush,
               ID2D1StrokeStyle *pDashStrokeStyle) override;
+    void DrawTo(RenderBackend &backend, const D2D1_COLOR_F &color) const override;
 
     bool HitTest(D2D1_POINT_2F point) override;
     void Move(float dx, float dy) override;
@@ -201,6 +288,12 @@ public:
     void RotateAroundPoint(float angle, D2D1_POINT_2F center) override;
 
     std::string Serialize() override;
+    std::shared_ptr<Shape> Clone() const override {
+        return MakeDocumentShared<MidpointLine>(*this);
+    }
+    size_t GetMemoryBytes() const override {
+        return sizeof(*this) + PointBytes(m_fillPixels) + PixelPatterns::OwnedBytes(m_pattern);
+    }
 
     D2D1_POINT_2F GetStart() const {
         return m_start;
@@ -208,12 +301,19 @@ public:
     D2D1_POINT_2F GetEnd() const {
         return m_end;
     }
+    // ö˵㣨üʱԭ޸ģͬʱ¼ص
+    void SetEndpoints(D2D1_POINT_2F start, D2D1_POINT_2F end) {
+        m_start = start;
+        m_end = end;
+        InvalidateBounds();
+        CalculateMidpointPixels();
+    }
 
     D2D1_POINT_2F GetCenter() const override {
         return D2D1::Point2F((m_start.x + m_end.x) / 2, (m_start.y + m_end.y) / 2);
     }
 
-    D2D1_RECT_F GetBounds() const override {
+    D2D1_RECT_F ComputeBounds() const override {
         return D2D1::RectF(
             min(m_start.x, m_end.x),
             min(m_start.y, m_end.y),
@@ -222,10 +322,8 @@ public:
     }
 
     // дɢ߶κ
-    std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> GetIntersectionSegments() const override {
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> segments;
-        segments.push_back({m_start, m_end});
-        return segments;
+    void VisitIntersectionSegments(SegmentVisitor visit, void *context) const override {
+        visit(context, m_start, m_end);
     }
 
     // ȡе㻭߷ɵص
@@ -233,7 +331,9 @@ public:
 
 private:
     D2D1_POINT_2F m_start, m_end;
-    std::vector<D2D1_POINT_2F> m_pixels; // 洢е㻭߷ɵص
+    PixelPatternPtr m_pattern;   // е㻭߷ɵģ壨ȡ㣩Ƴͼι
+    D2D1_POINT_2F m_pixelOrigin; // ȡ
+    int m_pixelDx, m_pixelDy;    // ģӦȡ˵
     void CalculateMidpointPixels(); // е㻭߷ص
 };
 
@@ -246,6 +346,7 @@ public:
               ID2D1SolidColorBrush *pBrush,
               ID2D1SolidColorBrush *pSelectedBrush,
               ID2D1StrokeStyle *pDashStrokeStyle) override;
+    void DrawTo(RenderBackend &backend, const D2D1_COLOR_F &color) const override;
 
     bool HitTest(D2D1_POINT_2F point) override;
     void Move(float dx, float dy) override;
@@ -254,6 +355,12 @@ public:
     void RotateAroundPoint(float angle, D2D1_POINT_2F center) override;
 
     std::string Serialize() override;
+    std::shared_ptr<Shape> Clone() const override {
+        return MakeDocumentShared<BresenhamLine>(*this);
+    }
+    size_t GetMemoryBytes() const override {
+        return sizeof(*this) + PointBytes(m_fillPixels) + PixelPatterns::OwnedBytes(m_pattern);
+    }
 
     D2D1_POINT_2F GetStart() const {
         return m_start;
@@ -261,12 +368,19 @@ public:
     D2D1_POINT_2F GetEnd() const {
         return m_end;
     }
+    // ö˵㣨üʱԭ޸ģͬʱ¼ص
+    void SetEndpoints(D2D1_POINT_2F start, D2D1_POINT_2F end) {
+        m_start = start;
+        m_end = end;
+        InvalidateBounds();
+        CalculateBresenhamPixels();
+    }
 
     D2D1_POINT_2F GetCenter() const override {
         return D2D1::Point2F((m_start.x + m_end.x) / 2, (m_start.y + m_end.y) / 2);
     }
 
-    D2D1_RECT_F GetBounds() const override {
+    D2D1_RECT_F ComputeBounds() const override {
         return D2D1::RectF(
             min(m_start.x, m_end.x),
             min(m_start.y, m_end.y),
@@ -275,10 +389,8 @@ public:
     }
 
     // дɢ߶κ
-    std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> GetIntersectionSegments() const override {
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> segments;
-        segments.push_back({m_start, m_end});
-        return segments;
+    void VisitIntersectionSegments(SegmentVisitor visit, void *context) const override {
+        visit(context, m_start, m_end);
     }
 
     // ȡBresenham߷ɵص
@@ -286,7 +398,9 @@ public:
 
 private:
     D2D1_POINT_2F m_start, m_end;
-    std::vector<D2D1_POINT_2F> m_pixels; // 洢Bresenham߷ɵص
+    PixelPatternPtr m_pattern;   // Bresenham߷ɵģ壨ȡ㣩Ƴͼι
+    D2D1_POINT_2F m_pixelOrigin; // ȡ
+    int m_pixelDx, m_pixelDy;    // ģӦȡ˵
     void CalculateBresenhamPixels(); // Bresenham߷ص
 };
 
@@ -299,6 +413,7 @@ public:
               ID2D1SolidColorBrush *pBrush,
               ID2D1SolidColorBrush *pSelectedBrush,
               ID2D1StrokeStyle *pDashStrokeStyle) override;
+    void DrawTo(RenderBackend &backend, const D2D1_COLOR_F &color) const override;
 
     bool HitTest(D2D1_POINT_2F point) override;
     void Move(float dx, float dy) override;
@@ -307,6 +422,12 @@ public:
     void RotateAroundPoint(float angle, D2D1_POINT_2F center) override;
 
     std::string Serialize() override;
+    std::shared_ptr<Shape> Clone() const override {
+        return MakeDocumentShared<MidpointCircle>(*this);
+    }
+    size_t GetMemoryBytes() const override {
+        return sizeof(*this) + PointBytes(m_fillPixels) + PixelPatterns::OwnedBytes(m_pattern);
+    }
 
     D2D1_POINT_2F GetCenter() const override {
         return m_center;
@@ -315,7 +436,7 @@ public:
         return m_radius;
     }
 
-    D2D1_RECT_F GetBounds() const override {
+    D2D1_RECT_F ComputeBounds() const override {
         return D2D1::RectF(
             m_center.x - m_radius,
             m_center.y - m_radius,
@@ -324,23 +445,8 @@ public:
     }
 
     // дɢ߶κ - ԲɢΪ
-    std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> GetIntersectionSegments() const override {
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> segments;
-        const int segmentsCount = 32;
-        std::vector<D2D1_POINT_2F> points;
-
-        for (int i = 0; i < segmentsCount; ++i) {
-            float angle = 2.0f * 3.14159265358979323846f * i / segmentsCount;
-            D2D1_POINT_2F point;
-            point.x = m_center.x + m_radius * cosf(angle);
-            point.y = m_center.y + m_radius * sinf(angle);
-            points.push_back(point);
-        }
-
-        for (int i = 0; i < segmentsCount; ++i) {
-            segments.push_back({points[i], points[(i + 1) % segmentsCount]});
-        }
-        return segments;
+    void VisitIntersectionSegments(SegmentVisitor visit, void *context) const override {
+        VisitCircleSegments(m_center, m_radius, visit, context);
     }
 
     // дԲغ
@@ -360,7 +466,7 @@ public:
 private:
     D2D1_POINT_2F m_center;
     float m_radius;
-    std::vector<D2D1_POINT_2F> m_pixels; // 洢е㻭Բɵص
+    PixelPatternPtr m_pattern; // е㻭Բɵģ壨Բģͬһ뾶Բ
     void CalculateMidpointPixels(); // е㻭Բص
 };
 
@@ -373,6 +479,7 @@ public:
               ID2D1SolidColorBrush *pBrush,
               ID2D1SolidColorBrush *pSelectedBrush,
               ID2D1StrokeStyle *pDashStrokeStyle) override;
+    void DrawTo(RenderBackend &backend, const D2D1_COLOR_F &color) const override;
 
     bool HitTest(D2D1_POINT_2F point) override;
     void Move(float dx, float dy) override;
@@ -381,6 +488,12 @@ public:
     void RotateAroundPoint(float angle, D2D1_POINT_2F center) override;
 
     std::string Serialize() override;
+    std::shared_ptr<Shape> Clone() const override {
+        return MakeDocumentShared<BresenhamCircle>(*this);
+    }
+    size_t GetMemoryBytes() const override {
+        return sizeof(*this) + PointBytes(m_fillPixels) + PixelPatterns::OwnedBytes(m_pattern);
+    }
 
     D2D1_POINT_2F GetCenter() const override {
         return m_center;
@@ -389,7 +502,7 @@ public:
         return m_radius;
     }
 
-    D2D1_RECT_F GetBounds() const override {
+    D2D1_RECT_F ComputeBounds() const override {
         return D2D1::RectF(
             m_center.x - m_radius,
             m_center.y - m_radius,
@@ -398,23 +511,8 @@ public:
     }
 
     // дɢ߶κ - ԲɢΪ
-    std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> GetIntersectionSegments() const override {
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> segments;
-        const int segmentsCount = 32;
-        std::vector<D2D1_POINT_2F> points;
-
-        for (int i = 0; i < segmentsCount; ++i) {
-            float angle = 2.0f * 3.14159265358979323846f * i / segmentsCount;
-            D2D1_POINT_2F point;
-            point.x = m_center.x + m_radius * cosf(angle);
-            point.y = m_center.y + m_radius * sinf(angle);
-            points.push_back(point);
-        }
-
-        for (int i = 0; i < segmentsCount; ++i) {
-            segments.push_back({points[i], points[(i + 1) % segmentsCount]});
-        }
-        return segments;
+    void VisitIntersectionSegments(SegmentVisitor visit, void *context) const override {
+        VisitCircleSegments(m_center, m_radius, visit, context);
     }
 
     // дԲغ
@@ -434,7 +532,7 @@ public:
 private:
     D2D1_POINT_2F m_center;
     float m_radius;
-    std::vector<D2D1_POINT_2F> m_pixels; // 洢BresenhamԲɵص
+    PixelPatternPtr m_pattern; // BresenhamԲɵģ壨Բģͬһ뾶Բ
     void CalculateBresenhamPixels(); // BresenhamԲص
 };
 
@@ -447,6 +545,7 @@ public:
               ID2D1SolidColorBrush *pBrush,
               ID2D1SolidColorBrush *pSelectedBrush,
               ID2D1StrokeStyle *pDashStrokeStyle) override;
+    void DrawTo(RenderBackend &backend, const D2D1_COLOR_F &color) const override;
 
     bool HitTest(D2D1_POINT_2F point) override;
     void Move(float dx, float dy) override;
@@ -456,6 +555,12 @@ public:
     void RotateAroundPoint(float angle, D2D1_POINT_2F center) override;
 
     std::string Serialize() override;
+    std::shared_ptr<Shape> Clone() const override {
+        return MakeDocumentShared<Circle>(*this);
+    }
+    size_t GetMemoryBytes() const override {
+        return sizeof(*this) + PointBytes(m_fillPixels);
+    }
     D2D1_POINT_2F GetCenter() const override {
         return m_center;
     }
@@ -463,7 +568,7 @@ public:
         return m_radius;
     }
 
-    D2D1_RECT_F GetBounds() const override {
+    D2D1_RECT_F ComputeBounds() const override {
         return D2D1::RectF(
             m_center.x - m_radius,
             m_center.y - m_radius,
@@ -472,25 +577,8 @@ public:
     }
 
     // дɢ߶κ - ԲɢΪ
-    std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> GetIntersectionSegments() const override {
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> segments;
-
-        const int segmentsCount = 32;
-        std::vector<D2D1_POINT_2F> points;
-
-        for (int i = 0; i < segmentsCount; ++i) {
-            float angle = 2.0f * 3.14159265358979323846f * i / segmentsCount;
-            D2D1_POINT_2F point;
-            point.x = m_center.x + m_radius * cosf(angle);
-            point.y = m_center.y + m_radius * sinf(angle);
-            points.push_back(point);
-        }
-
-        for (int i = 0; i < segmentsCount; ++i) {
-            segments.push_back({points[i], points[(i + 1) % segmentsCount]});
-        }
-
-        return segments;
+    void VisitIntersectionSegments(SegmentVisitor visit, void *context) const override {
+        VisitCircleSegments(m_center, m_radius, visit, context);
     }
 
     // дԲغ
@@ -531,7 +619,7 @@ public:
         return D2D1::Point2F(centerX, centerY);
     }
 
-    D2D1_RECT_F GetBounds() const override {
+    D2D1_RECT_F ComputeBounds() const override {
         float minX = m_points[0].x;
         float minY = m_points[0].y;
         float maxX = m_points[0].x;
@@ -548,17 +636,16 @@ public:
     }
 
     std::string Serialize() override;
+    std::shared_ptr<Shape> Clone() const override {
+        return MakeDocumentShared<Rect>(*this);
+    }
+    size_t GetMemoryBytes() const override {
+        return sizeof(*this) + PointBytes(m_fillPixels);
+    }
 
     // дɢ߶κ
-    std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> GetIntersectionSegments() const override {
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> segments;
-
-        segments.push_back({m_points[0], m_points[1]});
-        segments.push_back({m_points[1], m_points[2]});
-        segments.push_back({m_points[2], m_points[3]});
-        segments.push_back({m_points[3], m_points[0]});
-
-        return segments;
+    void VisitIntersectionSegments(SegmentVisitor visit, void *context) const override {
+        VisitClosedPolyline(m_points, 4, visit, context);
     }
 
 private:
@@ -582,6 +669,12 @@ public:
     void RotateAroundPoint(float angle, D2D1_POINT_2F center) override;
 
     std::string Serialize() override;
+    std::shared_ptr<Shape> Clone() const override {
+        return MakeDocumentShared<Triangle>(*this);
+    }
+    size_t GetMemoryBytes() const override {
+        return sizeof(*this) + PointBytes(m_fillPixels);
+    }
 
     D2D1_POINT_2F GetCenter() const override {
         float centerX = (m_points[0].x + m_points[1].x + m_points[2].x) / 3;
@@ -589,7 +682,7 @@ public:
         return D2D1::Point2F(centerX, centerY);
     }
 
-    D2D1_RECT_F GetBounds() const override {
+    D2D1_RECT_F ComputeBounds() const override {
         float minX = m_points[0].x;
         float minY = m_points[0].y;
         float maxX = m_points[0].x;
@@ -606,14 +699,8 @@ public:
     }
 
     // дɢ߶κ
-    std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> GetIntersectionSegments() const override {
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> segments;
-
-        segments.push_back({m_points[0], m_points[1]});
-        segments.push_back({m_points[1], m_points[2]});
-        segments.push_back({m_points[2], m_points[0]});
-
-        return segments;
+    void VisitIntersectionSegments(SegmentVisitor visit, void *context) const override {
+        VisitClosedPolyline(m_points, 3, visit, context);
     }
     
     // ȡζ
@@ -644,12 +731,17 @@ public:
     D2D1_POINT_2F GetCenter() const override {
         return m_center;
     }
-    D2D1_RECT_F GetBounds() const override;
+    D2D1_RECT_F ComputeBounds() const override;
 
     std::string Serialize() override;
+    std::shared_ptr<Shape> Clone() const override {
+        return MakeDocumentShared<Diamond>(*this);
+    }
+    size_t GetMemoryBytes() const override {
+        return sizeof(*this) + PointBytes(m_fillPixels);
+    }
 
-    std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>>
-    GetIntersectionSegments() const override;
+    void VisitIntersectionSegments(SegmentVisitor visit, void *context) const override;
 
 private:
     D2D1_POINT_2F m_center;
@@ -675,6 +767,12 @@ public:
     void RotateAroundPoint(float angle, D2D1_POINT_2F center) override;
 
     std::string Serialize() override;
+    std::shared_ptr<Shape> Clone() const override {
+        return MakeDocumentShared<Parallelogram>(*this);
+    }
+    size_t GetMemoryBytes() const override {
+        return sizeof(*this) + PointBytes(m_fillPixels);
+    }
 
     D2D1_POINT_2F GetCenter() const override {
         float centerX = (m_points[0].x + m_points[1].x + m_points[2].x + m_points[3].x) / 4;
@@ -682,7 +780,7 @@ public:
         return D2D1::Point2F(centerX, centerY);
     }
 
-    D2D1_RECT_F GetBounds() const override {
+    D2D1_RECT_F ComputeBounds() const override {
         float minX = m_points[0].x;
         float minY = m_points[0].y;
         float maxX = m_points[0].x;
@@ -699,15 +797,8 @@ public:
     }
 
     // дɢ߶κ
-    std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> GetIntersectionSegments() const override {
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> segments;
-
-        segments.push_back({m_points[0], m_points[1]});
-        segments.push_back({m_points[1], m_points[2]});
-        segments.push_back({m_points[2], m_points[3]});
-        segments.push_back({m_points[3], m_points[0]});
-
-        return segments;
+    void VisitIntersectionSegments(SegmentVisitor visit, void *context) const override {
+        VisitClosedPolyline(m_points, 4, visit, context);
     }
 
 private:
@@ -723,6 +814,7 @@ public:
               ID2D1SolidColorBrush *pBrush,
               ID2D1SolidColorBrush *pSelectedBrush,
               ID2D1StrokeStyle *pDashStrokeStyle) override;
+    void DrawTo(RenderBackend &backend, const D2D1_COLOR_F &color) const override;
 
     bool HitTest(D2D1_POINT_2F point) override;
     void Move(float dx, float dy) override;
@@ -731,11 +823,24 @@ public:
     void RotateAroundPoint(float angle, D2D1_POINT_2F center) override;
 
     std::string Serialize() override;
+    std::shared_ptr<Shape> Clone() const override {
+        return MakeDocumentShared<Curve>(*this);
+    }
+    size_t GetMemoryBytes() const override {
+        return sizeof(*this) + PointBytes(m_fillPixels) + PointBytes(m_points);
+    }
 
     // ȡ㼯
-    const std::vector<D2D1_POINT_2F> &GetPoints() const {
+    const PointVector &GetPoints() const {
         return m_points;
     }
+    // ÿƵ㣨㡢Ƶ㡢յ㣩
+    void SetPoints(const std::vector<D2D1_POINT_2F> &points) {
+        if (points.size() == 4) {
+            m_points.assign(points.begin(), points.end());
+            InvalidateBounds();
+        }
+    }
 
     D2D1_POINT_2F GetCenter() const override {
         if (m_points.empty()) {
@@ -751,31 +856,13 @@ public:
         return D2D1::Point2F(sumX / m_points.size(), sumY / m_points.size());
     }
 
-    D2D1_RECT_F GetBounds() const override {
-        if (m_points.empty()) {
-            return D2D1::RectF(0, 0, 0, 0);
-        }
-
-        float minX = m_points[0].x;
-        float minY = m_points[0].y;
-        float maxX = m_points[0].x;
-        float maxY = m_points[0].y;
-
-        for (const auto &point : m_points) {
-            minX = min(minX, point.x);
-            minY = min(minY, point.y);
-            maxX = max(maxX, point.x);
-            maxY = max(maxY, point.y);
-        }
-
-       return D2D1::RectF(minX, minY, maxX, maxY);
-    }
+    D2D1_RECT_F ComputeBounds() const override;
 
     // ɢ߶κ
-    std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> GetIntersectionSegments() const override;
+    void VisitIntersectionSegments(SegmentVisitor visit, void *context) const override;
 
 private:
-    std::vector<D2D1_POINT_2F> m_points;
+    PointVector m_points;
     static const int CURVE_FLATTEN_SEGS = 32; // 32   0.4 px 
 
     // 㱴ڲtĵ
@@ -799,14 +886,21 @@ public:
     void RotateAroundPoint(float angle, D2D1_POINT_2F center) override;
 
     void AddPoint(D2D1_POINT_2F point);
-    const std::vector<D2D1_POINT_2F> &GetPoints() const {
+    const PointVector &GetPoints() const {
         return m_points;
     }
     void SetPoints(const std::vector<D2D1_POINT_2F> &points) {
-        m_points = points;
+        m_points.assign(points.begin(), points.end());
+        InvalidateBounds();
     }
 
     std::string Serialize() override;
+    std::shared_ptr<Shape> Clone() const override {
+        return MakeDocumentShared<Poly>(*this);
+    }
+    size_t GetMemoryBytes() const override {
+        return sizeof(*this) + PointBytes(m_fillPixels) + PointBytes(m_points);
+    }
 
     D2D1_POINT_2F GetCenter() const override {
         if (m_points.empty()) {
@@ -822,7 +916,7 @@ public:
         return D2D1::Point2F(sumX / m_points.size(), sumY / m_points.size());
     }
 
-    D2D1_RECT_F GetBounds() const override {
+    D2D1_RECT_F ComputeBounds() const override {
         if (m_points.empty()) {
             return D2D1::RectF(0, 0, 0, 0);
         }
@@ -843,22 +937,14 @@ public:
     }
 
     // дɢ߶κ - ֱʹߵĸ߶
-    std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> GetIntersectionSegments() const override {
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> segments;
-
-        if (m_points.size() < 2) {
-            return segments;
-        }
-
+    void VisitIntersectionSegments(SegmentVisitor visit, void *context) const override {
         for (size_t i = 1; i < m_points.size(); ++i) {
-            segments.push_back({m_points[i - 1], m_points[i]});
+            visit(context, m_points[i - 1], m_points[i]);
         }
-
-        return segments;
     }
 
 private:
-    std::vector<D2D1_POINT_2F> m_points;
+    PointVector m_points;
 };
 
 // BezierࣨBezierϣ
@@ -878,10 +964,17 @@ public:
     void RotateAroundPoint(float angle, D2D1_POINT_2F center) override;
     
     std::string Serialize() override;
+    std::shared_ptr<Shape> Clone() const override {
+        return MakeDocumentShared<MultiBezier>(*this);
+    }
+    size_t GetMemoryBytes() const override {
+        return sizeof(*this) + PointBytes(m_fillPixels) + PointBytes(m_controlPoints);
+    }
     
     // ӿƵ
     void AddControlPoint(D2D1_POINT_2F point);
-    const std::vector<D2D1_POINT_2F>& GetControlPoints() const { return m_controlPoints; }
+    const PointVector& GetControlPoints() const { return m_controlPoints; }
+    void SetControlPoints(const std::vector<D2D1_POINT_2F>& points) { m_controlPoints.assign(points.begin(), points.end()); InvalidateBounds(); }
     
     // /Ԥ㣨ʵʱԤ
     void SetPreviewPoint(D2D1_POINT_2F point) { m_previewPoint = point; m_hasPreview = true; }
@@ -896,11 +989,11 @@ public:
     int GetControlPointCount() const { return static_cast<int>(m_controlPoints.size()); }
     
     D2D1_POINT_2F GetCenter() const override;
-    D2D1_RECT_F GetBounds() const override;
-    std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> GetIntersectionSegments() const override;
+    D2D1_RECT_F ComputeBounds() const override;
+    void VisitIntersectionSegments(SegmentVisitor visit, void *context) const override;
     
 private:
-    std::vector<D2D1_POINT_2F> m_controlPoints;  // Ƶ
+    PointVector m_controlPoints;  // Ƶ
     D2D1_POINT_2F m_previewPoint;                // Ԥ㣨λã
     bool m_hasPreview = false;                   // ǷԤ
     bool m_isEditing = false;                    // Ƿڱ༭״̬
@@ -908,7 +1001,10 @@ private:
     
     // De Casteljau㷨Bezierڲtĵ
     static D2D1_POINT_2F DeCasteljau(
-        const std::vector<D2D1_POINT_2F>& controlPoints, float t);
+        const PointVector& controlPoints, float t);
+    // ͬϣֵʹõ÷ṩĻ壬ʱظ
+    static D2D1_POINT_2F DeCasteljau(
+        const PointVector& controlPoints, float t, std::vector<D2D1_POINT_2F>& scratch);
 };
 
 // 
@@ -928,14 +1024,21 @@ public:
     void RotateAroundPoint(float angle, D2D1_POINT_2F center) override;
 
     void AddPoint(D2D1_POINT_2F point);
-    const std::vector<D2D1_POINT_2F> &GetPoints() const {
+    const PointVector &GetPoints() const {
         return m_points;
     }
     void SetPoints(const std::vector<D2D1_POINT_2F> &points) {
-        m_points = points;
+        m_points.assign(points.begin(), points.end());
+        InvalidateBounds();
     }
 
     std::string Serialize() override;
+    std::shared_ptr<Shape> Clone() const override {
+        return MakeDocumentShared<Polygon>(*this);
+    }
+    size_t GetMemoryBytes() const override {
+        return sizeof(*this) + PointBytes(m_fillPixels) + PointBytes(m_points);
+    }
 
     D2D1_POINT_2F GetCenter() const override {
         if (m_points.empty()) {
@@ -951,7 +1054,7 @@ public:
         return D2D1::Point2F(sumX / m_points.size(), sumY / m_points.size());
     }
 
-    D2D1_RECT_F GetBounds() const override {
+    D2D1_RECT_F ComputeBounds() const override {
         if (m_points.empty()) {
             return D2D1::RectF(0, 0, 0, 0);
         }
@@ -972,23 +1075,16 @@ public:
     }
 
     // дɢ߶κ - εĸ
-    std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> GetIntersectionSegments() const override {
-        std::vector<std::pair<D2D1_POINT_2F, D2D1_POINT_2F>> segments;
-
-        if (m_points.size() < 2) {
-            return segments;
-        }
-
+    void VisitIntersectionSegments(SegmentVisitor visit, void *context) const override {
+        if (m_points.size() < 2) return;
         // бߣպϱ
         for (size_t i = 1; i < m_points.size(); ++i) {
-            segments.push_back({m_points[i - 1], m_points[i]});
+            visit(context, m_points[i - 1], m_points[i]);
         }
         // պ϶
         if (m_points.size() >= 3) {
-            segments.push_back({m_points.back(), m_points[0]});
+            visit(context, m_points.back(), m_points[0]);
         }
-
-        return segments;
     }
 
     // µǷᵼཻ
@@ -996,7 +1092,7 @@ public:
     bool WouldCauseIntersection(D2D1_POINT_2F newPoint, bool checkClosingEdge = false) const;
 
 private:
-    std::vector<D2D1_POINT_2F> m_points;
+    PointVector m_points;
 
     // ߶Ƿཻ
     static bool SegmentsIntersect(D2D1_POINT_2F p1, D2D1_POINT_2F p2, 
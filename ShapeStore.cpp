@@ -0,0 +1,481 @@
+#include "ShapeStore.h"
+#include "Shape.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <utility>
+
+namespace {
+    // 点到线段距离的平方
+    inline float SegmentDistanceSq(float px, float py, float ax, float ay, float bx, float by) {
+        float dx = bx - ax;
+        float dy = by - ay;
+        float lenSq = dx * dx + dy * dy;
+        float t = 0.0f;
+        if (lenSq > 0.0f) {
+            t = ((px - ax) * dx + (py - ay) * dy) / lenSq;
+            t = (std::max)(0.0f, (std::min)(1.0f, t));
+        }
+        float ex = px - (ax + t * dx);
+        float ey = py - (ay + t * dy);
+        return ex * ex + ey * ey;
+    }
+
+    // 从稠密数组中删除一个元素，后面的元素前移
+    template <typename T>
+    inline void EraseAt(std::vector<T> &v, size_t index) {
+        v.erase(v.begin() + index);
+    }
+
+    // 在稠密数组中插入一个元素，后面的元素后移（末尾插入即 push_back）
+    template <typename T, typename V>
+    inline void InsertAt(std::vector<T> &v, size_t index, V &&value) {
+        v.insert(v.begin() + index, std::forward<V>(value));
+    }
+
+    // 池内用末尾元素填补被删除的位置
+    template <typename T>
+    inline void SwapRemove(std::vector<T> &v, size_t index) {
+        v[index] = v.back();
+        v.pop_back();
+    }
+}
+
+ShapeHandle ShapeStore::Add(std::shared_ptr<Shape> shape) {
+    return Insert(m_shapes.size(), std::move(shape));
+}
+
+ShapeHandle ShapeStore::Insert(size_t index, std::shared_ptr<Shape> shape) {
+    if (index > m_shapes.size()) index = m_shapes.size();
+
+    uint32_t slot;
+    if (!m_freeSlots.empty()) {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    } else {
+        slot = static_cast<uint32_t>(m_slots.size());
+        m_slots.push_back({UINT32_MAX, 0});
+    }
+
+    InsertAt(m_shapes, index, std::move(shape));
+    InsertAt(m_slotOf, index, slot);
+    InsertAt(m_minX, index, 0.0f);
+    InsertAt(m_minY, index, 0.0f);
+    InsertAt(m_maxX, index, 0.0f);
+    InsertAt(m_maxY, index, 0.0f);
+    InsertAt(m_type, index, static_cast<uint8_t>(0));
+    InsertAt(m_lineWidth, index, static_cast<uint8_t>(1));
+    InsertAt(m_lineStyle, index, static_cast<uint8_t>(0));
+    InsertAt(m_kind, index, GeometryKind::SPAN);
+    InsertAt(m_geometry, index, UINT32_MAX);
+    MarkBoundsDirty(index, npos);
+
+    RebuildSlots(index);
+    Extract(index);
+    return {slot, m_slots[slot].generation};
+}
+
+void ShapeStore::RemoveAt(size_t index) {
+    if (index >= m_shapes.size()) return;
+
+    ReleaseGeometry(index);
+
+    Slot &slot = m_slots[m_slotOf[index]];
+    slot.index = UINT32_MAX;
+    ++slot.generation;
+    m_freeSlots.push_back(m_slotOf[index]);
+
+    EraseAt(m_shapes, index);
+    EraseAt(m_slotOf, index);
+    EraseAt(m_minX, index);
+    EraseAt(m_minY, index);
+    EraseAt(m_maxX, index);
+    EraseAt(m_maxY, index);
+    EraseAt(m_type, index);
+    EraseAt(m_lineWidth, index);
+    EraseAt(m_lineStyle, index);
+    EraseAt(m_kind, index);
+    EraseAt(m_geometry, index);
+    MarkBoundsDirty(index, npos);
+
+    RebuildSlots(index);
+}
+
+bool ShapeStore::Remove(ShapeHandle handle) {
+    size_t index = IndexOf(handle);
+    if (index == npos) return false;
+    RemoveAt(index);
+    return true;
+}
+
+void ShapeStore::Clear() {
+    // 清空时槽位代数全部加一，旧句柄随之失效
+    for (uint32_t slot : m_slotOf) {
+        m_slots[slot].index = UINT32_MAX;
+        ++m_slots[slot].generation;
+        m_freeSlots.push_back(slot);
+    }
+
+    m_shapes.clear();
+    m_slotOf.clear();
+    m_minX.clear();
+    m_minY.clear();
+    m_maxX.clear();
+    m_maxY.clear();
+    m_type.clear();
+    m_lineWidth.clear();
+    m_lineStyle.clear();
+    m_kind.clear();
+    m_geometry.clear();
+    MarkBoundsDirty(0, npos);
+
+    m_lines = LinePool();
+    m_circles = CirclePool();
+    m_spans = SpanPool();
+}
+
+void ShapeStore::Assign(std::vector<std::shared_ptr<Shape>> shapes) {
+    Clear();
+
+    size_t count = shapes.size();
+    m_shapes.reserve(count);
+    m_slotOf.reserve(count);
+    m_minX.reserve(count);
+    m_minY.reserve(count);
+    m_maxX.reserve(count);
+    m_maxY.reserve(count);
+    m_type.reserve(count);
+    m_lineWidth.reserve(count);
+    m_lineStyle.reserve(count);
+    m_kind.reserve(count);
+    m_geometry.reserve(count);
+
+    for (auto &shape : shapes) {
+        Add(std::move(shape));
+    }
+}
+
+std::vector<std::shared_ptr<Shape>> ShapeStore::Release() {
+    std::vector<std::shared_ptr<Shape>> shapes = std::move(m_shapes);
+    Clear();
+    return shapes;
+}
+
+ShapeHandle ShapeStore::HandleAt(size_t index) const {
+    if (index >= m_shapes.size()) return ShapeHandle();
+    uint32_t slot = m_slotOf[index];
+    return {slot, m_slots[slot].generation};
+}
+
+size_t ShapeStore::IndexOf(ShapeHandle handle) const {
+    if (handle.slot >= m_slots.size()) return npos;
+    const Slot &slot = m_slots[handle.slot];
+    if (slot.generation != handle.generation || slot.index == UINT32_MAX) return npos;
+    return slot.index;
+}
+
+size_t ShapeStore::IndexOf(const Shape *shape) const {
+    for (size_t i = 0; i < m_shapes.size(); ++i) {
+        if (m_shapes[i].get() == shape) return i;
+    }
+    return npos;
+}
+
+Shape *ShapeStore::Get(ShapeHandle handle) const {
+    size_t index = IndexOf(handle);
+    return index == npos ? nullptr : m_shapes[index].get();
+}
+
+void ShapeStore::Replace(size_t index, std::shared_ptr<Shape> shape) {
+    if (index >= m_shapes.size()) return;
+    m_shapes[index] = std::move(shape);
+    Extract(index);
+}
+
+void ShapeStore::Sync(size_t index) {
+    if (index >= m_shapes.size()) return;
+    Extract(index);
+}
+
+void ShapeStore::SyncAll() {
+    for (size_t i = 0; i < m_shapes.size(); ++i) {
+        Extract(i);
+    }
+}
+
+void ShapeStore::Translate(size_t index, float dx, float dy) {
+    if (index >= m_shapes.size()) return;
+
+    m_minX[index] += dx;
+    m_maxX[index] += dx;
+    m_minY[index] += dy;
+    m_maxY[index] += dy;
+    MarkBoundsDirty(index, index + 1);
+
+    uint32_t g = m_geometry[index];
+    switch (m_kind[index]) {
+    case GeometryKind::LINE:
+        m_lines.x0[g] += dx;
+        m_lines.y0[g] += dy;
+        m_lines.x1[g] += dx;
+        m_lines.y1[g] += dy;
+        break;
+    case GeometryKind::CIRCLE:
+        m_circles.cx[g] += dx;
+        m_circles.cy[g] += dy;
+        break;
+    case GeometryKind::SPAN: {
+        D2D1_POINT_2F *p = m_spans.points.data() + m_spans.offset[g];
+        for (uint32_t i = 0, n = m_spans.count[g]; i < n; ++i) {
+            p[i].x += dx;
+            p[i].y += dy;
+        }
+        break;
+    }
+    }
+}
+
+void ShapeStore::SetBounds(size_t index, const D2D1_RECT_F &bounds) {
+    if (index >= m_shapes.size()) return;
+    m_minX[index] = bounds.left;
+    m_minY[index] = bounds.top;
+    m_maxX[index] = bounds.right;
+    m_maxY[index] = bounds.bottom;
+    MarkBoundsDirty(index, index + 1);
+}
+
+std::shared_ptr<const ShapeBoundsSnapshot> ShapeStore::BoundsSnapshot() {
+    if (m_boundsSnapshot && m_boundsDirtyBegin >= m_boundsDirtyEnd) {
+        return m_boundsSnapshot;
+    }
+
+    const size_t CHUNK_SIZE = ShapeBoundsSnapshot::CHUNK_SIZE;
+    std::shared_ptr<ShapeBoundsSnapshot> snapshot = std::make_shared<ShapeBoundsSnapshot>();
+    size_t count = m_shapes.size();
+    snapshot->m_size = count;
+    snapshot->m_chunks.reserve((count + CHUNK_SIZE - 1) / CHUNK_SIZE);
+    for (size_t begin = 0; begin < count; begin += CHUNK_SIZE) {
+        size_t end = (std::min)(count, begin + CHUNK_SIZE);
+        size_t c = begin / CHUNK_SIZE;
+        // 与改动范围不相交、大小也相同的块沿用上一副本
+        if (m_boundsSnapshot && c < m_boundsSnapshot->m_chunks.size() &&
+            (end <= m_boundsDirtyBegin || begin >= m_boundsDirtyEnd) &&
+            m_boundsSnapshot->m_chunks[c]->Size() == end - begin) {
+            snapshot->m_chunks.push_back(m_boundsSnapshot->m_chunks[c]);
+            continue;
+        }
+        std::shared_ptr<ShapeBoundsSnapshot::Chunk> chunk = std::make_shared<ShapeBoundsSnapshot::Chunk>();
+        chunk->minX.assign(m_minX.begin() + begin, m_minX.begin() + end);
+        chunk->minY.assign(m_minY.begin() + begin, m_minY.begin() + end);
+        chunk->maxX.assign(m_maxX.begin() + begin, m_maxX.begin() + end);
+        chunk->maxY.assign(m_maxY.begin() + begin, m_maxY.begin() + end);
+        chunk->lineWidth.assign(m_lineWidth.begin() + begin, m_lineWidth.begin() + end);
+        snapshot->m_chunks.push_back(std::move(chunk));
+    }
+
+    m_boundsSnapshot = std::move(snapshot);
+    m_boundsDirtyBegin = m_boundsDirtyEnd = 0;
+    return m_boundsSnapshot;
+}
+
+void ShapeStore::MarkBoundsDirty(size_t begin, size_t end) {
+    if (m_boundsDirtyBegin >= m_boundsDirtyEnd) {
+        m_boundsDirtyBegin = begin;
+        m_boundsDirtyEnd = end;
+    } else {
+        m_boundsDirtyBegin = (std::min)(m_boundsDirtyBegin, begin);
+        m_boundsDirtyEnd = (std::max)(m_boundsDirtyEnd, end);
+    }
+}
+
+void ShapeStore::QueryRect(const D2D1_RECT_F &rect, float margin, std::vector<uint32_t> &out) const {
+    out.clear();
+    const float *minX = m_minX.data();
+    const float *minY = m_minY.data();
+    const float *maxX = m_maxX.data();
+    const float *maxY = m_maxY.data();
+    const uint8_t *width = m_lineWidth.data();
+
+    for (size_t i = 0, n = m_shapes.size(); i < n; ++i) {
+        float pad = margin + width[i] * 0.5f;
+        if (maxX[i] + pad < rect.left || minX[i] - pad > rect.right ||
+            maxY[i] + pad < rect.top || minY[i] - pad > rect.bottom)
+            continue;
+        out.push_back(static_cast<uint32_t>(i));
+    }
+}
+
+size_t ShapeStore::NextPointCandidate(D2D1_POINT_2F point, float tolerance, size_t before) const {
+    const float px = point.x;
+    const float py = point.y;
+    const float tolSq = tolerance * tolerance;
+
+    for (size_t i = (std::min)(before, m_shapes.size()); i-- > 0;) {
+        // 包围盒粗筛
+        if (px < m_minX[i] - tolerance || px > m_maxX[i] + tolerance ||
+            py < m_minY[i] - tolerance || py > m_maxY[i] + tolerance)
+            continue;
+
+        // 几何池细筛
+        uint32_t g = m_geometry[i];
+        bool hit = false;
+        switch (m_kind[i]) {
+        case GeometryKind::LINE:
+            hit = SegmentDistanceSq(px, py, m_lines.x0[g], m_lines.y0[g],
+                                    m_lines.x1[g], m_lines.y1[g]) <= tolSq;
+            break;
+        case GeometryKind::CIRCLE: {
+            float dx = px - m_circles.cx[g];
+            float dy = py - m_circles.cy[g];
+            float d = sqrtf(dx * dx + dy * dy);
+            hit = fabsf(d - m_circles.radius[g]) <= tolerance;
+            break;
+        }
+        case GeometryKind::SPAN: {
+            // 点序列两两一组构成离散线段
+            const D2D1_POINT_2F *p = m_spans.points.data() + m_spans.offset[g];
+            for (uint32_t k = 0, n = m_spans.count[g]; k + 1 < n && !hit; k += 2) {
+                hit = SegmentDistanceSq(px, py, p[k].x, p[k].y, p[k + 1].x, p[k + 1].y) <= tolSq;
+            }
+            break;
+        }
+        }
+        if (hit) return i;
+    }
+    return npos;
+}
+
+D2D1_RECT_F ShapeStore::TotalBounds() const {
+    if (m_shapes.empty()) return D2D1::RectF(0, 0, 0, 0);
+
+    float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+    for (size_t i = 0, n = m_shapes.size(); i < n; ++i) {
+        minX = (std::min)(minX, m_minX[i]);
+        minY = (std::min)(minY, m_minY[i]);
+        maxX = (std::max)(maxX, m_maxX[i]);
+        maxY = (std::max)(maxY, m_maxY[i]);
+    }
+    return D2D1::RectF(minX, minY, maxX, maxY);
+}
+
+void ShapeStore::Extract(size_t index) {
+    const Shape &shape = *m_shapes[index];
+
+    D2D1_RECT_F bounds = shape.GetBounds();
+    m_minX[index] = (std::min)(bounds.left, bounds.right);
+    m_minY[index] = (std::min)(bounds.top, bounds.bottom);
+    m_maxX[index] = (std::max)(bounds.left, bounds.right);
+    m_maxY[index] = (std::max)(bounds.top, bounds.bottom);
+    m_type[index] = static_cast<uint8_t>(shape.GetType());
+    m_lineWidth[index] = static_cast<uint8_t>(shape.GetLineWidthValue());
+    m_lineStyle[index] = static_cast<uint8_t>(shape.GetLineStyle());
+    MarkBoundsDirty(index, index + 1);
+
+    // 重新提取几何前先释放旧的池条目（点序列长度可能变化，替换图形时种类也可能变化）
+    ReleaseGeometry(index);
+
+    uint32_t slot = m_slotOf[index];
+    D2D1_POINT_2F center;
+    float radius;
+    if (shape.GetCircleGeometry(center, radius)) {
+        m_kind[index] = GeometryKind::CIRCLE;
+        m_geometry[index] = static_cast<uint32_t>(m_circles.owner.size());
+        m_circles.cx.push_back(center.x);
+        m_circles.cy.push_back(center.y);
+        m_circles.radius.push_back(radius);
+        m_circles.owner.push_back(slot);
+        return;
+    }
+
+    if (shape.GetType() == ShapeType::LINE) {
+        // 直线只有一条离散线段
+        size_t count = 0;
+        D2D1_POINT_2F start = {}, end = {};
+        shape.ForEachIntersectionSegment([&](D2D1_POINT_2F a, D2D1_POINT_2F b) {
+            if (count++ == 0) {
+                start = a;
+                end = b;
+            }
+        });
+        if (count == 1) {
+            m_kind[index] = GeometryKind::LINE;
+            m_geometry[index] = static_cast<uint32_t>(m_lines.owner.size());
+            m_lines.x0.push_back(start.x);
+            m_lines.y0.push_back(start.y);
+            m_lines.x1.push_back(end.x);
+            m_lines.y1.push_back(end.y);
+            m_lines.owner.push_back(slot);
+            return;
+        }
+    }
+
+    m_kind[index] = GeometryKind::SPAN;
+    m_geometry[index] = static_cast<uint32_t>(m_spans.owner.size());
+    size_t first = m_spans.points.size();
+    shape.ForEachIntersectionSegment([&](D2D1_POINT_2F a, D2D1_POINT_2F b) {
+        m_spans.points.push_back(a);
+        m_spans.points.push_back(b);
+    });
+    m_spans.offset.push_back(static_cast<uint32_t>(first));
+    m_spans.count.push_back(static_cast<uint32_t>(m_spans.points.size() - first));
+    m_spans.owner.push_back(slot);
+}
+
+void ShapeStore::ReleaseGeometry(size_t index) {
+    uint32_t g = m_geometry[index];
+    if (g == UINT32_MAX) return;
+    m_geometry[index] = UINT32_MAX;
+
+    // 池内用末尾条目填补空位，并修正被搬动条目所属图形的池下标
+    uint32_t movedOwner = UINT32_MAX;
+    switch (m_kind[index]) {
+    case GeometryKind::LINE:
+        SwapRemove(m_lines.x0, g);
+        SwapRemove(m_lines.y0, g);
+        SwapRemove(m_lines.x1, g);
+        SwapRemove(m_lines.y1, g);
+        SwapRemove(m_lines.owner, g);
+        if (g < m_lines.owner.size()) movedOwner = m_lines.owner[g];
+        break;
+    case GeometryKind::CIRCLE:
+        SwapRemove(m_circles.cx, g);
+        SwapRemove(m_circles.cy, g);
+        SwapRemove(m_circles.radius, g);
+        SwapRemove(m_circles.owner, g);
+        if (g < m_circles.owner.size()) movedOwner = m_circles.owner[g];
+        break;
+    case GeometryKind::SPAN:
+        m_spans.garbage += m_spans.count[g];
+        SwapRemove(m_spans.offset, g);
+        SwapRemove(m_spans.count, g);
+        SwapRemove(m_spans.owner, g);
+        if (g < m_spans.owner.size()) movedOwner = m_spans.owner[g];
+        break;
+    }
+    if (movedOwner != UINT32_MAX) {
+        m_geometry[m_slots[movedOwner].index] = g;
+    }
+
+    if (m_spans.garbage > 1024 && m_spans.garbage * 2 > m_spans.points.size()) {
+        CompactSpans();
+    }
+}
+
+void ShapeStore::CompactSpans() {
+    // 按现有条目顺序重新紧凑排列点序列
+    std::vector<D2D1_POINT_2F> points;
+    points.reserve(m_spans.points.size() - m_spans.garbage);
+    for (size_t g = 0; g < m_spans.offset.size(); ++g) {
+        const D2D1_POINT_2F *p = m_spans.points.data() + m_spans.offset[g];
+        m_spans.offset[g] = static_cast<uint32_t>(points.size());
+        points.insert(points.end(), p, p + m_spans.count[g]);
+    }
+    m_spans.points.swap(points);
+    m_spans.garbage = 0;
+}
+
+void ShapeStore::RebuildSlots(size_t from) {
+    for (size_t i = from; i < m_shapes.size(); ++i) {
+        m_slots[m_slotOf[i]].index = static_cast<uint32_t>(i);
+    }
+}
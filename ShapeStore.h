@@ -0,0 +1,175 @@
+#pragma once
+#include <d2d1.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class Shape;
+
+// 图形句柄：槽位 + 代数。图形删除后旧句柄失效，槽位复用时代数加一
+struct ShapeHandle {
+    uint32_t slot = UINT32_MAX;
+    uint32_t generation = 0;
+
+    bool IsValid() const {
+        return slot != UINT32_MAX;
+    }
+};
+
+// 图形库中包围盒和线宽的只读副本，随帧交给绘制线程做剔除和细节层次判断，不访问图形对象。
+// 按固定大小分块写时复制：图形库生成新副本时，自上一副本以来没有改动的块直接共享，
+// 拖动一个图形或追加图形时只复制所在的块，与文档大小无关
+class ShapeBoundsSnapshot {
+public:
+    static const size_t CHUNK_SIZE = 4096; // 每块的图形数（最后一块可能不满）
+
+    struct Chunk {
+        std::vector<float> minX, minY, maxX, maxY;
+        std::vector<uint8_t> lineWidth;
+
+        size_t Size() const {
+            return minX.size();
+        }
+    };
+
+    size_t Size() const {
+        return m_size;
+    }
+    size_t ChunkCount() const {
+        return m_chunks.size();
+    }
+    // 第 c 块为图形 [c * CHUNK_SIZE, c * CHUNK_SIZE + Size())
+    const Chunk &ChunkAt(size_t c) const {
+        return *m_chunks[c];
+    }
+
+private:
+    friend class ShapeStore;
+
+    std::vector<std::shared_ptr<const Chunk>> m_chunks;
+    size_t m_size = 0;
+};
+
+// 面向数据的图形库
+// 图形对象本身仍由 shared_ptr 持有，对外保持原有 Shape 接口；同时把遍历时常用的热数据
+// （包围盒、线宽/线型/类型字节）按结构数组连续存放，并按几何种类分池保存位置、半径和点序列。
+// 包围盒查询、视口剔除、点选粗筛和平移都是对这些数组的紧凑循环，不再逐个访问堆上的图形对象。
+// 图形在库外被修改后需调用 Sync 重新提取热数据。
+class ShapeStore {
+public:
+    static const size_t npos = static_cast<size_t>(-1);
+
+    // 绘制顺序的图形列表
+    const std::vector<std::shared_ptr<Shape>> &Shapes() const {
+        return m_shapes;
+    }
+    size_t Size() const {
+        return m_shapes.size();
+    }
+
+    ShapeHandle Add(std::shared_ptr<Shape> shape);
+    // 插入到绘制顺序中的 index 处，后面图形的下标加一（句柄不变）
+    ShapeHandle Insert(size_t index, std::shared_ptr<Shape> shape);
+    void RemoveAt(size_t index);
+    bool Remove(ShapeHandle handle);
+    void Clear();
+    // 整体替换图形列表（批量编辑后使用），全部重新提取
+    void Assign(std::vector<std::shared_ptr<Shape>> shapes);
+    // 取出图形列表交给批量编辑，编辑完成后用 Assign 放回
+    std::vector<std::shared_ptr<Shape>> Release();
+
+    ShapeHandle HandleAt(size_t index) const;
+    size_t IndexOf(ShapeHandle handle) const;
+    size_t IndexOf(const Shape *shape) const;
+    Shape *Get(ShapeHandle handle) const;
+
+    // 用另一个图形对象替换下标处的图形（写时复制、撤销恢复），句柄不变
+    void Replace(size_t index, std::shared_ptr<Shape> shape);
+
+    // 图形的几何或样式在库外被修改后，重新提取它的热数据
+    void Sync(size_t index);
+    void SyncAll();
+
+    // 图形已经平移 (dx, dy) 后调用：包围盒和几何池直接加偏移，不再访问图形对象
+    void Translate(size_t index, float dx, float dy);
+
+    // 图形带有尚未写回几何的变换时，由调用方给出变换后的包围盒（几何池不变，提交后再 Sync）
+    void SetBounds(size_t index, const D2D1_RECT_F &bounds);
+
+    // 当前包围盒和线宽的只读副本；自上次调用以来没有改动时返回同一个副本，否则只重新复制改动过的块
+    std::shared_ptr<const ShapeBoundsSnapshot> BoundsSnapshot();
+
+    // 热数据访问
+    D2D1_RECT_F BoundsAt(size_t index) const {
+        return D2D1::RectF(m_minX[index], m_minY[index], m_maxX[index], m_maxY[index]);
+    }
+    int LineWidthAt(size_t index) const {
+        return m_lineWidth[index];
+    }
+
+    // 包围盒（各向扩展 margin 和半个线宽）与矩形相交的图形，按绘制顺序输出下标
+    void QueryRect(const D2D1_RECT_F &rect, float margin, std::vector<uint32_t> &out) const;
+    // 从下标 before 往下（逆绘制顺序）找下一个与点的距离可能不超过 tolerance 的图形，没有时返回 npos；
+    // 先比较包围盒，再用几何池中的线段、圆或点序列求距离，候选是精确点击测试的超集。
+    // 从 Size() 开始逐个取候选做精确测试，找到最上层的图形即可停止
+    size_t NextPointCandidate(D2D1_POINT_2F point, float tolerance, size_t before) const;
+    // 所有图形的包围盒，没有图形时返回空矩形
+    D2D1_RECT_F TotalBounds() const;
+
+private:
+    // 几何种类，决定热数据放在哪个池中
+    enum class GeometryKind : uint8_t {
+        LINE,   // 直线类：两个端点
+        CIRCLE, // 圆类：圆心和半径
+        SPAN    // 其余图形：离散线段串成的点序列
+    };
+
+    struct Slot {
+        uint32_t index;      // 在稠密数组中的下标，空闲时为 UINT32_MAX
+        uint32_t generation;
+    };
+
+    // 稠密数组（绘制顺序），下标一致
+    std::vector<std::shared_ptr<Shape>> m_shapes;
+    std::vector<uint32_t> m_slotOf;
+    std::vector<float> m_minX, m_minY, m_maxX, m_maxY;
+    std::vector<uint8_t> m_type, m_lineWidth, m_lineStyle;
+    std::vector<GeometryKind> m_kind;
+    std::vector<uint32_t> m_geometry; // 在对应几何池中的下标
+
+    std::vector<Slot> m_slots;
+    std::vector<uint32_t> m_freeSlots;
+
+    // 上次生成的包围盒副本，以及此后包围盒或线宽改动过的下标范围 [m_boundsDirtyBegin, m_boundsDirtyEnd)
+    std::shared_ptr<const ShapeBoundsSnapshot> m_boundsSnapshot;
+    size_t m_boundsDirtyBegin = 0;
+    size_t m_boundsDirtyEnd = 0;
+
+    // 直线池
+    struct LinePool {
+        std::vector<float> x0, y0, x1, y1;
+        std::vector<uint32_t> owner; // 所属图形的槽位
+    } m_lines;
+
+    // 圆池
+    struct CirclePool {
+        std::vector<float> cx, cy, radius;
+        std::vector<uint32_t> owner;
+    } m_circles;
+
+    // 点序列池：所有点连续存放，每个图形占 [offset, offset + count)
+    struct SpanPool {
+        std::vector<uint32_t> offset, count;
+        std::vector<uint32_t> owner;
+        std::vector<D2D1_POINT_2F> points;
+        size_t garbage = 0; // 已废弃的点数，超过一半时压缩
+    } m_spans;
+
+    void Extract(size_t index);
+    // 记下包围盒数组中 [begin, end) 已改动；插入、删除使后面的图形整体移动，end 取 npos
+    void MarkBoundsDirty(size_t begin, size_t end);
+    void ReleaseGeometry(size_t index);
+    void CompactSpans();
+    void RebuildSlots(size_t from);
+};
@@ -0,0 +1,841 @@
+#include "SoftwareRasterizer.h"
+#include "RasterBatch.h"
+#include "DashPattern.h"
+#include <algorithm>
+#include <cmath>
+#include <climits>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define RASTER_USE_SSE2 1
+#endif
+
+// 每条边每行都要调用的小函数，编译器按调用次数估计常认为不值得内联，这里强制内联
+#if defined(_MSC_VER)
+#define RASTER_FORCE_INLINE __forceinline
+#elif defined(__GNUC__)
+#define RASTER_FORCE_INLINE inline __attribute__((always_inline))
+#else
+#define RASTER_FORCE_INLINE inline
+#endif
+
+namespace {
+    const float PI = 3.14159265358979323846f;
+    const float FLATTEN_TOLERANCE = 0.25f; // 曲线展平的最大弦高误差（像素）
+
+    inline float Clamp01(float v) {
+        return v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v);
+    }
+
+    inline uint32_t ToByte(float v) {
+        return static_cast<uint32_t>(Clamp01(v) * 255.0f + 0.5f);
+    }
+
+    // 不透明的源颜色（A=255），混合时按权重在源和目标之间插值，等价于预乘Alpha的 source-over
+    inline uint32_t PackOpaque(const D2D1_COLOR_F &c) {
+        return ToByte(c.r) | (ToByte(c.g) << 8) | (ToByte(c.b) << 16) | 0xFF000000u;
+    }
+
+    // 单像素混合：每个通道 (src * w + dst * (256 - w)) >> 8，w 取值 [0, 256]
+    // 与SSE2路径使用完全相同的整数运算，保证结果逐位一致
+    inline uint32_t BlendPixel(uint32_t dst, uint32_t src, uint32_t w) {
+        uint32_t iw = 256 - w;
+        uint32_t rb = (((src & 0x00FF00FFu) * w + (dst & 0x00FF00FFu) * iw) >> 8) & 0x00FF00FFu;
+        uint32_t ga = (((src >> 8) & 0x00FF00FFu) * w + ((dst >> 8) & 0x00FF00FFu) * iw) & 0xFF00FF00u;
+        return rb | ga;
+    }
+
+#ifdef RASTER_USE_SSE2
+    // 按4个连续的权重混合4个像素，srcLo 为源颜色低两个像素展开成的16位通道
+    inline void BlendQuad(uint32_t *dst, const uint16_t *weights, __m128i src4, __m128i srcLo) {
+        uint64_t quad;
+        memcpy(&quad, weights, sizeof(quad));
+        if (quad == 0) return; // 4个像素都未覆盖
+        if (quad == 0x0100010001000100ull) { // 4个像素完全覆盖
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), src4);
+            return;
+        }
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i full = _mm_set1_epi16(256);
+        __m128i w4 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(weights));
+        __m128i w2 = _mm_unpacklo_epi16(w4, w4);      // w0 w0 w1 w1 w2 w2 w3 w3
+        __m128i wLo = _mm_unpacklo_epi32(w2, w2);     // w0 x4, w1 x4
+        __m128i wHi = _mm_unpackhi_epi32(w2, w2);     // w2 x4, w3 x4
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst));
+        __m128i dLo = _mm_unpacklo_epi8(d, zero);
+        __m128i dHi = _mm_unpackhi_epi8(d, zero);
+        __m128i rLo = _mm_add_epi16(_mm_mullo_epi16(srcLo, wLo),
+                                    _mm_mullo_epi16(dLo, _mm_sub_epi16(full, wLo)));
+        __m128i rHi = _mm_add_epi16(_mm_mullo_epi16(srcLo, wHi),
+                                    _mm_mullo_epi16(dHi, _mm_sub_epi16(full, wHi)));
+        rLo = _mm_srli_epi16(rLo, 8);
+        rHi = _mm_srli_epi16(rHi, 8);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), _mm_packus_epi16(rLo, rHi));
+    }
+#endif
+
+    // 按权重数组混合一段连续像素
+    void BlendSpan(uint32_t *dst, const uint16_t *weights, int count, uint32_t src) {
+        int i = 0;
+#ifdef RASTER_USE_SSE2
+        const __m128i src4 = _mm_set1_epi32(static_cast<int>(src));
+        const __m128i srcLo = _mm_unpacklo_epi8(src4, _mm_setzero_si128());
+        for (; i + 4 <= count; i += 4) {
+            BlendQuad(dst + i, weights + i, src4, srcLo);
+        }
+#endif
+        for (; i < count; ++i) {
+            uint32_t w = weights[i];
+            if (w == 0) continue;
+            dst[i] = (w == 256) ? src : BlendPixel(dst[i], src, w);
+        }
+    }
+
+    // 返回 [x, end) 中第一个非零单元的位置
+    inline int SkipZeroCells(const float *row, int x, int end) {
+#ifdef RASTER_USE_SSE2
+        const __m128 zero = _mm_setzero_ps();
+        while (x + 4 <= end) {
+            __m128 v = _mm_loadu_ps(row + x);
+            int mask = _mm_movemask_ps(_mm_cmpneq_ps(v, zero));
+            if (mask != 0) {
+                while ((mask & 1) == 0) {
+                    mask >>= 1;
+                    ++x;
+                }
+                return x;
+            }
+            x += 4;
+        }
+#endif
+        while (x < end && row[x] == 0.0f) ++x;
+        return x;
+    }
+
+    // 按弦高误差计算圆/椭圆展平所需的段数
+    int SegmentsForRadius(float radius) {
+        if (radius <= FLATTEN_TOLERANCE) return 8;
+        float step = acosf(1.0f - FLATTEN_TOLERANCE / radius);
+        int n = static_cast<int>(ceilf(PI / step));
+        return (std::max)(8, (std::min)(n, 4096));
+    }
+
+    // 非负数的取整（截断即向下取整），避免 floorf/ceilf 在热路径上的库函数调用
+    inline int FloorPositive(float v) {
+        return static_cast<int>(v);
+    }
+    inline int CeilPositive(float v) {
+        int i = static_cast<int>(v);
+        return static_cast<float>(i) < v ? i + 1 : i;
+    }
+
+    // 跨越多个单元的一段：首尾单元按三角形面积分配，中间的单元每个分得 ds。
+    // 较少走到这里，不与上面的热路径内联在一起，避免逐行调用时保存大量寄存器
+    void AccumulateWideSpan(float *row, int x0i, int x1i, float xl, float xr, float d, float ds) {
+        float x0f = xl - static_cast<float>(x0i);
+        float a0 = 0.5f * ds * (1.0f - x0f) * (1.0f - x0f);
+        float x1f = xr - static_cast<float>(x1i) + 1.0f;
+        float am = 0.5f * ds * x1f * x1f;
+        row[x0i] += a0;
+        if (x1i == x0i + 2) {
+            row[x0i + 1] += d - a0 - am;
+        } else {
+            float a1 = ds * (1.5f - x0f);
+            row[x0i + 1] += a1 - a0;
+            for (int xi = x0i + 2; xi < x1i - 1; ++xi) {
+                row[xi] += ds;
+            }
+            float a2 = a1 + (x1i - x0i - 3) * ds;
+            row[x1i - 1] += d - a2 - am;
+        }
+        row[x1i] += am;
+    }
+
+    // 把一段行内的边（x 已是相对累积区域的坐标并且位于 [0, 宽度] 内，xl/xr 为其中较小/较大者）
+    // 累加到该行的单元中。d 为该段在本行内的有向高度，ds 为 d 除以该段的水平跨度，单元值的前缀和即为像素覆盖率
+    RASTER_FORCE_INLINE void AccumulateRowSpan(float *row, float xl, float xr, float xa, float xb, float d, float ds) {
+        int x0i = FloorPositive(xl);
+        float x0floor = static_cast<float>(x0i);
+        int x1i = CeilPositive(xr);
+
+#ifdef RASTER_USE_SSE2
+        // 描边的边大多在一行内只跨越1~3个单元：直接由面积公式同时求出4个像素的覆盖率再差分成单元值，
+        // 不按跨越的单元数分支。像素 i 在边右侧的面积为 ds * (G(i+1-xl) - G(i+1-xr))，
+        // G(u) = min(u,1)^2/2 + max(u-1,0)，u 先钳制到非负。近乎竖直的边跨度太小，相减误差大，仍走下面的公式
+        if (x1i <= x0i + 3 && xr - xl >= 1.0f / 256.0f) {
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 one = _mm_set1_ps(1.0f);
+            const __m128 half = _mm_set1_ps(0.5f);
+            __m128 right = _mm_add_ps(_mm_set1_ps(x0floor + 1.0f), _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f));
+            __m128 u1 = _mm_max_ps(_mm_sub_ps(right, _mm_set1_ps(xl)), zero);
+            __m128 u2 = _mm_max_ps(_mm_sub_ps(right, _mm_set1_ps(xr)), zero);
+            __m128 m1 = _mm_min_ps(u1, one);
+            __m128 m2 = _mm_min_ps(u2, one);
+            __m128 g1 = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(m1, m1), half), _mm_sub_ps(u1, m1));
+            __m128 g2 = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(m2, m2), half), _mm_sub_ps(u2, m2));
+            __m128 coverage = _mm_mul_ps(_mm_set1_ps(ds), _mm_sub_ps(g1, g2));
+            // 左边界不小于 xr 的像素完全在边右侧，取精确的 d，使其后的单元增量恰好为零
+            __m128 full = _mm_cmpge_ps(_mm_sub_ps(right, one), _mm_set1_ps(xr));
+            coverage = _mm_or_ps(_mm_and_ps(full, _mm_set1_ps(d)), _mm_andnot_ps(full, coverage));
+            __m128 cells = _mm_sub_ps(coverage, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(coverage), 4)));
+            _mm_storeu_ps(row + x0i, _mm_add_ps(_mm_loadu_ps(row + x0i), cells));
+            return;
+        }
+#endif
+
+        if (x1i <= x0i + 1) {
+            // 边在本行内只跨越一个像素
+            float xmf = 0.5f * (xa + xb) - x0floor;
+            row[x0i] += d - d * xmf;
+            row[x0i + 1] += d * xmf;
+            return;
+        }
+
+        AccumulateWideSpan(row, x0i, x1i, xl, xr, d, ds);
+    }
+
+    // 超出累积区域的部分在边界处分段并钳制到边界上：
+    // 左侧的部分仍然贡献覆盖率，右侧的部分落在不读取的额外单元中
+    void AccumulateClippedRowSpan(float *row, float xa, float xb, float width, float d, float ds) {
+        float ts[4] = {0.0f, 1.0f, 1.0f, 1.0f};
+        int n = 1;
+        if ((xa < 0.0f) != (xb < 0.0f)) ts[n++] = (0.0f - xa) / (xb - xa);
+        if ((xa > width) != (xb > width)) ts[n++] = (width - xa) / (xb - xa);
+        ts[n++] = 1.0f;
+        if (n == 4 && ts[1] > ts[2]) std::swap(ts[1], ts[2]);
+        for (int i = 0; i + 1 < n; ++i) {
+            float t0 = ts[i];
+            float t1 = ts[i + 1];
+            if (t1 <= t0) continue;
+            float xs = (std::max)(0.0f, (std::min)(width, xa + (xb - xa) * t0));
+            float xe = (std::max)(0.0f, (std::min)(width, xa + (xb - xa) * t1));
+            // 钳制后的分段水平跨度不变或为零，每单元的高度仍是 ds
+            AccumulateRowSpan(row, (std::min)(xs, xe), (std::max)(xs, xe), xs, xe, d * (t1 - t0), ds);
+        }
+    }
+
+    inline D2D1_POINT_2F Lerp(D2D1_POINT_2F a, D2D1_POINT_2F b, float t) {
+        return D2D1::Point2F(a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t);
+    }
+}
+
+SoftwareRasterizer::SoftwareRasterizer(RasterSurface &surface) :
+    m_surface(surface), m_clipLeft(0), m_clipTop(0), m_clipRight(surface.width), m_clipBottom(surface.height),
+    m_pathX0(0), m_pathY0(0), m_pathX1(0), m_pathY1(0), m_pathStride(0), m_pathEmpty(true) {
+}
+
+void SoftwareRasterizer::SetClipRect(int left, int top, int right, int bottom) {
+    m_clipLeft = (std::max)(0, left);
+    m_clipTop = (std::max)(0, top);
+    m_clipRight = (std::min)(m_surface.width, right);
+    m_clipBottom = (std::min)(m_surface.height, bottom);
+}
+
+void SoftwareRasterizer::Clear(const D2D1_COLOR_F &color) {
+    if (m_clipLeft >= m_clipRight) return;
+
+    // 缓冲中保存预乘Alpha颜色
+    float a = Clamp01(color.a);
+    uint32_t value = ToByte(color.r * a) | (ToByte(color.g * a) << 8) | (ToByte(color.b * a) << 16) | (ToByte(a) << 24);
+    for (int y = m_clipTop; y < m_clipBottom; ++y) {
+        uint32_t *row = m_surface.Row(y);
+        std::fill(row + m_clipLeft, row + m_clipRight, value);
+    }
+}
+
+bool SoftwareRasterizer::BeginPath(float minX, float minY, float maxX, float maxY) {
+    m_pathEmpty = true;
+    // 同时排除NaN
+    if (!(minX <= maxX && minY <= maxY)) return false;
+    if (maxX < 0.0f || minX >= static_cast<float>(m_surface.width)) return false;
+    if (maxY < static_cast<float>(m_clipTop) || minY >= static_cast<float>(m_clipBottom)) return false;
+
+    // 列范围只取决于画布而非裁剪矩形，保证分块渲染时每行的覆盖率与整幅渲染相同
+    m_pathX0 = minX <= 0.0f ? 0 : FloorPositive(minX);
+    m_pathX1 = maxX >= static_cast<float>(m_surface.width) ? m_surface.width : CeilPositive(maxX) + 1;
+    m_pathX1 = (std::min)(m_pathX1, m_surface.width);
+    m_pathY0 = minY <= static_cast<float>(m_clipTop) ? m_clipTop : FloorPositive(minY);
+    m_pathY1 = maxY >= static_cast<float>(m_clipBottom) ? m_clipBottom : CeilPositive(maxY) + 1;
+    m_pathY1 = (std::min)(m_pathY1, m_clipBottom);
+
+    if (m_pathX0 >= m_pathX1 || m_pathY0 >= m_pathY1) return false;
+    if ((std::max)(m_pathX0, m_clipLeft) >= (std::min)(m_pathX1, m_clipRight)) return false;
+
+    // 每行多留4个单元，容纳落在右边界上的覆盖率增量和一次写4个单元时越过右边界的部分
+    m_pathStride = m_pathX1 - m_pathX0 + 4;
+    int rows = m_pathY1 - m_pathY0;
+    size_t needed = static_cast<size_t>(m_pathStride) * rows;
+    if (m_accum.size() < needed) {
+        m_accum.resize(needed, 0.0f);
+    }
+    if (m_rowMin.size() < static_cast<size_t>(rows)) {
+        m_rowMin.resize(rows);
+        m_rowMax.resize(rows);
+    }
+    std::fill(m_rowMin.begin(), m_rowMin.begin() + rows, INT_MAX);
+    std::fill(m_rowMax.begin(), m_rowMax.begin() + rows, -1);
+    m_pathEmpty = false;
+    return true;
+}
+
+void SoftwareRasterizer::AddEdge(D2D1_POINT_2F a, D2D1_POINT_2F b) {
+    if (m_pathEmpty || a.y == b.y) return;
+
+    float dir = 1.0f;
+    if (a.y > b.y) {
+        std::swap(a, b);
+        dir = -1.0f;
+    }
+    if (b.y <= static_cast<float>(m_pathY0) || a.y >= static_cast<float>(m_pathY1)) return;
+
+    float dxdy = (b.x - a.x) / (b.y - a.y);
+    // 跨越多个单元时每单元分得的高度只取决于斜率，每条边算一次而不是每行做一次除法
+    float ds = dxdy != 0.0f ? dir / fabsf(dxdy) : 0.0f;
+    float width = static_cast<float>(m_pathX1 - m_pathX0);
+    float originX = static_cast<float>(m_pathX0);
+    int rowStart = a.y <= static_cast<float>(m_pathY0) ? m_pathY0 : FloorPositive(a.y);
+    int rowEnd = b.y >= static_cast<float>(m_pathY1) ? m_pathY1 : CeilPositive(b.y);
+    // 整条边在累积区域的列范围内时（绝大多数情况）省去逐行的边界判断
+    bool inside = (std::min)(a.x, b.x) >= originX && (std::max)(a.x, b.x) - originX <= width;
+
+    // 每行的交点直接由端点计算而不是逐行累加，使结果与起始行（即分块位置）无关；
+    // 上一行的下端交点与本行的上端交点是同一个表达式，直接沿用
+    float ya = (std::max)(static_cast<float>(rowStart), a.y);
+    float xa = a.x + dxdy * (ya - a.y) - originX;
+    float *row = &m_accum[static_cast<size_t>(rowStart - m_pathY0) * m_pathStride];
+    int *rowMin = &m_rowMin[rowStart - m_pathY0];
+    int *rowMax = &m_rowMax[rowStart - m_pathY0];
+
+    for (int y = rowStart; y < rowEnd; ++y, row += m_pathStride, ++rowMin, ++rowMax) {
+        float yb = (std::min)(static_cast<float>(y + 1), b.y);
+        float xb = a.x + dxdy * (yb - a.y) - originX;
+        float d = (yb - ya) * dir;
+        float xl = (std::min)(xa, xb);
+        float xr = (std::max)(xa, xb);
+
+        if (inside) {
+            // 记录本行被触及的单元范围（保守估计）
+            int lo = static_cast<int>(xl);
+            int hi = static_cast<int>(xr) + 2;
+            if (lo < *rowMin) *rowMin = lo;
+            if (hi > *rowMax) *rowMax = hi;
+            AccumulateRowSpan(row, xl, xr, xa, xb, d, ds);
+        } else {
+            int lo = static_cast<int>((std::max)(0.0f, xl));
+            int hi = static_cast<int>((std::min)(width, xr)) + 2;
+            if (lo < *rowMin) *rowMin = lo;
+            if (hi > *rowMax) *rowMax = hi;
+            AccumulateClippedRowSpan(row, xa, xb, width, d, ds);
+        }
+        ya = yb;
+        xa = xb;
+    }
+}
+
+void SoftwareRasterizer::FlushPath(const D2D1_COLOR_F &color) {
+    if (m_pathEmpty) return;
+    m_pathEmpty = true;
+
+    int width = m_pathX1 - m_pathX0;
+    if (m_weights.size() < static_cast<size_t>(width) + 4) {
+        m_weights.resize(static_cast<size_t>(width) + 4);
+    }
+    uint32_t src = PackOpaque(color);
+    float scale = Clamp01(color.a) * 256.0f;
+    int blendStart = (std::max)(m_pathX0, m_clipLeft) - m_pathX0;
+    int blendEnd = (std::min)(m_pathX1, m_clipRight) - m_pathX0;
+    uint16_t *weights = m_weights.data();
+#ifdef RASTER_USE_SSE2
+    const __m128i src4 = _mm_set1_epi32(static_cast<int>(src));
+    const __m128i srcLo = _mm_unpacklo_epi8(src4, _mm_setzero_si128());
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    const __m128 one4 = _mm_set1_ps(1.0f);
+    const __m128 half4 = _mm_set1_ps(0.5f);
+    const __m128 scale4 = _mm_set1_ps(scale);
+#endif
+
+    for (int y = m_pathY0; y < m_pathY1; ++y) {
+        int rowIndex = y - m_pathY0;
+        if (m_rowMax[rowIndex] < 0) continue;
+
+        float *row = &m_accum[static_cast<size_t>(rowIndex) * m_pathStride];
+        uint32_t *dst = m_surface.Row(y) + m_pathX0;
+        int x = m_rowMin[rowIndex];
+        int end = (std::min)(width, m_rowMax[rowIndex]);
+        float acc = 0.0f;
+        uint16_t w = 0;
+
+        while (x < end) {
+            // 覆盖率为零时跳过全零单元（描边内部的大段空白）
+            if (w == 0) {
+                x = SkipZeroCells(row, x, end);
+                if (x >= end) break;
+            }
+#ifdef RASTER_USE_SSE2
+            // 4个单元一组：组内前缀和、覆盖率和混合都不分支，避免描边每次穿过本行都单独处理一小段像素
+            if (x + 4 <= end) {
+                __m128 v = _mm_loadu_ps(row + x);
+                _mm_storeu_ps(row + x, _mm_setzero_ps());
+                v = _mm_add_ps(v, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(v), 4)));
+                v = _mm_add_ps(v, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(v), 8)));
+                v = _mm_add_ps(v, _mm_set1_ps(acc));
+                acc = _mm_cvtss_f32(_mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)));
+                __m128 coverage = _mm_min_ps(_mm_and_ps(v, absMask), one4);
+                __m128i w4 = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(coverage, scale4), half4));
+                _mm_storel_epi64(reinterpret_cast<__m128i *>(weights + x), _mm_packs_epi32(w4, w4));
+                // 分组只取决于本行的单元范围，与裁剪矩形无关；被裁剪的组逐像素混合在范围内的部分
+                if (x >= blendStart && x + 4 <= blendEnd) {
+                    BlendQuad(dst + x, weights + x, src4, srcLo);
+                } else {
+                    int s0 = (std::max)(x, blendStart);
+                    int s1 = (std::min)(x + 4, blendEnd);
+                    if (s0 < s1) BlendSpan(dst + s0, weights + s0, s1 - s0, src);
+                }
+                w = weights[x + 3];
+                x += 4;
+                continue;
+            }
+#endif
+            acc += row[x];
+            row[x] = 0.0f;
+            float coverage = fabsf(acc);
+            if (coverage > 1.0f) coverage = 1.0f;
+            w = static_cast<uint16_t>(coverage * scale + 0.5f);
+            if (w != 0 && x >= blendStart && x < blendEnd) {
+                dst[x] = (w == 256) ? src : BlendPixel(dst[x], src, w);
+            }
+            ++x;
+        }
+
+        // 最后一条边右侧覆盖率保持不变（路径被右边界截断时不为零）
+        if (w != 0 && end < width) {
+            int s0 = (std::max)(end, blendStart);
+            int s1 = blendEnd;
+            if (s0 < s1) {
+                std::fill(weights + s0, weights + s1, w);
+                BlendSpan(dst + s0, weights + s0, s1 - s0, src);
+            }
+        }
+        row[width] = 0.0f;
+        row[width + 1] = 0.0f;
+        row[width + 2] = 0.0f;
+        row[width + 3] = 0.0f;
+    }
+}
+
+void SoftwareRasterizer::AddSegmentQuad(D2D1_POINT_2F a, D2D1_POINT_2F b, float halfWidth) {
+    float dx = b.x - a.x;
+    float dy = b.y - a.y;
+    float len = sqrtf(dx * dx + dy * dy);
+    if (len <= 0.0f) return;
+
+    // 所有四边形使用相同的绕向，重叠部分的覆盖率只会叠加而不会抵消
+    float nx = -dy / len * halfWidth;
+    float ny = dx / len * halfWidth;
+    D2D1_POINT_2F q0 = D2D1::Point2F(a.x + nx, a.y + ny);
+    D2D1_POINT_2F q1 = D2D1::Point2F(b.x + nx, b.y + ny);
+    D2D1_POINT_2F q2 = D2D1::Point2F(b.x - nx, b.y - ny);
+    D2D1_POINT_2F q3 = D2D1::Point2F(a.x - nx, a.y - ny);
+    AddEdge(q0, q1);
+    AddEdge(q1, q2);
+    AddEdge(q2, q3);
+    AddEdge(q3, q0);
+}
+
+void SoftwareRasterizer::AddEllipseContour(D2D1_POINT_2F center, float radiusX, float radiusY, bool reversed) {
+    int n = SegmentsForRadius((std::max)(radiusX, radiusY));
+    float step = (reversed ? -2.0f : 2.0f) * PI / n;
+    float cs = cosf(step);
+    float sn = sinf(step);
+
+    // 用旋转递推代替逐点三角函数
+    float c = 1.0f;
+    float s = 0.0f;
+    D2D1_POINT_2F first = D2D1::Point2F(center.x + radiusX, center.y);
+    D2D1_POINT_2F prev = first;
+    for (int i = 1; i < n; ++i) {
+        float nc = c * cs - s * sn;
+        s = s * cs + c * sn;
+        c = nc;
+        D2D1_POINT_2F cur = D2D1::Point2F(center.x + radiusX * c, center.y + radiusY * s);
+        AddEdge(prev, cur);
+        prev = cur;
+    }
+    AddEdge(prev, first);
+}
+
+void SoftwareRasterizer::AddDisc(D2D1_POINT_2F center, float radius, bool reversed) {
+    AddEllipseContour(center, radius, radius, reversed);
+}
+
+void SoftwareRasterizer::AddSolidStroke(const D2D1_POINT_2F *points, size_t count, bool closed, float halfWidth) {
+    // 闭合折线在末尾补回起点；几乎共线的中间点（离弦不超过 SIMPLIFY_TOLERANCE 像素且不回折）
+    // 并入同一段，曲线离散出的密集折线只剩少量线段。零长度的线段被跳过，相邻的有效线段仍然首尾相接
+    const float SIMPLIFY_TOLERANCE = 0.1f;
+    const size_t SIMPLIFY_MAX_RUN = 8; // 一段最多合并的原始线段数，限制逐点检查的开销
+    size_t vertexCount = closed ? count + 1 : count;
+    auto vertex = [&](size_t i) {
+        return points[i == count ? 0 : i];
+    };
+
+    m_segments.clear();
+    size_t anchor = 0;
+    while (anchor + 1 < vertexCount) {
+        D2D1_POINT_2F a = vertex(anchor);
+        size_t end = anchor + 1;
+        while (end + 1 < vertexCount && end + 1 - anchor <= SIMPLIFY_MAX_RUN) {
+            D2D1_POINT_2F c = vertex(end + 1);
+            float cx = c.x - a.x;
+            float cy = c.y - a.y;
+            float chordSq = cx * cx + cy * cy;
+            if (chordSq <= 0.0f) break;
+            bool straight = true;
+            for (size_t k = anchor + 1; k <= end && straight; ++k) {
+                D2D1_POINT_2F v = vertex(k);
+                float vx = v.x - a.x;
+                float vy = v.y - a.y;
+                float cross = cx * vy - cy * vx;
+                float along = cx * vx + cy * vy;
+                straight = cross * cross <= SIMPLIFY_TOLERANCE * SIMPLIFY_TOLERANCE * chordSq &&
+                           along >= 0.0f && along <= chordSq;
+            }
+            if (!straight) break;
+            ++end;
+        }
+
+        StrokeSegment segment;
+        segment.a = a;
+        segment.b = vertex(end);
+        anchor = end;
+        float dx = segment.b.x - segment.a.x;
+        float dy = segment.b.y - segment.a.y;
+        segment.length = sqrtf(dx * dx + dy * dy);
+        if (segment.length <= 0.0f) continue;
+        float scale = halfWidth / segment.length;
+        segment.normal = D2D1::Point2F(-dy * scale, dx * scale);
+        segment.miter = segment.normal;
+        segment.joined = false;
+        m_segments.push_back(segment);
+    }
+    size_t n = m_segments.size();
+    if (n == 0) return;
+
+    // 转折平缓（不超过约45度）且两段都不短于半线宽时，两段在连接点共用斜接点，
+    // 中间的两条端边正好抵消而不再生成；此时内侧偏移边不会反向，斜接长度不超过半线宽的1.1倍。
+    // 其余的连接点断开，两段各自闭合，较粗的线在明显转折处补圆形连接
+    const float MITER_MIN_COS = 0.7f;
+    float halfWidthSq = halfWidth * halfWidth;
+    for (size_t k = closed ? 0 : 1; k < n && n >= 2; ++k) {
+        const StrokeSegment &prev = m_segments[(k + n - 1) % n];
+        StrokeSegment &cur = m_segments[k];
+        float cosTurn = (prev.normal.x * cur.normal.x + prev.normal.y * cur.normal.y) / halfWidthSq;
+        if (cosTurn >= MITER_MIN_COS && prev.length >= halfWidth && cur.length >= halfWidth) {
+            float scale = 1.0f / (1.0f + cosTurn);
+            cur.miter = D2D1::Point2F((prev.normal.x + cur.normal.x) * scale, (prev.normal.y + cur.normal.y) * scale);
+            cur.joined = true;
+        } else if (halfWidth > 1.0f && cosTurn <= 0.99f) {
+            AddDisc(cur.a, halfWidth, true);
+        }
+    }
+
+    // 与 AddSegmentQuad 相同的绕向：a+n -> b+n -> b-n -> a-n；分块外的线段不会触及累积行，直接跳过
+    float reach = 2.0f * halfWidth;
+    float top = static_cast<float>(m_pathY0) - reach;
+    float bottom = static_cast<float>(m_pathY1) + reach;
+    for (size_t k = 0; k < n; ++k) {
+        const StrokeSegment &segment = m_segments[k];
+        const StrokeSegment &next = m_segments[k + 1 == n ? 0 : k + 1];
+        if ((std::max)(segment.a.y, segment.b.y) < top || (std::min)(segment.a.y, segment.b.y) >= bottom) continue;
+
+        bool endJoined = (k + 1 < n || closed) && next.joined;
+        D2D1_POINT_2F start = segment.joined ? segment.miter : segment.normal;
+        D2D1_POINT_2F end = endJoined ? next.miter : segment.normal;
+        D2D1_POINT_2F q0 = D2D1::Point2F(segment.a.x + start.x, segment.a.y + start.y);
+        D2D1_POINT_2F q1 = D2D1::Point2F(segment.b.x + end.x, segment.b.y + end.y);
+        D2D1_POINT_2F q2 = D2D1::Point2F(segment.b.x - end.x, segment.b.y - end.y);
+        D2D1_POINT_2F q3 = D2D1::Point2F(segment.a.x - start.x, segment.a.y - start.y);
+        AddEdge(q0, q1);
+        if (!endJoined) AddEdge(q1, q2);
+        AddEdge(q2, q3);
+        if (!segment.joined) AddEdge(q3, q0);
+    }
+}
+
+void SoftwareRasterizer::StrokePoints(const D2D1_POINT_2F *points, size_t count, bool closed,
+                                      const D2D1_COLOR_F &color, float width, LineStyle style) {
+    if (!points || count < 2) return;
+
+    float strokeWidth = (std::max)(width, 1.0f);
+    float halfWidth = strokeWidth * 0.5f;
+
+    float minX = points[0].x, minY = points[0].y, maxX = points[0].x, maxY = points[0].y;
+    for (size_t i = 1; i < count; ++i) {
+        minX = (std::min)(minX, points[i].x);
+        minY = (std::min)(minY, points[i].y);
+        maxX = (std::max)(maxX, points[i].x);
+        maxY = (std::max)(maxY, points[i].y);
+    }
+    // 斜接点离顶点最远约1.1倍半线宽
+    float margin = strokeWidth + 1.0f;
+    if (!BeginPath(minX - margin, minY - margin, maxX + margin, maxY + margin)) return;
+
+    size_t segmentCount = closed ? count : count - 1;
+    // 虚线模式以线宽为单位，与 GraphicsEngine 创建的D2D笔划样式使用同一张表
+    DashCursor dash(DashPatterns::Stroke(style), strokeWidth);
+
+    if (dash.IsSolid()) {
+        AddSolidStroke(points, count, closed, halfWidth);
+    } else {
+        // 虚线：沿折线连续推进线型游标，跨线段保持相位
+        for (size_t i = 0; i < segmentCount; ++i) {
+            D2D1_POINT_2F a = points[i];
+            D2D1_POINT_2F b = points[(i + 1) % count];
+            float dx = b.x - a.x;
+            float dy = b.y - a.y;
+            float len = sqrtf(dx * dx + dy * dy);
+            float t = 0.0f;
+            while (len - t > 0.0f) {
+                float step = (std::min)(dash.Remaining(), len - t);
+                if (dash.IsOn()) {
+                    AddSegmentQuad(Lerp(a, b, t / len), Lerp(a, b, (t + step) / len), halfWidth);
+                }
+                float next = t + step;
+                if (next <= t) break; // 浮点精度耗尽，避免死循环
+                t = next;
+                dash.Advance(step);
+            }
+        }
+    }
+
+    FlushPath(color);
+}
+
+void SoftwareRasterizer::DrawLine(D2D1_POINT_2F p0, D2D1_POINT_2F p1,
+                                  const D2D1_COLOR_F &color, float width, LineStyle style) {
+    D2D1_POINT_2F points[2] = {p0, p1};
+    StrokePoints(points, 2, false, color, width, style);
+}
+
+void SoftwareRasterizer::DrawPolyline(const D2D1_POINT_2F *points, size_t count, bool closed,
+                                      const D2D1_COLOR_F &color, float width, LineStyle style) {
+    StrokePoints(points, count, closed, color, width, style);
+}
+
+void SoftwareRasterizer::DrawEllipse(D2D1_POINT_2F center, float radiusX, float radiusY,
+                                     const D2D1_COLOR_F &color, float width, LineStyle style) {
+    radiusX = fabsf(radiusX);
+    radiusY = fabsf(radiusY);
+
+    if (style != LineStyle::SOLID) {
+        // 虚线圆展平为闭合折线后沿弧长推进虚线模式
+        int n = SegmentsForRadius((std::max)(radiusX, radiusY));
+        m_scratch.resize(n);
+        for (int i = 0; i < n; ++i) {
+            float angle = 2.0f * PI * i / n;
+            m_scratch[i] = D2D1::Point2F(center.x + radiusX * cosf(angle), center.y + radiusY * sinf(angle));
+        }
+        StrokePoints(m_scratch.data(), m_scratch.size(), true, color, width, style);
+        return;
+    }
+
+    float halfWidth = (std::max)(width, 1.0f) * 0.5f;
+    if (radiusX == radiusY) {
+        FillRing(center, radiusX + halfWidth, radiusX - halfWidth, color);
+        return;
+    }
+
+    // 实线椭圆环：外轮廓与反向的内轮廓组成一个路径，一次填充完成
+    float outerX = radiusX + halfWidth;
+    float outerY = radiusY + halfWidth;
+    if (!BeginPath(center.x - outerX - 1.0f, center.y - outerY - 1.0f,
+                   center.x + outerX + 1.0f, center.y + outerY + 1.0f)) {
+        return;
+    }
+    AddEllipseContour(center, outerX, outerY, false);
+    if (radiusX > halfWidth && radiusY > halfWidth) {
+        AddEllipseContour(center, radiusX - halfWidth, radiusY - halfWidth, true);
+    }
+    FlushPath(color);
+}
+
+// 实线圆环直接按像素中心到圆心的距离求覆盖率：外圆覆盖率减去内圆覆盖率，各自在半径两侧各半个像素内线性过渡。
+// 每行先解出圆环所在的列范围并跳过内圆中覆盖率为零的部分，不需要展平为多边形边。
+// 每个像素的结果只取决于它的位置，与裁剪矩形无关
+void SoftwareRasterizer::FillRing(D2D1_POINT_2F center, float outerRadius, float innerRadius, const D2D1_COLOR_F &color) {
+    float reach = outerRadius + 0.5f;
+    if (!(reach > 0.0f)) return;
+    float top = floorf(center.y - reach);
+    float bottom = ceilf(center.y + reach);
+    if (bottom <= static_cast<float>(m_clipTop) || top >= static_cast<float>(m_clipBottom)) return;
+    if (center.x + reach <= 0.0f || center.x - reach >= static_cast<float>(m_surface.width)) return;
+
+    if (m_weights.size() < static_cast<size_t>(m_surface.width)) {
+        m_weights.resize(m_surface.width);
+    }
+    uint16_t *weights = m_weights.data();
+    uint32_t src = PackOpaque(color);
+    float scale = Clamp01(color.a) * 256.0f;
+    float reachSq = reach * reach;
+    // 内圆半径不为正时是实心圆盘，内圆覆盖率恒为零
+    float hole = innerRadius > 0.0f ? innerRadius - 0.5f : 0.0f;
+    float inner = innerRadius > 0.0f ? innerRadius + 0.5f : -1.0f;
+    float outer = outerRadius + 0.5f;
+    float canvasRight = static_cast<float>(m_surface.width);
+
+    int y0 = (std::max)(m_clipTop, static_cast<int>(top));
+    int y1 = (std::min)(m_clipBottom, static_cast<int>(bottom));
+    for (int y = y0; y < y1; ++y) {
+        float dy = static_cast<float>(y) + 0.5f - center.y;
+        float dySq = dy * dy;
+        if (dySq >= reachSq) continue;
+        float span = sqrtf(reachSq - dySq);
+        int x0 = static_cast<int>((std::max)(0.0f, floorf(center.x - span)));
+        int x1 = static_cast<int>((std::min)(canvasRight, ceilf(center.x + span)));
+        // 内圆中像素中心到圆心的距离不超过 hole 的部分覆盖率恰好为零
+        int h0 = x1;
+        int h1 = x1;
+        if (hole > 0.0f && dySq < hole * hole) {
+            float holeSpan = sqrtf(hole * hole - dySq);
+            h0 = (std::max)(x0, static_cast<int>(ceilf(center.x - holeSpan)));
+            h1 = (std::min)(x1, static_cast<int>(floorf(center.x + holeSpan)));
+            if (h0 >= h1) {
+                h0 = x1;
+                h1 = x1;
+            }
+        }
+
+        uint32_t *dst = m_surface.Row(y);
+        int pieces[2][2] = {{x0, h0}, {h1, x1}};
+        for (int p = 0; p < 2; ++p) {
+            int s0 = pieces[p][0];
+            int s1 = pieces[p][1];
+            if (s0 >= s1) continue;
+            int x = s0;
+#ifdef RASTER_USE_SSE2
+            // 一次4个像素，与下面的逐像素计算使用相同的单精度运算，结果逐位一致
+            const __m128 zero4 = _mm_setzero_ps();
+            const __m128 one4 = _mm_set1_ps(1.0f);
+            const __m128 half4 = _mm_set1_ps(0.5f);
+            const __m128 step4 = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+            const __m128 centerX4 = _mm_set1_ps(center.x);
+            const __m128 dySq4 = _mm_set1_ps(dySq);
+            const __m128 outer4 = _mm_set1_ps(outer);
+            const __m128 inner4 = _mm_set1_ps(inner);
+            const __m128 scale4 = _mm_set1_ps(scale);
+            for (; x + 4 <= s1; x += 4) {
+                __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), step4);
+                __m128 dx = _mm_sub_ps(_mm_add_ps(px, half4), centerX4);
+                __m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), dySq4));
+                __m128 coverage = _mm_sub_ps(_mm_min_ps(one4, _mm_max_ps(zero4, _mm_sub_ps(outer4, distance))),
+                                             _mm_min_ps(one4, _mm_max_ps(zero4, _mm_sub_ps(inner4, distance))));
+                __m128i w = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(coverage, scale4), half4));
+                _mm_storel_epi64(reinterpret_cast<__m128i *>(weights + x), _mm_packs_epi32(w, w));
+            }
+#endif
+            for (; x < s1; ++x) {
+                float dx = static_cast<float>(x) + 0.5f - center.x;
+                float distance = sqrtf(dx * dx + dySq);
+                float coverage = Clamp01(outer - distance) - Clamp01(inner - distance);
+                weights[x] = static_cast<uint16_t>(coverage * scale + 0.5f);
+            }
+            int b0 = (std::max)(s0, m_clipLeft);
+            int b1 = (std::min)(s1, m_clipRight);
+            if (b0 < b1) BlendSpan(dst + b0, weights + b0, b1 - b0, src);
+        }
+    }
+}
+
+void SoftwareRasterizer::DrawBezier(D2D1_POINT_2F p0, D2D1_POINT_2F p1, D2D1_POINT_2F p2, D2D1_POINT_2F p3,
+                                    const D2D1_COLOR_F &color, float width, LineStyle style) {
+    // 由二阶差分估计展平段数：误差上界为 3/4 * |二阶差分| / n^2
+    float ddx = (std::max)(fabsf(p0.x - 2.0f * p1.x + p2.x), fabsf(p1.x - 2.0f * p2.x + p3.x));
+    float ddy = (std::max)(fabsf(p0.y - 2.0f * p1.y + p2.y), fabsf(p1.y - 2.0f * p2.y + p3.y));
+    float dd = sqrtf(ddx * ddx + ddy * ddy);
+    int n = static_cast<int>(ceilf(sqrtf(0.75f * dd / FLATTEN_TOLERANCE)));
+    n = (std::max)(1, (std::min)(n, 1024));
+
+    m_scratch.resize(n + 1);
+    for (int i = 0; i <= n; ++i) {
+        float t = static_cast<float>(i) / n;
+        float u = 1.0f - t;
+        float b0 = u * u * u;
+        float b1 = 3.0f * u * u * t;
+        float b2 = 3.0f * u * t * t;
+        float b3 = t * t * t;
+        m_scratch[i] = D2D1::Point2F(b0 * p0.x + b1 * p1.x + b2 * p2.x + b3 * p3.x,
+                                     b0 * p0.y + b1 * p1.y + b2 * p2.y + b3 * p3.y);
+    }
+    StrokePoints(m_scratch.data(), m_scratch.size(), false, color, width, style);
+}
+
+void SoftwareRasterizer::FillPolygon(const D2D1_POINT_2F *points, size_t count, const D2D1_COLOR_F &color) {
+    if (!points || count < 3) return;
+
+    float minX = points[0].x, minY = points[0].y, maxX = points[0].x, maxY = points[0].y;
+    for (size_t i = 1; i < count; ++i) {
+        minX = (std::min)(minX, points[i].x);
+        minY = (std::min)(minY, points[i].y);
+        maxX = (std::max)(maxX, points[i].x);
+        maxY = (std::max)(maxY, points[i].y);
+    }
+    if (!BeginPath(minX, minY, maxX, maxY)) return;
+    for (size_t i = 0; i < count; ++i) {
+        AddEdge(points[i], points[(i + 1) % count]);
+    }
+    FlushPath(color);
+}
+
+void SoftwareRasterizer::FillPixels(const D2D1_POINT_2F *pixels, size_t count, const D2D1_COLOR_F &color) {
+    if (!pixels) return;
+
+    uint32_t src = PackOpaque(color);
+    uint32_t w = static_cast<uint32_t>(Clamp01(color.a) * 256.0f + 0.5f);
+    if (w == 0) return;
+    float left = static_cast<float>(m_clipLeft);
+    float top = static_cast<float>(m_clipTop);
+    float right = static_cast<float>(m_clipRight);
+    float bottom = static_cast<float>(m_clipBottom);
+
+    for (size_t i = 0; i < count; ++i) {
+        float fx = floorf(pixels[i].x);
+        float fy = floorf(pixels[i].y);
+        if (!(fx >= left && fx < right && fy >= top && fy < bottom)) continue;
+        uint32_t *dst = m_surface.Row(static_cast<int>(fy)) + static_cast<int>(fx);
+        *dst = (w >= 256) ? src : BlendPixel(*dst, src, w);
+    }
+}
+
+void SoftwareRasterizer::FillRuns(const PixelRun *runs, size_t count, const D2D1_COLOR_F &color) {
+    if (!runs) return;
+
+    uint32_t src = PackOpaque(color);
+    uint32_t w = static_cast<uint32_t>(Clamp01(color.a) * 256.0f + 0.5f);
+    if (w == 0) return;
+
+    for (size_t i = 0; i < count; ++i) {
+        const PixelRun &run = runs[i];
+        if (run.vertical) {
+            if (run.x < m_clipLeft || run.x >= m_clipRight) continue;
+            int y0 = (std::max)(run.y, m_clipTop);
+            int y1 = (std::min)(run.y + run.length, m_clipBottom);
+            for (int y = y0; y < y1; ++y) {
+                uint32_t *dst = m_surface.Row(y) + run.x;
+                *dst = (w >= 256) ? src : BlendPixel(*dst, src, w);
+            }
+        } else {
+            if (run.y < m_clipTop || run.y >= m_clipBottom) continue;
+            int x0 = (std::max)(run.x, m_clipLeft);
+            int x1 = (std::min)(run.x + run.length, m_clipRight);
+            if (x0 >= x1) continue;
+            uint32_t *dst = m_surface.Row(run.y) + x0;
+            if (w >= 256) {
+                std::fill(dst, dst + (x1 - x0), src);
+            } else {
+                for (int x = 0; x < x1 - x0; ++x) {
+                    dst[x] = BlendPixel(dst[x], src, w);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "RenderBackend.h"
+
+struct PixelRun;
+
+// 32位RGBA像素缓冲，内存中按 R,G,B,A 字节顺序存放，颜色为预乘Alpha
+struct RasterSurface {
+    int width = 0;
+    int height = 0;
+    std::vector<uint32_t> pixels;
+
+    void Resize(int w, int h) {
+        width = w > 0 ? w : 0;
+        height = h > 0 ? h : 0;
+        pixels.assign(static_cast<size_t>(width) * height, 0);
+    }
+    uint32_t *Row(int y) {
+        return pixels.data() + static_cast<size_t>(y) * width;
+    }
+    const uint32_t *Row(int y) const {
+        return pixels.data() + static_cast<size_t>(y) * width;
+    }
+};
+
+// CPU软件光栅化后端
+// 所有图元（描边、虚线、圆、Bezier）都先转换为多边形边，再用扫描行覆盖率累积得到抗锯齿覆盖率，
+// 最后按行把覆盖率span混合到缓冲中（SSE2一次处理4个像素）。
+// 每一行的覆盖率只依赖图元本身和画布宽度，与裁剪矩形无关，因此按水平分块多线程渲染时
+// 结果与单线程逐位一致；不同分块写入互不重叠的行，可以共享同一个 RasterSurface。
+class SoftwareRasterizer : public RenderBackend {
+public:
+    explicit SoftwareRasterizer(RasterSurface &surface);
+
+    // 设置裁剪矩形（半开区间），默认为整个缓冲；分块渲染时每个线程只写自己的分块
+    void SetClipRect(int left, int top, int right, int bottom);
+
+    void Clear(const D2D1_COLOR_F &color) override;
+    void DrawLine(D2D1_POINT_2F p0, D2D1_POINT_2F p1,
+                  const D2D1_COLOR_F &color, float width, LineStyle style) override;
+    void DrawPolyline(const D2D1_POINT_2F *points, size_t count, bool closed,
+                      const D2D1_COLOR_F &color, float width, LineStyle style) override;
+    void DrawEllipse(D2D1_POINT_2F center, float radiusX, float radiusY,
+                     const D2D1_COLOR_F &color, float width, LineStyle style) override;
+    void DrawBezier(D2D1_POINT_2F p0, D2D1_POINT_2F p1, D2D1_POINT_2F p2, D2D1_POINT_2F p3,
+                    const D2D1_COLOR_F &color, float width, LineStyle style) override;
+    void FillPolygon(const D2D1_POINT_2F *points, size_t count, const D2D1_COLOR_F &color) override;
+    void FillPixels(const D2D1_POINT_2F *pixels, size_t count, const D2D1_COLOR_F &color) override;
+
+    // 填充整数像素段（RasterBatch 批量光栅化的输出），按段整行/整列写入，超出裁剪矩形的部分跳过
+    void FillRuns(const PixelRun *runs, size_t count, const D2D1_COLOR_F &color);
+
+private:
+    RasterSurface &m_surface;
+    int m_clipLeft, m_clipTop, m_clipRight, m_clipBottom;
+
+    // 当前路径的累积区域：列覆盖画布内的整个包围盒宽度，行限制在裁剪矩形内
+    int m_pathX0, m_pathY0, m_pathX1, m_pathY1;
+    int m_pathStride;
+    bool m_pathEmpty;
+    std::vector<float> m_accum;        // 覆盖率累积缓冲（跨路径复用，用完即清零）
+    std::vector<uint16_t> m_weights;   // 一行的混合权重 [0, 256]
+    std::vector<int> m_rowMin, m_rowMax; // 每行被边触及的单元范围，刷新时只扫描这一段
+    std::vector<D2D1_POINT_2F> m_scratch; // 展平曲线用的临时点
+
+    // 实线描边的一段：法向量已乘半线宽；joined 表示与前一段在起点处共用斜接点，miter 为该点的偏移
+    struct StrokeSegment {
+        D2D1_POINT_2F a, b;
+        D2D1_POINT_2F normal;
+        D2D1_POINT_2F miter;
+        float length;
+        bool joined;
+    };
+    std::vector<StrokeSegment> m_segments;
+
+    bool BeginPath(float minX, float minY, float maxX, float maxY);
+    void AddEdge(D2D1_POINT_2F a, D2D1_POINT_2F b);
+    void FlushPath(const D2D1_COLOR_F &color);
+
+    void AddSegmentQuad(D2D1_POINT_2F a, D2D1_POINT_2F b, float halfWidth);
+    void AddSolidStroke(const D2D1_POINT_2F *points, size_t count, bool closed, float halfWidth);
+    void FillRing(D2D1_POINT_2F center, float outerRadius, float innerRadius, const D2D1_COLOR_F &color);
+    void AddDisc(D2D1_POINT_2F center, float radius, bool reversed);
+    void AddEllipseContour(D2D1_POINT_2F center, float radiusX, float radiusY, bool reversed);
+    void StrokePoints(const D2D1_POINT_2F *points, size_t count, bool closed,
+                      const D2D1_COLOR_F &color, float width, LineStyle style);
+};
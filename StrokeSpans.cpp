@@ -0,0 +1,122 @@
+#include "StrokeSpans.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    const float EDGE_EPSILON = 1e-4f; // 恰好落在描边边界上的像素算在内，吸收浮点误差
+
+    // 满足 lo <= (x - x0) * k + c <= hi 的 x 区间与 [left, right] 求交
+    void IntersectLinear(float x0, float k, float c, float lo, float hi, float &left, float &right) {
+        if (fabsf(k) < 1e-6f) {
+            if (c < lo - EDGE_EPSILON || c > hi + EDGE_EPSILON) {
+                left = 1.0f;
+                right = 0.0f;
+            }
+            return;
+        }
+        float a = x0 + (lo - c) / k;
+        float b = x0 + (hi - c) / k;
+        if (a > b) std::swap(a, b);
+        left = (std::max)(left, a);
+        right = (std::min)(right, b);
+    }
+}
+
+void StrokeSpans::AddRow(int y, float left, float right) {
+    int x0 = static_cast<int>(ceilf(left - EDGE_EPSILON));
+    int x1 = static_cast<int>(floorf(right + EDGE_EPSILON));
+    if (x0 > x1) return;
+    m_spans.push_back(PixelRun{x0, y, x1 - x0 + 1, 0});
+}
+
+void StrokeSpans::AddSegment(D2D1_POINT_2F a, D2D1_POINT_2F b, float halfWidth, LineCap cap) {
+    float dx = b.x - a.x;
+    float dy = b.y - a.y;
+    float length = sqrtf(dx * dx + dy * dy);
+    bool round = cap == LineCap::ROUND;
+    if (length < 1e-6f && !round) return;
+
+    // 描边在y方向的范围：圆头为两端点上下各扩 halfWidth，平头为矩形四角
+    float ux = length > 0 ? dx / length : 1.0f;
+    float uy = length > 0 ? dy / length : 0.0f;
+    float nx = -uy;
+    float ny = ux;
+    float extentY = round ? halfWidth : fabsf(ny) * halfWidth;
+    int rowFirst = static_cast<int>(ceilf((std::min)(a.y, b.y) - extentY - EDGE_EPSILON));
+    int rowLast = static_cast<int>(floorf((std::max)(a.y, b.y) + extentY + EDGE_EPSILON));
+    float r2 = halfWidth * halfWidth;
+
+    for (int y = rowFirst; y <= rowLast; ++y) {
+        float fy = static_cast<float>(y);
+        float left = HUGE_VALF;
+        float right = -HUGE_VALF;
+
+        // 两端点之间的矩形部分：沿线方向投影在 [0, length]，法向投影在 [-halfWidth, halfWidth]
+        if (length > 0) {
+            float rectLeft = -HUGE_VALF;
+            float rectRight = HUGE_VALF;
+            IntersectLinear(a.x, ux, (fy - a.y) * uy, 0.0f, length, rectLeft, rectRight);
+            IntersectLinear(a.x, nx, (fy - a.y) * ny, -halfWidth, halfWidth, rectLeft, rectRight);
+            if (rectLeft <= rectRight) {
+                left = rectLeft;
+                right = rectRight;
+            }
+        }
+        // 圆头：两端点处的圆盘；描边是凸集，与一行的交集仍是一个区间
+        if (round) {
+            const D2D1_POINT_2F ends[2] = {a, b};
+            for (const D2D1_POINT_2F &end : ends) {
+                float ey = fy - end.y;
+                float h2 = r2 - ey * ey;
+                if (h2 < -EDGE_EPSILON) continue;
+                float h = sqrtf((std::max)(h2, 0.0f));
+                left = (std::min)(left, end.x - h);
+                right = (std::max)(right, end.x + h);
+            }
+        }
+        if (left <= right) AddRow(y, left, right);
+    }
+}
+
+void StrokeSpans::AddRing(D2D1_POINT_2F center, float radius, float halfWidth) {
+    float outer = radius + halfWidth;
+    float inner = radius - halfWidth;
+    float outer2 = outer * outer;
+    float inner2 = inner > 0 ? inner * inner : 0.0f;
+    int rowFirst = static_cast<int>(ceilf(center.y - outer - EDGE_EPSILON));
+    int rowLast = static_cast<int>(floorf(center.y + outer + EDGE_EPSILON));
+
+    for (int y = rowFirst; y <= rowLast; ++y) {
+        float dy = static_cast<float>(y) - center.y;
+        float dy2 = dy * dy;
+        float wo = sqrtf((std::max)(outer2 - dy2, 0.0f));
+        if (dy2 < inner2) {
+            // 这一行穿过内圆：左右各一段
+            float wi = sqrtf(inner2 - dy2);
+            AddRow(y, center.x - wo, center.x - wi);
+            AddRow(y, center.x + wi, center.x + wo);
+        } else {
+            AddRow(y, center.x - wo, center.x + wo);
+        }
+    }
+}
+
+const std::vector<PixelRun> &StrokeSpans::Finish() {
+    std::sort(m_spans.begin(), m_spans.end(), [](const PixelRun &l, const PixelRun &r) {
+        return l.y != r.y ? l.y < r.y : l.x < r.x;
+    });
+    size_t count = 0;
+    for (size_t i = 0; i < m_spans.size(); ++i) {
+        const PixelRun &span = m_spans[i];
+        if (count > 0) {
+            PixelRun &last = m_spans[count - 1];
+            if (last.y == span.y && span.x <= last.x + last.length) {
+                last.length = (std::max)(last.length, span.x + span.length - last.x);
+                continue;
+            }
+        }
+        m_spans[count++] = span;
+    }
+    m_spans.resize(count);
+    return m_spans;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <d2d1.h>
+#include <vector>
+#include "CommonType.h"
+#include "RasterBatch.h" // PixelRun
+
+// 粗线描边的水平像素段：按扫描行直接求出描边覆盖的像素区间，每个图元每行一到两段，
+// 不再围绕每个中心像素盖圆盘。像素中心在整数坐标上，与像素级画线/画圆算法一致。
+// Finish 之后各段按行、列排序且互不重叠
+class StrokeSpans {
+public:
+    void Clear() {
+        m_spans.clear();
+    }
+
+    // 线段 a-b 的描边：圆头取到线段距离不超过 halfWidth 的像素，平头只取两端点之间的矩形部分
+    void AddSegment(D2D1_POINT_2F a, D2D1_POINT_2F b, float halfWidth, LineCap cap);
+    // 圆环：到圆心距离在 [radius - halfWidth, radius + halfWidth] 内的像素
+    void AddRing(D2D1_POINT_2F center, float radius, float halfWidth);
+
+    // 只保留 keep(x, y) 为真的像素，段在不满足处断开（虚线按像素位置取舍时用）
+    template <typename Pred>
+    void Filter(Pred keep) {
+        std::vector<PixelRun> kept;
+        kept.reserve(m_spans.size());
+        for (const PixelRun &span : m_spans) {
+            int runStart = 0;
+            bool inRun = false;
+            for (int i = 0; i < span.length; ++i) {
+                bool on = keep(span.x + i, span.y);
+                if (on && !inRun) {
+                    runStart = i;
+                    inRun = true;
+                } else if (!on && inRun) {
+                    kept.push_back(PixelRun{span.x + runStart, span.y, i - runStart, 0});
+                    inRun = false;
+                }
+            }
+            if (inRun) kept.push_back(PixelRun{span.x + runStart, span.y, span.length - runStart, 0});
+        }
+        m_spans.swap(kept);
+    }
+
+    // 按行排序并合并重叠、相邻的段
+    const std::vector<PixelRun> &Finish();
+
+    const std::vector<PixelRun> &Spans() const {
+        return m_spans;
+    }
+
+private:
+    std::vector<PixelRun> m_spans;
+
+    // 行 y 上中心落在 [left, right] 内的像素
+    void AddRow(int y, float left, float right);
+};
@@ -0,0 +1,120 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// 基于工作窃取的并行循环
+// 任务区间预先均分给各线程，线程从自己区间的前端取任务；自己的区间做完后，
+// 从其他线程区间的后端窃取一半。图形集中在画布某一区域、各分块工作量差别很大时，各核仍能保持忙碌。
+namespace WorkStealing {
+
+    // 一个线程的任务区间 [begin, end)，打包在一个64位原子量中，所有者与窃取者都通过CAS修改
+    class TaskRange {
+    public:
+        void Reset(uint32_t begin, uint32_t end) {
+            m_range.store(Pack(begin, end));
+        }
+
+        // 所有者从前端取一个任务
+        bool Pop(uint32_t &task) {
+            uint64_t cur = m_range.load();
+            for (;;) {
+                uint32_t b = Begin(cur);
+                uint32_t e = End(cur);
+                if (b >= e) return false;
+                if (m_range.compare_exchange_weak(cur, Pack(b + 1, e))) {
+                    task = b;
+                    return true;
+                }
+            }
+        }
+
+        // 窃取者从后端取走一半任务（至少一个）
+        bool Steal(uint32_t &begin, uint32_t &end) {
+            uint64_t cur = m_range.load();
+            for (;;) {
+                uint32_t b = Begin(cur);
+                uint32_t e = End(cur);
+                if (b >= e) return false;
+                uint32_t mid = e - (e - b + 1) / 2;
+                if (m_range.compare_exchange_weak(cur, Pack(b, mid))) {
+                    begin = mid;
+                    end = e;
+                    return true;
+                }
+            }
+        }
+
+    private:
+        std::atomic<uint64_t> m_range{0};
+
+        static uint64_t Pack(uint32_t begin, uint32_t end) {
+            return (static_cast<uint64_t>(begin) << 32) | end;
+        }
+        static uint32_t Begin(uint64_t range) {
+            return static_cast<uint32_t>(range >> 32);
+        }
+        static uint32_t End(uint64_t range) {
+            return static_cast<uint32_t>(range);
+        }
+    };
+
+    // 实际使用的线程数
+    inline int WorkerCount(int taskCount, int threadCount) {
+        return (std::max)(1, (std::min)(threadCount, taskCount));
+    }
+
+    // 并行执行 fn(taskIndex, workerIndex)，taskIndex 取 [0, taskCount)，workerIndex 取 [0, WorkerCount())
+    // 同一 workerIndex 的调用总在同一线程上串行进行，调用方可以按 workerIndex 准备线程私有的临时缓冲
+    template <typename Fn>
+    void ParallelFor(int taskCount, int threadCount, Fn &&fn) {
+        if (taskCount <= 0) return;
+
+        int workerCount = WorkerCount(taskCount, threadCount);
+        if (workerCount == 1) {
+            for (int i = 0; i < taskCount; ++i) {
+                fn(i, 0);
+            }
+            return;
+        }
+
+        std::unique_ptr<TaskRange[]> ranges(new TaskRange[workerCount]);
+        for (int w = 0; w < workerCount; ++w) {
+            ranges[w].Reset(static_cast<uint32_t>(static_cast<int64_t>(taskCount) * w / workerCount),
+                            static_cast<uint32_t>(static_cast<int64_t>(taskCount) * (w + 1) / workerCount));
+        }
+
+        auto worker = [&](int w) {
+            for (;;) {
+                uint32_t task;
+                while (ranges[w].Pop(task)) {
+                    fn(static_cast<int>(task), w);
+                }
+
+                // 自己的任务已做完，依次尝试从其他线程窃取；所有区间都空时退出
+                bool stolen = false;
+                for (int k = 1; k < workerCount && !stolen; ++k) {
+                    uint32_t begin, end;
+                    if (ranges[(w + k) % workerCount].Steal(begin, end)) {
+                        ranges[w].Reset(begin, end);
+                        stolen = true;
+                    }
+                }
+                if (!stolen) return;
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(workerCount - 1);
+        for (int w = 1; w < workerCount; ++w) {
+            threads.emplace_back(worker, w);
+        }
+        worker(0);
+        for (auto &t : threads) {
+            t.join();
+        }
+    }
+}
@@ -0,0 +1,425 @@
+#include "Benchmark.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <regex>
+#include <sstream>
+#include <thread>
+
+namespace bench {
+    namespace {
+        std::vector<std::unique_ptr<Benchmark>> &Registry() {
+            static std::vector<std::unique_ptr<Benchmark>> benchmarks;
+            return benchmarks;
+        }
+
+        double RealSeconds() {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        // 进程CPU时间：多线程测试中包括所有线程
+        double CpuSeconds() {
+            return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+        }
+
+        const int64_t MAX_ITERATIONS = 1000000000;
+
+        struct Options {
+            std::string filter = ".";
+            double minTime = 0.5;
+            bool json = false;
+            std::string outPath;
+            bool listOnly = false;
+        };
+
+        struct Result {
+            std::string name;
+            int64_t iterations;
+            double realTime; // 每次迭代，按测试的时间单位
+            double cpuTime;
+            TimeUnit unit;
+            double itemsPerSecond;
+            double bytesPerSecond;
+            std::map<std::string, double> counters;
+            std::string label;
+            std::string error;
+        };
+
+        const char *UnitName(TimeUnit unit) {
+            switch (unit) {
+            case TimeUnit::MICROSECOND:
+                return "us";
+            case TimeUnit::MILLISECOND:
+                return "ms";
+            default:
+                return "ns";
+            }
+        }
+
+        double UnitScale(TimeUnit unit) {
+            switch (unit) {
+            case TimeUnit::MICROSECOND:
+                return 1e6;
+            case TimeUnit::MILLISECOND:
+                return 1e3;
+            default:
+                return 1e9;
+            }
+        }
+
+        void WriteJsonString(std::ostream &out, const std::string &text) {
+            out << '"';
+            for (char c : text) {
+                if (c == '"' || c == '\\') {
+                    out << '\\' << c;
+                } else if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned char>(c));
+                    out << escaped;
+                } else {
+                    out << c;
+                }
+            }
+            out << '"';
+        }
+
+        void WriteJsonNumber(std::ostream &out, double value) {
+            char text[32];
+            snprintf(text, sizeof(text), "%.17g", value);
+            out << text;
+        }
+
+        void WriteJson(std::ostream &out, const char *executable, const std::vector<Result> &results) {
+            char date[64] = "";
+            std::time_t now = std::time(nullptr);
+            std::tm local = {};
+#ifdef _MSC_VER
+            localtime_s(&local, &now);
+#else
+            localtime_r(&now, &local);
+#endif
+            std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", &local);
+
+            out << "{\n  \"context\": {\n";
+            out << "    \"date\": ";
+            WriteJsonString(out, date);
+            out << ",\n    \"executable\": ";
+            WriteJsonString(out, executable);
+            out << ",\n    \"num_cpus\": " << std::thread::hardware_concurrency();
+#ifdef NDEBUG
+            out << ",\n    \"library_build_type\": \"release\"\n";
+#else
+            out << ",\n    \"library_build_type\": \"debug\"\n";
+#endif
+            out << "  },\n  \"benchmarks\": [";
+            for (size_t i = 0; i < results.size(); ++i) {
+                const Result &r = results[i];
+                out << (i ? ",\n" : "\n") << "    {\n      \"name\": ";
+                WriteJsonString(out, r.name);
+                out << ",\n      \"run_name\": ";
+                WriteJsonString(out, r.name);
+                out << ",\n      \"run_type\": \"iteration\"";
+                if (!r.error.empty()) {
+                    out << ",\n      \"error_occurred\": true,\n      \"error_message\": ";
+                    WriteJsonString(out, r.error);
+                    out << "\n    }";
+                    continue;
+                }
+                out << ",\n      \"iterations\": " << r.iterations;
+                out << ",\n      \"real_time\": ";
+                WriteJsonNumber(out, r.realTime);
+                out << ",\n      \"cpu_time\": ";
+                WriteJsonNumber(out, r.cpuTime);
+                out << ",\n      \"time_unit\": \"" << UnitName(r.unit) << '"';
+                if (r.bytesPerSecond > 0) {
+                    out << ",\n      \"bytes_per_second\": ";
+                    WriteJsonNumber(out, r.bytesPerSecond);
+                }
+                if (r.itemsPerSecond > 0) {
+                    out << ",\n      \"items_per_second\": ";
+                    WriteJsonNumber(out, r.itemsPerSecond);
+                }
+                for (const auto &counter : r.counters) {
+                    out << ",\n      ";
+                    WriteJsonString(out, counter.first);
+                    out << ": ";
+                    WriteJsonNumber(out, counter.second);
+                }
+                if (!r.label.empty()) {
+                    out << ",\n      \"label\": ";
+                    WriteJsonString(out, r.label);
+                }
+                out << "\n    }";
+            }
+            out << "\n  ]\n}\n";
+        }
+
+        void PrintConsoleHeader(size_t nameWidth) {
+            std::printf("%-*s %15s %15s %12s\n", static_cast<int>(nameWidth), "Benchmark", "Time", "CPU", "Iterations");
+            std::printf("%s\n", std::string(nameWidth + 45, '-').c_str());
+        }
+
+        void PrintConsoleResult(const Result &r, size_t nameWidth) {
+            if (!r.error.empty()) {
+                std::printf("%-*s ERROR: %s\n", static_cast<int>(nameWidth), r.name.c_str(), r.error.c_str());
+                return;
+            }
+            std::printf("%-*s %12.4g %-2s %12.4g %-2s %12lld", static_cast<int>(nameWidth), r.name.c_str(),
+                        r.realTime, UnitName(r.unit), r.cpuTime, UnitName(r.unit),
+                        static_cast<long long>(r.iterations));
+            if (r.itemsPerSecond > 0) std::printf(" items/s=%.4g", r.itemsPerSecond);
+            if (r.bytesPerSecond > 0) std::printf(" bytes/s=%.4g", r.bytesPerSecond);
+            for (const auto &counter : r.counters) {
+                std::printf(" %s=%.4g", counter.first.c_str(), counter.second);
+            }
+            if (!r.label.empty()) std::printf(" %s", r.label.c_str());
+            std::printf("\n");
+            std::fflush(stdout);
+        }
+
+        bool ParseFlag(const char *arg, const char *flag, std::string &value) {
+            size_t length = std::strlen(flag);
+            if (std::strncmp(arg, flag, length) != 0) return false;
+            if (arg[length] == '=') {
+                value = arg + length + 1;
+                return true;
+            }
+            if (arg[length] == '\0') {
+                value.clear();
+                return true;
+            }
+            return false;
+        }
+    }
+
+    State::State(const std::vector<int64_t> &args, int64_t maxIterations) :
+        m_args(args), m_maxIterations(maxIterations), m_remaining(maxIterations), m_running(false),
+        m_realStart(0), m_cpuStart(0), m_realSeconds(0), m_cpuSeconds(0), m_items(0), m_bytes(0) {
+    }
+
+    void State::StartTimer() {
+        if (m_running) return;
+        m_running = true;
+        m_realStart = RealSeconds();
+        m_cpuStart = CpuSeconds();
+    }
+
+    void State::StopTimer() {
+        if (!m_running) return;
+        m_running = false;
+        m_realSeconds += RealSeconds() - m_realStart;
+        m_cpuSeconds += CpuSeconds() - m_cpuStart;
+    }
+
+    Benchmark::Benchmark(const char *name, Function function) :
+        m_name(name), m_function(function), m_multiplier(8), m_unit(TimeUnit::NANOSECOND), m_iterations(0) {
+    }
+
+    Benchmark *Benchmark::Arg(int64_t value) {
+        m_argSets.push_back(std::vector<int64_t>(1, value));
+        return this;
+    }
+
+    Benchmark *Benchmark::Args(const std::vector<int64_t> &values) {
+        m_argSets.push_back(values);
+        return this;
+    }
+
+    Benchmark *Benchmark::Range(int64_t low, int64_t high) {
+        for (int64_t value = low; value < high; value *= m_multiplier) {
+            Arg(value);
+            if (value == 0) break;
+        }
+        return Arg(high);
+    }
+
+    Benchmark *Benchmark::RangeMultiplier(int multiplier) {
+        m_multiplier = multiplier > 1 ? multiplier : 2;
+        return this;
+    }
+
+    Benchmark *Benchmark::ArgsProduct(const std::vector<std::vector<int64_t>> &values) {
+        std::vector<std::vector<int64_t>> product(1);
+        for (const auto &choices : values) {
+            std::vector<std::vector<int64_t>> next;
+            for (const auto &prefix : product) {
+                for (int64_t choice : choices) {
+                    next.push_back(prefix);
+                    next.back().push_back(choice);
+                }
+            }
+            product.swap(next);
+        }
+        m_argSets.insert(m_argSets.end(), product.begin(), product.end());
+        return this;
+    }
+
+    Benchmark *Benchmark::ArgNames(const std::vector<std::string> &names) {
+        m_argNames = names;
+        return this;
+    }
+
+    Benchmark *Benchmark::Unit(TimeUnit unit) {
+        m_unit = unit;
+        return this;
+    }
+
+    Benchmark *Benchmark::Iterations(int64_t iterations) {
+        m_iterations = iterations;
+        return this;
+    }
+
+    Benchmark *RegisterBenchmark(const char *name, Function function) {
+        Registry().emplace_back(new Benchmark(name, function));
+        return Registry().back().get();
+    }
+
+    class Runner {
+    public:
+        // 展开一个测试的所有参数组合为 (名字, 参数)
+        static void Expand(const Benchmark &benchmark, std::vector<std::pair<std::string, std::vector<int64_t>>> &out) {
+            if (benchmark.m_argSets.empty()) {
+                out.emplace_back(benchmark.m_name, std::vector<int64_t>());
+                return;
+            }
+            for (const auto &args : benchmark.m_argSets) {
+                std::ostringstream name;
+                name << benchmark.m_name;
+                for (size_t i = 0; i < args.size(); ++i) {
+                    name << '/';
+                    if (i < benchmark.m_argNames.size() && !benchmark.m_argNames[i].empty()) {
+                        name << benchmark.m_argNames[i] << ':';
+                    }
+                    name << args[i];
+                }
+                out.emplace_back(name.str(), args);
+            }
+        }
+
+        // 与 Google Benchmark 相同的迭代次数确定方式：从1次开始，按已用时间外推，直到单次运行达到最短时间
+        static Result Run(const Benchmark &benchmark, const std::string &name,
+                          const std::vector<int64_t> &args, double minTime) {
+            Result result = {};
+            result.name = name;
+            result.unit = benchmark.m_unit;
+
+            int64_t iterations = benchmark.m_iterations > 0 ? benchmark.m_iterations : 1;
+            for (;;) {
+                State state(args, iterations);
+                benchmark.m_function(state);
+                if (!state.m_error.empty()) {
+                    result.error = state.m_error;
+                    return result;
+                }
+                if (state.m_remaining > 0) {
+                    result.error = "benchmark returned before KeepRunning() finished";
+                    return result;
+                }
+
+                bool done = benchmark.m_iterations > 0 || state.m_realSeconds >= minTime ||
+                            iterations >= MAX_ITERATIONS;
+                if (done) {
+                    double scale = UnitScale(benchmark.m_unit);
+                    result.iterations = iterations;
+                    result.realTime = state.m_realSeconds * scale / iterations;
+                    result.cpuTime = state.m_cpuSeconds * scale / iterations;
+                    if (state.m_realSeconds > 0) {
+                        result.itemsPerSecond = state.m_items / state.m_realSeconds;
+                        result.bytesPerSecond = state.m_bytes / state.m_realSeconds;
+                    }
+                    result.counters = state.counters;
+                    result.label = state.m_label;
+                    return result;
+                }
+
+                // 用时太短时外推不可靠，最多放大10倍
+                double multiplier = state.m_realSeconds > 0 ? minTime * 1.4 / state.m_realSeconds : 10.0;
+                if (state.m_realSeconds / minTime <= 0.1) multiplier = (std::min)(multiplier, 10.0);
+                multiplier = (std::max)(multiplier, 1.0);
+                int64_t next = static_cast<int64_t>(iterations * multiplier + 0.5);
+                iterations = (std::min)((std::max)(next, iterations + 1), MAX_ITERATIONS);
+            }
+        }
+    };
+
+    int RunSpecifiedBenchmarks(int argc, char **argv) {
+        Options options;
+        for (int i = 1; i < argc; ++i) {
+            std::string value;
+            if (ParseFlag(argv[i], "--benchmark_filter", value)) {
+                options.filter = value.empty() ? "." : value;
+            } else if (ParseFlag(argv[i], "--benchmark_min_time", value)) {
+                options.minTime = std::atof(value.c_str());
+                if (options.minTime <= 0) options.minTime = 0.5;
+            } else if (ParseFlag(argv[i], "--benchmark_format", value)) {
+                options.json = value == "json";
+            } else if (ParseFlag(argv[i], "--benchmark_out", value)) {
+                options.outPath = value;
+            } else if (ParseFlag(argv[i], "--benchmark_list_tests", value)) {
+                options.listOnly = true;
+            } else {
+                std::fprintf(stderr, "unknown argument: %s\n", argv[i]);
+                return 1;
+            }
+        }
+
+        std::regex filter;
+        try {
+            filter = std::regex(options.filter);
+        } catch (const std::regex_error &) {
+            std::fprintf(stderr, "invalid --benchmark_filter: %s\n", options.filter.c_str());
+            return 1;
+        }
+
+        std::vector<std::pair<const Benchmark *, std::pair<std::string, std::vector<int64_t>>>> runs;
+        for (const auto &benchmark : Registry()) {
+            std::vector<std::pair<std::string, std::vector<int64_t>>> instances;
+            Runner::Expand(*benchmark, instances);
+            for (auto &instance : instances) {
+                if (std::regex_search(instance.first, filter)) {
+                    runs.emplace_back(benchmark.get(), std::move(instance));
+                }
+            }
+        }
+
+        if (options.listOnly) {
+            for (const auto &run : runs) {
+                std::printf("%s\n", run.second.first.c_str());
+            }
+            return 0;
+        }
+        if (runs.empty()) {
+            std::fprintf(stderr, "no benchmark matches '%s'\n", options.filter.c_str());
+            return 1;
+        }
+
+        size_t nameWidth = 10;
+        for (const auto &run : runs) {
+            nameWidth = (std::max)(nameWidth, run.second.first.size());
+        }
+        if (!options.json) PrintConsoleHeader(nameWidth);
+
+        std::vector<Result> results;
+        for (const auto &run : runs) {
+            results.push_back(Runner::Run(*run.first, run.second.first, run.second.second, options.minTime));
+            if (!options.json) PrintConsoleResult(results.back(), nameWidth);
+        }
+
+        const char *executable = argc > 0 ? argv[0] : "";
+        if (options.json) WriteJson(std::cout, executable, results);
+        if (!options.outPath.empty()) {
+            std::ofstream out(options.outPath.c_str(), std::ios::binary);
+            if (!out) {
+                std::fprintf(stderr, "cannot write %s\n", options.outPath.c_str());
+                return 1;
+            }
+            WriteJson(out, executable, results);
+        }
+        return 0;
+    }
+}
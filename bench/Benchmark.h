@@ -0,0 +1,160 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// 基准测试框架：接口按 Google Benchmark 的写法精简而来（BENCHMARK 注册、KeepRunning 循环、Arg/Range 参数化、
+// 计数器），结果可输出为与 Google Benchmark 相同结构的 JSON，现有的比较脚本可以直接读取。
+// 不依赖第三方库，和被测模块一起编译即可。
+// 命令行参数：
+//   --benchmark_filter=<正则>      只运行名字匹配的测试
+//   --benchmark_min_time=<秒>      每个测试至少运行的时间，默认 0.5
+//   --benchmark_format=console|json 标准输出的格式，默认 console
+//   --benchmark_out=<文件>         另外把 JSON 结果写入文件
+//   --benchmark_list_tests         只列出测试名
+namespace bench {
+    enum class TimeUnit {
+        NANOSECOND,
+        MICROSECOND,
+        MILLISECOND
+    };
+
+    class State {
+    public:
+        State(const std::vector<int64_t> &args, int64_t maxIterations);
+
+        // 每次循环调用一次：第一次调用时开始计时，达到迭代次数后停止计时并返回 false
+        bool KeepRunning() {
+            if (m_remaining > 0) {
+                if (m_remaining == m_maxIterations) StartTimer();
+                --m_remaining;
+                return true;
+            }
+            if (m_running) StopTimer();
+            return false;
+        }
+
+        // 暂停计时，用于排除每次迭代中的准备工作
+        void PauseTiming() {
+            StopTimer();
+        }
+        void ResumeTiming() {
+            StartTimer();
+        }
+
+        int64_t range(size_t index = 0) const {
+            return index < m_args.size() ? m_args[index] : 0;
+        }
+        int64_t iterations() const {
+            return m_maxIterations;
+        }
+
+        // 总处理量，输出为每秒处理量
+        void SetItemsProcessed(int64_t items) {
+            m_items = items;
+        }
+        void SetBytesProcessed(int64_t bytes) {
+            m_bytes = bytes;
+        }
+        void SetLabel(const std::string &label) {
+            m_label = label;
+        }
+        // 测试无法运行时调用，结果中记录错误信息
+        void SkipWithError(const char *message) {
+            m_error = message;
+            m_remaining = 0;
+        }
+
+        // 自定义计数器，原样写入结果
+        std::map<std::string, double> counters;
+
+    private:
+        friend class Runner;
+
+        std::vector<int64_t> m_args;
+        int64_t m_maxIterations;
+        int64_t m_remaining;
+        bool m_running;
+        double m_realStart, m_cpuStart;
+        double m_realSeconds, m_cpuSeconds;
+        int64_t m_items, m_bytes;
+        std::string m_label;
+        std::string m_error;
+
+        void StartTimer();
+        void StopTimer();
+    };
+
+    typedef void (*Function)(State &state);
+
+    // 一个注册的测试，参数化方法可以链式调用
+    class Benchmark {
+    public:
+        Benchmark(const char *name, Function function);
+
+        Benchmark *Arg(int64_t value);
+        Benchmark *Args(const std::vector<int64_t> &values);
+        // 从 low 到 high 按倍数取参数（含两端），倍数默认 8
+        Benchmark *Range(int64_t low, int64_t high);
+        Benchmark *RangeMultiplier(int multiplier);
+        // 多个参数的取值组合（笛卡尔积）
+        Benchmark *ArgsProduct(const std::vector<std::vector<int64_t>> &values);
+        Benchmark *ArgNames(const std::vector<std::string> &names);
+        Benchmark *Unit(TimeUnit unit);
+        // 固定迭代次数，不按最短时间自动确定
+        Benchmark *Iterations(int64_t iterations);
+
+    private:
+        friend class Runner;
+
+        std::string m_name;
+        Function m_function;
+        std::vector<std::vector<int64_t>> m_argSets;
+        std::vector<std::string> m_argNames;
+        int m_multiplier;
+        TimeUnit m_unit;
+        int64_t m_iterations;
+    };
+
+    Benchmark *RegisterBenchmark(const char *name, Function function);
+
+    // 解析命令行并运行所有匹配的测试，返回进程退出码
+    int RunSpecifiedBenchmarks(int argc, char **argv);
+
+    // 阻止编译器把结果当作无用计算删除
+    template <typename T>
+    inline void DoNotOptimize(T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : "+m,r"(value) : : "memory");
+#else
+        const volatile void *sink = &value;
+        (void)sink;
+        _ReadWriteBarrier();
+#endif
+    }
+    template <typename T>
+    inline void DoNotOptimize(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        const volatile void *sink = &value;
+        (void)sink;
+        _ReadWriteBarrier();
+#endif
+    }
+}
+
+#define BENCHMARK_CONCAT_INNER(a, b) a##b
+#define BENCHMARK_CONCAT(a, b) BENCHMARK_CONCAT_INNER(a, b)
+// 注册测试函数，可接参数化调用：BENCHMARK(BM_Foo)->Range(8, 4096);
+#define BENCHMARK(function) \
+    static bench::Benchmark *BENCHMARK_CONCAT(benchmark_, __LINE__) = bench::RegisterBenchmark(#function, function)
+#define BENCHMARK_MAIN() \
+    int main(int argc, char **argv) { \
+        return bench::RunSpecifiedBenchmarks(argc, argv); \
+    }
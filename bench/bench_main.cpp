@@ -0,0 +1,1380 @@
+// 算法模块的无界面基准测试。
+// 不依赖窗口和Direct2D设备：在Linux等平台用 bench/shim 中的最小 Windows/Direct2D 头文件编译，
+// 在Windows上也可以直接用系统头文件编译。在仓库根目录（一条命令）：
+//   g++ -O2 -std=c++14 -pthread -DNDEBUG -Ibench/shim -I. -o exp2_bench bench/*.cpp
+//       Shape.cpp CommonType.cpp PixelPattern.cpp DocumentArena.cpp StrokeSpans.cpp DeviceResourceCache.cpp
+//       Log.cpp Profiler.cpp FillAlgorithms.cpp IntersectionManager.cpp LineClipping.cpp PolygonClipping.cpp
+//       RasterBatch.cpp ShapeStore.cpp DocumentHistory.cpp SoftwareRasterizer.cpp GraphicsEngine.cpp Overlay.cpp
+//       FillJobs.cpp
+//   ./exp2_bench --benchmark_format=json --benchmark_out=bench.json
+// 参数说明见 Benchmark.h。所有输入由固定种子生成，不同次运行的工作量相同
+#include "Benchmark.h"
+#include "DeviceResourceCache.h"
+#include "DocumentArena.h"
+#include "DocumentHistory.h"
+#include "FillAlgorithms.h"
+#include "FillJobs.h"
+#include "GraphicsEngine.h"
+#include "IntersectionManager.h"
+#include "LineClipping.h"
+#include "Log.h"
+#include "PixelPattern.h"
+#include "PolygonClipping.h"
+#include "Profiler.h"
+#include "RasterBatch.h"
+#include "RenderThread.h"
+#include "Shape.h"
+#include "ShapeStore.h"
+#include "SoftwareRasterizer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    const float CANVAS_WIDTH = 1024.0f;
+    const float CANVAS_HEIGHT = 768.0f;
+    const float PI = 3.14159265f;
+
+    class Random {
+    public:
+        explicit Random(unsigned seed = 12345) : m_engine(seed) {
+        }
+        float Uniform(float low, float high) {
+            return std::uniform_real_distribution<float>(low, high)(m_engine);
+        }
+        D2D1_POINT_2F Point(float width = CANVAS_WIDTH, float height = CANVAS_HEIGHT) {
+            return D2D1::Point2F(Uniform(0, width), Uniform(0, height));
+        }
+
+    private:
+        std::mt19937 m_engine;
+    };
+
+    // 以 center 为中心、半径在 [inner, outer] 之间交替的星形多边形，顶点数 count（凹多边形）
+    std::vector<D2D1_POINT_2F> StarPolygon(D2D1_POINT_2F center, float inner, float outer, size_t count,
+                                           float phase = 0.0f) {
+        std::vector<D2D1_POINT_2F> points(count);
+        for (size_t i = 0; i < count; ++i) {
+            float angle = phase + 2.0f * PI * i / count;
+            float radius = (i % 2) ? inner : outer;
+            points[i] = D2D1::Point2F(center.x + radius * std::cos(angle), center.y + radius * std::sin(angle));
+        }
+        return points;
+    }
+
+    // 按类型生成一个位于画布内的图形，size 为大致尺寸
+    std::shared_ptr<Shape> MakeShape(ShapeType type, Random &random, float size,
+                                     float canvasWidth = CANVAS_WIDTH, float canvasHeight = CANVAS_HEIGHT) {
+        D2D1_POINT_2F c = random.Point(canvasWidth - size, canvasHeight - size);
+        c.x += size * 0.5f;
+        c.y += size * 0.5f;
+        float h = size * 0.5f;
+        switch (type) {
+        case ShapeType::LINE:
+            return MakeDocumentShared<Line>(D2D1::Point2F(c.x - h, c.y - h * 0.3f), D2D1::Point2F(c.x + h, c.y + h * 0.3f));
+        case ShapeType::CIRCLE:
+            return MakeDocumentShared<Circle>(c, h);
+        case ShapeType::RECTANGLE:
+            return MakeDocumentShared<Rect>(D2D1::Point2F(c.x - h, c.y - h * 0.6f), D2D1::Point2F(c.x + h, c.y + h * 0.6f));
+        case ShapeType::TRIANGLE:
+            return MakeDocumentShared<Triangle>(D2D1::Point2F(c.x, c.y - h), D2D1::Point2F(c.x - h, c.y + h),
+                                                D2D1::Point2F(c.x + h, c.y + h));
+        case ShapeType::DIAMOND:
+            return MakeDocumentShared<Diamond>(c, h, h * 0.7f);
+        case ShapeType::PARALLELOGRAM:
+            return MakeDocumentShared<Parallelogram>(D2D1::Point2F(c.x - h, c.y + h * 0.5f), D2D1::Point2F(c.x - h * 0.5f, c.y - h * 0.5f),
+                                                     D2D1::Point2F(c.x + h, c.y - h * 0.5f));
+        case ShapeType::CURVE:
+            return MakeDocumentShared<Curve>(D2D1::Point2F(c.x - h, c.y), D2D1::Point2F(c.x - h * 0.3f, c.y - h),
+                                             D2D1::Point2F(c.x + h * 0.3f, c.y + h), D2D1::Point2F(c.x + h, c.y));
+        case ShapeType::POLYLINE: {
+            std::vector<D2D1_POINT_2F> points = StarPolygon(c, h * 0.5f, h, 12);
+            return MakeDocumentShared<Poly>(points);
+        }
+        case ShapeType::MULTI_BEZIER: {
+            auto bezier = MakeDocumentShared<MultiBezier>();
+            bezier->SetControlPoints(StarPolygon(c, h * 0.5f, h, 8));
+            return bezier;
+        }
+        case ShapeType::POLYGON:
+        default:
+            return MakeDocumentShared<Polygon>(StarPolygon(c, h * 0.5f, h, 12));
+        }
+    }
+
+    const ShapeType ALL_TYPES[] = {
+        ShapeType::LINE, ShapeType::CIRCLE, ShapeType::RECTANGLE, ShapeType::TRIANGLE, ShapeType::DIAMOND,
+        ShapeType::PARALLELOGRAM, ShapeType::CURVE, ShapeType::POLYLINE, ShapeType::MULTI_BEZIER, ShapeType::POLYGON
+    };
+    const int TYPE_COUNT = static_cast<int>(sizeof(ALL_TYPES) / sizeof(ALL_TYPES[0]));
+    const char *const TYPE_NAMES[] = {
+        "LINE", "CIRCLE", "RECTANGLE", "TRIANGLE", "DIAMOND",
+        "PARALLELOGRAM", "CURVE", "POLYLINE", "MULTI_BEZIER", "POLYGON"
+    };
+
+    // 各类图形混合的文档
+    std::vector<std::shared_ptr<Shape>> MakeDocument(size_t count, float size = 40.0f, unsigned seed = 12345,
+                                                     float canvasWidth = CANVAS_WIDTH, float canvasHeight = CANVAS_HEIGHT) {
+        Random random(seed);
+        std::vector<std::shared_ptr<Shape>> shapes;
+        shapes.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            shapes.push_back(MakeShape(ALL_TYPES[i % TYPE_COUNT], random, size, canvasWidth, canvasHeight));
+        }
+        return shapes;
+    }
+
+    SegmentBatch MakeSegments(size_t count, float extent) {
+        Random random;
+        SegmentBatch segments;
+        segments.Reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            D2D1_POINT_2F a = random.Point();
+            D2D1_POINT_2F b = D2D1::Point2F(a.x + random.Uniform(-extent, extent), a.y + random.Uniform(-extent, extent));
+            segments.Add(a, b);
+        }
+        return segments;
+    }
+
+    // 文档区需要在运行测试的线程上设置
+    void EnsureDocumentArena() {
+        if (!DocumentArena::Current()) DocumentArena::BeginDocument();
+    }
+}
+
+// ---------------------------------------------------------------------------
+// 直线、圆的像素生成
+
+static void BM_MidpointLinePattern(bench::State &state) {
+    int length = static_cast<int>(state.range(0));
+    int dy = length * 3 / 7;
+    size_t pixels = 0;
+    while (state.KeepRunning()) {
+        PixelPatternPtr pattern = PixelPatterns::MidpointLine(length, dy);
+        pixels += pattern->size();
+        bench::DoNotOptimize(pattern);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(pixels));
+}
+BENCHMARK(BM_MidpointLinePattern)->Range(16, 4096);
+
+static void BM_BresenhamLinePattern(bench::State &state) {
+    int length = static_cast<int>(state.range(0));
+    int dy = length * 3 / 7;
+    size_t pixels = 0;
+    while (state.KeepRunning()) {
+        PixelPatternPtr pattern = PixelPatterns::BresenhamLine(length, dy);
+        pixels += pattern->size();
+        bench::DoNotOptimize(pattern);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(pixels));
+}
+BENCHMARK(BM_BresenhamLinePattern)->Range(16, 4096);
+
+// 圆模板按半径缓存弱引用，每次迭代释放后重新生成
+static void BM_MidpointCirclePattern(bench::State &state) {
+    int radius = static_cast<int>(state.range(0));
+    size_t pixels = 0;
+    while (state.KeepRunning()) {
+        PixelPatternPtr pattern = PixelPatterns::MidpointCircle(radius);
+        pixels += pattern->size();
+        bench::DoNotOptimize(pattern);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(pixels));
+}
+BENCHMARK(BM_MidpointCirclePattern)->Range(8, 2048);
+
+static void BM_BresenhamCirclePattern(bench::State &state) {
+    int radius = static_cast<int>(state.range(0));
+    size_t pixels = 0;
+    while (state.KeepRunning()) {
+        PixelPatternPtr pattern = PixelPatterns::BresenhamCircle(radius);
+        pixels += pattern->size();
+        bench::DoNotOptimize(pattern);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(pixels));
+}
+BENCHMARK(BM_BresenhamCirclePattern)->Range(8, 2048);
+
+// 批量光栅化与逐条生成像素数组的对比：同样 n 条随机线段
+static void BM_LinesPerPixel(bench::State &state) {
+    SegmentBatch lines = MakeSegments(static_cast<size_t>(state.range(0)), 64.0f);
+    std::vector<D2D1_POINT_2F> pixels;
+    while (state.KeepRunning()) {
+        size_t total = 0;
+        for (size_t i = 0; i < lines.Size(); ++i) {
+            int x0 = static_cast<int>(lines.x0[i]), y0 = static_cast<int>(lines.y0[i]);
+            PixelPatternPtr pattern = PixelPatterns::MidpointLine(static_cast<int>(lines.x1[i]) - x0,
+                                                                  static_cast<int>(lines.y1[i]) - y0);
+            PixelPatterns::Expand(*pattern, D2D1::Point2F(static_cast<float>(x0), static_cast<float>(y0)), pixels);
+            total += pixels.size();
+        }
+        bench::DoNotOptimize(total);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LinesPerPixel)->Range(1 << 12, 1 << 20)->Unit(bench::TimeUnit::MILLISECOND);
+
+static void BM_RasterizeLines(bench::State &state) {
+    SegmentBatch lines = MakeSegments(static_cast<size_t>(state.range(0)), 64.0f);
+    std::vector<PixelRun> runs(RasterBatch::CountLineRuns(lines, nullptr));
+    size_t written = 0;
+    while (state.KeepRunning()) {
+        written = RasterBatch::RasterizeLines(lines, runs.data(), nullptr);
+        bench::DoNotOptimize(written);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["runs"] = static_cast<double>(written);
+}
+BENCHMARK(BM_RasterizeLines)->Range(1 << 12, 1 << 20)->Unit(bench::TimeUnit::MILLISECOND);
+
+static void BM_RasterizeCircles(bench::State &state) {
+    Random random;
+    CircleBatch circles;
+    size_t count = static_cast<size_t>(state.range(0));
+    circles.Reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        circles.Add(random.Point(), random.Uniform(2.0f, 64.0f));
+    }
+    std::vector<PixelRun> runs(RasterBatch::CircleRunCapacity(circles, nullptr));
+    while (state.KeepRunning()) {
+        size_t written = RasterBatch::RasterizeCircles(circles, CircleAlgorithm::MIDPOINT, runs.data(), nullptr);
+        bench::DoNotOptimize(written);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RasterizeCircles)->Range(1 << 10, 1 << 18)->Unit(bench::TimeUnit::MILLISECOND);
+
+// ---------------------------------------------------------------------------
+// 区域填充：在尺寸为 n 的矩形、圆内部从中心开始填充
+
+static void FillBenchmark(bench::State &state, ShapeType type, bool scanline) {
+    EnsureDocumentArena();
+    float size = static_cast<float>(state.range(0));
+    std::shared_ptr<Shape> shape;
+    D2D1_POINT_2F center = D2D1::Point2F(size, size);
+    if (type == ShapeType::CIRCLE) {
+        shape = MakeDocumentShared<Circle>(center, size * 0.5f);
+    } else {
+        shape = MakeDocumentShared<Rect>(D2D1::Point2F(size * 0.5f, size * 0.5f), D2D1::Point2F(size * 1.5f, size * 1.5f));
+    }
+    size_t pixels = 0;
+    while (state.KeepRunning()) {
+        std::vector<D2D1_POINT_2F> filled = scanline ? FillAlgorithms::ScanlineFill(shape.get(), center)
+                                                     : FillAlgorithms::SeedFill(shape.get(), center);
+        pixels += filled.size();
+        bench::DoNotOptimize(filled);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(pixels));
+}
+
+static void BM_ScanlineFillRect(bench::State &state) {
+    FillBenchmark(state, ShapeType::RECTANGLE, true);
+}
+BENCHMARK(BM_ScanlineFillRect)->RangeMultiplier(4)->Range(16, 1024)->Unit(bench::TimeUnit::MICROSECOND);
+
+static void BM_ScanlineFillCircle(bench::State &state) {
+    FillBenchmark(state, ShapeType::CIRCLE, true);
+}
+BENCHMARK(BM_ScanlineFillCircle)->RangeMultiplier(4)->Range(16, 1024)->Unit(bench::TimeUnit::MICROSECOND);
+
+static void BM_SeedFillRect(bench::State &state) {
+    FillBenchmark(state, ShapeType::RECTANGLE, false);
+}
+BENCHMARK(BM_SeedFillRect)->RangeMultiplier(4)->Range(16, 1024)->Unit(bench::TimeUnit::MICROSECOND);
+
+static void BM_SeedFillCircle(bench::State &state) {
+    FillBenchmark(state, ShapeType::CIRCLE, false);
+}
+BENCHMARK(BM_SeedFillCircle)->RangeMultiplier(4)->Range(16, 1024)->Unit(bench::TimeUnit::MICROSECOND);
+
+// 分带并行的扫描线填充：直径 4096 的圆（约 1300 万像素）和 1024 个顶点的星形多边形，range(0) 个线程。
+// 检查结果与单线程逐位一致
+static void ScanlineFillScaling(bench::State &state, const std::shared_ptr<Shape> &shape, D2D1_POINT_2F seed) {
+    int threads = static_cast<int>(state.range(0));
+    std::vector<D2D1_POINT_2F> reference = FillAlgorithms::ScanlineFill(shape.get(), seed);
+    size_t pixels = 0;
+    bool same = true;
+    while (state.KeepRunning()) {
+        std::vector<D2D1_POINT_2F> filled = FillAlgorithms::ScanlineFill(shape.get(), seed, nullptr, threads);
+        pixels += filled.size();
+        state.PauseTiming();
+        same = same && filled.size() == reference.size() &&
+               std::equal(filled.begin(), filled.end(), reference.begin(), [](D2D1_POINT_2F a, D2D1_POINT_2F b) {
+                   return a.x == b.x && a.y == b.y;
+               });
+        state.ResumeTiming();
+    }
+    if (!same) {
+        state.SkipWithError("banded fill differs from single-threaded fill");
+        return;
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(pixels));
+}
+
+static void BM_ScanlineFillThreadsCircle(bench::State &state) {
+    EnsureDocumentArena();
+    std::shared_ptr<Shape> shape = MakeDocumentShared<Circle>(D2D1::Point2F(2048.0f, 2048.0f), 2048.0f);
+    ScanlineFillScaling(state, shape, shape->GetCenter());
+}
+BENCHMARK(BM_ScanlineFillThreadsCircle)->RangeMultiplier(2)->Range(1, 32)->ArgNames({"threads"})
+    ->Unit(bench::TimeUnit::MILLISECOND);
+
+static void BM_ScanlineFillThreadsStar(bench::State &state) {
+    EnsureDocumentArena();
+    // 内外半径交替的锯齿形，边表有 1024 条边，活性边表逐行增删
+    std::vector<D2D1_POINT_2F> points;
+    const int vertices = 1024;
+    for (int i = 0; i < vertices; ++i) {
+        float angle = 6.2831853f * i / vertices;
+        float radius = (i % 2) ? 1200.0f : 2000.0f;
+        points.push_back(D2D1::Point2F(2048.0f + radius * std::cos(angle), 2048.0f + radius * std::sin(angle)));
+    }
+    std::shared_ptr<Shape> shape = MakeDocumentShared<Poly>(points);
+    ScanlineFillScaling(state, shape, D2D1::Point2F(2048.0f, 2048.0f));
+}
+BENCHMARK(BM_ScanlineFillThreadsStar)->RangeMultiplier(2)->Range(1, 32)->ArgNames({"threads"})
+    ->Unit(bench::TimeUnit::MILLISECOND);
+
+// 后台填充：range(0) 个工作线程同时填充 8 个互不相关的圆（直径 256，扫描线填充），
+// 每次迭代提交全部任务并等待结束，检查每个任务都产生了结果
+static void BM_FillJobsConcurrent(bench::State &state) {
+    EnsureDocumentArena();
+    const int jobCount = 8;
+    std::vector<std::shared_ptr<Shape>> shapes;
+    for (int i = 0; i < jobCount; ++i) {
+        shapes.push_back(MakeDocumentShared<Circle>(D2D1::Point2F(200.0f + 300.0f * i, 200.0f), 128.0f));
+    }
+    FillJobQueue queue(static_cast<int>(state.range(0)));
+    size_t pixels = 0;
+    while (state.KeepRunning()) {
+        for (int i = 0; i < jobCount; ++i) {
+            ShapeHandle handle;
+            handle.slot = static_cast<uint32_t>(i);
+            queue.Submit(shapes[i]->Clone(), handle, shapes[i]->GetCenter(), FillJobQueue::Algorithm::SCANLINE);
+        }
+        queue.WaitIdle();
+        std::vector<FillJobQueue::Result> results = queue.TakeResults();
+        if (results.size() != static_cast<size_t>(jobCount)) {
+            state.SkipWithError("fill job lost");
+            return;
+        }
+        for (const auto &result : results) {
+            pixels += result.pixels.size();
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(pixels));
+}
+BENCHMARK(BM_FillJobsConcurrent)->Arg(1)->Arg(2)->Arg(4)->ArgNames({"threads"})->Unit(bench::TimeUnit::MILLISECOND);
+
+// 取消延迟：大圆（直径 range(0)）的种子填充运行 2ms 后取消，计时从取消到任务结束；
+// 被取消的任务不能产生结果
+static void BM_FillJobCancel(bench::State &state) {
+    EnsureDocumentArena();
+    float radius = static_cast<float>(state.range(0)) * 0.5f;
+    std::shared_ptr<Shape> shape = MakeDocumentShared<Circle>(D2D1::Point2F(radius, radius), radius);
+    FillJobQueue queue(1);
+    ShapeHandle handle;
+    handle.slot = 0;
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        queue.Submit(shape->Clone(), handle, shape->GetCenter(), FillJobQueue::Algorithm::SEED);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        state.ResumeTiming();
+        queue.Cancel(handle);
+        queue.WaitIdle();
+    }
+    if (!queue.TakeResults().empty()) {
+        state.SkipWithError("cancelled fill produced a result");
+    }
+}
+BENCHMARK(BM_FillJobCancel)->Arg(1024)->ArgNames({"size"})->Unit(bench::TimeUnit::MICROSECOND);
+
+// ---------------------------------------------------------------------------
+// 求交：每对有求交实现的图形类型各测一次（参数为 ALL_TYPES 下标），两个图形有重叠
+
+static void BM_Intersection(bench::State &state) {
+    EnsureDocumentArena();
+    int a = static_cast<int>(state.range(0));
+    int b = static_cast<int>(state.range(1));
+    Random random;
+    std::shared_ptr<Shape> first = MakeShape(ALL_TYPES[a], random, 200.0f);
+    std::shared_ptr<Shape> second = MakeShape(ALL_TYPES[b], random, 200.0f);
+    // 移到同一中心附近，保证有交点
+    D2D1_POINT_2F c1 = first->GetCenter();
+    D2D1_POINT_2F c2 = second->GetCenter();
+    second->Move(c1.x - c2.x + 30.0f, c1.y - c2.y + 20.0f);
+
+    IntersectionManager &manager = IntersectionManager::getInstance();
+    size_t points = 0;
+    while (state.KeepRunning()) {
+        manager.clear();
+        manager.selectShape(first);
+        manager.selectShape(second);
+        points = manager.calculateIntersection().size();
+    }
+    manager.clear();
+    state.SetLabel(std::string(TYPE_NAMES[a]) + " x " + TYPE_NAMES[b]);
+    state.counters["points"] = static_cast<double>(points);
+}
+static bench::Benchmark *RegisterIntersectionPairs() {
+    bench::Benchmark *benchmark = bench::RegisterBenchmark("BM_Intersection", BM_Intersection);
+    // 多点Bezier曲线和多边形没有求交实现
+    const int KERNEL_TYPE_COUNT = 8;
+    for (int a = 0; a < KERNEL_TYPE_COUNT; ++a) {
+        for (int b = a; b < KERNEL_TYPE_COUNT; ++b) {
+            benchmark->Args({a, b});
+        }
+    }
+    return benchmark->ArgNames({"a", "b"});
+}
+static bench::Benchmark *g_intersectionPairs = RegisterIntersectionPairs();
+
+// 多段线对多段线，顶点数 n
+static void BM_IntersectionPolyline(bench::State &state) {
+    EnsureDocumentArena();
+    size_t count = static_cast<size_t>(state.range(0));
+    D2D1_POINT_2F center = D2D1::Point2F(CANVAS_WIDTH * 0.5f, CANVAS_HEIGHT * 0.5f);
+    auto first = MakeDocumentShared<Poly>(StarPolygon(center, 150.0f, 300.0f, count));
+    auto second = MakeDocumentShared<Poly>(StarPolygon(center, 150.0f, 300.0f, count, 0.5f * PI / count));
+    IntersectionManager &manager = IntersectionManager::getInstance();
+    size_t points = 0;
+    while (state.KeepRunning()) {
+        manager.clear();
+        manager.selectShape(first);
+        manager.selectShape(second);
+        points = manager.calculateIntersection().size();
+    }
+    manager.clear();
+    state.counters["points"] = static_cast<double>(points);
+}
+BENCHMARK(BM_IntersectionPolyline)->Range(16, 4096)->Unit(bench::TimeUnit::MICROSECOND);
+
+// 离散线段：回调访问与生成线段数组的对比
+static void BM_VisitIntersectionSegments(bench::State &state) {
+    EnsureDocumentArena();
+    D2D1_POINT_2F center = D2D1::Point2F(CANVAS_WIDTH * 0.5f, CANVAS_HEIGHT * 0.5f);
+    auto polygon = MakeDocumentShared<Polygon>(StarPolygon(center, 150.0f, 300.0f, static_cast<size_t>(state.range(0))));
+    while (state.KeepRunning()) {
+        float sum = 0;
+        polygon->ForEachIntersectionSegment([&sum](D2D1_POINT_2F a, D2D1_POINT_2F b) {
+            sum += a.x + b.y;
+        });
+        bench::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_VisitIntersectionSegments)->Range(16, 4096);
+
+static void BM_GetIntersectionSegments(bench::State &state) {
+    EnsureDocumentArena();
+    D2D1_POINT_2F center = D2D1::Point2F(CANVAS_WIDTH * 0.5f, CANVAS_HEIGHT * 0.5f);
+    auto polygon = MakeDocumentShared<Polygon>(StarPolygon(center, 150.0f, 300.0f, static_cast<size_t>(state.range(0))));
+    while (state.KeepRunning()) {
+        float sum = 0;
+        for (const auto &segment : polygon->GetIntersectionSegments()) {
+            sum += segment.first.x + segment.second.y;
+        }
+        bench::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_GetIntersectionSegments)->Range(16, 4096);
+
+// De Casteljau：多点Bezier曲线离散为线段（控制点数 n）
+static void BM_DeCasteljau(bench::State &state) {
+    EnsureDocumentArena();
+    Random random;
+    auto bezier = MakeDocumentShared<MultiBezier>();
+    std::vector<D2D1_POINT_2F> points;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        points.push_back(random.Point());
+    }
+    bezier->SetControlPoints(points);
+    size_t segments = 0;
+    while (state.KeepRunning()) {
+        segments = 0;
+        bezier->ForEachIntersectionSegment([&segments](D2D1_POINT_2F, D2D1_POINT_2F) {
+            ++segments;
+        });
+        bench::DoNotOptimize(segments);
+    }
+    state.counters["segments"] = static_cast<double>(segments);
+}
+BENCHMARK(BM_DeCasteljau)->RangeMultiplier(2)->Range(3, 64)->Unit(bench::TimeUnit::MICROSECOND);
+
+// ---------------------------------------------------------------------------
+// 裁剪
+
+static const ClipWindow CLIP_WINDOW = {200.0f, 150.0f, 824.0f, 618.0f};
+
+static void BM_LiangBarskyScalar(bench::State &state) {
+    SegmentBatch segments = MakeSegments(static_cast<size_t>(state.range(0)), 400.0f);
+    size_t n = segments.Size();
+    std::vector<float> t0(n), t1(n);
+    while (state.KeepRunning()) {
+        size_t accepted = 0;
+        for (size_t i = 0; i < n; ++i) {
+            accepted += LineClipping::ClipParams(D2D1::Point2F(segments.x0[i], segments.y0[i]),
+                                                 D2D1::Point2F(segments.x1[i], segments.y1[i]),
+                                                 CLIP_WINDOW, t0[i], t1[i]);
+        }
+        bench::DoNotOptimize(accepted);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LiangBarskyScalar)->Range(1 << 10, 1 << 20)->Unit(bench::TimeUnit::MICROSECOND);
+
+static void BM_LiangBarskyBatch(bench::State &state) {
+    SegmentBatch segments = MakeSegments(static_cast<size_t>(state.range(0)), 400.0f);
+    size_t n = segments.Size();
+    std::vector<float> t0(n), t1(n);
+    std::vector<uint8_t> accepted(n);
+    while (state.KeepRunning()) {
+        LineClipping::ClipParamsBatch(segments, CLIP_WINDOW, t0.data(), t1.data(), accepted.data());
+        bench::DoNotOptimize(accepted);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LiangBarskyBatch)->Range(1 << 10, 1 << 20)->Unit(bench::TimeUnit::MICROSECOND);
+
+// 4个窗口
+static void BM_LiangBarskyMultiWindow(bench::State &state) {
+    SegmentBatch segments = MakeSegments(static_cast<size_t>(state.range(0)), 400.0f);
+    const ClipWindow windows[] = {
+        {0, 0, 512, 384}, {512, 0, 1024, 384}, {0, 384, 512, 768}, {256, 192, 768, 576}
+    };
+    ClippedSegments out;
+    while (state.KeepRunning()) {
+        LineClipping::ClipBatch(segments, windows, 4, out);
+        bench::DoNotOptimize(out);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["output"] = static_cast<double>(out.segments.Size());
+}
+BENCHMARK(BM_LiangBarskyMultiWindow)->Range(1 << 10, 1 << 20)->Unit(bench::TimeUnit::MICROSECOND);
+
+// 文档级裁剪：每次迭代复制文档后裁剪（复制不计时）
+static void BM_ClipShapes(bench::State &state) {
+    EnsureDocumentArena();
+    std::vector<std::shared_ptr<Shape>> document = MakeDocument(static_cast<size_t>(state.range(0)), 120.0f);
+    std::vector<std::shared_ptr<Shape>> shapes;
+    size_t changed = 0;
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        shapes = document;
+        state.ResumeTiming();
+        changed = LineClipping::ClipShapes(shapes, &CLIP_WINDOW, 1);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["changed"] = static_cast<double>(changed);
+}
+BENCHMARK(BM_ClipShapes)->Range(1000, 100000)->Unit(bench::TimeUnit::MILLISECOND);
+
+// 参数：多边形数、每个多边形的顶点数
+static void SutherlandHodgmanInput(bench::State &state, PolygonArena &input) {
+    Random random;
+    size_t polygons = static_cast<size_t>(state.range(0));
+    size_t vertices = static_cast<size_t>(state.range(1));
+    input.Reserve(polygons * vertices, polygons);
+    for (size_t i = 0; i < polygons; ++i) {
+        std::vector<D2D1_POINT_2F> polygon = StarPolygon(random.Point(), 60.0f, 180.0f, vertices, random.Uniform(0, PI));
+        input.Add(polygon.data(), polygon.size());
+    }
+}
+
+// 改为流水线裁剪器之前 MainWindow::SutherlandHodgmanClip 的原样副本，作为对比基准：
+// 四条边界各整表裁剪一遍，每遍复制一次顶点表
+static std::vector<D2D1_POINT_2F> BaselineSutherlandHodgmanClip(
+    const std::vector<D2D1_POINT_2F>& polygon,
+    float xmin, float ymin, float xmax, float ymax) {
+    
+    if (polygon.size() < 3) return polygon;
+    
+    std::vector<D2D1_POINT_2F> output = polygon;
+    
+    // 对四条边界依次裁剪：左、右、下、上
+    for (int edge = 0; edge < 4; edge++) {
+        if (output.empty()) break;
+        
+        std::vector<D2D1_POINT_2F> input = output;
+        output.clear();
+        
+        for (size_t i = 0; i < input.size(); i++) {
+            D2D1_POINT_2F current = input[i];
+            D2D1_POINT_2F next = input[(i + 1) % input.size()];
+            
+            bool currentInside = false;
+            bool nextInside = false;
+            D2D1_POINT_2F intersection;
+            
+            // 根据当前边界判断点是否在内侧，并计算交点
+            switch (edge) {
+            case 0: // 左边界 x = xmin
+                currentInside = (current.x >= xmin);
+                nextInside = (next.x >= xmin);
+                if (currentInside != nextInside) {
+                    float t = (xmin - current.x) / (next.x - current.x);
+                    intersection = D2D1::Point2F(xmin, current.y + t * (next.y - current.y));
+                }
+                break;
+            case 1: // 右边界 x = xmax
+                currentInside = (current.x <= xmax);
+                nextInside = (next.x <= xmax);
+                if (currentInside != nextInside) {
+                    float t = (xmax - current.x) / (next.x - current.x);
+                    intersection = D2D1::Point2F(xmax, current.y + t * (next.y - current.y));
+                }
+                break;
+            case 2: // 下边界 y = ymin
+                currentInside = (current.y >= ymin);
+                nextInside = (next.y >= ymin);
+                if (currentInside != nextInside) {
+                    float t = (ymin - current.y) / (next.y - current.y);
+                    intersection = D2D1::Point2F(current.x + t * (next.x - current.x), ymin);
+                }
+                break;
+            case 3: // 上边界 y = ymax
+                currentInside = (current.y <= ymax);
+                nextInside = (next.y <= ymax);
+                if (currentInside != nextInside) {
+                    float t = (ymax - current.y) / (next.y - current.y);
+                    intersection = D2D1::Point2F(current.x + t * (next.x - current.x), ymax);
+                }
+                break;
+            }
+            
+            // 根据当前点和下一点的位置关系添加顶点
+            if (currentInside) {
+                output.push_back(current);
+                if (!nextInside) {
+                    // 从内到外，添加交点
+                    output.push_back(intersection);
+                }
+            } else if (nextInside) {
+                // 从外到内，添加交点
+                output.push_back(intersection);
+            }
+        }
+    }
+    
+    return output;
+}
+
+static void SutherlandHodgmanPerPolygon(bench::State &state,
+                                        std::vector<D2D1_POINT_2F> (*clip)(const std::vector<D2D1_POINT_2F> &,
+                                                                           float, float, float, float)) {
+    PolygonArena input;
+    SutherlandHodgmanInput(state, input);
+    std::vector<std::vector<D2D1_POINT_2F>> polygons(input.Count());
+    for (size_t i = 0; i < input.Count(); ++i) {
+        polygons[i].assign(input.Points(i), input.Points(i) + input.Size(i));
+    }
+    size_t points = 0;
+    while (state.KeepRunning()) {
+        points = 0;
+        for (const auto &polygon : polygons) {
+            points += clip(polygon, CLIP_WINDOW.xmin, CLIP_WINDOW.ymin, CLIP_WINDOW.xmax, CLIP_WINDOW.ymax).size();
+        }
+        bench::DoNotOptimize(points);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(1));
+    state.counters["output"] = static_cast<double>(points);
+}
+
+// 旧的逐边整表裁剪，逐个多边形调用
+static void BM_SutherlandHodgmanBaseline(bench::State &state) {
+    SutherlandHodgmanPerPolygon(state, BaselineSutherlandHodgmanClip);
+}
+BENCHMARK(BM_SutherlandHodgmanBaseline)->ArgsProduct({{100, 10000}, {16, 1024}})->ArgNames({"polygons", "vertices"})
+    ->Unit(bench::TimeUnit::MILLISECOND);
+
+// 流水线裁剪器，逐个多边形调用（每次返回新的顶点表）
+static void BM_SutherlandHodgman(bench::State &state) {
+    SutherlandHodgmanPerPolygon(state, PolygonClipping::SutherlandHodgmanClip);
+}
+BENCHMARK(BM_SutherlandHodgman)->ArgsProduct({{100, 10000}, {16, 1024}})->ArgNames({"polygons", "vertices"})
+    ->Unit(bench::TimeUnit::MILLISECOND);
+
+// 流水线裁剪器批量裁剪到输出缓冲。每次迭代用新的输出缓冲，与 ApplyPolygonClippingSH 的用法一致，
+// 缓冲的分配和首次写入（缺页）计入时间。
+// 批量的好处是省掉每个多边形一次的分配：16个顶点时约快一倍。1024个顶点时分配已经摊薄，
+// 而一万个多边形的批量输出有几十MB，新缓冲首次写入的缺页使它比逐个调用慢一成左右
+// （逐个调用的结果缓冲很小，一直在缓存中复用）；复用同一个输出缓冲时两者持平
+static void BM_SutherlandHodgmanBatch(bench::State &state) {
+    PolygonArena input;
+    SutherlandHodgmanInput(state, input);
+    size_t points = 0;
+    while (state.KeepRunning()) {
+        PolygonArena output;
+        PolygonClipping::SutherlandHodgmanClipBatch(input, CLIP_WINDOW.xmin, CLIP_WINDOW.ymin,
+                                                    CLIP_WINDOW.xmax, CLIP_WINDOW.ymax, output);
+        points = output.points.size();
+        bench::DoNotOptimize(output);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(1));
+    state.counters["output"] = static_cast<double>(points);
+}
+BENCHMARK(BM_SutherlandHodgmanBatch)->ArgsProduct({{100, 10000}, {16, 1024}})->ArgNames({"polygons", "vertices"})
+    ->Unit(bench::TimeUnit::MILLISECOND);
+
+// 两个顶点数为 n 的凹星形多边形求交
+static void BM_WeilerAtherton(bench::State &state) {
+    size_t count = static_cast<size_t>(state.range(0));
+    D2D1_POINT_2F center = D2D1::Point2F(CANVAS_WIDTH * 0.5f, CANVAS_HEIGHT * 0.5f);
+    std::vector<D2D1_POINT_2F> subject = StarPolygon(center, 150.0f, 300.0f, count);
+    std::vector<D2D1_POINT_2F> clip = StarPolygon(D2D1::Point2F(center.x + 40.0f, center.y + 25.0f),
+                                                  150.0f, 300.0f, count, 0.37f);
+    std::vector<std::vector<D2D1_POINT_2F>> result;
+    size_t pieces = 0;
+    while (state.KeepRunning()) {
+        if (!PolygonClipping::WeilerAthertonClip(subject, clip, result)) {
+            state.SkipWithError("WeilerAthertonClip degenerate");
+            return;
+        }
+        pieces = result.size();
+        bench::DoNotOptimize(pieces);
+    }
+    state.counters["pieces"] = static_cast<double>(pieces);
+}
+BENCHMARK(BM_WeilerAtherton)->Range(16, 4096)->Unit(bench::TimeUnit::MICROSECOND);
+
+// ---------------------------------------------------------------------------
+// 序列化、点击测试
+
+static void BM_Serialize(bench::State &state) {
+    EnsureDocumentArena();
+    std::vector<std::shared_ptr<Shape>> shapes = MakeDocument(static_cast<size_t>(state.range(0)));
+    size_t bytes = 0;
+    while (state.KeepRunning()) {
+        std::string text;
+        for (const auto &shape : shapes) {
+            text += shape->Serialize();
+            text += '\n';
+        }
+        bytes += text.size();
+        bench::DoNotOptimize(text);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Serialize)->Range(100, 100000)->Unit(bench::TimeUnit::MICROSECOND);
+
+static void BM_Deserialize(bench::State &state) {
+    EnsureDocumentArena();
+    std::vector<std::string> lines;
+    size_t bytes = 0;
+    for (const auto &shape : MakeDocument(static_cast<size_t>(state.range(0)))) {
+        lines.push_back(shape->Serialize());
+        bytes += lines.back().size() + 1;
+    }
+    size_t loaded = 0;
+    while (state.KeepRunning()) {
+        std::vector<std::shared_ptr<Shape>> shapes;
+        shapes.reserve(lines.size());
+        for (const auto &line : lines) {
+            std::shared_ptr<Shape> shape = Shape::Deserialize(line);
+            if (shape) shapes.push_back(std::move(shape));
+        }
+        loaded = shapes.size();
+        bench::DoNotOptimize(shapes);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(bytes * state.iterations()));
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["loaded"] = static_cast<double>(loaded);
+}
+BENCHMARK(BM_Deserialize)->Range(100, 100000)->Unit(bench::TimeUnit::MICROSECOND);
+
+// 每种图形各做一次点击测试（参数为 ALL_TYPES 下标），测试点一半在图形上、一半在附近空白处
+static void BM_HitTestShape(bench::State &state) {
+    EnsureDocumentArena();
+    int type = static_cast<int>(state.range(0));
+    Random random;
+    std::shared_ptr<Shape> shape = MakeShape(ALL_TYPES[type], random, 200.0f);
+    D2D1_RECT_F bounds = shape->GetBounds();
+    std::vector<D2D1_POINT_2F> probes(256);
+    for (auto &probe : probes) {
+        probe = D2D1::Point2F(random.Uniform(bounds.left - 10, bounds.right + 10), random.Uniform(bounds.top - 10, bounds.bottom + 10));
+    }
+    size_t hits = 0;
+    while (state.KeepRunning()) {
+        for (const auto &probe : probes) {
+            hits += shape->HitTest(probe);
+        }
+    }
+    state.SetLabel(TYPE_NAMES[type]);
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(probes.size()));
+    bench::DoNotOptimize(hits);
+}
+BENCHMARK(BM_HitTestShape)->ArgsProduct({{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}})->ArgNames({"type"});
+
+// 文档中选中图形：逐个 HitTest 与经图形库候选过滤的对比，图形数 n
+static void BM_HitTestLinear(bench::State &state) {
+    EnsureDocumentArena();
+    std::vector<std::shared_ptr<Shape>> shapes = MakeDocument(static_cast<size_t>(state.range(0)), 20.0f);
+    Random random(777);
+    while (state.KeepRunning()) {
+        D2D1_POINT_2F point = random.Point();
+        Shape *found = nullptr;
+        for (size_t i = shapes.size(); i-- > 0;) {
+            if (shapes[i]->HitTest(point)) {
+                found = shapes[i].get();
+                break;
+            }
+        }
+        bench::DoNotOptimize(found);
+    }
+}
+BENCHMARK(BM_HitTestLinear)->Range(100, 100000)->Unit(bench::TimeUnit::MICROSECOND);
+
+static void BM_SelectShape(bench::State &state) {
+    GraphicsEngine engine;
+    engine.ReplaceShapes(MakeDocument(static_cast<size_t>(state.range(0)), 20.0f));
+    Random random(777);
+    while (state.KeepRunning()) {
+        std::shared_ptr<Shape> found = engine.SelectShape(random.Point());
+        bench::DoNotOptimize(found);
+    }
+}
+BENCHMARK(BM_SelectShape)->Range(100, 100000)->Unit(bench::TimeUnit::MICROSECOND);
+
+// ---------------------------------------------------------------------------
+// 图形库、文档区、撤销历史
+
+static void BM_ShapeStoreBuild(bench::State &state) {
+    EnsureDocumentArena();
+    std::vector<std::shared_ptr<Shape>> shapes = MakeDocument(static_cast<size_t>(state.range(0)));
+    while (state.KeepRunning()) {
+        ShapeStore store;
+        for (const auto &shape : shapes) {
+            store.Add(shape);
+        }
+        bench::DoNotOptimize(store);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ShapeStoreBuild)->Range(1000, 100000)->Unit(bench::TimeUnit::MILLISECOND);
+
+static void BM_ShapeStoreQueryRect(bench::State &state) {
+    EnsureDocumentArena();
+    ShapeStore store;
+    store.Assign(MakeDocument(static_cast<size_t>(state.range(0)), 20.0f));
+    std::vector<uint32_t> found;
+    Random random(99);
+    size_t total = 0;
+    while (state.KeepRunning()) {
+        D2D1_POINT_2F p = random.Point();
+        store.QueryRect(D2D1::RectF(p.x, p.y, p.x + 128.0f, p.y + 96.0f), 2.0f, found);
+        total += found.size();
+    }
+    state.counters["found"] = static_cast<double>(total) / state.iterations();
+}
+BENCHMARK(BM_ShapeStoreQueryRect)->Range(1000, 100000)->Unit(bench::TimeUnit::MICROSECOND);
+
+static void BM_ShapeStoreTranslate(bench::State &state) {
+    EnsureDocumentArena();
+    ShapeStore store;
+    store.Assign(MakeDocument(static_cast<size_t>(state.range(0))));
+    float delta = 1.0f;
+    while (state.KeepRunning()) {
+        for (size_t i = 0; i < store.Size(); ++i) {
+            store.Translate(i, delta, -delta);
+        }
+        delta = -delta;
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ShapeStoreTranslate)->Range(1000, 100000)->Unit(bench::TimeUnit::MILLISECOND);
+
+// 图形库的稠密数组与逐个访问图形对象（改用图形库之前的做法）对比，同一批图形、同样的操作。
+// 参数：图形数、是否打乱顺序。图形按创建顺序排列时对象在文档区中连续，逐个访问尚能顺序预取；
+// 经过插入、删除、调整层次后绘制顺序与内存顺序不再一致，用打乱顺序模拟
+static std::vector<std::shared_ptr<Shape>> StoreComparisonDocument(bench::State &state) {
+    std::vector<std::shared_ptr<Shape>> shapes = MakeDocument(static_cast<size_t>(state.range(0)), 20.0f);
+    if (state.range(1)) {
+        std::shuffle(shapes.begin(), shapes.end(), std::mt19937(7));
+    }
+    return shapes;
+}
+
+// 矩形查询（剔除）：逐个图形调用 GetBounds、GetLineWidthValue
+static void BM_CullPointers(bench::State &state) {
+    EnsureDocumentArena();
+    std::vector<std::shared_ptr<Shape>> shapes = StoreComparisonDocument(state);
+    std::vector<uint32_t> found;
+    Random random(99);
+    size_t total = 0;
+    while (state.KeepRunning()) {
+        D2D1_POINT_2F p = random.Point();
+        D2D1_RECT_F rect = D2D1::RectF(p.x, p.y, p.x + 128.0f, p.y + 96.0f);
+        found.clear();
+        for (size_t i = 0; i < shapes.size(); ++i) {
+            D2D1_RECT_F bounds = shapes[i]->GetBounds();
+            float pad = 2.0f + shapes[i]->GetLineWidthValue() * 0.5f;
+            if (bounds.right + pad < rect.left || bounds.left - pad > rect.right ||
+                bounds.bottom + pad < rect.top || bounds.top - pad > rect.bottom)
+                continue;
+            found.push_back(static_cast<uint32_t>(i));
+        }
+        total += found.size();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["found"] = static_cast<double>(total) / state.iterations();
+}
+BENCHMARK(BM_CullPointers)->ArgsProduct({{100000}, {0, 1}})->ArgNames({"shapes", "shuffled"})
+    ->Unit(bench::TimeUnit::MICROSECOND);
+
+// 同样的查询在图形库的包围盒数组上进行
+static void BM_CullStore(bench::State &state) {
+    EnsureDocumentArena();
+    ShapeStore store;
+    store.Assign(StoreComparisonDocument(state));
+    std::vector<uint32_t> found;
+    Random random(99);
+    size_t total = 0;
+    while (state.KeepRunning()) {
+        D2D1_POINT_2F p = random.Point();
+        store.QueryRect(D2D1::RectF(p.x, p.y, p.x + 128.0f, p.y + 96.0f), 2.0f, found);
+        total += found.size();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["found"] = static_cast<double>(total) / state.iterations();
+}
+BENCHMARK(BM_CullStore)->ArgsProduct({{100000}, {0, 1}})->ArgNames({"shapes", "shuffled"})
+    ->Unit(bench::TimeUnit::MICROSECOND);
+
+// 平移全部图形并取得新的包围盒：逐个图形 Move 后 GetBounds（包围盒缓存失效，重新计算）
+static void BM_TranslatePointers(bench::State &state) {
+    EnsureDocumentArena();
+    std::vector<std::shared_ptr<Shape>> shapes = StoreComparisonDocument(state);
+    float delta = 1.0f;
+    float sum = 0.0f;
+    while (state.KeepRunning()) {
+        for (const auto &shape : shapes) {
+            shape->Move(delta, -delta);
+            sum += shape->GetBounds().left;
+        }
+        delta = -delta;
+    }
+    bench::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TranslatePointers)->ArgsProduct({{100000}, {0, 1}})->ArgNames({"shapes", "shuffled"})
+    ->Unit(bench::TimeUnit::MILLISECOND);
+
+// 同样的平移在图形库中进行：包围盒数组和几何池直接加偏移，再读出包围盒
+static void BM_TranslateStore(bench::State &state) {
+    EnsureDocumentArena();
+    ShapeStore store;
+    store.Assign(StoreComparisonDocument(state));
+    float delta = 1.0f;
+    float sum = 0.0f;
+    while (state.KeepRunning()) {
+        for (size_t i = 0; i < store.Size(); ++i) {
+            store.Translate(i, delta, -delta);
+            sum += store.BoundsAt(i).left;
+        }
+        delta = -delta;
+    }
+    bench::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TranslateStore)->ArgsProduct({{100000}, {0, 1}})->ArgNames({"shapes", "shuffled"})
+    ->Unit(bench::TimeUnit::MILLISECOND);
+
+static void BM_DocumentArenaAllocate(bench::State &state) {
+    std::shared_ptr<DocumentArena> arena = std::make_shared<DocumentArena>();
+    size_t bytes = static_cast<size_t>(state.range(0));
+    std::vector<void *> blocks(1024);
+    while (state.KeepRunning()) {
+        for (auto &block : blocks) {
+            block = arena->Allocate(bytes);
+        }
+        for (auto &block : blocks) {
+            arena->Deallocate(block, bytes);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(blocks.size()));
+}
+BENCHMARK(BM_DocumentArenaAllocate)->Range(16, 4096)->Unit(bench::TimeUnit::MICROSECOND);
+
+// 丢弃整个文档：图形逐个析构，retired 为1时文档区已 Retire，小块不再逐个挂回空闲链表
+static void BM_DocumentTeardown(bench::State &state) {
+    std::shared_ptr<DocumentArena> previous = DocumentArena::Current();
+    bool retire = state.range(1) != 0;
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        std::shared_ptr<DocumentArena> arena = DocumentArena::BeginDocument();
+        std::vector<std::shared_ptr<Shape>> shapes = MakeDocument(static_cast<size_t>(state.range(0)));
+        DocumentArena::SetCurrent(previous);
+        state.ResumeTiming();
+
+        if (retire) arena->Retire();
+        shapes.clear();
+        arena.reset();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DocumentTeardown)->ArgsProduct({{10000, 200000}, {0, 1}})->ArgNames({"shapes", "retired"})
+    ->Unit(bench::TimeUnit::MILLISECOND);
+
+static void BM_MallocBaseline(bench::State &state) {
+    size_t bytes = static_cast<size_t>(state.range(0));
+    std::vector<void *> blocks(1024);
+    while (state.KeepRunning()) {
+        for (auto &block : blocks) {
+            block = std::malloc(bytes);
+        }
+        bench::DoNotOptimize(blocks);
+        for (auto &block : blocks) {
+            std::free(block);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(blocks.size()));
+}
+BENCHMARK(BM_MallocBaseline)->Range(16, 4096)->Unit(bench::TimeUnit::MICROSECOND);
+
+// 编辑一个图形后记录一步：写时复制该图形，其余块与上一步共享
+static void BM_DocumentHistoryCommit(bench::State &state) {
+    EnsureDocumentArena();
+    std::vector<std::shared_ptr<Shape>> shapes = MakeDocument(static_cast<size_t>(state.range(0)));
+    DocumentHistory history;
+    history.Commit(shapes);
+    size_t index = 0;
+    while (state.KeepRunning()) {
+        index = (index + 7919) % shapes.size();
+        std::shared_ptr<Shape> edited = shapes[index]->Clone();
+        edited->Move(1.0f, 0.0f);
+        shapes[index] = std::move(edited);
+        history.Commit(shapes, index);
+    }
+}
+BENCHMARK(BM_DocumentHistoryCommit)->Range(1000, 100000)->Unit(bench::TimeUnit::MICROSECOND);
+
+// ---------------------------------------------------------------------------
+// 软件光栅化：1024x768 画布，参数为图形数和线程数
+
+namespace {
+    // 图形散布在整个画布上，画布越大单个图形占的像素比例越小，主要衡量每个图形的建边和描边开销
+    void RenderToSurfaceBenchmark(bench::State &state, int width, int height) {
+        GraphicsEngine engine;
+        engine.ReplaceShapes(MakeDocument(static_cast<size_t>(state.range(0)), 60.0f, 12345,
+                                          static_cast<float>(width), static_cast<float>(height)));
+        RasterSurface surface;
+        surface.Resize(width, height);
+        int threads = static_cast<int>(state.range(1));
+        while (state.KeepRunning()) {
+            engine.RenderToSurface(surface, threads);
+            bench::DoNotOptimize(surface.pixels);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+}
+
+static void BM_RenderToSurface(bench::State &state) {
+    RenderToSurfaceBenchmark(state, static_cast<int>(CANVAS_WIDTH), static_cast<int>(CANVAS_HEIGHT));
+}
+BENCHMARK(BM_RenderToSurface)->ArgsProduct({{1000, 10000}, {1, 2, 4, 8, 16}})->ArgNames({"shapes", "threads"})
+    ->Unit(bench::TimeUnit::MILLISECOND);
+
+// 4K 画布上一万个图形：单线程一帧应明显低于 100ms
+static void BM_RenderToSurface4K(bench::State &state) {
+    RenderToSurfaceBenchmark(state, 3840, 2160);
+}
+BENCHMARK(BM_RenderToSurface4K)->ArgsProduct({{10000}, {1, 4, 16}})->ArgNames({"shapes", "threads"})
+    ->Unit(bench::TimeUnit::MILLISECOND);
+
+// ---------------------------------------------------------------------------
+// 资源缓存：命中时只查表，失效时重新生成路径几何
+
+namespace {
+    class BenchRenderTarget : public ID2D1RenderTarget {
+    public:
+        explicit BenchRenderTarget(ID2D1Factory *factory) : m_factory(factory) {
+        }
+        void GetFactory(ID2D1Factory **factory) const override {
+            m_factory->AddRef();
+            *factory = m_factory;
+        }
+
+    private:
+        ID2D1Factory *m_factory;
+    };
+
+    void BuildStar(ID2D1GeometrySink *sink, const std::vector<D2D1_POINT_2F> &points) {
+        sink->BeginFigure(points[0], D2D1_FIGURE_BEGIN_FILLED);
+        sink->AddLines(points.data() + 1, static_cast<UINT32>(points.size() - 1));
+        sink->EndFigure(D2D1_FIGURE_END_CLOSED);
+    }
+
+    void PathGeometryBenchmark(bench::State &state, bool hit) {
+        ID2D1Factory *factory = nullptr;
+        if (FAILED(D2D1CreateFactory(D2D1_FACTORY_TYPE_SINGLE_THREADED, &factory))) {
+            state.SkipWithError("D2D1CreateFactory failed");
+            return;
+        }
+        BenchRenderTarget *target = new BenchRenderTarget(factory);
+        std::vector<D2D1_POINT_2F> points = StarPolygon(D2D1::Point2F(300, 300), 100, 200, 64);
+        {
+            DeviceResourceCache cache;
+            cache.Attach(target, nullptr);
+            uint64_t version = 1;
+            while (state.KeepRunning()) {
+                cache.BeginFrame();
+                if (!hit) ++version;
+                ID2D1PathGeometry *geometry = cache.GetPathGeometry(version, 0, [&points](ID2D1GeometrySink *sink) {
+                    BuildStar(sink, points);
+                });
+                bench::DoNotOptimize(geometry);
+                cache.EndFrame();
+            }
+        }
+        target->Release();
+        factory->Release();
+    }
+}
+
+static void BM_PathGeometryCacheHit(bench::State &state) {
+    PathGeometryBenchmark(state, true);
+}
+BENCHMARK(BM_PathGeometryCacheHit);
+
+static void BM_PathGeometryRebuild(bench::State &state) {
+    PathGeometryBenchmark(state, false);
+}
+BENCHMARK(BM_PathGeometryRebuild);
+
+// 细节层次：像素级圆在不同视图缩放下的绘制。缩放为1时逐像素绘制，缩小后画一张缓存的遮罩位图；
+// primitives 为每次绘制提交的图元数
+
+namespace {
+    class CountingRenderTarget : public BenchRenderTarget {
+    public:
+        explicit CountingRenderTarget(ID2D1Factory *factory) : BenchRenderTarget(factory), primitives(0) {
+        }
+        void FillEllipse(const D2D1_ELLIPSE &, ID2D1Brush *) override {
+            ++primitives;
+        }
+        void FillOpacityMask(ID2D1Bitmap *, ID2D1Brush *, D2D1_OPACITY_MASK_CONTENT,
+                             const D2D1_RECT_F *, const D2D1_RECT_F *) override {
+            ++primitives;
+        }
+
+        int64_t primitives;
+    };
+}
+
+static void BM_DrawPixelCircleZoom(bench::State &state) {
+    float zoom = state.range(0) / 100.0f;
+    ID2D1Factory *factory = nullptr;
+    if (FAILED(D2D1CreateFactory(D2D1_FACTORY_TYPE_SINGLE_THREADED, &factory))) {
+        state.SkipWithError("D2D1CreateFactory failed");
+        return;
+    }
+    CountingRenderTarget *target = new CountingRenderTarget(factory);
+    ID2D1SolidColorBrush *brush = nullptr;
+    target->CreateSolidColorBrush(D2D1::ColorF(D2D1::ColorF::Black), &brush);
+    {
+        DeviceResourceCache cache;
+        cache.Attach(target, nullptr);
+        cache.SetViewScale(zoom);
+        DeviceResourceCache *previous = DeviceResourceCache::Current();
+        DeviceResourceCache::SetCurrent(&cache);
+        EnsureDocumentArena();
+        MidpointCircle circle(D2D1::Point2F(400, 400), 300);
+        while (state.KeepRunning()) {
+            cache.BeginFrame();
+            circle.Draw(target, brush, brush, nullptr);
+            cache.EndFrame();
+        }
+        DeviceResourceCache::SetCurrent(previous);
+    }
+    state.counters["primitives"] = static_cast<double>(target->primitives) / state.iterations();
+    state.SetItemsProcessed(state.iterations());
+    brush->Release();
+    target->Release();
+    factory->Release();
+}
+BENCHMARK(BM_DrawPixelCircleZoom)->Arg(100)->Arg(50)->Arg(10)->ArgNames({"zoom%"});
+
+// 视图缩小时的帧时间：一百万个图形散布在 20000x20000 的文档上，在 1920x1080 的窗口中从左上角逐级缩小视图。
+// 每次迭代提交一帧并等待绘制线程画完；基准中的渲染目标不能创建兼容目标，没有静态层，每帧都完整地剔除和绘制。
+// 缩小后可见图形增多，但都小于细节层次阈值，只在遮罩上画点或框，帧时间应保持有界。drawn 为每帧实际绘制的图形数
+static const std::vector<std::shared_ptr<Shape>> &ViewDocument() {
+    const float DOCUMENT_EXTENT = 20000.0f;
+    EnsureDocumentArena();
+    static const std::vector<std::shared_ptr<Shape>> document =
+        MakeDocument(1000000, 20.0f, 12345, DOCUMENT_EXTENT, DOCUMENT_EXTENT);
+    return document;
+}
+
+static void BM_ViewFrameZoom(bench::State &state) {
+    const std::vector<std::shared_ptr<Shape>> &document = ViewDocument();
+
+    GraphicsEngine engine;
+    if (FAILED(engine.Initialize(nullptr))) {
+        state.SkipWithError("GraphicsEngine::Initialize failed");
+        return;
+    }
+    engine.Resize(1920, 1080);
+    engine.ReplaceShapes(document);
+    engine.ZoomView(state.range(0) / 100.0f, D2D1::Point2F(0, 0));
+
+    FrameStats stats = {};
+    while (state.KeepRunning()) {
+        engine.SubmitFrame(OverlayList());
+        engine.WaitForFrames();
+    }
+    stats = Profiler::GetFrameStats();
+    state.counters["drawn"] = static_cast<double>(stats.drawCalls);
+    state.counters["culled"] = static_cast<double>(stats.shapesCulled);
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(document.size()));
+}
+BENCHMARK(BM_ViewFrameZoom)->Arg(100)->Arg(25)->Arg(10)->Arg(5)->Arg(1)->ArgNames({"zoom%"})
+    ->Unit(bench::TimeUnit::MILLISECOND);
+
+// 只测上面每帧的剔除和细节层次判断（不画遮罩、不绘制），比较两种数据来源。参数：缩放百分比、数据来源：
+// 0 为逐个访问快照中的图形对象，调用 GetBounds、GetLineWidthValue（改用包围盒副本之前 DrawShapes 的做法）；
+// 1 为扫描帧带来的包围盒副本 ShapeBoundsSnapshot 的连续数组。副本在文档不变时复用，生成不计时
+static void BM_ViewCull(bench::State &state) {
+    // 与 GraphicsEngine.cpp 中的取值相同
+    const float CULL_MARGIN = 2.0f;
+    const float LOD_BOX_PIXELS = 6.0f;
+    const float LOD_DOT_PIXELS = 2.0f;
+    const std::vector<std::shared_ptr<Shape>> &document = ViewDocument();
+    size_t addedBytes = 0;
+    std::shared_ptr<const DocumentSnapshot> snapshot = DocumentSnapshot::Build(document, nullptr, 0, addedBytes);
+    ShapeStore store;
+    store.Assign(document);
+    std::shared_ptr<const ShapeBoundsSnapshot> bounds = store.BoundsSnapshot();
+    const bool useSnapshot = state.range(1) != 0;
+
+    const float zoom = state.range(0) / 100.0f;
+    const D2D1_POINT_2F visibleMin = D2D1::Point2F(0, 0);
+    const D2D1_POINT_2F visibleMax = D2D1::Point2F(1920.0f / zoom, 1080.0f / zoom);
+    const float cullMargin = CULL_MARGIN / zoom;
+    std::vector<uint32_t> drawIndices;
+    uint32_t culled = 0, dots = 0, boxes = 0;
+    // 返回 true 表示需要绘制
+    auto classify = [&](float left, float top, float right, float bottom, float halfWidth) {
+        float margin = halfWidth + cullMargin;
+        if (right + margin < visibleMin.x || left - margin > visibleMax.x ||
+            bottom + margin < visibleMin.y || top - margin > visibleMax.y) {
+            ++culled;
+            return false;
+        }
+        float extent = ((std::max)(right - left, bottom - top) + 2.0f * halfWidth) * zoom;
+        if (extent < LOD_BOX_PIXELS) {
+            ++(extent < LOD_DOT_PIXELS ? dots : boxes);
+            return false;
+        }
+        return true;
+    };
+
+    while (state.KeepRunning()) {
+        culled = dots = boxes = 0;
+        drawIndices.clear();
+        if (useSnapshot) {
+            for (size_t c = 0; c < bounds->ChunkCount(); ++c) {
+                const ShapeBoundsSnapshot::Chunk &chunk = bounds->ChunkAt(c);
+                size_t base = c * ShapeBoundsSnapshot::CHUNK_SIZE;
+                for (size_t j = 0, n = chunk.Size(); j < n; ++j) {
+                    if (classify(chunk.minX[j], chunk.minY[j], chunk.maxX[j], chunk.maxY[j], chunk.lineWidth[j] * 0.5f)) {
+                        drawIndices.push_back(static_cast<uint32_t>(base + j));
+                    }
+                }
+            }
+        } else {
+            snapshot->ForEach([&](size_t i, const std::shared_ptr<Shape> &shape) {
+                D2D1_RECT_F r = shape->GetBounds();
+                if (classify(r.left, r.top, r.right, r.bottom, shape->GetLineWidthValue() * 0.5f)) {
+                    drawIndices.push_back(static_cast<uint32_t>(i));
+                }
+            });
+        }
+        bench::DoNotOptimize(drawIndices);
+    }
+    state.counters["culled"] = culled;
+    state.counters["lod"] = dots + boxes;
+    state.counters["drawn"] = static_cast<double>(drawIndices.size());
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(document.size()));
+}
+BENCHMARK(BM_ViewCull)->ArgsProduct({{100, 10, 1}, {0, 1}})->ArgNames({"zoom%", "snapshot"})
+    ->Unit(bench::TimeUnit::MILLISECOND);
+
+// ---------------------------------------------------------------------------
+// 绘制线程的帧交接：界面线程连续提交帧（帧内容为序号），绘制线程每帧固定耗时 range(0) 微秒。
+// 检查绘制的帧序号只增不减、最后提交的一帧一定被画出；计时的是界面线程提交一帧的开销
+
+static void BM_RenderThreadSubmit(bench::State &state) {
+    const std::chrono::microseconds frameCost(state.range(0));
+    int64_t lastRendered = -1;
+    bool outOfOrder = false;
+    RenderThread<int64_t> thread;
+    thread.Start([&](const int64_t &frame) {
+        if (frame <= lastRendered) outOfOrder = true;
+        lastRendered = frame;
+        std::this_thread::sleep_for(frameCost);
+    });
+
+    int64_t next = 0;
+    while (state.KeepRunning()) {
+        thread.Submit(next++);
+    }
+    thread.WaitIdle();
+    RenderThread<int64_t>::Stats stats = thread.GetStats();
+    thread.Stop();
+
+    if (outOfOrder || lastRendered != next - 1 || stats.rendered + stats.coalesced != stats.submitted) {
+        state.SkipWithError("frames rendered out of order or lost");
+        return;
+    }
+    state.counters["rendered"] = static_cast<double>(stats.rendered);
+    state.counters["coalesced%"] = 100.0 * stats.coalesced / (std::max)(stats.submitted, static_cast<uint64_t>(1));
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RenderThreadSubmit)->Arg(0)->Arg(100)->Arg(1000)->ArgNames({"frame_us"});
+
+// ---------------------------------------------------------------------------
+// 日志、剖析本身的开销
+
+namespace {
+    void DiscardLog(LogLevel, const char *) {
+    }
+}
+
+static void BM_LogWrite(bench::State &state) {
+    Log::SetSink(DiscardLog);
+    Log::Flush();
+    size_t droppedBefore = Log::DroppedCount();
+    int i = 0;
+    while (state.KeepRunning()) {
+        Log::Write(LogLevel::WARN, "shape %d moved to (%.1f, %.1f) %s", i, 1.5f * i, 2.5f, "bench");
+        // 队列写满后只剩丢弃的开销，定期等后台线程输出完（不计时）
+        if (++i % 512 == 0) {
+            state.PauseTiming();
+            Log::Flush();
+            state.ResumeTiming();
+        }
+    }
+    Log::Flush();
+    state.counters["dropped"] = static_cast<double>(Log::DroppedCount() - droppedBefore);
+    Log::SetSink(nullptr);
+}
+BENCHMARK(BM_LogWrite);
+
+static void BM_ProfileScope(bench::State &state) {
+    while (state.KeepRunning()) {
+        PROFILE_SCOPE("BM_ProfileScope");
+    }
+}
+BENCHMARK(BM_ProfileScope);
+
+BENCHMARK_MAIN()
@@ -0,0 +1,247 @@
+#pragma once
+// 最小 Direct2D 接口：值类型与真实头文件布局相同；接口的方法都有空实现，
+// 工厂创建的窗口渲染目标、路径几何、画刷和描边样式是真实的空对象，渲染目标不产生任何输出
+#include <windows.h>
+#include <dwrite.h>
+
+struct D2D1_POINT_2F {
+    FLOAT x, y;
+};
+struct D2D1_POINT_2U {
+    UINT32 x, y;
+};
+struct D2D1_SIZE_F {
+    FLOAT width, height;
+};
+struct D2D1_SIZE_U {
+    UINT32 width, height;
+};
+struct D2D1_RECT_F {
+    FLOAT left, top, right, bottom;
+};
+struct D2D1_RECT_U {
+    UINT32 left, top, right, bottom;
+};
+struct D2D1_COLOR_F {
+    FLOAT r, g, b, a;
+};
+struct D2D1_ELLIPSE {
+    D2D1_POINT_2F point;
+    FLOAT radiusX, radiusY;
+};
+struct D2D1_MATRIX_3X2_F {
+    FLOAT _11, _12, _21, _22, _31, _32;
+};
+
+enum D2D1_FACTORY_TYPE { D2D1_FACTORY_TYPE_SINGLE_THREADED, D2D1_FACTORY_TYPE_MULTI_THREADED };
+enum D2D1_CAP_STYLE { D2D1_CAP_STYLE_FLAT, D2D1_CAP_STYLE_SQUARE, D2D1_CAP_STYLE_ROUND, D2D1_CAP_STYLE_TRIANGLE };
+enum D2D1_LINE_JOIN { D2D1_LINE_JOIN_MITER, D2D1_LINE_JOIN_BEVEL, D2D1_LINE_JOIN_ROUND, D2D1_LINE_JOIN_MITER_OR_BEVEL };
+enum D2D1_DASH_STYLE {
+    D2D1_DASH_STYLE_SOLID, D2D1_DASH_STYLE_DASH, D2D1_DASH_STYLE_DOT,
+    D2D1_DASH_STYLE_DASH_DOT, D2D1_DASH_STYLE_DASH_DOT_DOT, D2D1_DASH_STYLE_CUSTOM
+};
+enum D2D1_FIGURE_BEGIN { D2D1_FIGURE_BEGIN_FILLED, D2D1_FIGURE_BEGIN_HOLLOW };
+enum D2D1_FIGURE_END { D2D1_FIGURE_END_OPEN, D2D1_FIGURE_END_CLOSED };
+enum D2D1_ANTIALIAS_MODE { D2D1_ANTIALIAS_MODE_PER_PRIMITIVE, D2D1_ANTIALIAS_MODE_ALIASED };
+enum D2D1_ALPHA_MODE { D2D1_ALPHA_MODE_UNKNOWN, D2D1_ALPHA_MODE_PREMULTIPLIED, D2D1_ALPHA_MODE_STRAIGHT, D2D1_ALPHA_MODE_IGNORE };
+enum DXGI_FORMAT { DXGI_FORMAT_UNKNOWN = 0, DXGI_FORMAT_R8G8B8A8_UNORM = 28, DXGI_FORMAT_A8_UNORM = 65, DXGI_FORMAT_B8G8R8A8_UNORM = 87 };
+enum D2D1_BITMAP_INTERPOLATION_MODE { D2D1_BITMAP_INTERPOLATION_MODE_NEAREST_NEIGHBOR, D2D1_BITMAP_INTERPOLATION_MODE_LINEAR };
+enum D2D1_OPACITY_MASK_CONTENT {
+    D2D1_OPACITY_MASK_CONTENT_GRAPHICS, D2D1_OPACITY_MASK_CONTENT_TEXT_NATURAL, D2D1_OPACITY_MASK_CONTENT_TEXT_GDI_COMPATIBLE
+};
+
+#define D2DERR_RECREATE_TARGET ((HRESULT)(int32_t)0x8899000Cu)
+
+struct D2D1_STROKE_STYLE_PROPERTIES {
+    D2D1_CAP_STYLE startCap, endCap, dashCap;
+    D2D1_LINE_JOIN lineJoin;
+    FLOAT miterLimit;
+    D2D1_DASH_STYLE dashStyle;
+    FLOAT dashOffset;
+};
+struct D2D1_RENDER_TARGET_PROPERTIES {
+    int type;
+};
+struct D2D1_PIXEL_FORMAT {
+    DXGI_FORMAT format;
+    D2D1_ALPHA_MODE alphaMode;
+};
+struct D2D1_BITMAP_PROPERTIES {
+    D2D1_PIXEL_FORMAT pixelFormat;
+    FLOAT dpiX, dpiY;
+};
+struct D2D1_HWND_RENDER_TARGET_PROPERTIES {
+    HWND hwnd;
+    D2D1_SIZE_U pixelSize;
+};
+
+struct ID2D1Factory;
+struct ID2D1BitmapRenderTarget;
+
+struct ID2D1Resource : IUnknown {
+};
+struct ID2D1StrokeStyle : ID2D1Resource {
+};
+struct ID2D1Brush : ID2D1Resource {
+    virtual void SetOpacity(FLOAT) {
+    }
+};
+struct ID2D1SolidColorBrush : ID2D1Brush {
+    D2D1_COLOR_F color = {};
+    virtual void SetColor(const D2D1_COLOR_F &value) {
+        color = value;
+    }
+    virtual D2D1_COLOR_F GetColor() const {
+        return color;
+    }
+};
+
+struct ID2D1SimplifiedGeometrySink : IUnknown {
+    virtual void BeginFigure(D2D1_POINT_2F, D2D1_FIGURE_BEGIN) {
+    }
+    virtual void AddLine(D2D1_POINT_2F) {
+    }
+    virtual void AddLines(const D2D1_POINT_2F *, UINT32) {
+    }
+    virtual void EndFigure(D2D1_FIGURE_END) {
+    }
+    virtual HRESULT Close() {
+        return S_OK;
+    }
+};
+struct ID2D1GeometrySink : ID2D1SimplifiedGeometrySink {
+};
+struct ID2D1Geometry : ID2D1Resource {
+};
+struct ID2D1PathGeometry : ID2D1Geometry {
+    virtual HRESULT Open(ID2D1GeometrySink **sink) {
+        *sink = new ID2D1GeometrySink();
+        return S_OK;
+    }
+};
+
+struct ID2D1Bitmap : ID2D1Resource {
+    virtual HRESULT CopyFromMemory(const D2D1_RECT_U *, const void *, UINT32) {
+        return S_OK;
+    }
+};
+
+struct ID2D1RenderTarget : ID2D1Resource {
+    virtual void GetFactory(ID2D1Factory **factory) const {
+        *factory = nullptr;
+    }
+    virtual HRESULT CreateSolidColorBrush(const D2D1_COLOR_F &color, ID2D1SolidColorBrush **brush) {
+        *brush = new ID2D1SolidColorBrush();
+        (*brush)->SetColor(color);
+        return S_OK;
+    }
+    virtual HRESULT CreateBitmap(D2D1_SIZE_U, const void *, UINT32, const D2D1_BITMAP_PROPERTIES &, ID2D1Bitmap **bitmap) {
+        *bitmap = new ID2D1Bitmap();
+        return S_OK;
+    }
+    virtual HRESULT CreateCompatibleRenderTarget(D2D1_SIZE_F, ID2D1BitmapRenderTarget **target) {
+        *target = nullptr;
+        return E_FAIL;
+    }
+    virtual void DrawBitmap(ID2D1Bitmap *, const D2D1_RECT_F &, FLOAT = 1.0f,
+                            D2D1_BITMAP_INTERPOLATION_MODE = D2D1_BITMAP_INTERPOLATION_MODE_LINEAR,
+                            const D2D1_RECT_F * = nullptr) {
+    }
+    virtual void DrawLine(D2D1_POINT_2F, D2D1_POINT_2F, ID2D1Brush *, FLOAT = 1.0f, ID2D1StrokeStyle * = nullptr) {
+    }
+    virtual void DrawRectangle(const D2D1_RECT_F &, ID2D1Brush *, FLOAT = 1.0f, ID2D1StrokeStyle * = nullptr) {
+    }
+    virtual void FillRectangle(const D2D1_RECT_F &, ID2D1Brush *) {
+    }
+    void FillRectangle(const D2D1_RECT_F *rect, ID2D1Brush *brush) {
+        FillRectangle(*rect, brush);
+    }
+    virtual void DrawEllipse(const D2D1_ELLIPSE &, ID2D1Brush *, FLOAT = 1.0f, ID2D1StrokeStyle * = nullptr) {
+    }
+    virtual void FillEllipse(const D2D1_ELLIPSE &, ID2D1Brush *) {
+    }
+    virtual void DrawGeometry(ID2D1Geometry *, ID2D1Brush *, FLOAT = 1.0f, ID2D1StrokeStyle * = nullptr) {
+    }
+    virtual void FillGeometry(ID2D1Geometry *, ID2D1Brush *, ID2D1Brush * = nullptr) {
+    }
+    virtual void DrawText(const WCHAR *, UINT32, IDWriteTextFormat *, const D2D1_RECT_F &, ID2D1Brush *) {
+    }
+    virtual void DrawTextLayout(D2D1_POINT_2F, IDWriteTextLayout *, ID2D1Brush *) {
+    }
+    virtual void FillOpacityMask(ID2D1Bitmap *, ID2D1Brush *, D2D1_OPACITY_MASK_CONTENT,
+                                 const D2D1_RECT_F * = nullptr, const D2D1_RECT_F * = nullptr) {
+    }
+    virtual void SetAntialiasMode(D2D1_ANTIALIAS_MODE mode) {
+        m_antialiasMode = mode;
+    }
+    virtual D2D1_ANTIALIAS_MODE GetAntialiasMode() const {
+        return m_antialiasMode;
+    }
+    virtual void SetTransform(const D2D1_MATRIX_3X2_F &) {
+    }
+    virtual void GetTransform(D2D1_MATRIX_3X2_F *) const {
+    }
+    virtual void PushAxisAlignedClip(const D2D1_RECT_F &, D2D1_ANTIALIAS_MODE) {
+    }
+    virtual void PopAxisAlignedClip() {
+    }
+    virtual void Clear(const D2D1_COLOR_F &) {
+    }
+    virtual void BeginDraw() {
+    }
+    virtual HRESULT EndDraw() {
+        return S_OK;
+    }
+    virtual D2D1_SIZE_F GetSize() const {
+        return D2D1_SIZE_F{0, 0};
+    }
+
+private:
+    D2D1_ANTIALIAS_MODE m_antialiasMode = D2D1_ANTIALIAS_MODE_PER_PRIMITIVE;
+};
+struct ID2D1BitmapRenderTarget : ID2D1RenderTarget {
+    virtual HRESULT GetBitmap(ID2D1Bitmap **bitmap) {
+        *bitmap = nullptr;
+        return E_FAIL;
+    }
+};
+struct ID2D1HwndRenderTarget : ID2D1RenderTarget {
+    explicit ID2D1HwndRenderTarget(D2D1_SIZE_U size = D2D1_SIZE_U{0, 0}) : m_size(size) {
+    }
+    virtual HRESULT Resize(const D2D1_SIZE_U &size) {
+        m_size = size;
+        return S_OK;
+    }
+    D2D1_SIZE_F GetSize() const override {
+        return D2D1_SIZE_F{static_cast<FLOAT>(m_size.width), static_cast<FLOAT>(m_size.height)};
+    }
+
+private:
+    D2D1_SIZE_U m_size;
+};
+
+struct ID2D1Factory : IUnknown {
+    virtual HRESULT CreateHwndRenderTarget(const D2D1_RENDER_TARGET_PROPERTIES &,
+                                           const D2D1_HWND_RENDER_TARGET_PROPERTIES &properties,
+                                           ID2D1HwndRenderTarget **target) {
+        *target = new ID2D1HwndRenderTarget(properties.pixelSize);
+        return S_OK;
+    }
+    virtual HRESULT CreateStrokeStyle(const D2D1_STROKE_STYLE_PROPERTIES &, const FLOAT *, UINT32,
+                                      ID2D1StrokeStyle **style) {
+        *style = new ID2D1StrokeStyle();
+        return S_OK;
+    }
+    virtual HRESULT CreatePathGeometry(ID2D1PathGeometry **geometry) {
+        *geometry = new ID2D1PathGeometry();
+        return S_OK;
+    }
+};
+
+template <typename T>
+HRESULT D2D1CreateFactory(D2D1_FACTORY_TYPE, T **factory) {
+    *factory = new T();
+    return S_OK;
+}
+
+#include <d2d1helper.h>
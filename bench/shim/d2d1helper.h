@@ -0,0 +1,106 @@
+#pragma once
+// d2d1helper.h 中源码用到的辅助函数和 ColorF / Matrix3x2F
+#include <d2d1.h>
+
+namespace D2D1 {
+    inline D2D1_POINT_2F Point2F(FLOAT x = 0.0f, FLOAT y = 0.0f) {
+        return D2D1_POINT_2F{x, y};
+    }
+    inline D2D1_SIZE_F SizeF(FLOAT width = 0.0f, FLOAT height = 0.0f) {
+        return D2D1_SIZE_F{width, height};
+    }
+    inline D2D1_SIZE_U SizeU(UINT32 width = 0, UINT32 height = 0) {
+        return D2D1_SIZE_U{width, height};
+    }
+    inline D2D1_RECT_F RectF(FLOAT left = 0.0f, FLOAT top = 0.0f, FLOAT right = 0.0f, FLOAT bottom = 0.0f) {
+        return D2D1_RECT_F{left, top, right, bottom};
+    }
+    inline D2D1_RECT_U RectU(UINT32 left = 0, UINT32 top = 0, UINT32 right = 0, UINT32 bottom = 0) {
+        return D2D1_RECT_U{left, top, right, bottom};
+    }
+    inline D2D1_PIXEL_FORMAT PixelFormat(DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN, D2D1_ALPHA_MODE alphaMode = D2D1_ALPHA_MODE_UNKNOWN) {
+        return D2D1_PIXEL_FORMAT{format, alphaMode};
+    }
+    inline D2D1_BITMAP_PROPERTIES BitmapProperties(const D2D1_PIXEL_FORMAT &pixelFormat = PixelFormat(),
+                                                   FLOAT dpiX = 96.0f, FLOAT dpiY = 96.0f) {
+        return D2D1_BITMAP_PROPERTIES{pixelFormat, dpiX, dpiY};
+    }
+    inline D2D1_ELLIPSE Ellipse(D2D1_POINT_2F center, FLOAT radiusX, FLOAT radiusY) {
+        return D2D1_ELLIPSE{center, radiusX, radiusY};
+    }
+    inline D2D1_RENDER_TARGET_PROPERTIES RenderTargetProperties() {
+        return D2D1_RENDER_TARGET_PROPERTIES{0};
+    }
+    inline D2D1_HWND_RENDER_TARGET_PROPERTIES HwndRenderTargetProperties(HWND hwnd, D2D1_SIZE_U pixelSize = D2D1_SIZE_U{0, 0}) {
+        return D2D1_HWND_RENDER_TARGET_PROPERTIES{hwnd, pixelSize};
+    }
+    inline D2D1_STROKE_STYLE_PROPERTIES StrokeStyleProperties(
+        D2D1_CAP_STYLE startCap = D2D1_CAP_STYLE_FLAT, D2D1_CAP_STYLE endCap = D2D1_CAP_STYLE_FLAT,
+        D2D1_CAP_STYLE dashCap = D2D1_CAP_STYLE_FLAT, D2D1_LINE_JOIN lineJoin = D2D1_LINE_JOIN_MITER,
+        FLOAT miterLimit = 10.0f, D2D1_DASH_STYLE dashStyle = D2D1_DASH_STYLE_SOLID, FLOAT dashOffset = 0.0f) {
+        return D2D1_STROKE_STYLE_PROPERTIES{startCap, endCap, dashCap, lineJoin, miterLimit, dashStyle, dashOffset};
+    }
+
+    class ColorF : public D2D1_COLOR_F {
+    public:
+        enum Enum {
+            Black = 0x000000,
+            Blue = 0x0000FF,
+            DarkGray = 0xA9A9A9,
+            Gray = 0x808080,
+            Green = 0x008000,
+            LightBlue = 0xADD8E6,
+            LightGray = 0xD3D3D3,
+            Orange = 0xFFA500,
+            Red = 0xFF0000,
+            White = 0xFFFFFF,
+            Yellow = 0xFFFF00
+        };
+
+        ColorF(UINT32 rgb, FLOAT alpha = 1.0f) {
+            r = ((rgb >> 16) & 0xFF) / 255.0f;
+            g = ((rgb >> 8) & 0xFF) / 255.0f;
+            b = (rgb & 0xFF) / 255.0f;
+            a = alpha;
+        }
+        ColorF(FLOAT red, FLOAT green, FLOAT blue, FLOAT alpha = 1.0f) {
+            r = red;
+            g = green;
+            b = blue;
+            a = alpha;
+        }
+    };
+
+    class Matrix3x2F : public D2D1_MATRIX_3X2_F {
+    public:
+        Matrix3x2F() {
+            _11 = 1.0f; _12 = 0.0f;
+            _21 = 0.0f; _22 = 1.0f;
+            _31 = 0.0f; _32 = 0.0f;
+        }
+        Matrix3x2F(FLOAT m11, FLOAT m12, FLOAT m21, FLOAT m22, FLOAT dx, FLOAT dy) {
+            _11 = m11; _12 = m12;
+            _21 = m21; _22 = m22;
+            _31 = dx; _32 = dy;
+        }
+
+        static Matrix3x2F Identity() {
+            return Matrix3x2F();
+        }
+        static Matrix3x2F Translation(FLOAT x, FLOAT y) {
+            return Matrix3x2F(1.0f, 0.0f, 0.0f, 1.0f, x, y);
+        }
+        static Matrix3x2F Scale(FLOAT x, FLOAT y, D2D1_POINT_2F center = D2D1_POINT_2F{0, 0}) {
+            return Matrix3x2F(x, 0.0f, 0.0f, y, center.x - x * center.x, center.y - y * center.y);
+        }
+        Matrix3x2F operator*(const Matrix3x2F &m) const {
+            return Matrix3x2F(_11 * m._11 + _12 * m._21, _11 * m._12 + _12 * m._22,
+                              _21 * m._11 + _22 * m._21, _21 * m._12 + _22 * m._22,
+                              _31 * m._11 + _32 * m._21 + m._31, _31 * m._12 + _32 * m._22 + m._32);
+        }
+    };
+
+    inline D2D1_MATRIX_3X2_F IdentityMatrix() {
+        return Matrix3x2F();
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+// 最小 DirectWrite 接口：创建的格式和布局是空对象，足够测试资源缓存的命中和重建开销
+#include <windows.h>
+
+enum DWRITE_FACTORY_TYPE { DWRITE_FACTORY_TYPE_SHARED, DWRITE_FACTORY_TYPE_ISOLATED };
+enum DWRITE_FONT_WEIGHT { DWRITE_FONT_WEIGHT_NORMAL = 400, DWRITE_FONT_WEIGHT_BOLD = 700 };
+enum DWRITE_FONT_STYLE { DWRITE_FONT_STYLE_NORMAL };
+enum DWRITE_FONT_STRETCH { DWRITE_FONT_STRETCH_NORMAL = 5 };
+
+struct DWRITE_TEXT_METRICS {
+    FLOAT left, top, width, widthIncludingTrailingWhitespace, height, layoutWidth, layoutHeight;
+    UINT32 maxBidiReorderingDepth, lineCount;
+};
+
+struct IDWriteTextFormat : IUnknown {
+};
+struct IDWriteTextLayout : IDWriteTextFormat {
+    virtual HRESULT GetMetrics(DWRITE_TEXT_METRICS *metrics) {
+        *metrics = DWRITE_TEXT_METRICS{};
+        return S_OK;
+    }
+};
+
+struct IDWriteFactory : IUnknown {
+    virtual HRESULT CreateTextFormat(const WCHAR *, void *, DWRITE_FONT_WEIGHT, DWRITE_FONT_STYLE,
+                                     DWRITE_FONT_STRETCH, FLOAT, const WCHAR *, IDWriteTextFormat **format) {
+        *format = new IDWriteTextFormat();
+        return S_OK;
+    }
+    virtual HRESULT CreateTextLayout(const WCHAR *, UINT32, IDWriteTextFormat *, FLOAT, FLOAT,
+                                     IDWriteTextLayout **layout) {
+        *layout = new IDWriteTextLayout();
+        return S_OK;
+    }
+};
+
+inline HRESULT DWriteCreateFactory(DWRITE_FACTORY_TYPE, int, IUnknown **factory) {
+    *factory = new IDWriteFactory();
+    return S_OK;
+}
@@ -0,0 +1,2 @@
+#pragma once
+// GraphicsEngine.h 包含此头文件，基准测试不用WIC
@@ -0,0 +1,118 @@
+#pragma once
+// 基准测试在非Windows平台编译时使用的最小 windows.h：只提供算法模块和 GraphicsEngine 用到的类型、宏和函数，
+// 窗口相关的函数都是空实现。COM接口基类带引用计数，Release 到0时删除对象
+// 标准库头文件在定义 min/max 宏之前全部包含一遍，之后再包含时被包含保护跳过，不受宏影响
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cwchar>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <set>
+#include <sstream>
+#include <stack>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+typedef long HRESULT;
+typedef int BOOL;
+typedef unsigned char BYTE;
+typedef unsigned short WORD;
+typedef unsigned long DWORD;
+typedef unsigned int UINT;
+typedef uint32_t UINT32;
+typedef uint64_t UINT64;
+typedef int64_t LONGLONG;
+typedef float FLOAT;
+typedef wchar_t WCHAR;
+typedef const wchar_t *LPCWSTR;
+typedef intptr_t LONG_PTR;
+typedef uintptr_t WPARAM;
+typedef intptr_t LPARAM;
+typedef intptr_t LRESULT;
+typedef void *HANDLE;
+typedef struct HWND__ *HWND;
+typedef struct HINSTANCE__ *HINSTANCE;
+
+typedef struct tagRECT {
+    long left, top, right, bottom;
+} RECT;
+typedef struct tagPOINT {
+    long x, y;
+} POINT;
+
+#define S_OK ((HRESULT)0L)
+// long 在64位 Linux 上是64位，错误码先转成32位有符号数，与 Windows 一样为负值，FAILED 才能判断出来
+#define E_FAIL ((HRESULT)(int32_t)0x80004005u)
+#define E_OUTOFMEMORY ((HRESULT)(int32_t)0x8007000Eu)
+#define E_INVALIDARG ((HRESULT)(int32_t)0x80070057u)
+#define SUCCEEDED(hr) (((HRESULT)(hr)) >= 0)
+#define FAILED(hr) (((HRESULT)(hr)) < 0)
+#define TRUE 1
+#define FALSE 0
+#define CALLBACK
+#define WINAPI
+#define MAX_PATH 260
+#define ARRAYSIZE(a) (sizeof(a) / sizeof((a)[0]))
+#define __uuidof(x) 0
+#define LOWORD(l) ((WORD)(((uintptr_t)(l)) & 0xffff))
+#define HIWORD(l) ((WORD)((((uintptr_t)(l)) >> 16) & 0xffff))
+
+// 源码中有直接使用 min/max 宏的地方，与 windows.h 一样定义
+#ifndef NOMINMAX
+#ifndef min
+#define min(a, b) (((a) < (b)) ? (a) : (b))
+#endif
+#ifndef max
+#define max(a, b) (((a) > (b)) ? (a) : (b))
+#endif
+#endif
+
+inline void OutputDebugStringA(const char *) {
+}
+inline void OutputDebugStringW(const wchar_t *) {
+}
+inline BOOL GetClientRect(HWND, RECT *rect) {
+    if (rect) *rect = RECT{0, 0, 0, 0};
+    return TRUE;
+}
+inline BOOL InvalidateRect(HWND, const RECT *, BOOL) {
+    return TRUE;
+}
+
+struct IUnknown {
+    IUnknown() : m_refCount(1) {
+    }
+    virtual ~IUnknown() {
+    }
+    virtual unsigned long AddRef() {
+        return ++m_refCount;
+    }
+    virtual unsigned long Release() {
+        unsigned long count = --m_refCount;
+        if (count == 0) delete this;
+        return count;
+    }
+
+private:
+    std::atomic<unsigned long> m_refCount;
+};
@@ -63,6 +63,8 @@
 #define ID_32818                        32818
 #define ID_32819                        32819
 #define ID_32820                        32820
+#define ID_32821                        32821
+#define ID_32822                        32822
 #define IDC_STATIC                      -1
 
 // Next default values for new objects
@@ -71,7 +73,7 @@
 #ifndef APSTUDIO_READONLY_SYMBOLS
 #define _APS_NO_MFC                     1
 #define _APS_NEXT_RESOURCE_VALUE        129
-#define _APS_NEXT_COMMAND_VALUE         32821
+#define _APS_NEXT_COMMAND_VALUE         32823
 #define _APS_NEXT_CONTROL_VALUE         1000
 #define _APS_NEXT_SYMED_VALUE           110
 #endif